@@ -85,4 +85,9 @@ class Behaviour {
      * Returns until (excl.) which time on this behaviour applies.
      */
     TimeOfDay until() const;
+
+    /**
+     * Returns the bitmask of days on which this behaviour is active.
+     */
+    DayOfWeekBitMask activeDaysOfWeek() const;
 };
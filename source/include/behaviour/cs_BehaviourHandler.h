@@ -65,12 +65,11 @@ private:
     void handleGetBehaviourDebug(event_t& evt);
 
     /**
-     * Returns b, casted as switch behaviour if that cast is valid and
-     * isValid(*) returns true.
-     * Else, returns nullptr.
+     * Result of the last computeIntendedState() that did not depend on presence.
+     * Valid as long as the schedule generation equals cachedGeneration.
      */
-    SwitchBehaviour* ValidateSwitchBehaviour(Behaviour* behave, Time currentTime,
-       PresenceStateDescription currentPresence);
+    std::optional<uint8_t> cachedIntendedState = {};
+    uint32_t cachedGeneration = 0;
 
     /**
      * The last value returned by getValue.
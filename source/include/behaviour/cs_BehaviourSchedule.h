@@ -0,0 +1,140 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Compiled form of the stored behaviours, used to find the valid behaviours without looping over all of them.
+ *
+ * The from and until times are resolved to seconds since midnight when compiling, so sunrise and sunset
+ * based times do not have to be looked up on every evaluation.
+ *
+ * Between two consecutive boundaries (any from or until time, or midnight), the set of time valid
+ * behaviours and their relevance order doesn't change. This set is computed once per segment, and only
+ * recomputed when the time passes the next boundary, or when the schedule is recompiled.
+ *
+ * The valid set is ordered most relevant first: a later from time (seen from the current time of day) is more relevant,
+ * and for equal from times, an earlier until time is more relevant. Behaviours with the same from and until
+ * time are equally relevant.
+ *
+ * Only depends on plain integers, so it can be used in host tests.
+ */
+class BehaviourSchedule {
+public:
+	static constexpr uint8_t MaxEntries = 50;
+	static constexpr uint32_t SecondsPerDay = 24 * 60 * 60;
+
+	struct __attribute__((__packed__)) entry_t {
+		//! Seconds since midnight from which (incl.) the behaviour applies.
+		uint32_t from;
+		//! Seconds since midnight until which (excl.) the behaviour applies.
+		uint32_t until;
+		//! Bitmask of DayOfWeek.
+		uint8_t activeDays;
+		//! Index of the behaviour in the behaviour store.
+		uint8_t index;
+		//! Behaviour type.
+		uint8_t type;
+	};
+
+	/**
+	 * Remove all entries, and mark the valid set as outdated.
+	 */
+	void clear();
+
+	/**
+	 * Add an entry, and mark the valid set as outdated.
+	 *
+	 * @param[in] index        Index of the behaviour in the behaviour store.
+	 * @param[in] type         Behaviour type.
+	 * @param[in] activeDays   Bitmask of days on which the behaviour is active.
+	 * @param[in] from         Seconds since midnight from which (incl.) the behaviour applies.
+	 * @param[in] until        Seconds since midnight until which (excl.) the behaviour applies.
+	 * @return                 False when there is no space left.
+	 */
+	bool add(uint8_t index, uint8_t type, uint8_t activeDays, uint32_t from, uint32_t until);
+
+	/**
+	 * Make sure the valid set corresponds with the given time.
+	 *
+	 * Cheap when the time is in the same segment as the previous call.
+	 *
+	 * @param[in] posixTime    Current (local) posix time.
+	 */
+	void update(uint32_t posixTime);
+
+	/**
+	 * Number of time valid entries, as computed by the last call to update().
+	 */
+	uint8_t getValidCount() const {
+		return _validCount;
+	}
+
+	/**
+	 * Get a time valid entry, 0 being the most relevant.
+	 */
+	const entry_t& getValid(uint8_t i) const {
+		return _entries[_valid[i]];
+	}
+
+	/**
+	 * Incremented every time the valid set is recomputed.
+	 *
+	 * Results that only depend on the valid set can be cached as long as this value doesn't change.
+	 */
+	uint32_t getGeneration() const {
+		return _generation;
+	}
+
+	/**
+	 * Posix time at which the valid set changes next.
+	 */
+	uint32_t getNextBoundary() const {
+		return _segmentEnd;
+	}
+
+	/**
+	 * Whether a behaviour applies at the given time.
+	 *
+	 * If from == until, the behaviour applies all day.
+	 * When the interval overlaps midnight, the part after midnight uses the active day of yesterday.
+	 */
+	static bool isValid(uint32_t from, uint32_t until, uint8_t activeDays, uint32_t posixTime);
+
+	/**
+	 * Whether two entries have the same from and until time.
+	 */
+	static bool intervalIsEqual(const entry_t& lhs, const entry_t& rhs) {
+		return lhs.from == rhs.from && lhs.until == rhs.until;
+	}
+
+private:
+	entry_t _entries[MaxEntries];
+	uint8_t _entryCount = 0;
+
+	/**
+	 * Indices in _entries of the time valid entries, most relevant first.
+	 */
+	uint8_t _valid[MaxEntries];
+	uint8_t _validCount = 0;
+
+	/**
+	 * The valid set is correct for posix times in [_segmentStart, _segmentEnd).
+	 */
+	uint32_t _segmentStart = 0;
+	uint32_t _segmentEnd = 0;
+
+	uint32_t _generation = 0;
+
+	/**
+	 * Seconds from now until the given time of day, in the range [0, SecondsPerDay).
+	 */
+	static uint32_t normalize(uint32_t timeOfDay, uint32_t nowTimeOfDay) {
+		return (timeOfDay + SecondsPerDay - nowTimeOfDay) % SecondsPerDay;
+	}
+};
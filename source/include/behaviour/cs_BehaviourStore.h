@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <behaviour/cs_BehaviourSchedule.h>
 #include <behaviour/cs_ExtendedSwitchBehaviour.h>
 #include <behaviour/cs_SwitchBehaviour.h>
 #include <behaviour/cs_TwilightBehaviour.h>
@@ -14,6 +15,7 @@
 #include <events/cs_EventListener.h>
 #include <protocol/cs_ErrorCodes.h>
 
+#include <algorithm>
 #include <array>
 #include <optional>
 #include <vector>
@@ -24,29 +26,136 @@
 class BehaviourStore : public EventListener {
 public:
 	static constexpr size_t MaxBehaviours = 50;
+
+	/**
+	 * Size of the largest behaviour type.
+	 */
+	static constexpr size_t MaxBehaviourSize = std::max({
+			sizeof(SwitchBehaviour),
+			sizeof(TwilightBehaviour),
+			sizeof(ExtendedSwitchBehaviour)});
+
 private:
+	/**
+	 * Storage for a single behaviour of any type.
+	 *
+	 * All behaviours are constructed in place in a contiguous array of slots,
+	 * so that replacing or removing a behaviour doesn't fragment the heap.
+	 */
+	struct behaviour_slot_t {
+		alignas(SwitchBehaviour) alignas(TwilightBehaviour) alignas(ExtendedSwitchBehaviour)
+		uint8_t data[MaxBehaviourSize];
+	};
+
+	static behaviour_slot_t slots[MaxBehaviours];
+
+	/**
+	 * Pointers to the behaviours in the slots, nullptr when the slot is empty.
+	 */
 	static std::array<Behaviour*, MaxBehaviours> activeBehaviours;
 
+	/**
+	 * Type of the behaviour in each slot, so that behaviours of a type can be found without touching the slots.
+	 * Only valid when the slot is not empty.
+	 */
+	static std::array<Behaviour::Type, MaxBehaviours> behaviourTypes;
+
+	/**
+	 * Compiled from and until times of the active behaviours.
+	 */
+	static BehaviourSchedule schedule;
+
 public:
 	/**
 	 * handles events concerning updates of the active behaviours on this crownstone.
 	 */
 	virtual void handleEvent(event_t& evt);
 
+	/**
+	 * Iterable view on all stored behaviours that can be used as BehaviourType.
+	 */
+	template<class BehaviourType>
+	class BehaviourView {
+	public:
+		class Iterator {
+		public:
+			Iterator(uint8_t index) : _index(index) {
+				skip();
+			}
+
+			BehaviourType& operator*() const {
+				return *static_cast<BehaviourType*>(activeBehaviours[_index]);
+			}
+
+			Iterator& operator++() {
+				++_index;
+				skip();
+				return *this;
+			}
+
+			bool operator!=(const Iterator& other) const {
+				return _index != other._index;
+			}
+
+			/**
+			 * Index of the current behaviour in the store.
+			 */
+			uint8_t index() const {
+				return _index;
+			}
+
+		private:
+			uint8_t _index;
+
+			void skip() {
+				while (_index < MaxBehaviours
+						&& (activeBehaviours[_index] == nullptr || !BehaviourType::isOfType(behaviourTypes[_index]))) {
+					++_index;
+				}
+			}
+		};
+
+		Iterator begin() const {
+			return Iterator(0);
+		}
+
+		Iterator end() const {
+			return Iterator(MaxBehaviours);
+		}
+	};
+
 	//
 	/*****************************
 	 * NOTE: to loop over a specific type of behaviours simply do:
 	 *
-	 * for(auto b : getActiveBehaviours()){
-	 *   if(auto switchbehave = dynamic_cast<SwitchBehaviour*>(b)){
-	 *     // work with switchbehave
-	 *   }
+	 * for (auto& twilight : getBehaviours<TwilightBehaviour>()) {
+	 *   // work with twilight
 	 * }
+	 *
+	 * Note that getBehaviours<SwitchBehaviour>() includes the extended switch behaviours.
+	 * To only loop over the behaviours that are valid at a given time, use getSchedule().
+	 */
+	template<class BehaviourType>
+	static inline BehaviourView<BehaviourType> getBehaviours() {
+		return BehaviourView<BehaviourType>();
+	}
+
+	/**
+	 * Get all behaviour slots, nullptr for the empty ones.
 	 */
 	static inline std::array<Behaviour*, MaxBehaviours>& getActiveBehaviours() {
 		return activeBehaviours;
 	}
 
+	/**
+	 * Get the compiled schedule of the active behaviours.
+	 *
+	 * Call update() on it with the current time, before looping over the valid entries.
+	 */
+	static inline BehaviourSchedule& getSchedule() {
+		return schedule;
+	}
+
 	/**
 	 * Initialize store from flash.
 	 */
@@ -99,10 +208,30 @@ private:
 	// utilities
 	void dispatchBehaviourMutationEvent();
 
+	/**
+	 * Compile the active behaviours into the schedule.
+	 *
+	 * Has to be called after any change to the active behaviours, or to the sun times.
+	 */
+	void compileSchedule();
+
 	// checks intermediate state of handleReplaceBehaviour for consistency.
 	// returns true if ok, false if nok.
 	bool ReplaceParameterValidation(event_t& evt, uint8_t index, const size_t& behaviourSize);
 
+	/**
+	 * Construct a behaviour in the slot at [index], replacing any behaviour in it.
+	 *
+	 * @return the constructed behaviour.
+	 */
+	template<class BehaviourType>
+	Behaviour* emplaceBehaviour(uint8_t index, const BehaviourType& behaviour);
+
+	/**
+	 * Destruct the behaviour in the slot at [index], and mark the slot empty.
+	 */
+	void destroyBehaviour(uint8_t index);
+
 	// loads the behaviours from state into the 'activeBehaviours' array.
 	// BehaviourType must match BehaviourCsType.
 	template<class BehaviourType>
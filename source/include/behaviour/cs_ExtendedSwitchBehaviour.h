@@ -35,6 +35,9 @@ class ExtendedSwitchBehaviour: public SwitchBehaviour {
 
     virtual Type getType() const override { return Type::Extended; }
 
+    // returns true if a behaviour of given type can be used as ExtendedSwitchBehaviour.
+    static bool isOfType(Type type) { return type == Type::Extended; }
+
     // requiresPresence depends on corebehaviour, extensionIsActive and extensionCondition.
     // it assumes that extensionIsActive is up to date.
     virtual bool requiresPresence() override;
@@ -47,6 +47,9 @@ public:
 
     virtual Type getType() const override { return Type::Switch; }
 
+    // returns true if a behaviour of given type can be used as SwitchBehaviour.
+    static bool isOfType(Type type) { return type == Type::Switch || type == Type::Extended; }
+
     virtual void print();
 
     // =========== Semantics ===========
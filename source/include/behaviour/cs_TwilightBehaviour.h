@@ -47,6 +47,9 @@ public:
 
     virtual Type getType() const override { return Type::Twilight; }
 
+    // returns true if a behaviour of given type can be used as TwilightBehaviour.
+    static bool isOfType(Type type) { return type == Type::Twilight; }
+
     // Because of the definition of isValid(PresenceStateDescription) in this class
     // the base class function with the same name is shadowed. This using statement
     // reintroduces the function name in this class's scope.
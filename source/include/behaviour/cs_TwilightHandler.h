@@ -55,6 +55,13 @@ class TwilightHandler : public EventListener {
 
     std::optional<uint8_t> currentIntendedState = 100;
 
+    /**
+     * Result of the last computeIntendedState().
+     * Valid as long as the schedule generation equals cachedGeneration.
+     */
+    std::optional<uint8_t> cachedIntendedState = {};
+    uint32_t cachedGeneration = 0;
+
     /**
      * Is this handler active?
      */
@@ -77,7 +77,8 @@ public:
 	 * Updates some states.
 	 * Selects a type of data, and puts this in the service data.
 	 * Writes the service data to UART.
-	 * Sends out event EVT_ADVERTISEMENT_UPDATED.
+	 * Encrypts the service data and sends out event EVT_ADVERTISEMENT_UPDATED, unless only the timestamp or counter
+	 * changed since the last advertised data, and that data is not older than ADVERTISING_UNCHANGED_REFRESH_PERIOD.
 	 *
 	 * @param[in] initial         Set initial to true when this is just the initial data
 	 *                            when there's no need to send out the event.
@@ -106,6 +107,21 @@ private:
 	 */
 	service_data_t _serviceData;
 
+	/**
+	 * Service data that is being filled, before encryption.
+	 */
+	service_data_t _nextServiceData;
+
+	/**
+	 * The last advertised service data, before encryption.
+	 */
+	service_data_t _advertisedServiceData;
+
+	/**
+	 * Number of updates that were not advertised, because only the timestamp or counter changed.
+	 */
+	uint8_t _unchangedUpdates = 0;
+
 	//! Cache own ID
 	stone_id_t _crownstoneId = 0;
 
@@ -138,6 +154,18 @@ private:
 
 	uint32_t _sendStateCountdown = MESH_SEND_STATE_INTERVAL_MS / TICK_INTERVAL_MS;
 
+	//! Cache the hub mode.
+	bool _hubMode = false;
+
+	//! Cache whether encryption is enabled.
+	bool _encryptionEnabled = false;
+
+	//! Cache the behaviour master hash.
+	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) _behaviourMasterHash = 0;
+
+	//! Cache the asset filters version.
+	TYPIFY(STATE_ASSET_FILTERS_VERSION) _assetFiltersVersion;
+
 	//! Cache the operation mode.
 	OperationMode _operationMode = OperationMode::OPERATION_MODE_UNINITIALIZED;
 
@@ -176,6 +204,16 @@ private:
 	 */
 	void encryptServiceData();
 
+	/**
+	 * Whether the next service data only differs from the advertised service data in the timestamp or counter.
+	 */
+	bool onlyCounterChanged();
+
+	/**
+	 * Clear the timestamp or counter of service data of this crownstone.
+	 */
+	static void clearCounter(service_data_t& serviceData);
+
 	/**
 	 * Put the state of this Crownstone in setup mode in the service data.
 	 */
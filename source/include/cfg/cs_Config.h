@@ -134,12 +134,18 @@
 #define CS_WATCHDOG_TIMEOUT_MS                   60000
 
 
-#define CS_ADC_SAMPLE_INTERVAL_US                200 // 100 samples per period of 50Hz wave
+#define CS_ADC_SAMPLE_INTERVAL_US                200 // 100 samples per period of 50Hz wave, used by the default sampling profile.
+#define CS_ADC_SAMPLE_INTERVAL_HIGH_RATE_US      100 // Used by the high rate sampling profile, for harmonic analysis.
+#define CS_ADC_SAMPLE_INTERVAL_LOW_POWER_US      400 // Used by the low power sampling profile.
 #define CS_ADC_NUM_CHANNELS                      2 // Number of channels (pins) to sample.
-#define CS_ADC_NUM_SAMPLES_PER_CHANNEL           (20000 / CS_ADC_SAMPLE_INTERVAL_US) // Make size so it fills up 20ms of data.
+#define CS_ADC_BUFFER_DURATION_US                20000 // Each buffer holds 20ms of data, whatever the sampling profile.
+#define CS_ADC_NUM_SAMPLES_PER_CHANNEL           (CS_ADC_BUFFER_DURATION_US / CS_ADC_SAMPLE_INTERVAL_US) // Number of samples per channel with the default sampling profile.
+#define CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL       (CS_ADC_BUFFER_DURATION_US / CS_ADC_SAMPLE_INTERVAL_HIGH_RATE_US)
 //#define CS_ADC_BUF_SIZE                          (CS_ADC_NUM_CHANNELS * CS_ADC_NUM_SAMPLES_PER_CHANNEL)
 
 #define CS_ADC_NUM_BUFFERS                       9 // 5 buffers are held by processing, 2 queued in SAADC, 1 moves between them, 1 extra for CPU usage peaks.
+#define CS_ADC_NUM_BUFFERS_HIGH_RATE             6 // 3 buffers are held by processing (the minimum for channel swap detection and switch samples), 2 queued in SAADC, 1 moves between them.
+#define CS_ADC_PROCESSING_BUDGET_PERCENT         50 // Part of the buffer duration that processing a buffer may take, the rest is for BLE, mesh, etc.
 #define CS_ADC_TIMEOUT_SAMPLES                   2 // Timeout when no buffer has been set at N samples before end of interval.
 
 
@@ -162,11 +168,14 @@
 //#define CURRENT_ZERO_EXP_AVG_DISCOUNT            1000 // No averaging
 #define POWER_EXP_AVG_DISCOUNT                   200 // Is divided by 1000, so 200 is a discount of 0.2. // 99% of the average is influenced by the last 21 values
 //#define POWER_EXP_AVG_DISCOUNT                   1000 // No averaging
-#define POWER_SAMPLING_RMS_WINDOW_SIZE           9 // Windows size used for filtering the power and current rms. Currently can only be 7, 9, or 25!
+#define POWER_SAMPLING_RMS_WINDOW_SIZE           9 // Windows size used for filtering the power and current rms, preferably odd.
 
 #define POWER_SAMPLING_CURVE_HALF_WINDOW_SIZE    5 // Half window size used for filtering the current curve. Can't just be any value!
 //#define POWER_SAMPLING_CURVE_HALF_WINDOW_SIZE    16 // Half window size used for filtering the current curve. Can't just be any value!
 
+#define POWER_HARMONICS_COUNT                    8  // Number of analysed current harmonics: the fundamental and the odd harmonics 3, 5, .., 15.
+#define POWER_HARMONICS_INTERVAL_PERIODS         50 // Analyse the harmonics every so many AC periods. Set to 0 to disable the analysis.
+
 
 #define POWER_DIFF_THRESHOLD_PART                0.10f  // When difference is 10% larger or smaller, consider it a significant change.
 #define POWER_DIFF_THRESHOLD_MIN_WATT            10.0f  // But the difference must also be at least so many Watts.
@@ -238,13 +247,19 @@
 #define ADVERTISING_TIMEOUT                      0
 #define ADVERTISING_REFRESH_PERIOD               500 // Push the changes in the advertisement packet to the stack every x milliseconds
 #define ADVERTISING_REFRESH_PERIOD_SETUP         500 // Push the changes in the advertisement packet to the stack every x milliseconds
+#define ADVERTISING_UNCHANGED_REFRESH_PERIOD     2000 // Push service data of which only the timestamp or counter changed every x milliseconds
 
 #define EXTERNAL_STATE_LIST_COUNT                10 // Number of stones to cache the state of, for advertising external state.
 #define EXTERNAL_STATE_TIMEOUT_MS                60000 // Time after which a state of another stone is considered to be timed out.
 
+#ifndef TRACKED_DEVICES_MAX_COUNT
+#define TRACKED_DEVICES_MAX_COUNT                32 // Number of tracked devices to remember, the least recently used device is removed when full.
+#endif
+
 #define SWITCH_ON_AT_SETUP_BOOT_DELAY            3600  // Seconds until the switch turns on when in setup mode (Crownstone built-in only)
 
 #define SUN_TIME_THROTTLE_PERIOD_SECONDS         (60*60*24) // Seconds to throttle writing the sun time to flash.
+#define ENERGY_CHECKPOINT_MAX_DELAY_SECONDS      (15*60) // Max seconds before the accumulated energy is written to flash, it's written earlier along with other writes.
 
 #define CS_CLEAR_GPREGRET_COUNTER_TIMEOUT_S      60 // Seconds after boot to clear the GPREGRET reset counter.
 
@@ -253,6 +268,14 @@
  */
 #define TICK_INTERVAL_MS 100
 
+/**
+ * Defaults of the nearest crownstone election: no hysteresis, and no suppression beyond a single tick.
+ * In test_LocalisationSimulator, 2 dB and 300 ms send fewer messages, but are not clearly more correct, and decide later.
+ * Can be changed with CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS and CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD.
+ */
+#define NEAREST_CROWNSTONE_RSSI_HYSTERESIS_DB              0
+#define NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD_MS    TICK_INTERVAL_MS
+
 #define CONFIG_POWER_ZERO_INVALID 0x7FFFFFFF
 
 #ifndef STATE_SWITCH_STATE_DEFAULT
@@ -16,6 +16,22 @@
 
 // REVIEW: this class seems like a lot of RAM/code overhead for its current use case.
 
+/**
+ * Identifies a component class, without the need for RTTI.
+ */
+typedef const void* component_type_t;
+
+/**
+ * Returns the type of component class T.
+ *
+ * This is the address of a static variable, so it's unique per class.
+ */
+template <class T>
+component_type_t getComponentTypeOf() {
+	static uint8_t typeId;
+	return &typeId;
+}
+
 /**
  * Helper class to manage decoupling of components.
  *
@@ -60,6 +76,13 @@ public:
 
 	// ================== Getters ==================
 
+	/**
+	 * Returns the type of this component.
+	 *
+	 * Implemented by each component class as: return getComponentTypeOf<ClassName>();
+	 */
+	virtual component_type_t getComponentType() const = 0;
+
 	inline std::vector<Component*> getChildren() {
 		return _children;
 	}
@@ -68,6 +91,8 @@ public:
 	 * Returns a component of type T* from _children, or
 	 * owned by the parent of this component.
 	 * If none-exists, a nullptr is returned.
+	 *
+	 * Only components of exactly type T are returned, not of a class derived from T.
 	 */
 	template <class T>
 	T* getComponent(Component* requester = nullptr);
@@ -153,9 +178,8 @@ T* Component::getComponent(Component* requester) {
 			continue;
 		}
 
-		T* t = dynamic_cast<T*>(c);
-		if (t != nullptr) {
-			return t;
+		if (c->getComponentType() == getComponentTypeOf<T>()) {
+			return static_cast<T*>(c);
 		}
 	}
 
@@ -154,6 +154,9 @@ enum class CS_TYPE: uint16_t {
 	STATE_BEHAVIOUR_RULE                    = 69,
 	STATE_TWILIGHT_RULE                     = 70,
 	STATE_EXTENDED_BEHAVIOUR_RULE			= 71,
+	CONFIG_ADC_SAMPLING_PROFILE             = 72,    // Sampling interval and processing budget of the ADC, applied on boot.
+	CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS = 73,  // RSSI margin in dB by which another crownstone should be closer to become nearest.
+	CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD = 74, // Minimum time in ms between two reports about the same asset.
 
 	STATE_RESET_COUNTER                     = 128,
 	STATE_SWITCH_STATE                      = 129,
@@ -193,6 +196,8 @@ enum class CS_TYPE: uint16_t {
 	STATE_ASSET_FILTER_256                  = 163,
 	STATE_ASSET_FILTER_512                  = 164,
 
+	STATE_ENERGY_CHECKPOINT                 = 165,    // Accumulated energy, stored in flash every now and then.
+
 	/*
 	 * Internal commands and events.
 	 * Start at Internal_Base.
@@ -348,6 +353,8 @@ enum class CS_TYPE: uint16_t {
 	CMD_GET_GPREGRET,                                 // Get the Nth general purpose retention register as it was on boot.
 	CMD_GET_ADC_CHANNEL_SWAPS,                        // Get number of detected ADC channel swaps.
 	CMD_GET_RAM_STATS,                                // Get RAM statistics.
+	CMD_GET_ADC_PROCESSING_STATS,                     // Get processing time statistics of ADC buffers.
+	CMD_GET_POWER_HARMONICS,                          // Get the last analysed harmonics and power factor of the current.
 
 	CMD_MICROAPP_GET_INFO,                            // Microapp control command.
 	CMD_MICROAPP_UPLOAD,                              // Microapp control command. The data pointer is assume to remain valid until write is completed!
@@ -355,6 +362,7 @@ enum class CS_TYPE: uint16_t {
 	CMD_MICROAPP_REMOVE,                              // Microapp control command.
 	CMD_MICROAPP_ENABLE,                              // Microapp control command.
 	CMD_MICROAPP_DISABLE,                             // Microapp control command.
+	CMD_MICROAPP_GET_CPU_STATS,                       // Microapp control command.
 	EVT_MICROAPP_UPLOAD_RESULT,                       // Uploaded chunk has been written to flash, or failed to do so.
 	EVT_MICROAPP_ERASE_RESULT,                        // Microapp has been erase from flash, or failed to do so.
 	CMD_MICROAPP_ADVERTISE,                           // A microapp wants to advertise something.
@@ -491,6 +499,9 @@ typedef     BOOL TYPIFY(CONFIG_START_DIMMER_ON_ZERO_CROSSING);
 typedef     BOOL TYPIFY(CONFIG_SWITCH_LOCKED);
 typedef     BOOL TYPIFY(CONFIG_SWITCHCRAFT_ENABLED);
 typedef    float TYPIFY(CONFIG_SWITCHCRAFT_THRESHOLD);
+typedef  uint8_t TYPIFY(CONFIG_ADC_SAMPLING_PROFILE); // AdcSamplingProfile
+typedef  uint8_t TYPIFY(CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS);
+typedef uint16_t TYPIFY(CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD);
 typedef     BOOL TYPIFY(CONFIG_TAP_TO_TOGGLE_ENABLED);
 typedef   int8_t TYPIFY(CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET);
 typedef   int8_t TYPIFY(CONFIG_TX_POWER);
@@ -499,6 +510,7 @@ typedef    float TYPIFY(CONFIG_VOLTAGE_MULTIPLIER);
 typedef  int32_t TYPIFY(CONFIG_VOLTAGE_ADC_ZERO);
 
 typedef  int64_t TYPIFY(STATE_ACCUMULATED_ENERGY);
+typedef cs_energy_checkpoint_t TYPIFY(STATE_ENERGY_CHECKPOINT);
 typedef state_errors_t TYPIFY(STATE_ERRORS);
 typedef  uint8_t TYPIFY(STATE_FACTORY_RESET);
 typedef  uint8_t TYPIFY(STATE_OPERATION_MODE);
@@ -665,12 +677,15 @@ typedef void TYPIFY(CMD_GET_RESET_REASON);
 typedef uint8_t TYPIFY(CMD_GET_GPREGRET);
 typedef void TYPIFY(CMD_GET_ADC_CHANNEL_SWAPS);
 typedef void TYPIFY(CMD_GET_RAM_STATS);
+typedef void TYPIFY(CMD_GET_ADC_PROCESSING_STATS);
+typedef void TYPIFY(CMD_GET_POWER_HARMONICS);
 typedef void TYPIFY(CMD_MICROAPP_GET_INFO);
 typedef microapp_upload_internal_t TYPIFY(CMD_MICROAPP_UPLOAD);
 typedef microapp_ctrl_header_t TYPIFY(CMD_MICROAPP_VALIDATE);
 typedef microapp_ctrl_header_t TYPIFY(CMD_MICROAPP_REMOVE);
 typedef microapp_ctrl_header_t TYPIFY(CMD_MICROAPP_ENABLE);
 typedef microapp_ctrl_header_t TYPIFY(CMD_MICROAPP_DISABLE);
+typedef microapp_ctrl_header_t TYPIFY(CMD_MICROAPP_GET_CPU_STATS);
 typedef cs_ret_code_t TYPIFY(EVT_MICROAPP_UPLOAD_RESULT);
 typedef cs_ret_code_t TYPIFY(EVT_MICROAPP_ERASE_RESULT);
 typedef microapp_advertise_request_t TYPIFY(CMD_MICROAPP_ADVERTISE);
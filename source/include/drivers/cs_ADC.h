@@ -31,6 +31,7 @@ enum adc_gain_t {
  * The typedef adc_done_cb_t is a function pointer to a function with the buffer index as argument.
  * This function pointer can be set via ADC::setDoneCallback.
  * Currently, ADC::setDoneCallback is called from cs_PowerSampling.cpp.
+ * The callback holds the buffer until it calls ADC::releaseBuffer().
  */
 typedef void (*adc_done_cb_t) (adc_buffer_id_t bufIndex);
 
@@ -76,7 +77,8 @@ enum adc_saadc_state_t {
  * The buffers to be used internally. To have these buffers in the form of macros means that we can check at compile
  * time if they are small enough with respect to the nRF52 memory limitations.
  *
- *   - CS_ADC_NUM_BUFFERS              The number of ADC buffers to use, should be at least 2.
+ *   - CS_ADC_NUM_BUFFERS              The max number of ADC buffers to use, should be at least 2.
+ *   - CS_ADC_BUFFER_DURATION_US       The time it takes to fill a buffer, the number of samples depends on the sampling interval.
  *   - CS_ADC_BUF_SIZE                 The size of the buffer (first time used in init()).
  *
  * The pins:
@@ -116,6 +118,15 @@ public:
 	 */
 	void setDoneCallback(adc_done_cb_t callback);
 
+	/**
+	 * Release a buffer that was given to the done callback, so that it can be filled again.
+	 *
+	 * Only to be called from main thread.
+	 *
+	 * @param[in] bufIndex             The buffer to release.
+	 */
+	void releaseBuffer(adc_buffer_id_t bufIndex);
+
 	/** Set the callback which is called on a zero crossing interrupt.
 	 *
 	 * Currently only called when going from below to above the zero.
@@ -221,13 +232,6 @@ private:
 	 */
 	nrf_ppi_channel_t _ppiChannelStart;
 
-	/**
-	 * Queue of buffers that are free to be added to the SAADC queue.
-	 *
-	 * == Used in interrupt! ==
-	 */
-	CircularBuffer<adc_buffer_id_t> _bufferQueue;
-
 	/**
 	 * Keeps up which buffers that are queued in the SAADC peripheral.
 	 *
@@ -332,7 +336,7 @@ private:
 	cs_ret_code_t initBufferQueue();
 
 	/**
-	 * Try to add all queued buffers to the SAADC queue.
+	 * Try to add free buffers to the SAADC queue, until it's full.
 	 * If the SAADC queue is now filled, stop the timeout timer.
 	 *
 	 * @return ERR_SUCCESS when SAADC queue is full,           and timeout timer has been stopped.
@@ -8,21 +8,16 @@
 #pragma once
 
 #include <ble/cs_Nordic.h>
+#include <encryption/cs_AesEngine.h>
 #include <structs/cs_PacketsInternal.h>
 
-/**
- * AES block size.
- *
- * 16 byte size, just like SOC_ECB_CLEARTEXT_LENGTH and SOC_ECB_CIPHERTEXT_LENGTH.
- */
-#define AES_BLOCK_SIZE 16
-
 /**
  * Class that implements AES encryption.
  *
  * - Block size is 16 byte.
  * - ECB mode has no decrypt method, as that's not hardware accelerated.
  * - CTR mode has both encrypt and decrypt methods.
+ * - Multiple blocks are encrypted at once, see AesEngine.
  */
 class AES {
 public:
@@ -110,9 +105,9 @@ private:
 	cs_ret_code_t ctr(cs_data_t key, cs_data_t nonce, cs_data_t inputPrefix, cs_data_t input, cs_data_t outputPrefix, cs_data_t output, cs_buffer_size_t& writtenSize, uint8_t blockCtr = 0);
 
 	/**
-	 * Struct with key, and single block of encrypted and decypted data.
+	 * Engine that does the actual encryption, in batches of blocks.
 	 */
-	nrf_ecb_hal_data_t _block __attribute__ ((aligned (4)));
+	AesEngine _engine;
 
 };
 
@@ -0,0 +1,111 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <ble/cs_Nordic.h>
+#include <structs/cs_PacketsInternal.h>
+
+/**
+ * AES block size.
+ *
+ * 16 byte size, just like SOC_ECB_CLEARTEXT_LENGTH and SOC_ECB_CIPHERTEXT_LENGTH.
+ */
+#define AES_BLOCK_SIZE 16
+
+/**
+ * Number of blocks that are encrypted with a single call to the ECB peripheral.
+ */
+#define AES_ENGINE_BATCH_NUM_BLOCKS 4
+
+/**
+ * Engine that encrypts multiple AES blocks at once.
+ *
+ * - Encrypts up to AES_ENGINE_BATCH_NUM_BLOCKS blocks per call to the softdevice, using sd_ecb_blocks_encrypt().
+ * - In CTR mode, the counter blocks are prepared once per message, only the counter byte changes per block.
+ * - The keystream is XOR-ed with the data word-wise when the buffers allow it.
+ * - When compiled for the host, a software AES implementation is used instead of the softdevice.
+ *
+ * Does not check whether the softdevice is enabled, or whether the buffers are large enough: that's up to the caller.
+ */
+class AesEngine {
+public:
+	AesEngine();
+
+	/**
+	 * Set the key to encrypt with.
+	 *
+	 * @param[in]  key                 Key of AES_BLOCK_SIZE bytes.
+	 */
+	void setKey(const uint8_t* key);
+
+	/**
+	 * Encrypt data in ECB mode.
+	 *
+	 * The data that's encrypted is a concatenation of prefix and input, zero padded to a multiple of the block size.
+	 *
+	 * @param[in]  prefix              Extra data to put before the input data.
+	 * @param[in]  input               Input data to be encrypted.
+	 * @param[out] output              Buffer to encrypt to, should be at least numBlocks * AES_BLOCK_SIZE bytes.
+	 * @param[in]  numBlocks           Number of blocks to encrypt.
+	 */
+	void ecb(cs_data_t prefix, cs_data_t input, cs_data_t output, uint16_t numBlocks);
+
+	/**
+	 * Encrypt or decrypt data in CTR mode.
+	 *
+	 * The input stream is a concatenation of input prefix, input, and zero padding.
+	 * The output stream is a concatenation of output prefix and output.
+	 * The data is processed front to back, so the output may overlap the input, as long as the output stream position
+	 * of every byte is at or before its input stream position.
+	 *
+	 * @param[in]  nonce               Nonce, put at the start of each counter block.
+	 * @param[in]  inputPrefix         Extra data to put before the input data.
+	 * @param[in]  input               Input data.
+	 * @param[out] outputPrefix        Buffer to write to, before writing to the output buffer.
+	 * @param[out] output              Buffer to write to.
+	 * @param[in]  numBlocks           Number of blocks to process.
+	 * @param[in]  blockCtr            Initial block counter, put in the last byte of the counter block.
+	 * @return                         Number of bytes written to output, excluding the output prefix.
+	 */
+	cs_buffer_size_t ctr(cs_data_t nonce, cs_data_t inputPrefix, cs_data_t input, cs_data_t outputPrefix, cs_data_t output, uint16_t numBlocks, uint8_t blockCtr);
+
+	/**
+	 * XOR input with keystream, and write it to output.
+	 *
+	 * Uses 32 bit words when all buffers are word aligned.
+	 */
+	static void xorBytes(uint8_t* output, const uint8_t* input, const uint8_t* keystream, cs_buffer_size_t size);
+
+private:
+	/**
+	 * Key, aligned so it can be read by the ECB peripheral without copying.
+	 */
+	uint8_t _key[AES_BLOCK_SIZE] __attribute__ ((aligned (4)));
+
+	/**
+	 * Batch of blocks to be encrypted.
+	 */
+	uint8_t _cleartext[AES_ENGINE_BATCH_NUM_BLOCKS][AES_BLOCK_SIZE] __attribute__ ((aligned (4)));
+
+	/**
+	 * Batch of encrypted blocks, or keystream in case of CTR mode.
+	 */
+	uint8_t _ciphertext[AES_ENGINE_BATCH_NUM_BLOCKS][AES_BLOCK_SIZE] __attribute__ ((aligned (4)));
+
+#ifndef HOST_TARGET
+	/**
+	 * Block descriptors for the softdevice, these always point to the arrays above.
+	 */
+	nrf_ecb_hal_data_block_t _blocks[AES_ENGINE_BATCH_NUM_BLOCKS];
+#endif
+
+	/**
+	 * Encrypt the first numBlocks blocks of cleartext to ciphertext.
+	 */
+	void encryptBlocks(uint8_t numBlocks);
+};
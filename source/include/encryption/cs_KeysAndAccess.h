@@ -9,14 +9,27 @@
 
 #include <protocol/cs_Packets.h>
 #include <common/cs_Types.h>
+#include <events/cs_EventListener.h>
+
+/**
+ * Number of keys that are cached: admin, member, basic, service data, localization.
+ */
+#define KEYS_AND_ACCESS_NUM_CACHED_KEYS 5
+
+/**
+ * Number of UART keys that are cached: messages are sent with key ID 0, but received with the key ID of the header.
+ */
+#define KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS 2
 
 /**
  * Class to get keys based on access level, and to check access levels.
  *
  * - Generates temporary keys.
  * - Caches state.
+ * - Caches keys, so that encrypting or decrypting a message does not read from State.
+ *   The cache is invalidated when a key is set.
  */
-class KeysAndAccess {
+class KeysAndAccess : public EventListener {
 public:
 	//! Use static variant of singleton, no dynamic memory allocation
 	static KeysAndAccess& getInstance() {
@@ -48,6 +61,37 @@ public:
 	 */
 	bool getKey(EncryptionAccessLevel accessLevel, buffer_ptr_t outBuf, cs_buffer_size_t outBufSize);
 
+	/**
+	 * Get a pointer to the cached key of given access level.
+	 *
+	 * The key is only read from State the first time, or after it changed.
+	 *
+	 * @param[in] accessLevel          Access level of which to get the key.
+	 * @return                         Pointer and size of key. Pointer is NULL when the key is unavailable.
+	 *                                 The data remains valid until the key changes.
+	 */
+	cs_data_t getKey(EncryptionAccessLevel accessLevel);
+
+	/**
+	 * Get a pointer to the cached UART key with given ID.
+	 *
+	 * The last used UART keys are cached, so that sending and receiving don't keep replacing each other's key.
+	 *
+	 * @param[in] keyId                ID of the UART key.
+	 * @return                         Pointer and size of key. Pointer is NULL when the key is unavailable.
+	 *                                 The data remains valid until a UART key changes, or until two other key IDs
+	 *                                 that were not cached have been requested.
+	 */
+	cs_data_t getUartKey(cs_state_id_t keyId);
+
+	/**
+	 * Get the keys version.
+	 *
+	 * This version is incremented each time a key changes, so that classes that derive data from a key, can check
+	 * whether they should derive it again.
+	 */
+	uint8_t getKeysVersion();
+
 	/**
 	 * Get a pointer to the setup key.
 	 *
@@ -77,6 +121,11 @@ public:
 	 */
 	void invalidateSetupKey();
 
+	/**
+	 * Internal usage.
+	 */
+	void handleEvent(event_t& event) override;
+
 private:
 	// This class is singleton, make constructor private.
 	KeysAndAccess();
@@ -107,6 +156,54 @@ private:
 	 */
 	bool _setupKeyValid = false;
 
+	/**
+	 * Cached keys, see getCacheIndex() for the index.
+	 */
+	uint8_t _keys[KEYS_AND_ACCESS_NUM_CACHED_KEYS][ENCRYPTION_KEY_LENGTH];
+
+	/**
+	 * Bitmask of which cached keys are valid.
+	 */
+	uint8_t _keysCachedBitmask = 0;
+
+	/**
+	 * Cached UART keys.
+	 */
+	uint8_t _uartKeys[KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS][ENCRYPTION_KEY_LENGTH];
+
+	/**
+	 * ID of each cached UART key.
+	 */
+	cs_state_id_t _uartKeyIds[KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS] = {};
+
+	/**
+	 * Bitmask of which cached UART keys are valid.
+	 */
+	uint8_t _uartKeysCachedBitmask = 0;
+
+	/**
+	 * Index of the cached UART key that was used last, so that it's not the one to be replaced.
+	 */
+	uint8_t _uartKeyLastUsedIndex = 0;
+
+	/**
+	 * Incremented each time a key changes.
+	 */
+	uint8_t _keysVersion = 0;
+
+	/**
+	 * Get the index in the key cache, and the state type of a key.
+	 *
+	 * @param[in]  accessLevel         Access level of the key.
+	 * @param[out] type                State type of the key.
+	 * @return                         Index in the cache, or -1 when the key is not cached.
+	 */
+	int8_t getCacheIndex(EncryptionAccessLevel accessLevel, CS_TYPE& type);
+
+	/**
+	 * Invalidate the cached key of given state type.
+	 */
+	void onKeyChange(CS_TYPE type);
 };
 
 
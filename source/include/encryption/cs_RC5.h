@@ -58,8 +58,20 @@ private:
 	 */
 	uint16_t _subKeys[RC5_NUM_SUBKEYS];
 
+	/**
+	 * Whether the round subkey words are prepared.
+	 */
+	bool _keyPrepared = false;
+
+	/**
+	 * Keys version of KeysAndAccess at the time the round subkey words were prepared.
+	 */
+	uint8_t _keysVersion = 0;
+
 	/**
 	 * Expands the key of given access level.
+	 *
+	 * Done again when the keys version of KeysAndAccess changed.
 	 */
 	bool initKey(EncryptionAccessLevel accessLevel);
 
@@ -6,6 +6,7 @@
  */
 #pragma once
 
+#include <localisation/cs_AssetFilterInput.h>
 #include <protocol/cs_AssetFilterPackets.h>
 #include <structs/cs_AssetFilterStructs.h>
 #include <util/cs_CuckooFilter.h>
@@ -18,44 +19,6 @@
  */
 
 
-/**
- * Class that determines the input data for a filter or for the output.
- */
-class AssetFilterInput {
-public:
-	uint8_t* _data;  // byte representation of this object.
-	AssetFilterInput(uint8_t* data) : _data(data) {}
-
-	/**
-	 * Get the type of input.
-	 */
-	AssetFilterInputType*           type();
-
-	/**
-	 * Get the payload for type AdDataType.
-	 *
-	 * @return nullptr if type is not AdDataType.
-	 */
-	ad_data_type_selector_t*        AdTypeField();
-
-	/**
-	 * Get the payload for type MaskedAdDataType.
-	 *
-	 * @return nullptr if type is not MaskedAdDataType.
-	 */
-	masked_ad_data_type_selector_t* AdTypeMasked();
-
-	/**
-	 * Checks if the data has valid values.
-	 */
-	bool isValid();
-
-	/**
-	 * Get the expected length of this class, depends on type.
-	 */
-	size_t length();
-};
-
 /**
  * Class that determines the output method and data of an asset that passed the filter.
  */
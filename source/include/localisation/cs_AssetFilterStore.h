@@ -14,6 +14,7 @@
 #include <optional>
 #include <protocol/cs_AssetFilterPackets.h>
 #include <structs/cs_AssetFilterStructs.h>
+#include <time/cs_TimerWheel.h>
 
 /**
  * Keeps up the asset filters.
@@ -26,6 +27,10 @@
  */
 class AssetFilterStore : public EventListener, public Component {
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<AssetFilterStore>();
+	}
+
 	/**
 	 * set _filterModificationInProgress to false.
 	 */
@@ -116,11 +121,9 @@ private:
 	uint32_t _masterCrc;
 
 	/**
-	 * When this value is not 0, the filters are being modified.
-	 *
-	 * Reduced by 1 every tick.
+	 * While this timer is scheduled, the filters are being modified.
 	 */
-	uint16_t _modificationInProgressCountdown = 0;
+	timer_wheel_entry_t _modificationInProgressTimeout;
 
 	/**
 	 * Allocates RAM for a filter of given size, and adds it to the filters array.
@@ -228,8 +231,6 @@ private:
 	 */
 	void handleGetFilterSummariesCommand(cs_result_t& result);
 
-	void onTick();
-
 	// -------------------------------------------------------------
 	// ---------------------- Utility functions --------------------
 	// -------------------------------------------------------------
@@ -250,6 +251,13 @@ private:
 	 */
 	void inProgressTimeout();
 
+	/**
+	 * Called by the timer wheel, calls inProgressTimeout().
+	 *
+	 * @param[in] context              Pointer to the asset filter store.
+	 */
+	static void onInProgressTimeout(void* context);
+
 	/**
 	 * Send an internal event when isInProgress() may have changed.
 	 */
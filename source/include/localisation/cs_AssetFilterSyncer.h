@@ -21,6 +21,10 @@
  */
 class AssetFilterSyncer : public EventListener, public Component {
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<AssetFilterSyncer>();
+	}
+
 	/**
 	 * Interval at which the master version is broadcasted.
 	 */
@@ -18,6 +18,10 @@
 
 class AssetFiltering : public EventListener, public Component {
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<AssetFiltering>();
+	}
+
 	/**
 	 * Initialize this class.
 	 *
@@ -17,6 +17,10 @@ class AssetForwarder : public EventListener, public Component {
 	static constexpr uint16_t MIN_THROTTLED_ADVERTISEMENT_PERIOD_MS = 1000;
 
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<AssetForwarder>();
+	}
+
 	cs_ret_code_t init();
 
 	/**
@@ -8,18 +8,29 @@
 #pragma once
 
 #include <util/cs_Rssi.h>
+#include <util/cs_RssiStats.h>
 
 struct __attribute__((__packed__)) asset_record_t {
+	/**
+	 * Number of scans over which the RSSI is averaged.
+	 */
+	static constexpr uint16_t RSSI_WINDOW_SIZE = 4;
+
 	/**
 	 * ID of the asset, unique field.
 	 */
 	short_asset_id_t assetId;
 
 	/**
-	 * Most recent RSSI value observed by this Crownstone.
+	 * Averaged RSSI value observed by this Crownstone, with the channel of the most recent scan.
 	 */
 	compressed_rssi_data_t myRssi;
 
+	/**
+	 * Running average of the RSSI values observed by this Crownstone.
+	 */
+	RssiStats<RSSI_WINDOW_SIZE> myRssiStats;
+
 	/**
 	 * Set to 0 each time this asset is scanned.
 	 * Increment at regular interval.
@@ -46,22 +57,53 @@ struct __attribute__((__packed__)) asset_record_t {
 	 * Only valid when the nearest stone ID is valid.
 	 */
 	compressed_rssi_data_t nearestRssi;
+
+	/**
+	 * When not 0, no report about this asset should be sent.
+	 * Decrement every tick.
+	 */
+	uint8_t reportSuppressionCountdown;
+
+	/**
+	 * Bitmask of reports about this asset that wait to be sent.
+	 */
+	uint8_t pendingReports;
+
+	/**
+	 * RSSI of the last broadcast this stone sent about this asset.
+	 */
+	compressed_rssi_data_t broadcastRssi;
 #endif
 
 	// ------------- utility functions -------------
 
 	void empty() {
 		lastReceivedCounter = 0;
+		myRssiStats.reset();
 #if BUILD_CLOSEST_CROWNSTONE_TRACKER == 1
 		nearestStoneId = 0;
+		reportSuppressionCountdown = 0;
+		pendingReports = 0;
+		broadcastRssi = {};
 #endif
 	}
 
+	/**
+	 * Add an RSSI value observed by this Crownstone.
+	 */
+	void addRssi(int8_t rssi, uint8_t channel) {
+		myRssiStats.addValue(rssi);
+		myRssi = compressRssi(myRssiStats.getMean(), channel);
+	}
+
 	/**
 	 * Invalidate this record.
 	 */
 	void invalidate() {
 		lastReceivedCounter = 0xFF;
+#if BUILD_CLOSEST_CROWNSTONE_TRACKER == 1
+		pendingReports = 0;
+#endif
 	}
 
 	/**
@@ -14,6 +14,10 @@
 
 class AssetStore : public EventListener, public Component {
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<AssetStore>();
+	}
+
 	/**
 	 * Max number of asset records to keep up.
 	 */
@@ -68,6 +72,16 @@ public:
 	 */
 	void addThrottlingBump(asset_record_t& record, uint16_t timeToNextThrottleOpenMs);
 
+	/**
+	 * Calls func(asset_record_t&) for all records in use, including records that are invalidated.
+	 */
+	template <class Func>
+	void forEachRecord(Func func) {
+		for (uint8_t i = 0; i < _assetRecordCount; ++i) {
+			func(_assetRecords[i]);
+		}
+	}
+
 
 private:
 	/**
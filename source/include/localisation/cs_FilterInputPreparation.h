@@ -0,0 +1,94 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <localisation/cs_AssetFilterInput.h>
+#include <logging/cs_Logger.h>
+#include <structs/cs_PacketsInternal.h>
+#include <util/cs_Utils.h>
+
+#define LogLevelAssetFilteringVerbose SERIAL_VERY_VERBOSE
+
+/**
+ * This method prepares the input of a scanned device according to an input description,
+ * and calls the delegate with the prepared data.
+ *
+ * delegateExpression should be of the form (const uint8_t*, size_t) -> ReturnType.
+ *
+ * Buffers are only allocated when strictly necessary.
+ * (E.g. MacAddress is already available in the `device`, but for MaskedAdDataType a buffer
+ * of 31 bytes needs to be allocated on the stack.)
+ *
+ * Used by the asset filters, and by the scan subscriptions of microapps.
+ */
+template <class ReturnType, class ExpressionType>
+ReturnType prepareFilterInputAndCallDelegate(
+		const scanned_device_t& device,
+		AssetFilterInput filterInputDescription,
+		ExpressionType delegateExpression,
+		ReturnType defaultValue) {
+
+	switch (*filterInputDescription.type()) {
+		case AssetFilterInputType::MacAddress: {
+			return delegateExpression(device.address, sizeof(device.address));
+		}
+		case AssetFilterInputType::AdDataType: {
+			// selects the first found field of configured type and calls the delegate with that field's
+			// data. returns defaultValue if it can't be found.
+			cs_data_t result                  = {};
+			ad_data_type_selector_t* selector = filterInputDescription.AdTypeField();
+
+			if (selector == nullptr) {
+				LOGe("Filter metadata type check failed");
+				return defaultValue;
+			}
+
+			if (BLEutil::findAdvType(selector->adDataType, device.data, device.dataSize, &result) == ERR_SUCCESS) {
+				return delegateExpression(result.data, result.len);
+			}
+
+			return defaultValue;
+		}
+		case AssetFilterInputType::MaskedAdDataType: {
+			// selects the first found field of configured type and calls the delegate with the masked
+			// bytes of that field's data. returns defaultValue if it can't be found.
+			cs_data_t result                         = {};
+			masked_ad_data_type_selector_t* selector = filterInputDescription.AdTypeMasked();
+
+			if (selector == nullptr) {
+				LOGe("Filter metadata type check failed");
+				return defaultValue;
+			}
+
+			if (BLEutil::findAdvType(selector->adDataType, device.data, device.dataSize, &result) == ERR_SUCCESS) {
+				// A normal advertisement payload size is 31B at most.
+				// We are also limited by the 32b bitmask.
+				if (result.len > 31) {
+					LOGw("Advertisement too large");
+					return defaultValue;
+				}
+				uint8_t buff[31];
+
+				// apply the mask
+				uint8_t buffIndex = 0;
+				for (uint8_t bitIndex = 0; bitIndex < result.len; bitIndex++) {
+					if (BLEutil::isBitSet(selector->adDataMask, bitIndex)) {
+						buff[buffIndex] = result.data[bitIndex];
+						buffIndex++;
+					}
+				}
+				_logArray(LogLevelAssetFilteringVerbose, true, buff, buffIndex);
+				return delegateExpression(buff, buffIndex);
+			}
+
+			return defaultValue;
+		}
+	}
+
+	return defaultValue;
+}
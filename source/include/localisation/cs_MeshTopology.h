@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <events/cs_EventListener.h>
 #include <protocol/cs_MeshTopologyPackets.h>
+#include <time/cs_TimerWheel.h>
 
 #if BUILD_MESH_TOPOLOGY_RESEARCH == 1
 #include <localisation/cs_MeshTopologyResearch.h>
@@ -19,8 +20,10 @@ class MeshTopology: EventListener {
 public:
 	/**
 	 * Maximum number of neighbours in the list.
+	 *
+	 * Must be lower than INDEX_NOT_FOUND.
 	 */
-	static constexpr uint8_t MAX_NEIGHBOURS = 50;
+	static constexpr uint8_t MAX_NEIGHBOURS = 100;
 
 	/**
 	 * Time after last seen, before a neighbour is removed from the list.
@@ -68,6 +71,8 @@ public:
 private:
 	static constexpr uint8_t INDEX_NOT_FOUND = 0xFF;
 
+	static_assert(MAX_NEIGHBOURS < INDEX_NOT_FOUND, "Neighbour index must fit in the index table");
+
 	static constexpr int8_t RSSI_INIT = 0; // Should be in protocol
 
 	struct __attribute__((__packed__)) neighbour_node_t {
@@ -75,7 +80,11 @@ private:
 		int8_t rssiChannel37;
 		int8_t rssiChannel38;
 		int8_t rssiChannel39;
-		uint8_t lastSeenSecondsAgo;
+		/**
+		 * Value of the seconds counter when this neighbour was last seen.
+		 * Only the lower bits are stored: a neighbour is removed long before it wraps.
+		 */
+		uint16_t lastSeenSeconds;
 	};
 
 	/**
@@ -93,6 +102,18 @@ private:
 	 */
 	uint8_t _neighbourCount = 0;
 
+	/**
+	 * For each stone ID: the index in the neighbours list, or INDEX_NOT_FOUND. Allocated on init.
+	 */
+	uint8_t* _neighbourIndices = nullptr;
+
+	/**
+	 * Expires when the first neighbour may time out.
+	 *
+	 * Neighbours are only checked for time out when this timer expires.
+	 */
+	timer_wheel_entry_t _timeoutCheck;
+
 	/**
 	 * Next index of the neighbours list to send via the mesh.
 	 */
@@ -138,6 +159,35 @@ private:
 	 */
 	uint8_t find(stone_id_t id);
 
+	/**
+	 * Move a neighbour to another index, overwriting the neighbour at that index.
+	 */
+	void move(uint8_t from, uint8_t to);
+
+	/**
+	 * Remove the neighbour at given index, by moving the last neighbour to that index.
+	 *
+	 * Adjusts the next send index, so that the neighbours that are left are each sent once per round.
+	 */
+	void remove(uint8_t index);
+
+	/**
+	 * Remove all neighbours that timed out, and set the next time to check.
+	 */
+	void removeTimedOut();
+
+	/**
+	 * Called by the timer wheel, calls removeTimedOut().
+	 *
+	 * @param[in] context              Pointer to the mesh topology.
+	 */
+	static void onTimeoutCheck(void* context);
+
+	/**
+	 * Seconds since a neighbour was last seen.
+	 */
+	uint16_t getLastSeenSecondsAgo(const neighbour_node_t& node);
+
 	/**
 	 * Get the RSSI of given stone ID and put it in the result buffer.
 	 */
@@ -13,7 +13,7 @@
 #include <protocol/cs_MeshTopologyPackets.h>
 #include <structs/cs_PacketsInternal.h>
 #include <util/cs_Coroutine.h>
-#include <util/cs_Variance.h>
+#include <util/cs_RssiStats.h>
 
 /**
  * This class/component keeps track of the rssi distance of a
@@ -50,12 +50,16 @@ public:
 private:
 	stone_id_t my_id = 0xff;
 
-	// stores the relevant history, per neighbor stone_id.
-	static constexpr uint8_t CHANNEL_COUNT = 3;
-	static constexpr uint8_t CHANNEL_START = 37;
+	/**
+	 * Number of samples after which the statistics become an exponentially weighted average.
+	 */
+	static constexpr uint16_t RSSI_STATS_WINDOW_SIZE = 256;
+
+	typedef RssiChannelStats<RSSI_STATS_WINDOW_SIZE> rssi_stats_t;
 
-	// TODO: change maps to object for small ram memory footprint optimization
-	std::map<stone_id_t,VarianceAggregator> variance_map[CHANNEL_COUNT] = {};
+	// stores the relevant history, per neighbor stone_id, per channel.
+	// TODO: change map to object for small ram memory footprint optimization
+	std::map<stone_id_t, rssi_stats_t> rssi_stats_map = {};
 
 	// will be set to true by coroutine to flush data after startup.
 	bool boot_sequence_finished = false;
@@ -70,7 +74,7 @@ private:
 	struct TimingSettings {
 		/**
 		 * When flushAggregatedRssiData is in the flushing phase,
-		 * only variance_map entries that have accumulated this many samples will
+		 * only rssi_stats_map entries that have accumulated this many samples will
 		 * be included.
 		 */
 		uint8_t min_samples_to_trigger_burst;
@@ -122,16 +126,16 @@ private:
 	uint32_t flushAggregatedRssiData();
 
 	/**
-	 * Returns the 3 bit descriptor of the given variance as defined
+	 * Returns the 3 bit descriptor of the given fixed point variance as defined
 	 * in cs_PacketsInternal.h.
 	 */
-	inline uint8_t getVarianceRepresentation(float standard_deviation);
+	inline uint8_t getVarianceRepresentation(uint32_t variance);
 
 	/**
 	 * Returns the 7 bit representation of the given mean as defined
 	 * in cs_PacketsInternal.h.
 	 */
-	inline uint8_t getMeanRssiRepresentation(float mean);
+	inline uint8_t getMeanRssiRepresentation(int8_t mean);
 
 	/**
 	 * Returns the 6 bit representation of the given count as defined
@@ -192,9 +196,7 @@ private:
 	void receiveMeshMsgEvent(MeshMsgEvent& mesh_msg_evt);
 
 	/**
-	 * Saves rssi value to last received map and variance recorder map.
-	 * If the long term recorder has accumulated a lot of data, it will
-	 * be reduced to prevent overflow.
+	 * Adds the rssi value to the statistics of the sender, for the given channel.
 	 */
 	void recordRssiValue(stone_id_t sender_id, int8_t rssi, uint8_t channel);
 };
@@ -0,0 +1,129 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cfg/cs_Config.h>
+#include <localisation/cs_AssetRecord.h>
+#include <protocol/cs_Typedefs.h>
+
+struct nearest_crownstone_election_config_t {
+	/**
+	 * Another crownstone only takes over as nearest when its RSSI is closer than the RSSI
+	 * of the current nearest by more than this margin, in steps of 2 dB.
+	 *
+	 * Prevents the nearest crownstone from flip-flopping when an asset is about as close to two crownstones.
+	 */
+	uint8_t rssiHysteresisHalved = NEAREST_CROWNSTONE_RSSI_HYSTERESIS_DB / 2;
+
+	/**
+	 * Minimum number of ticks between two reports about the same asset.
+	 *
+	 * Reports that are requested in the meantime are merged, and sent when the period ended.
+	 * A change of the nearest crownstone, or of its RSSI, is reported without waiting.
+	 *
+	 * Longer periods send fewer messages, but the crownstones agree on the nearest crownstone
+	 * for a smaller part of the time.
+	 */
+	uint8_t reportSuppressionTicks = NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD_MS / TICK_INTERVAL_MS;
+};
+
+/**
+ * Decides which crownstone is nearest to an asset, and which reports about it should be sent.
+ *
+ * Only works on the asset records, the caller sends the actual messages.
+ * This way, it can be used by the NearestCrownstoneTracker as well as by a host simulation of many crownstones.
+ */
+class NearestCrownstoneElection {
+public:
+	/**
+	 * Bits of asset_record_t::pendingReports.
+	 */
+	static constexpr uint8_t PENDING_BROADCAST   = 1 << 0;
+	static constexpr uint8_t PENDING_UART_UPDATE = 1 << 1;
+
+	enum class WinnerChange : uint8_t {
+		NONE,
+		WON,
+		LOST,
+	};
+
+	struct Stats {
+		uint32_t broadcastsSent = 0;
+		uint32_t broadcastsAvoided = 0;
+		uint32_t uartUpdatesSent = 0;
+		uint32_t uartUpdatesAvoided = 0;
+	};
+
+	/**
+	 * @param[in] myStoneId      Stone ID of this crownstone.
+	 * @param[in] config         Hysteresis and suppression settings.
+	 */
+	void init(stone_id_t myStoneId, const nearest_crownstone_election_config_t& config = {});
+
+	/**
+	 * Change the hysteresis and suppression settings.
+	 *
+	 * Takes effect for reports that are queued from now on.
+	 */
+	void setConfig(const nearest_crownstone_election_config_t& config);
+
+	/**
+	 * To be called when this crownstone received an advertisement of the asset.
+	 *
+	 * @param[in] record         Record of the asset.
+	 * @param[in] rssi           RSSI of the advertisement.
+	 * @return                   Whether this crownstone became nearest.
+	 */
+	WinnerChange onAdvertisement(asset_record_t& record, compressed_rssi_data_t rssi);
+
+	/**
+	 * To be called when another crownstone reported its RSSI to the asset.
+	 *
+	 * @param[in] record         Record of the asset.
+	 * @param[in] rssi           RSSI in the report.
+	 * @param[in] reporter       Stone ID of the crownstone that sent the report.
+	 * @return                   Whether this crownstone became, or is no longer, nearest.
+	 */
+	WinnerChange onReport(asset_record_t& record, compressed_rssi_data_t rssi, stone_id_t reporter);
+
+	/**
+	 * To be called every tick, for each asset record.
+	 *
+	 * @param[in] record         Record of the asset.
+	 * @return                   Bitmask of reports about the asset to send now.
+	 *                           When PENDING_BROADCAST is set, the nearest RSSI of the record should be broadcasted.
+	 */
+	uint8_t tick(asset_record_t& record);
+
+	/**
+	 * Number of reports sent and avoided by merging, since init.
+	 */
+	const Stats& getStats() const {
+		return _stats;
+	}
+
+private:
+	stone_id_t _myStoneId = 0;
+	nearest_crownstone_election_config_t _config;
+	Stats _stats;
+
+	/**
+	 * Marks reports about an asset to be sent after its suppression period.
+	 * Reports that are already pending are merged.
+	 *
+	 * @param[in] urgent         Send the reports on the next tick, without waiting for the suppression period.
+	 */
+	void queueReports(asset_record_t& record, uint8_t reports, bool urgent = false);
+
+	/**
+	 * Whether lhs is closer than rhs by more than the hysteresis.
+	 */
+	bool isCloser(const compressed_rssi_data_t& lhs, const compressed_rssi_data_t& rhs);
+
+	void saveWinner(asset_record_t& record, compressed_rssi_data_t rssi, stone_id_t winnerId);
+};
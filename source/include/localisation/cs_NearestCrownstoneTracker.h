@@ -18,6 +18,7 @@
 #include <localisation/cs_AssetRecord.h>
 #include <localisation/cs_AssetStore.h>
 #include <localisation/cs_AssetHandler.h>
+#include <localisation/cs_NearestCrownstoneElection.h>
 
 /**
  * This class implements the in-mesh computation of which crownstone
@@ -46,7 +47,16 @@ class NearestCrownstoneTracker : public EventListener, public Component {
 
 	static constexpr auto FILTER_STRATEGY = FilterStrategy::TIME_OUT;
 
+	/**
+	 * Interval at which the stats are logged.
+	 */
+	static constexpr uint32_t STATS_LOG_PERIOD_MS = 60 * 1000;
+
 public:
+	component_type_t getComponentType() const override {
+		return getComponentTypeOf<NearestCrownstoneTracker>();
+	}
+
 	/**
 	 * Caches CONFIG_CROWNSTONE_ID and AssetStore.
 	 * If assetstore is not available, ERR_NOT_FOUND is returned.
@@ -63,6 +73,18 @@ private:
 	stone_id_t _myStoneId;
 	AssetStore* _assetStore;
 
+	/**
+	 * Decides which crownstone is nearest, and when to send reports.
+	 */
+	NearestCrownstoneElection _election;
+
+	/**
+	 * Records with pending reports, or of which the suppression period didn't end yet.
+	 * Only these have to be visited every tick.
+	 */
+	asset_record_t* _scheduledRecords[AssetStore::MAX_RECORDS];
+	uint8_t _scheduledRecordCount = 0;
+
 	// -------------------------------------------
 	// ------------- Incoming events -------------
 	// -------------------------------------------
@@ -107,6 +129,17 @@ private:
 	 */
 	void onReceiveAssetReport(report_asset_id_t& report, stone_id_t reporter);
 
+	/**
+	 * Called every tick.
+	 * Sends the pending reports of all assets of which the suppression period ended.
+	 */
+	void onTick(uint32_t tickCount);
+
+	/**
+	 * Adds the record to the scheduled records, if the election gave it pending reports or a suppression period.
+	 */
+	void schedule(asset_record_t& record);
+
 	// -------------------------------------------
 	// ------------- Outgoing events -------------
 	// -------------------------------------------
@@ -117,12 +150,6 @@ private:
 	 */
 	void broadcastReport(report_asset_id_t& report);
 
-	/**
-	 * makes a report from the records personalRssi field
-	 * and broadcast it over the mesh.
-	 */
-	void broadcastPersonalReport(asset_record_t& record);
-
 	/**
 	 * Sends a message over UART containing the winner, its rssi
 	 * and the asset id.
@@ -141,11 +168,6 @@ private:
 	// ------------- Utils -------------
 	// ---------------------------------
 
-	/**
-	 * saves the report in the _winning list.
-	 */
-	void saveWinningReport(asset_record_t& rec, compressed_rssi_data_t winningRssi, stone_id_t winningId);
-
 	/**
 	 * getRecord for assetId from assetStore and return it.
 	 * return nullptr if rec->lastReceivedCounter is above threshold.
@@ -154,12 +176,20 @@ private:
 	 */
 	asset_record_t* getRecordFiltered(const short_asset_id_t& assetId);
 
+	/**
+	 * Get the election config from the state.
+	 */
+	nearest_crownstone_election_config_t loadElectionConfig();
+
 public:
 	/**
 	 * Handlers for:
 	 * EVT_MESH_NEAREST_WITNESS_REPORT
 	 * EVT_ASSET_ACCEPTED
 	 * EVT_FILTERS_UPDATED
+	 * EVT_TICK
+	 * CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS
+	 * CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD
 	 */
 	void handleEvent(event_t &evt);
 };
@@ -48,6 +48,11 @@ private:
 	 */
 	bool _loaded = false;
 
+	/**
+	 * Index of the microapp that is called first next tick.
+	 */
+	uint8_t _firstAppIndex = 0;
+
 	void loadApps();
 
 	void loadState(uint8_t index);
@@ -91,7 +96,9 @@ private:
 
 	/**
 	 * To be called every tick.
-	 * Calls all microapps.
+	 *
+	 * Calls the microapps round-robin: each tick, another microapp goes first.
+	 * When the microapps used up MICROAPP_TICK_BUDGET_MS, the remaining microapps go first next tick.
 	 */
 	void tick();
 
@@ -104,6 +111,7 @@ private:
 	cs_ret_code_t handleRemove(microapp_ctrl_header_t* packet);
 	cs_ret_code_t handleEnable(microapp_ctrl_header_t* packet);
 	cs_ret_code_t handleDisable(microapp_ctrl_header_t* packet);
+	cs_ret_code_t handleGetCpuStats(microapp_ctrl_header_t* packet, cs_result_t& result);
 
 	/**
 	 * Checks if control command header is ok.
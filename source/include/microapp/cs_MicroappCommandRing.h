@@ -0,0 +1,69 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cs_MicroappStructs.h>
+#include <protocol/cs_ErrorCodes.h>
+#include <protocol/cs_Typedefs.h>
+
+/**
+ * Handle the commands a microapp queued in its command ring, and write their results to the completion ring.
+ *
+ * To be called when the microapp yielded or returned. Used by MicroappProtocol, and by the host runner, which
+ * each handle the commands themselves.
+ *
+ * @param[in,out] ring            The command ring of the microapp.
+ * @param[in] handleCommand       Called with the payload and length of each valid command, returns the result code.
+ * @param[out] handledCount       Number of commands taken from the command ring.
+ * @return ERR_SUCCESS            When the commands have been handled, or until the completion ring was full.
+ * @return ERR_WRONG_STATE        When the microapp corrupted the command ring, the queued commands are dropped.
+ */
+template <typename CommandHandler>
+cs_ret_code_t handleMicroappCommandRing(
+		microapp_command_ring_t& ring, CommandHandler handleCommand, uint8_t& handledCount) {
+	uint8_t commandHead = ring.commandHead;
+	uint8_t commandTail = ring.commandTail;
+	uint8_t completionHead = ring.completionHead;
+	const uint8_t mask = MICROAPP_COMMAND_RING_SIZE - 1;
+	handledCount = 0;
+
+	if ((uint8_t)(commandHead - commandTail) > MICROAPP_COMMAND_RING_SIZE) {
+		ring.commandTail = commandHead;
+		return ERR_WRONG_STATE;
+	}
+
+	while (commandTail != commandHead) {
+		if ((uint8_t)(completionHead - ring.completionTail) >= MICROAPP_COMMAND_RING_SIZE) {
+			// The microapp has to read the completions first.
+			break;
+		}
+		microapp_ring_command_t& command = ring.commands[commandTail & mask];
+		microapp_ring_completion_t& completion = ring.completions[completionHead & mask];
+		completion.id = commandTail;
+		completion.cmd = command.payload[0];
+		if (command.length == 0) {
+			completion.result = ERR_NO_PAYLOAD;
+		}
+		else if (command.length > MAX_PAYLOAD) {
+			completion.result = ERR_TOO_LARGE;
+		}
+		else if (command.payload[0] == CS_MICROAPP_COMMAND_DELAY) {
+			// Delay yields the coroutine, which we are not in now.
+			completion.result = ERR_NOT_IN_RING;
+		}
+		else {
+			completion.result = handleCommand(command.payload, command.length);
+		}
+		commandTail++;
+		completionHead++;
+		handledCount++;
+	}
+
+	ring.commandTail = commandTail;
+	ring.completionHead = completionHead;
+	return ERR_SUCCESS;
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cs_MicroappStructs.h>
 #include <events/cs_EventListener.h>
+#include <microapp/cs_MicroappScanForwarder.h>
+#include <protocol/cs_MicroappPackets.h>
 #include <structs/buffer/cs_CircularBuffer.h>
 
 extern "C" {
@@ -18,6 +21,16 @@ typedef struct {
 
 #define MICROAPP_LOOP_INTERVAL_MS (TICK_INTERVAL_MS * MICROAPP_LOOP_FREQUENCY)
 
+// Max time all microapps together may run per tick. Microapps that are due after that, are called the next tick.
+#define MICROAPP_TICK_BUDGET_MS 10
+
+// Max time a single call to a microapp may take. Microapps can't be interrupted, so when a call takes longer,
+// the microapp skips a loop for every time the budget was exceeded.
+#define MICROAPP_CALL_BUDGET_MS 5
+
+// Max number of loops a microapp skips after exceeding its budget.
+#define MICROAPP_MAX_PENALTY_LOOPS 10
+
 // The number of 8 interrupt service routines should be sufficient.
 #define MAX_ISR_COUNT 8
 
@@ -27,8 +40,86 @@ typedef struct pin_isr_t {
 } pin_isr_t;
 
 /**
- * The class MicroappProtocol has functionality to store a second app (and perhaps in the future even more apps) on another
- * part of the flash memory.
+ * Runtime state of a microapp.
+ */
+struct microapp_context_t {
+	/**
+	 * Set after the main of the microapp returned.
+	 *
+	 * TODO: Of course, if there is something wrong, booted will not be reached. The foolproof implementation
+	 * sets first the state to a temporarily "POTENTIAL BOOT FAILURE" and if it after a reboots finds the state
+	 * at this particular step, it will disable the app rather than try again. The app has to be then enabled
+	 * explicitly again.
+	 */
+	bool booted = false;
+
+	/**
+	 * Set when the setup and loop addresses have been read from IPC ram.
+	 */
+	bool loaded = false;
+
+	bool setupDone = false;
+
+	/**
+	 * Address to setup() function.
+	 */
+	uintptr_t setup = 0;
+
+	/**
+	 * Address to loop() function.
+	 */
+	uintptr_t loop = 0;
+
+	/**
+	 * Coroutine for the loop of the microapp, with its own stack.
+	 */
+	coroutine loopCoroutine;
+
+	/**
+	 * Arguments to the coroutine.
+	 */
+	coargs loopCoargs;
+
+	/**
+	 * A counter used for the coroutine (to e.g. set the number of ticks for "delay" functionality).
+	 */
+	int cocounter = 0;
+
+	/**
+	 * Implementing count down for a coroutine counter.
+	 */
+	int coskip = 0;
+
+	/**
+	 * Number of ticks until the next loop call.
+	 */
+	uint8_t loopCountdown = 0;
+
+	/**
+	 * Number of loops to skip, because the microapp exceeded its CPU budget.
+	 */
+	uint8_t penaltyLoops = 0;
+
+	microapp_cpu_stats_t stats;
+
+	/**
+	 * Commands queued by the microapp, and their results.
+	 */
+	microapp_command_ring_t commandRing;
+
+	/**
+	 * Forwards scanned devices the microapp subscribed to.
+	 */
+	MicroappScanForwarder scanForwarder;
+};
+
+/**
+ * The class MicroappProtocol has functionality to run microapps, that are stored on another part of the flash memory.
+ *
+ * Each microapp has its own part of the microapp RAM, with its coroutine stack at the end.
+ * The microapps are cooperative: a call only returns to the firmware when the microapp yields or returns.
+ * To make sure one microapp doesn't starve the others, the time of each call is measured, and a microapp
+ * that takes too long skips loops.
  */
 class MicroappProtocol: public EventListener {
 	private:
@@ -40,83 +131,70 @@ class MicroappProtocol: public EventListener {
 		void operator=(MicroappProtocol const &);
 
 		/**
-		 * Local flag to check if app did boot. This flag is set to true after the main of the microapp is called
-		 * and will be set after that function returns. If there is something wrong with the microapp it can be used
-		 * to disable the microapp.
-		 *
-		 * TODO: Of course, if there is something wrong, _booted will not be reached. The foolproof implementation
-		 * sets first the state to a temporarily "POTENTIAL BOOT FAILURE" and if it after a reboots finds the state
-		 * at this particular step, it will disable the app rather than try again. The app has to be then enabled
-		 * explicitly again.
+		 * Runtime state of each microapp.
 		 */
-		bool _booted;
+		microapp_context_t _apps[MAX_MICROAPPS];
 
 		/**
-		 * Local flag to indicate that ram section has been loaded.
+		 * Index of the microapp that is called, so that commands know from which microapp they are.
 		 */
-		bool _loaded;
+		uint8_t _currentAppIndex = 0;
 
 		/**
 		 * Debug mode
 		 */
 		bool _debug;
 
-		/**
-		 * Address to setup() function.
-		 */
-		uintptr_t _setup;
-
-		/**
-		 * Address to loop() function.
-		 */
-		uintptr_t _loop;
-
 		/**
 		 * Addressees of interrupt service routines.
 		 */
 		pin_isr_t _isr[MAX_ISR_COUNT];
 
 		/**
-		 * Coroutine for microapp.
+		 * Store data for callbacks towards the microapp.
 		 */
-		coroutine _coroutine;
+		CircularBuffer<uint8_t>* _callbackData;
+
+	protected:
 
 		/**
-		 * Arguments to the coroutine.
+		 * Call the loop function (internally).
 		 */
-		coargs _coargs;
+		void callLoop(uint8_t appIndex);
 
 		/**
-		 * A counter used for the coroutine (to e.g. set the number of ticks for "delay" functionality).
+		 * Initialize memory for the microapp.
 		 */
-		int _cocounter;
+		uint16_t initMemory(uint8_t appIndex);
 
 		/**
-		 * Implementing count down for a coroutine counter.
+		 * Load ram information, set by microapp.
 		 */
-		int _coskip;
+		uint16_t interpretRamdata(microapp_context_t& app);
 
 		/**
-		 * Store data for callbacks towards the microapp.
+		 * Measure how long a call to a microapp took, and penalize the microapp when it took too long.
+		 *
+		 * @param[in] startCount     RTC count at the start of the call.
 		 */
-		CircularBuffer<uint8_t>* _callbackData;
-
-	protected:
+		void accountCpuTime(uint8_t appIndex, uint32_t startCount);
 
 		/**
-		 * Call the loop function (internally).
+		 * Handle the commands the microapp queued in its command ring, and write their results to the completion ring.
+		 *
+		 * To be called when the microapp yielded or returned.
 		 */
-		void callLoop(int & cntr, int & skip);
+		void handleCommandRing(uint8_t appIndex);
 
 		/**
-		 * Initialize memory for the microapp.
+		 * Start of the RAM of a microapp.
 		 */
-		uint16_t initMemory();
+		uintptr_t getRamStart(uint8_t appIndex);
 
 		/**
-		 * Load ram information, set by microapp.
+		 * Size of the RAM of each microapp.
 		 */
-		uint16_t interpretRamdata();
+		uint32_t getRamSize();
 
 	public:
 		static MicroappProtocol& getInstance() {
@@ -135,10 +213,29 @@ class MicroappProtocol: public EventListener {
 		void callApp(uint8_t appIndex);
 
 		/**
-		 * Call setup and loop functions.
+		 * Call setup and loop functions, to be called every tick.
+		 *
+		 * Setup is called once, loop every MICROAPP_LOOP_FREQUENCY ticks, unless the microapp is delayed or penalized.
 		 */
 		void callSetupAndLoop(uint8_t appIndex);
 
+		/**
+		 * Get the CPU usage of a microapp.
+		 */
+		const microapp_cpu_stats_t& getCpuStats(uint8_t appIndex) {
+			return _apps[appIndex].stats;
+		}
+
+		/**
+		 * Handle a scan command of the microapp that is called.
+		 */
+		cs_ret_code_t handleScanCommand(uint8_t* payload, uint16_t length);
+
+		/**
+		 * Handle a command ring command: set the address of the command ring of the microapp that is called.
+		 */
+		cs_ret_code_t handleCommandRingCommand(uint8_t* payload, uint16_t length);
+
 		/**
 		 * Receive events (for example for i2c)
 		 */
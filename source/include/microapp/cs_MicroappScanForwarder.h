@@ -0,0 +1,80 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cs_MicroappStructs.h>
+#include <protocol/cs_AssetFilterPackets.h>
+#include <protocol/cs_Typedefs.h>
+#include <structs/cs_PacketsInternal.h>
+
+#define MICROAPP_MAX_SCAN_SUBSCRIPTIONS 4
+
+/**
+ * A scan subscription of a microapp.
+ */
+struct microapp_scan_subscription_t {
+	bool active = false;
+	uint8_t id = 0;
+	int8_t rssiThreshold = 0;
+	uint8_t valueLength = 0;
+
+	/**
+	 * Input description, in the format of AssetFilterInput.
+	 */
+	uint8_t input[sizeof(AssetFilterInputType) + sizeof(masked_ad_data_type_selector_t)] = {};
+
+	uint8_t value[MICROAPP_SCAN_VALUE_SIZE] = {};
+	uint8_t valueMask[MICROAPP_SCAN_VALUE_SIZE] = {};
+};
+
+/**
+ * Forwards scanned devices to a microapp.
+ *
+ * Only devices that match a subscription of the microapp are forwarded, so that the microapp doesn't have to
+ * handle every scanned device. The input of a device is selected the same way as for asset filters.
+ * Matched devices are written to a buffer in the RAM of the microapp, which it can read in a batch.
+ */
+class MicroappScanForwarder {
+public:
+	/**
+	 * Set the buffer to write scanned devices to.
+	 *
+	 * @param[in] address        Address of a microapp_scan_buffer_t, 0 to stop forwarding.
+	 * @param[in] ramStart       Start of the RAM of the microapp, the buffer must be inside it.
+	 * @param[in] ramSize        Size of the RAM of the microapp.
+	 */
+	cs_ret_code_t setBuffer(uintptr_t address, uintptr_t ramStart, uint32_t ramSize);
+
+	/**
+	 * Add a subscription, or replace the subscription with the same ID.
+	 */
+	cs_ret_code_t subscribe(const scan_subscription_cmd_t& cmd);
+
+	cs_ret_code_t unsubscribe(uint8_t id);
+
+	/**
+	 * Write the device to the buffer, if it matches a subscription.
+	 */
+	void onScannedDevice(const scanned_device_t& device);
+
+private:
+	microapp_scan_subscription_t _subscriptions[MICROAPP_MAX_SCAN_SUBSCRIPTIONS];
+
+	uint8_t _subscriptionCount = 0;
+
+	microapp_scan_buffer_t* _buffer = nullptr;
+
+	/**
+	 * Size of the buffer, as it was when set: the microapp should not be able to change it afterwards.
+	 */
+	uint8_t _bufferSize = 0;
+
+	bool matches(microapp_scan_subscription_t& subscription, const scanned_device_t& device);
+
+	void forward(uint8_t id, const scanned_device_t& device);
+};
@@ -51,14 +51,14 @@ public:
 		// TODO: is this if even needed?
 		// TODO: use util setBit function.
 		if (index < 64) {
-			val |= 1 << index;
+			val |= 1ULL << index;
 		}
 	}
 	void clearRoom(uint8_t index) {
 		// TODO: is this if even needed?
 		// TODO: use util setBit function.
 		if (index < 64) {
-			val &= ~(1 << index);
+			val &= ~(1ULL << index);
 		}
 	}
 
@@ -9,8 +9,8 @@
 #include <events/cs_EventListener.h>
 #include <presence/cs_PresenceDescription.h>
 #include <time/cs_SystemTime.h>
+#include <time/cs_TimerWheel.h>
 
-#include <list>
 #include <optional>
 
 /**
@@ -47,49 +47,80 @@ private:
     static const constexpr uint32_t presence_uncertain_due_reboot_time_out_s = 30;
 
 
-    // using a list because of constant time insertion/deletion of
-    // any item in the container
     static const constexpr uint8_t max_records = 20;
+
+    static_assert(max_records <= 32, "Records are tracked in 32 bit masks");
+    static const constexpr uint32_t all_records_mask = (1ULL << max_records) - 1;
+
     struct PresenceRecord {
         uint8_t who;    // profile id
         uint8_t where;  // room id
         /**
-         * Used to determine when a record is timed out.
-         * Decreases every seconds.
-         * Starts at presence_time_out_s, when 0, it is timed out.
+         * Used to determine whether to send a mesh message.
+         * Value of the timer wheel seconds from which a mesh message can be sent.
          */
-    	uint8_t timeoutCountdownSeconds;
-    	/**
-    	 * Used to determine whether to send a mesh message.
-    	 * Decreases every seconds.
-    	 * Starts at presence_mesh_send_throttle_seconds, when 0, a mesh message can be sent.
-    	 */
-    	uint8_t meshSendCountdownSeconds;
-        PresenceRecord(
-        		uint8_t profileId,
-				uint8_t roomId,
-				uint8_t timeoutSeconds = presence_time_out_s,
-				uint8_t meshThrottleSeconds = presence_mesh_send_throttle_seconds):
-        	who(profileId),
-			where(roomId),
-			timeoutCountdownSeconds(timeoutSeconds),
-			meshSendCountdownSeconds(meshThrottleSeconds)
-        {}
+        uint32_t meshSendAllowedSeconds;
+        /**
+         * Removes this record when it expires.
+         */
+        timer_wheel_entry_t timeout;
     };
 
     /**
-     * keeps track of a short history of presence events.
-     * will be lazily updated to remove old entries: 
-     *  - when new presence is detected
-     *  - when getCurrentPresenceDescription() is called
+     * Fixed size table of presence records, used entries are marked in usedRecordsMask.
      */
-    static std::list<PresenceRecord> WhenWhoWhere;
+    static PresenceRecord records[max_records];
+    static uint32_t usedRecordsMask;
 
     /**
-     * Clears the WhenWhoWhere list from entries that have a time stamp older than
-     * presence_time_out_s.
+     * For each profile: a bit per location where that profile is present.
+     */
+    static uint64_t profileLocationsMask[max_profile_id + 1];
+
+    /**
+     * Bit per location where any profile is present, kept up to date with profileLocationsMask.
+     */
+    static uint64_t occupiedRoomsMask;
+
+    /**
+     * Returns index of the record with given profile and location, or max_records when not found.
+     */
+    static uint8_t findRecord(uint8_t profile, uint8_t location);
+
+    /**
+     * Returns index of the record that times out first, or max_records when there are no records.
+     */
+    static uint8_t findOldestRecord();
+
+    /**
+     * Add a new record, there must be a free spot.
+     * The mesh send throttle of the new record has already passed.
+     *
+     * @return index of the new record.
      */
-    void removeOldRecords();
+    static uint8_t addRecord(uint8_t profile, uint8_t location);
+
+    /**
+     * Set the time out of a record to presence_time_out_s from now.
+     */
+    static void refreshRecord(uint8_t index);
+
+    /**
+     * Remove the record at given index, and update the occupied rooms.
+     */
+    static void removeRecord(uint8_t index);
+
+    /**
+     * Remove all records.
+     */
+    static void clearRecords();
+
+    /**
+     * Called by the timer wheel when a record timed out.
+     *
+     * @param[in] context              Pointer to the record.
+     */
+    static void onRecordTimeout(void* context);
 
     /**
      * Calls handleProfileLocationAdministration, and dispatches events based
@@ -99,9 +130,8 @@ private:
 
 	/**
      * Processes a new profile-location combination:
-     * - a new entry is placed in the WhenWhoWhere list, 
-     * - previous entries with the same p-l combo are deleted
-     * - the WhenWhoWhere list is purged of old entries
+     * - a new record is added, or the time out of the existing record with the same p-l combo is refreshed
+     * - when there is no space for a new record, the record that times out first is removed
      * @param[in] forwardToMesh If true, the update will be pushed into the mesh (throttled).
      */
     MutationType handleProfileLocationAdministration(uint8_t profile, uint8_t location, bool forwardToMesh);
@@ -125,18 +155,13 @@ private:
      * @param[in] profileId            The profile ID that entered/left a location.
      * @param[in] locationId           The location ID that was entered/left.
      */
-    void sendPresenceChange(PresenceChange type, uint8_t profileId = 0, uint8_t locationId = 0);
+    static void sendPresenceChange(PresenceChange type, uint8_t profileId = 0, uint8_t locationId = 0);
 
     /**
      * Triggers a EVT_PRESENCE_MUTATION event of the given type.
      */
     void triggerPresenceMutation(MutationType mutationtype);
 
-    /**
-     * To be called every second.
-     */
-    void tickSecond();
-
     // out of order
     void print();
     
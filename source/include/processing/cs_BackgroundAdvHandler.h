@@ -10,6 +10,11 @@
 #include "events/cs_EventListener.h"
 #include "util/cs_Utils.h"
 
+/**
+ * Number of decrypted background advertisement payloads to remember.
+ */
+#define BACKGROUND_ADV_REPLAY_CACHE_SIZE 8
+
 /**
  * Class that parses advertisements for background broadcasts.
  *
@@ -64,6 +69,36 @@ private:
 	 */
 	uint8_t _lastMacAddress[MAC_ADDRESS_LEN] = {0};
 
+	/**
+	 * Encrypted payload, with the decrypted payload.
+	 */
+	struct replay_cache_entry_t {
+		uint32_t encryptedPayload;
+		uint16_t decryptedPayload[2];
+	};
+
+	/**
+	 * Recently decrypted payloads.
+	 *
+	 * Phones repeat the same background advertisement many times, so this saves decrypting them again.
+	 */
+	replay_cache_entry_t _replayCache[BACKGROUND_ADV_REPLAY_CACHE_SIZE];
+
+	/**
+	 * Number of valid entries in the replay cache.
+	 */
+	uint8_t _replayCacheSize = 0;
+
+	/**
+	 * Index of the replay cache entry that will be overwritten next.
+	 */
+	uint8_t _replayCacheNextIndex = 0;
+
+	/**
+	 * Keys version of KeysAndAccess at the time the replay cache was filled.
+	 */
+	uint8_t _replayCacheKeysVersion = 0;
+
 
 	BackgroundAdvertisementHandler();
 
@@ -72,6 +107,15 @@ private:
 	 */
 	void parseAdvertisement(scanned_device_t* scannedDevice);
 
+	/**
+	 * Decrypt the payload of a background advertisement, or get it from the replay cache.
+	 *
+	 * @param[in]  encryptedPayload    The encrypted payload.
+	 * @param[out] decryptedPayload    Buffer to write the decrypted payload to.
+	 * @return                         True on success.
+	 */
+	bool decryptPayload(uint16_t encryptedPayload[2], uint16_t decryptedPayload[2]);
+
 	/**
 	 * Parse an advertisement with incomplete list of service UUIDs.
 	 *
@@ -9,6 +9,7 @@
 
 #include "common/cs_Types.h"
 #include "events/cs_EventListener.h"
+#include "protocol/cs_UartMsgTypes.h"
 #include "util/cs_Utils.h"
 
 #define CMD_ADV_NUM_SERVICES_16BIT 4 // There are 4 16 bit service UUIDs in a command advertisement.
@@ -25,6 +26,16 @@
 
 #define CMD_ADC_ENCRYPTED_DATA_SIZE 16
 
+/**
+ * Number of recently handled command advertisements to remember. Must be a power of 2.
+ */
+#define CMD_ADV_RECENT_TABLE_SIZE 16
+
+/**
+ * Time that a handled command advertisement is remembered.
+ */
+#define CMD_ADV_RECENT_TIME_MS CMD_ADV_CLAIM_TIME_MS
+
 /**
  * Struct used to prevent double handling of similar command advertisements.
  * And to prevent handling command advertisements of many devices at once.
@@ -37,6 +48,20 @@ struct __attribute__((__packed__)) command_adv_claim_t {
 	uint16_t decryptedRC5;
 };
 
+/**
+ * Struct used to skip decryption and validation of command advertisements that were validated recently.
+ *
+ * Phones repeat the same command advertisement many times.
+ * The whole advertisement is stored: the nonce (which includes the device token and encrypted RC5 payload), and the
+ * encrypted payload. Only an exact copy of a validated advertisement is skipped.
+ */
+struct __attribute__((__packed__)) command_adv_recent_t {
+	uint8_t nonce[CMD_ADV_NUM_SERVICES_16BIT * sizeof(uint16_t)];
+	uint8_t encryptedData[CMD_ADC_ENCRYPTED_DATA_SIZE];
+	uint8_t timeoutCounter = 0;
+	uint16_t decryptedRC5[2];
+};
+
 struct __attribute__((__packed__)) command_adv_header_t {
 //	uint8_t sequence0 : 2;
 	uint16_t protocol : 3;
@@ -70,6 +95,16 @@ private:
 	command_adv_claim_t _claims[CMD_ADV_MAX_CLAIM_COUNT];
 	TYPIFY(CONFIG_SPHERE_ID) _sphereId = 0;
 
+	/**
+	 * Hash table of recently validated command advertisements, indexed by hash.
+	 */
+	command_adv_recent_t _recent[CMD_ADV_RECENT_TABLE_SIZE];
+
+	/**
+	 * Keys version of KeysAndAccess at the time the recent table was filled.
+	 */
+	uint8_t _recentKeysVersion = 0;
+
 	void parseAdvertisement(scanned_device_t* scannedDevice);
 
 	// Return true when command payload is validated, and RC5 payload is decrypted.
@@ -95,4 +130,22 @@ private:
 	bool claim(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5, int indexOfDevice);
 
 	void tickClaims();
+
+	/**
+	 * Return the recently validated command advertisement with the same nonce and encrypted payload,
+	 * or nullptr when not found.
+	 *
+	 * @param[in] hash            Hash of the nonce and encrypted payload.
+	 */
+	command_adv_recent_t* findRecent(uint32_t hash, const cs_data_t& nonce, const cs_data_t& encryptedData);
+
+	/**
+	 * Remember a validated command advertisement.
+	 *
+	 * @param[in] hash            Hash of the nonce and encrypted payload.
+	 * @param[in] decryptedRC5    The decrypted RC5 payload.
+	 */
+	void addRecent(uint32_t hash, const cs_data_t& nonce, const cs_data_t& encryptedData, uint16_t decryptedRC5[2]);
+
+	void tickRecent();
 };
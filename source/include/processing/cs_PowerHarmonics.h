@@ -0,0 +1,111 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cfg/cs_Config.h>
+#include <protocol/cs_Packets.h>
+#include <protocol/cs_Typedefs.h>
+
+#include <cstdint>
+
+/**
+ * Analyses the harmonics and power factor of one AC period of voltage and current samples.
+ *
+ * Only a few frequencies are of interest: the fundamental and the odd harmonics (even harmonics are
+ * negligible on the mains). So instead of an FFT, a Goertzel filter is used per harmonic, with fixed
+ * point coefficients. This also works for sample counts that are not a power of 2.
+ *
+ * The samples should cover exactly one AC period, so that each harmonic falls exactly in a frequency bin.
+ * When the mains frequency deviates from the nominal frequency, the harmonics leak a bit into each other.
+ *
+ * Doesn't depend on the ADC or any other driver, so that it can be tested on the host.
+ */
+class PowerHarmonics {
+public:
+	/**
+	 * Calculate the coefficients, given the number of samples per AC period.
+	 *
+	 * Harmonics above the Nyquist frequency are not analysed.
+	 *
+	 * @param[in] numSamples          Number of samples of each channel per AC period.
+	 *
+	 * @return ERR_SUCCESS             When successful.
+	 * @return ERR_WRONG_PARAMETER     When the number of samples is too small or too large.
+	 */
+	cs_ret_code_t init(uint16_t numSamples);
+
+	bool isInitialized() {
+		return _numSamples != 0;
+	}
+
+	/**
+	 * Analyse one AC period.
+	 *
+	 * @param[in] samples              Interleaved samples of all channels, as filled by the ADC.
+	 * @param[in] channelCount         Number of interleaved channels.
+	 * @param[in] voltageChannel       Channel index of the voltage samples.
+	 * @param[in] currentChannel       Channel index of the current samples.
+	 * @param[in] voltageZero          Zero of the voltage samples, times 1024.
+	 * @param[in] currentZero          Zero of the current samples, times 1024.
+	 * @param[in] currentMultiplier    Multiply a current sample with this value to get ampere.
+	 * @param[out] result              The result, except for the timestamp.
+	 */
+	void analyse(
+			const adc_sample_value_t* samples,
+			uint8_t channelCount,
+			uint8_t voltageChannel,
+			uint8_t currentChannel,
+			int32_t voltageZero,
+			int32_t currentZero,
+			float currentMultiplier,
+			cs_power_harmonics_t& result);
+
+private:
+	/**
+	 * Number of fractional bits of the coefficients.
+	 *
+	 * The state of a filter can grow to about 2^23 for a full scale fundamental at the max number of samples,
+	 * so the products fit in an int64_t.
+	 */
+	static constexpr uint8_t COEFFICIENT_FRACTION_BITS = 24;
+
+	/**
+	 * Fixed point coefficients of a Goertzel filter.
+	 */
+	struct goertzel_coefficients_t {
+		int32_t coefficient; // 2 * cos(w)
+		int32_t cos;         // cos(w)
+		int32_t sin;         // sin(w)
+	};
+
+	/**
+	 * State of a Goertzel filter: the last two outputs.
+	 */
+	struct goertzel_state_t {
+		int32_t prev = 0;
+		int32_t prevPrev = 0;
+	};
+
+	uint16_t _numSamples = 0;
+
+	/**
+	 * Number of harmonics below the Nyquist frequency.
+	 */
+	uint8_t _harmonicCount = 0;
+
+	goertzel_coefficients_t _coefficients[POWER_HARMONICS_COUNT];
+
+	static inline void update(goertzel_state_t& state, int32_t coefficient, int32_t sample);
+
+	/**
+	 * Get the frequency bin from the state of a Goertzel filter.
+	 *
+	 * The phase is relative to the last sample, which is the same for all channels.
+	 */
+	static void getBin(const goertzel_state_t& state, const goertzel_coefficients_t& coefficients, float& real, float& imag);
+};
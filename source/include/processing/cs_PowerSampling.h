@@ -9,10 +9,12 @@
 #include <cfg/cs_Boards.h>
 #include <drivers/cs_ADC.h>
 #include <events/cs_EventListener.h>
+#include <processing/cs_PowerHarmonics.h>
 #include <storage/cs_State.h>
 #include <structs/buffer/cs_CircularBuffer.h>
 #include <structs/buffer/cs_AdcBuffer.h>
 #include <third/Median.h>
+#include <util/cs_RunningMedian.h>
 #include <cstdint>
 
 typedef void (*ps_zero_crossing_cb_t) ();
@@ -97,6 +99,9 @@ private:
 	/**
 	 * Queue of buffers we can use for processing.
 	 *
+	 * These buffers are held, so they won't be filled by the ADC.
+	 * The oldest buffer is released when a new one is pushed to a full queue.
+	 *
 	 * If queue size == 1:
 	 * - buffer[0] = last filtered.
 	 * If queue size > 1:
@@ -107,13 +112,13 @@ private:
 	CircularBuffer<adc_buffer_id_t> _bufferQueue;
 
 	cs_power_samples_header_t _lastSoftfuse;
-	adc_sample_value_t _lastSoftfuseSamples[AdcBuffer::getChannelLength()] = {0};
+	adc_sample_value_t _lastSoftfuseSamples[AdcBuffer::getDefaultChannelLength()] = {0};
 
 	CircularBuffer<switch_state_t> _switchHist;
 	cs_power_samples_header_t _lastSwitchSamplesHeader;
 
 	const static uint8_t numSwitchSamplesBuffers = 6; // 3 voltage and 3 current buffers.
-	adc_sample_value_t _lastSwitchSamples[numSwitchSamplesBuffers * AdcBuffer::getChannelLength()] = {0};
+	adc_sample_value_t _lastSwitchSamples[numSwitchSamplesBuffers * AdcBuffer::getDefaultChannelLength()] = {0};
 
 	TYPIFY(CONFIG_VOLTAGE_MULTIPLIER) _voltageMultiplier; //! Voltage multiplier from settings.
 	TYPIFY(CONFIG_CURRENT_MULTIPLIER) _currentMultiplier; //! Current multiplier from settings.
@@ -154,10 +159,9 @@ private:
 	MedianFilter* _filterParams;  //! Stores the parameters for the moving median filter.
 
 	CircularBuffer<int32_t>* _powerMilliWattHist;      //! Used to store a history of the power
-	CircularBuffer<int32_t>* _currentRmsMilliAmpHist;  //! Used to store a history of the current_rms
-	CircularBuffer<int32_t>* _filteredCurrentRmsHistMA; //! Used to store a history of the filtered current_rms
-	CircularBuffer<int32_t>* _voltageRmsMilliVoltHist; //! Used to store a history of the voltage_rms
-	int32_t _histCopy[POWER_SAMPLING_RMS_WINDOW_SIZE]; //! Used to copy a history to (so it can be used to calculate the median)
+	RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE> _currentRmsMilliAmpHist;   //! Used to store a history of the current_rms
+	RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE> _filteredCurrentRmsHistMA; //! Used to store a history of the filtered current_rms
+	RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE> _voltageRmsMilliVoltHist;  //! Used to store a history of the voltage_rms
 	uint16_t _consecutiveDimmerOvercurrent = 0;
 	uint16_t _consecutiveOvercurrent = 0;
 
@@ -166,6 +170,13 @@ private:
 	TYPIFY(CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER) _currentMilliAmpThresholdDimmer; //! Current threshold when using dimmer from settings.
 
 	int64_t _energyUsedmicroJoule = 0; //! Energy used in micro joule
+	float _energyRemainderMicroJoule = 0.0f; //! Fraction of a micro joule that hasn't been added to the energy yet.
+	float _periodPowerMilliWatt = 0.0f; //! Real power of the last AC period, used to integrate the energy.
+	uint32_t _periodDurationUs = CS_ADC_BUFFER_DURATION_US; //! Duration of the last AC period, as sampled.
+	adc_buffer_seq_nr_t _lastEnergySeqNr = 0; //! Sequence nr of the last buffer of which the energy was integrated.
+	bool _lastEnergySeqNrValid = false;
+	uint8_t _energyCheckpointCountDown = 1000 / TICK_INTERVAL_MS; //! Ticks until the energy checkpoint is updated.
+	int64_t _checkpointEnergyMicroJoule = 0; //! Energy of the last energy checkpoint.
 
 	switch_state_t _lastSwitchState; //! Stores the last seen switch state.
 	uint32_t _lastSwitchOffTicks;    //! RTC ticks when the switch was last turned off.
@@ -204,11 +215,68 @@ private:
 	cs_adc_restarts_t _adcRestarts;
 	cs_adc_channel_swaps_t _adcChannelSwaps;
 
+	//! Sampling profile, read from settings on init.
+	AdcSamplingProfile _samplingProfile = ADC_SAMPLING_PROFILE_DEFAULT;
+
+	//! Time between samples, determined by the sampling profile.
+	uint16_t _samplingIntervalUs = CS_ADC_SAMPLE_INTERVAL_US;
+
+	/**
+	 * Max number of buffers in the queue.
+	 *
+	 * Less than the size of the queue when there are fewer ADC buffers, so that the ADC always has buffers to fill.
+	 */
+	uint8_t _maxQueuedBuffers = numFilteredBuffersForProcessing + numUnfilteredBuffers;
+
+	//! Every how many samples, a sample is copied to the fixed size sample arrays.
+	adc_sample_value_id_t _sampleCopyStep = 1;
+
+	cs_adc_processing_stats_t _adcProcessingStats;
+
+	PowerHarmonics _harmonics;
+
+	//! Number of AC periods until the harmonics are analysed again.
+	uint16_t _harmonicsCountDown = POWER_HARMONICS_INTERVAL_PERIODS;
+
+	//! Keep up whether the harmonics have been analysed yet.
+	bool _harmonicsAnalysed = false;
+
+	cs_power_harmonics_t _lastHarmonics;
+
 
 	/** Initialize the moving averages
 	 */
 	void initAverages();
 
+	/**
+	 * Set the sampling interval and number of queued buffers, given the sampling profile.
+	 */
+	void initSamplingProfile(AdcSamplingProfile profile);
+
+	/**
+	 * Process a buffer that has been filled by the ADC.
+	 */
+	void processBuf(adc_buffer_id_t bufIndex);
+
+	/**
+	 * Keep up the time it took to process a buffer, and compare it with the budget.
+	 */
+	void updateProcessingStats(uint32_t processingTimeUs);
+
+	/**
+	 * Get the number of samples that copySamples() copies.
+	 */
+	uint16_t getCopySampleCount();
+
+	/**
+	 * Copy the samples of a channel, with at most the default channel length.
+	 *
+	 * Every _sampleCopyStep'th sample is copied, so the copy covers the whole buffer.
+	 *
+	 * @return Number of copied samples.
+	 */
+	uint16_t copySamples(adc_buffer_id_t bufIndex, adc_channel_id_t channel, adc_sample_value_t* samples);
+
 	/**
 	 * Whether the given buffer is valid.
 	 *
@@ -230,6 +298,21 @@ private:
 	 */
 	void removeInvalidBufs();
 
+	/**
+	 * Add a buffer to the queue, release the oldest buffer when the queue is full.
+	 */
+	void pushBuf(adc_buffer_id_t bufIndex);
+
+	/**
+	 * Release the oldest buffer in the queue.
+	 */
+	void popBuf();
+
+	/**
+	 * Release all buffers in the queue.
+	 */
+	void clearBufs();
+
 	/**
 	 * Calculate the value of the zero line of the voltage samples (the offset).
 	 */
@@ -260,6 +343,15 @@ private:
 
 	void calculateSlowAveragePower(float powerMilliWatt, float fastAvgPowerMilliWatt);
 
+	/**
+	 * Analyse the harmonics of the current, every so many AC periods.
+	 *
+	 * Writes the result to UART when power logs are enabled.
+	 *
+	 * @param[in] bufIndex             Buffer with unfiltered samples.
+	 */
+	void analyseHarmonics(adc_buffer_id_t bufIndex);
+
 	/**
 	 * Determines measured power usage with no load.
 	 *
@@ -269,9 +361,21 @@ private:
 	 */
 	void calibratePowerZero(int32_t powerMilliWatt);
 
-	/** Calculate the energy used
+	/**
+	 * Integrate the real power of the last AC period.
+	 *
+	 * When buffers have been skipped or were invalid, the power during those periods is assumed to be the same.
+	 *
+	 * @param[in] seqNr                          Sequence nr of the last buffer.
+	 */
+	void calculateEnergy(adc_buffer_seq_nr_t seqNr);
+
+	/**
+	 * Set the energy checkpoint, so that the accumulated energy is restored after a reset.
+	 *
+	 * It's written to flash along with other state, or after ENERGY_CHECKPOINT_MAX_DELAY_SECONDS.
 	 */
-	void calculateEnergy();
+	void setEnergyCheckpoint();
 
 	/**
 	 * Check if the current goes above a threshold (for long enough).
@@ -35,8 +35,8 @@ private:
 	// Store the samples and meta data of the last detection.
 	cs_power_samples_header_t _lastDetection;
 	cs_power_samples_header_t _lastAlmostDetection;
-	int16_t _lastDetectionSamples[_numStoredBuffers * AdcBuffer::getChannelLength()] = {0};
-	int16_t _lastAlmostDetectionSamples[_numStoredBuffers * AdcBuffer::getChannelLength()] = {0};
+	int16_t _lastDetectionSamples[_numStoredBuffers * AdcBuffer::getDefaultChannelLength()] = {0};
+	int16_t _lastAlmostDetectionSamples[_numStoredBuffers * AdcBuffer::getDefaultChannelLength()] = {0};
 
 	enum FoundSwitch {
 		True,
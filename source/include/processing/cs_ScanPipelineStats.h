@@ -0,0 +1,44 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_UartMsgTypes.h>
+
+/**
+ * Class that counts scanned advertisements at every stage of the scan pipeline.
+ *
+ * Each stage calls count(), which is cheap enough to be done for every scanned device.
+ * The counters are periodically sent over UART as a single message, so it can be seen where advertisements are dropped.
+ */
+class ScanPipelineStats {
+public:
+	static ScanPipelineStats& getInstance() {
+		static ScanPipelineStats instance;
+		return instance;
+	}
+
+	/**
+	 * Increase the counter of a stage.
+	 */
+	void count(ScanPipelineStage stage) {
+		++_stats.counters[stage];
+	}
+
+	/**
+	 * Send the counters over UART.
+	 */
+	void sendStats();
+
+private:
+	ScanPipelineStats() {}
+
+	/**
+	 * Counters since boot, in UART message format.
+	 */
+	uart_msg_scan_pipeline_stats_t _stats = {};
+};
@@ -65,6 +65,7 @@ enum CommandHandlerTypes {
 	CTRL_CMD_GET_GPREGRET                = 86,
 	CTRL_CMD_GET_ADC_CHANNEL_SWAPS       = 87,
 	CTRL_CMD_GET_RAM_STATS               = 88,
+	CTRL_CMD_GET_ADC_PROCESSING_STATS    = 89,
 
 	CTRL_CMD_MICROAPP_GET_INFO           = 90,
 	CTRL_CMD_MICROAPP_UPLOAD             = 91,
@@ -73,6 +74,9 @@ enum CommandHandlerTypes {
 	CTRL_CMD_MICROAPP_ENABLE             = 94,
 	CTRL_CMD_MICROAPP_DISABLE            = 95,
 
+	CTRL_CMD_GET_POWER_HARMONICS         = 96,
+	CTRL_CMD_MICROAPP_GET_CPU_STATS      = 97,
+
 	CTRL_CMD_CLEAN_FLASH                 = 100,
 
 	CTRL_CMD_FILTER_UPLOAD               = 110,
@@ -11,8 +11,11 @@
 
 /**
  * Max number of microapps.
+ *
+ * Each microapp gets its own MICROAPP_MAX_SIZE of flash, and an equal part of the microapp RAM.
+ * So the microapp flash pages should fit MAX_MICROAPPS * MICROAPP_MAX_SIZE.
  */
-constexpr uint8_t MAX_MICROAPPS = 1;
+constexpr uint8_t MAX_MICROAPPS = 2;
 
 /**
  * Max allowed chunk size when uploading a microapp.
@@ -123,6 +126,17 @@ struct __attribute__((packed)) microapp_status_t {
 	microapp_state_t state;
 };
 
+/**
+ * CPU usage of a microapp, since boot.
+ */
+struct __attribute__((packed)) microapp_cpu_stats_t {
+	uint32_t calls = 0;        // Number of calls to setup or loop.
+	uint32_t yields = 0;       // Number of times the microapp yielded (by calling delay).
+	uint32_t overruns = 0;     // Number of calls that took longer than MICROAPP_CALL_BUDGET_MS.
+	uint32_t maxCallMs = 0;    // Longest call.
+	uint32_t ringCommands = 0; // Number of commands handled via the command ring.
+};
+
 /**
  * Packet with all info required to upload a microapp, and to see the status of already uploaded microapps.
  */
@@ -322,6 +322,14 @@ struct __attribute__((packed)) sun_time_t {
 	uint32_t sunset = 19*60*60; // Time in seconds after midnight that the sun sets.
 };
 
+/**
+ * Accumulated energy, as stored in flash, so that it survives a reset.
+ */
+struct __attribute__((packed)) cs_energy_checkpoint_t {
+	int64_t energyMicroJoule = 0; // Accumulated energy in μJ.
+	uint32_t unixTimestamp = 0;   // Unix timestamp of the checkpoint, 0 when the time was not set.
+};
+
 /**
  * Packet to change ibeacon config ID.
  *
@@ -477,6 +485,33 @@ struct __attribute__((packed)) cs_adc_channel_swaps_t {
 	uint32_t lastTimestamp = 0; // Timestamp of last detected ADC channel swap.
 };
 
+enum AdcSamplingProfile {
+	ADC_SAMPLING_PROFILE_DEFAULT = 0,   // Default sampling interval, with switchcraft.
+	ADC_SAMPLING_PROFILE_HIGH_RATE = 1, // Shorter sampling interval, without switchcraft.
+	ADC_SAMPLING_PROFILE_LOW_POWER = 2, // Longer sampling interval, without switchcraft.
+};
+
+struct __attribute__((packed)) cs_adc_processing_stats_t {
+	uint8_t samplingProfile = ADC_SAMPLING_PROFILE_DEFAULT; // AdcSamplingProfile.
+	uint16_t samplingIntervalUs = 0; // Time between samples.
+	uint32_t budgetUs = 0;           // Time that processing of a buffer may take.
+	uint32_t processedCount = 0;     // Number of processed buffers since boot.
+	uint32_t skippedCount = 0;       // Number of buffers that were filled, but never processed.
+	uint32_t overBudgetCount = 0;    // Number of buffers of which processing took longer than the budget.
+	uint32_t overrunCount = 0;       // Number of buffers of which processing took longer than filling a buffer.
+	uint32_t lastProcessingUs = 0;   // Processing time of the last buffer.
+	uint32_t maxProcessingUs = 0;    // Max processing time of a buffer since boot.
+	uint32_t avgProcessingUs = 0;    // Average processing time of a buffer.
+};
+
+struct __attribute__((packed)) cs_power_harmonics_t {
+	uint32_t unixTimestamp = 0;              // Unix timestamp of the analysed AC period.
+	int16_t powerFactor = 0;                 // Real power divided by apparent power, times 1000.
+	int16_t displacementPowerFactor = 0;     // Cosine of the phase between the voltage and current fundamental, times 1000.
+	uint16_t currentThd = 0;                 // Total harmonic distortion of the current, in permille of the fundamental.
+	uint16_t currentHarmonicsMilliAmp[POWER_HARMONICS_COUNT] = {}; // RMS current of the fundamental, 3rd, 5th, .. harmonic.
+};
+
 enum PowerSamplesType {
 	POWER_SAMPLES_TYPE_SWITCHCRAFT = 0,
 	POWER_SAMPLES_TYPE_SWITCHCRAFT_NON_TRIGGERED = 1,
@@ -514,6 +549,13 @@ struct __attribute__((packed)) cs_switch_history_item_t {
 	switch_state_t state;         // Switch state after executing the command.
 	cmd_source_t source;          // Source of the command.
 
+	cs_switch_history_item_t():
+		timestamp(0),
+		value(0),
+		state(),
+		source(CS_CMD_SOURCE_NONE)
+	{}
+
 	cs_switch_history_item_t(uint32_t timestamp, uint8_t switchValue, switch_state_t switchState, const cmd_source_t& source):
 		timestamp(timestamp),
 		value(switchValue),
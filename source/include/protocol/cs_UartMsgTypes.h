@@ -124,16 +124,45 @@ struct __attribute__((__packed__)) uart_msg_power_t {
 	int32_t  avgPowerMilliWattReal;
 };
 
+/**
+ * With the default sampling profile. Other sampling profiles have a different number of samples.
+ */
 struct __attribute__((__packed__)) uart_msg_current_t {
 	uint32_t timestamp;
 	int16_t  samples[CS_ADC_NUM_SAMPLES_PER_CHANNEL];
 };
 
+/**
+ * With the default sampling profile. Other sampling profiles have a different number of samples.
+ */
 struct __attribute__((__packed__)) uart_msg_voltage_t {
 	uint32_t timestamp;
 	int16_t  samples[CS_ADC_NUM_SAMPLES_PER_CHANNEL];
 };
 
+/**
+ * Stages of the scan pipeline, in the order of the counters in uart_msg_scan_pipeline_stats_t.
+ */
+enum ScanPipelineStage {
+	SCAN_PIPELINE_STACK_SCANNED = 0,       // Advertisement received from the softdevice scanner.
+	SCAN_PIPELINE_MESH_SCANNED,            // Advertisement received from the mesh scanner.
+	SCAN_PIPELINE_ASSET_REJECTED,          // Advertisement rejected by the asset filters.
+	SCAN_PIPELINE_ASSET_ACCEPTED,          // Advertisement accepted by the asset filters.
+	SCAN_PIPELINE_ASSET_THROTTLED,         // Accepted advertisement not forwarded, because the asset is throttled.
+	SCAN_PIPELINE_BACKGROUND_PARSED,       // Background advertisement parsed.
+	SCAN_PIPELINE_COMMAND_RECEIVED,        // Command advertisement of our sphere received.
+	SCAN_PIPELINE_COMMAND_RECENT_HIT,      // Command advertisement found in the table of recently handled command advertisements.
+	SCAN_PIPELINE_COMMAND_DECRYPTED,       // Command advertisement decrypted.
+	SCAN_PIPELINE_COMMAND_VALIDATED,       // Command advertisement validated.
+	SCAN_PIPELINE_TRACKED_DEVICE_UPDATED,  // Tracked device updated by a background advertisement.
+	SCAN_PIPELINE_NUM_STAGES
+};
+
+struct __attribute__((__packed__)) uart_msg_scan_pipeline_stats_t {
+	uint32_t uptime; // Seconds since boot.
+	uint32_t counters[SCAN_PIPELINE_NUM_STAGES]; // Counters since boot, see ScanPipelineStage.
+};
+
 struct __attribute__((__packed__)) uart_msg_adc_channel_config_t {
 	adc_channel_id_t channel;
 	adc_channel_config_t config;
@@ -119,6 +119,9 @@ enum UartOpcodeTx {
 	UART_OPCODE_TX_POWER_LOG_FILTERED_CURRENT =       50202,
 	UART_OPCODE_TX_POWER_LOG_FILTERED_VOLTAGE =       50203,
 	UART_OPCODE_TX_POWER_LOG_POWER =                  50204,
+	UART_OPCODE_TX_POWER_LOG_HARMONICS =              50205, // Harmonics of the current (payload: cs_power_harmonics_t)
+
+	UART_OPCODE_TX_SCAN_PIPELINE_STATS =              50301, // Counters of each stage of the scan pipeline (payload: uart_msg_scan_pipeline_stats_t)
 
 	UART_OPCODE_TX_TEXT =                             60000, // Payload is ascii text.
 	UART_OPCODE_TX_FIRMWARESTATE =                    60001,
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cfg/cs_Config.h>
 #include <mesh/cs_MeshDefines.h>
 #include <protocol/cs_Typedefs.h>
 #include <protocol/cs_CmdSource.h>
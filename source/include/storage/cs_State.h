@@ -56,7 +56,8 @@ constexpr OperationMode getOperationMode(uint8_t mode) {
 
 enum class StateQueueMode {
 	DELAY,
-	THROTTLE
+	THROTTLE,
+	BATCH
 };
 
 #define FACTORY_RESET_STATE_NORMAL 0
@@ -79,6 +80,7 @@ enum StateQueueOp {
  * counter:        Number of ticks until item is executed and removed from queue.
  * init_counter:   When set, and execute is true, this item is added again with counter set to this value.
  * execute:        Whether or not to execute the operation when the counter reaches 0.
+ * batched:        Whether to execute the operation earlier, when another item is written to flash.
  */
 struct __attribute__((__packed__)) cs_state_store_queue_t {
 	StateQueueOp operation;
@@ -87,6 +89,7 @@ struct __attribute__((__packed__)) cs_state_store_queue_t {
 	uint32_t counter; // Uint32, so it can fit 24h.
 	uint32_t init_counter;
 	bool execute;
+	bool batched;
 };
 
 const uint32_t CS_STATE_QUEUE_DELAY_SECONDS_MAX = 0xFFFFFFFF / 1000;
@@ -252,6 +255,27 @@ public:
 	 */
 	cs_ret_code_t setThrottled(const cs_state_data_t & data, uint32_t period);
 
+	/**
+	 * Set the state to a new value, and write it to flash along with the next write of another value.
+	 *
+	 * Assumes persistence mode STRATEGY1.
+	 * Use this for values that change often, but of which losing the last changes is acceptable.
+	 * Unlike setDelayed(), calling this again doesn't postpone the write: the value is written at most maxDelay
+	 * after the first call.
+	 *
+	 * @param[in] data            Data struct with state type, data, and size.
+	 * @param[in] maxDelay        Max time in seconds before the value is written. Must be smaller than CS_STATE_QUEUE_DELAY_SECONDS_MAX.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t setBatched(const cs_state_data_t & data, uint32_t maxDelay);
+
+	/**
+	 * Execute all queued writes now, instead of waiting for their delay.
+	 *
+	 * Use this when the power is about to go down, or the device is about to reboot.
+	 */
+	void flushQueuedWrites();
+
 	/**
 	 * Verify size of user data for getting a state.
 	 *
@@ -449,6 +473,11 @@ protected:
 
 	void delayedStoreTick();
 
+	/**
+	 * Let all batched writes be executed at the next tick, because another value has been written to flash.
+	 */
+	void triggerBatchedWrites();
+
 	/**
 	 * Stores state data structs with pointers to state data.
 	 */
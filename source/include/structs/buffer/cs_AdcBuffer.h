@@ -7,7 +7,6 @@
 #pragma once
 
 #include <cstdint>
-#include <cstdlib>
 #include <cfg/cs_Config.h>
 #include <util/cs_Error.h>
 #include <logging/cs_Logger.h>
@@ -17,26 +16,81 @@
 // The number of channels per buffer.
 static const adc_channel_id_t ADC_CHANNEL_COUNT = CS_ADC_NUM_CHANNELS;
 
-// The number of samples for each channel in a buffer.
+// The number of samples for each channel in a buffer, with the default sampling profile.
 static const adc_sample_value_id_t ADC_CHANNEL_SAMPLE_COUNT = CS_ADC_NUM_SAMPLES_PER_CHANNEL;
 
-// Total number of samples in a buffer.
-static const uint32_t ADC_BUFFER_SAMPLE_COUNT = ADC_CHANNEL_COUNT * ADC_CHANNEL_SAMPLE_COUNT;
+// The max number of samples for each channel in a buffer, of all sampling profiles.
+static const adc_sample_value_id_t ADC_MAX_CHANNEL_SAMPLE_COUNT = CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL;
 
-// The number of buffers.
+// The max number of buffers.
 static const adc_buffer_id_t ADC_BUFFER_COUNT = CS_ADC_NUM_BUFFERS;
 
+// Total number of samples of all buffers: enough for each sampling profile.
+static const uint32_t ADC_SAMPLE_MEMORY_SIZE = ADC_CHANNEL_COUNT * (
+		ADC_BUFFER_COUNT * ADC_CHANNEL_SAMPLE_COUNT > CS_ADC_NUM_BUFFERS_HIGH_RATE * ADC_MAX_CHANNEL_SAMPLE_COUNT
+		? ADC_BUFFER_COUNT * ADC_CHANNEL_SAMPLE_COUNT
+		: CS_ADC_NUM_BUFFERS_HIGH_RATE * ADC_MAX_CHANNEL_SAMPLE_COUNT);
+
+// Value for no buffer.
+static const adc_buffer_id_t ADC_BUFFER_ID_NONE = 0xFF;
+
+/**
+ * Who owns a buffer.
+ *
+ * A buffer goes around: FREE -> QUEUED -> FILLED -> PROCESSING -> FREE.
+ * Each transition is done by a single owner, with an atomic compare and swap, so the SAADC interrupt
+ * and the main thread can hand over buffers without disabling interrupts.
+ */
+enum adc_buffer_state_t : uint8_t {
+	ADC_BUFFER_STATE_FREE = 0,   // Can be queued in the SAADC.
+	ADC_BUFFER_STATE_QUEUED,     // Queued in the SAADC: being, or going to be, filled with samples.
+	ADC_BUFFER_STATE_FILLED,     // Filled with samples, waiting for the main thread.
+	ADC_BUFFER_STATE_PROCESSING, // Held by processing, until it's released.
+};
+
 /**
  * Class that keeps up the buffers used for ADC.
  *
- * - Allocates the buffers.
+ * - Statically allocates the buffers.
+ * - Divides the sample memory over the buffers, according to the sampling interval.
+ * - Keeps up who owns each buffer.
  * - Abstracts away the interleaved nature of the ADC samples.
  */
 class AdcBuffer {
 private:
 
-	adc_buffer_t* _buf[ADC_BUFFER_COUNT] = { nullptr };
-	bool _allocated = false;
+	adc_buffer_t _buf[ADC_BUFFER_COUNT];
+
+	/**
+	 * The samples of all buffers.
+	 *
+	 * The SAADC writes to them with EasyDMA, which requires word alignment.
+	 */
+	alignas(4) adc_sample_value_t _samples[ADC_SAMPLE_MEMORY_SIZE];
+
+	/**
+	 * Number of samples for each channel in a buffer.
+	 */
+	adc_sample_value_id_t _channelLength = ADC_CHANNEL_SAMPLE_COUNT;
+
+	/**
+	 * Number of buffers in use.
+	 */
+	adc_buffer_id_t _bufferCount = ADC_BUFFER_COUNT;
+
+	/**
+	 * State of each buffer.
+	 *
+	 * == Used in interrupt! ==
+	 */
+	volatile adc_buffer_state_t _state[ADC_BUFFER_COUNT];
+
+	/**
+	 * Buffer to start looking for a free buffer, so that buffers are used in turn.
+	 */
+	adc_buffer_id_t _nextFree = 0;
+
+	bool _initialized = false;
 
 	AdcBuffer() {};
 	AdcBuffer(AdcBuffer const&) {};
@@ -52,31 +106,29 @@ public:
 	}
 
 	/**
-	 * Allocate the buffers.
+	 * Initialize the buffers, all of them will be free.
+	 *
+	 * As many buffers as fit in the sample memory are used, up to the max number of buffers.
+	 *
+	 * @param[in] channelLength        Number of samples for each channel in a buffer.
 	 */
-	cs_ret_code_t init() {
-		if (_allocated) {
+	cs_ret_code_t init(adc_sample_value_id_t channelLength) {
+		if (_initialized) {
 			return ERR_SUCCESS;
 		}
-		for (adc_buffer_id_t i = 0; i < ADC_BUFFER_COUNT; ++i) {
-			adc_buffer_t* buf = (adc_buffer_t*) malloc(sizeof(adc_buffer_t));
-
-//			adc_sample_value_t* buf = (adc_sample_value_t*) malloc(sizeof(adc_sample_value_t) * ADC_BUFFER_SAMPLE_COUNT);
-			if (buf == nullptr) {
-				LOGw("No space to allocate buf");
-				// TODO: free all buffers?
-				return ERR_NO_SPACE;
-			}
-			buf->samples = (adc_sample_value_t*) malloc(sizeof(adc_sample_value_t) * ADC_BUFFER_SAMPLE_COUNT);
-			if (buf->samples == nullptr) {
-				LOGw("No space to allocate samples buf");
-				// TODO: free all buffers?
-				return ERR_NO_SPACE;
-			}
-			LOGd("Allocate buffer %i = %p", i, buf->samples);
-			_buf[i] = buf;
+		if (channelLength == 0 || channelLength > ADC_MAX_CHANNEL_SAMPLE_COUNT) {
+			LOGw("Invalid channel length %u", channelLength);
+			return ERR_WRONG_PARAMETER;
 		}
-		_allocated = true;
+		_channelLength = channelLength;
+		uint32_t bufferCount = ADC_SAMPLE_MEMORY_SIZE / getBufferLength();
+		_bufferCount = (bufferCount < ADC_BUFFER_COUNT) ? bufferCount : ADC_BUFFER_COUNT;
+		for (adc_buffer_id_t i = 0; i < _bufferCount; ++i) {
+			_buf[i].samples = _samples + i * getBufferLength();
+			_state[i] = ADC_BUFFER_STATE_FREE;
+			LOGd("Buffer %i = %p", i, _buf[i].samples);
+		}
+		_initialized = true;
 		return ERR_SUCCESS;
 	}
 
@@ -85,20 +137,65 @@ public:
 	 */
 	adc_buffer_t* getBuffer(adc_buffer_id_t buffer_id) {
 //		assert(buffer_id < getBufferCount(), "ADC has fewer buffers allocated");
-		return _buf[buffer_id];
+		return &(_buf[buffer_id]);
+	}
+
+	/**
+	 * Get the state of a buffer.
+	 */
+	adc_buffer_state_t getState(adc_buffer_id_t buffer_id) {
+		return _state[buffer_id];
+	}
+
+	/**
+	 * Change the state of a buffer, only if it has the expected state.
+	 *
+	 * Can be called from interrupt.
+	 *
+	 * @return     True when the state was changed.
+	 */
+	bool changeState(adc_buffer_id_t buffer_id, adc_buffer_state_t expected, adc_buffer_state_t desired) {
+		return __atomic_compare_exchange_n(&(_state[buffer_id]), &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	}
+
+	/**
+	 * Take a free buffer, and mark it as queued.
+	 *
+	 * == Called from interrupt! ==
+	 *
+	 * @return     The buffer id, or ADC_BUFFER_ID_NONE when no buffer is free.
+	 */
+	adc_buffer_id_t acquireFree() {
+		for (adc_buffer_id_t i = 0; i < _bufferCount; ++i) {
+			adc_buffer_id_t id = (_nextFree + i) % _bufferCount;
+			if (changeState(id, ADC_BUFFER_STATE_FREE, ADC_BUFFER_STATE_QUEUED)) {
+				_nextFree = (id + 1) % _bufferCount;
+				return id;
+			}
+		}
+		return ADC_BUFFER_ID_NONE;
 	}
 
 	/**
 	 * Get total number of samples in a buffer.
 	 */
-	static inline constexpr adc_sample_value_id_t getBufferLength() {
-		return ADC_BUFFER_SAMPLE_COUNT;
+	inline adc_sample_value_id_t getBufferLength() {
+		return ADC_CHANNEL_COUNT * _channelLength;
 	}
 
 	/**
 	 * Get number of samples for each channel in a buffer.
 	 */
-	static inline constexpr adc_sample_value_id_t getChannelLength() {
+	inline adc_sample_value_id_t getChannelLength() {
+		return _channelLength;
+	}
+
+	/**
+	 * Get number of samples for each channel in a buffer, with the default sampling profile.
+	 *
+	 * Can be used to size arrays.
+	 */
+	static inline constexpr adc_sample_value_id_t getDefaultChannelLength() {
 		return ADC_CHANNEL_SAMPLE_COUNT;
 	}
 
@@ -110,10 +207,10 @@ public:
 	}
 
 	/**
-	 * Get number of buffers.
+	 * Get number of buffers in use.
 	 */
-	static inline constexpr adc_buffer_id_t getBufferCount() {
-		return ADC_BUFFER_COUNT;
+	inline adc_buffer_id_t getBufferCount() {
+		return _bufferCount;
 	}
 
 	/**
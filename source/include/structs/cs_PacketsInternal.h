@@ -307,7 +307,8 @@ struct adc_buffer_t {
 	/**
 	 * Whether this buffer has valid data.
 	 *
-	 * This may change at any moment, so make sure to check it after calculations and be ready to revert.
+	 * Set to false when the buffer is queued in the SAADC, which only happens when nobody holds it.
+	 * So when you read a buffer you don't hold, check it after calculations and be ready to revert.
 	 */
 	bool valid = false;
 
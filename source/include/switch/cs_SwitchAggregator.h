@@ -11,7 +11,6 @@
 #include <behaviour/cs_TwilightHandler.h>
 #include <events/cs_EventListener.h>
 #include <optional>
-#include <structs/buffer/cs_CircularBuffer.h>
 #include <switch/cs_SmartSwitch.h>
 
 /**
@@ -51,6 +50,34 @@ private:
 	// the last state that was aggregated and passed on towards the SoftwareSwitch.
 	std::optional<uint8_t> aggregatedState = {};
 
+	/**
+	 * The inputs that determine the aggregated state.
+	 */
+	struct aggregation_inputs_t {
+		std::optional<uint8_t> overrideState;
+		std::optional<uint8_t> behaviourState;
+		std::optional<uint8_t> twilightState;
+		bool useOverride;
+
+		bool operator==(const aggregation_inputs_t& other) const {
+			return overrideState == other.overrideState && behaviourState == other.behaviourState
+				   && twilightState == other.twilightState && useOverride == other.useOverride;
+		}
+	};
+
+	/**
+	 * Inputs and result of the last aggregation.
+	 *
+	 * Most updates don't change any of the inputs, so the result can be reused.
+	 */
+	std::optional<aggregation_inputs_t> _cachedAggregationInputs = {};
+	std::optional<uint8_t> _cachedAggregationResult = {};
+
+	/**
+	 * Last dispatched value of EVT_BEHAVIOUR_OVERRIDDEN, so that it's only dispatched on change.
+	 */
+	std::optional<bool> _lastBehaviourOverridden = {};
+
 	// Cache of previous time update.
 	uint32_t _lastTimestamp = 0;
 
@@ -69,8 +96,20 @@ private:
 	/**
 	 * Keep up a history of switch commands.
 	 * This can be commands from any source, user or automated.
+	 *
+	 * Ring buffer: when full, the oldest item is overwritten.
+	 */
+	cs_switch_history_item_t _switchHistory[_maxSwitchHistoryItems];
+
+	/**
+	 * Index in the switch history where the next item will be written.
 	 */
-	CircularBuffer<cs_switch_history_item_t> _switchHistory;
+	uint8_t _switchHistoryNextIndex = 0;
+
+	/**
+	 * Number of items in the switch history.
+	 */
+	uint8_t _switchHistoryCount = 0;
 
 	// ================================== State updaters ==================================
 
@@ -162,6 +201,19 @@ private:
 	 */
 	std::optional<uint8_t> resolveOverrideState();
 
+	/**
+	 * Returns the aggregated state for the given inputs.
+	 *
+	 * Only resolves the state again when the inputs differ from the previous call.
+	 * Returns an empty optional when override and behaviour don't have an opinion.
+	 */
+	std::optional<uint8_t> getAggregatedState(const aggregation_inputs_t& inputs);
+
+	/**
+	 * Dispatch EVT_BEHAVIOUR_OVERRIDDEN, when the value changed.
+	 */
+	void dispatchBehaviourOverridden();
+
 	/**
 	 * Tries to set source as owner of the switch.
 	 * Returns true on success, false if switch is already owned by a different source, and given source does not overrule it.
@@ -171,6 +223,12 @@ private:
 	void handleGetBehaviourDebug(event_t& evt);
 
 	void addToSwitchHistory(const cs_switch_history_item_t& cmd);
+
+	/**
+	 * Get an item of the switch history, index 0 being the oldest item.
+	 */
+	const cs_switch_history_item_t& getSwitchHistoryItem(uint8_t index);
+
 	void printSwitchHistory();
 
 	void printStatus();
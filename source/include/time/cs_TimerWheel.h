@@ -0,0 +1,138 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Number of levels of the timer wheel.
+ */
+#define TIMER_WHEEL_LEVELS 3
+
+/**
+ * Number of bits of the slot index per level.
+ * Each level has (1 << TIMER_WHEEL_SLOT_BITS) slots.
+ */
+#define TIMER_WHEEL_SLOT_BITS 6
+
+/**
+ * Called when a timer expires.
+ *
+ * @param[in] context              The context that was set in the entry.
+ */
+typedef void (*timer_wheel_callback_t)(void* context);
+
+/**
+ * A timer, to be owned by the module that uses it.
+ *
+ * The entry must stay at the same address while it's scheduled.
+ */
+struct timer_wheel_entry_t {
+	//! Next entry in the same slot.
+	timer_wheel_entry_t* next = nullptr;
+	//! Pointer to the pointer that points to this entry, nullptr when not scheduled.
+	timer_wheel_entry_t** pprev = nullptr;
+	//! Value of the seconds counter at which this timer expires.
+	uint32_t expirySeconds = 0;
+	timer_wheel_callback_t callback = nullptr;
+	void* context = nullptr;
+};
+
+/**
+ * Hierarchical timer wheel, to be used for all timeouts with a resolution of a second.
+ *
+ * Instead of decrementing a countdown of every entry every second, modules schedule their
+ * entries once, and get a callback when it expired.
+ * - Scheduling and cancelling are O(1).
+ * - A second without expiries does no per entry work.
+ * - The first level has a slot per second, each next level has a slot per slot of the previous level.
+ *   Entries move to a lower level when the wheel reaches their slot.
+ * - Timeouts longer than the wheel size are moved down in multiple steps, so there is no max timeout.
+ */
+class TimerWheel {
+public:
+	static TimerWheel& getInstance() {
+		static TimerWheel instance;
+		return instance;
+	}
+
+#ifdef HOST_TARGET
+	/**
+	 * Only for tests: a separate wheel, that starts at the given number of seconds.
+	 */
+	explicit TimerWheel(uint32_t startSeconds) : _seconds(startSeconds) {}
+#endif
+
+	/**
+	 * Schedule an entry, or reschedule it when it's already scheduled.
+	 *
+	 * @param[in] entry                Entry with the callback and context set.
+	 * @param[in] delaySeconds         Number of seconds until the callback is called. A delay of 0 is treated as 1.
+	 */
+	void schedule(timer_wheel_entry_t& entry, uint32_t delaySeconds);
+
+	/**
+	 * Cancel an entry, does nothing when it's not scheduled.
+	 */
+	void cancel(timer_wheel_entry_t& entry);
+
+	/**
+	 * Whether the entry is scheduled.
+	 */
+	static bool isScheduled(const timer_wheel_entry_t& entry) {
+		return entry.pprev != nullptr;
+	}
+
+	/**
+	 * Number of seconds until the entry expires, or 0 when not scheduled.
+	 */
+	uint32_t getSecondsLeft(const timer_wheel_entry_t& entry) const;
+
+	/**
+	 * Number of seconds ticked since start.
+	 */
+	uint32_t getSeconds() const {
+		return _seconds;
+	}
+
+	/**
+	 * To be called every second.
+	 *
+	 * Calls the callbacks of the expired entries.
+	 */
+	void tickSecond();
+
+private:
+	static constexpr uint32_t NUM_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+	static constexpr uint32_t SLOT_MASK = NUM_SLOTS - 1;
+
+	TimerWheel() = default;
+	TimerWheel(TimerWheel const&) = delete;
+	void operator=(TimerWheel const&) = delete;
+
+	timer_wheel_entry_t* _slots[TIMER_WHEEL_LEVELS][NUM_SLOTS] = {};
+
+	uint32_t _seconds = 0;
+
+	/**
+	 * Put an unlinked entry in the slot that matches its expiry time.
+	 */
+	void insert(timer_wheel_entry_t& entry);
+
+	/**
+	 * Remove an entry from its slot.
+	 */
+	static void unlink(timer_wheel_entry_t& entry);
+
+	/**
+	 * Move all entries of the current slot of the given level to lower levels.
+	 *
+	 * @return the slot index of the given level.
+	 */
+	uint32_t cascade(uint8_t level);
+};
@@ -7,7 +7,7 @@
 #pragma once
 
 #include <events/cs_EventListener.h>
-#include <forward_list>
+#include <util/cs_HashIndex.h>
 #include <cstdint>
 
 /**
@@ -21,6 +21,11 @@
  * - Cache the data of the devices (profile, location, flags, etc).
  * - Handle scans with device token only as data, and dispatch background broadcast event, by adding cached data.
  * - Handle device heartbeats, which are treated as if the device was scanned, by dispatching profile location event.
+ *
+ * Devices are stored in a fixed size array, with a hash index on device ID and on device token,
+ * since every background broadcast has to be looked up by token.
+ * When the array is full, the least recently used device that is incomplete, else the least recently used device,
+ * is removed to make space.
  */
 class TrackedDevices: public EventListener {
 public:
@@ -41,7 +46,7 @@ public:
 	/**
 	 * Maximum number of registered tracked devices.
 	 */
-	static const uint8_t MAX_TRACKED_DEVICES = 20;
+	static const uint8_t MAX_TRACKED_DEVICES = TRACKED_DEVICES_MAX_COUNT;
 
 	/**
 	 * After N minutes not hearing anything from the device, the location ID will be set to 0 (in sphere).
@@ -70,25 +75,49 @@ private:
 	};
 	static const uint8_t ALL_FIELDS_SET = 0x7F;
 
+	static const uint8_t INDEX_NOT_FOUND = HashIndex<MAX_TRACKED_DEVICES>::INDEX_NOT_FOUND;
+
 	struct __attribute__((packed)) TrackedDevice {
 		uint8_t fieldsSet = 0;
 		uint8_t locationIdTTLMinutes = LOCATION_ID_TTL_MINUTES;
 		uint8_t heartbeatTTLMinutes = 0;
 		internal_register_tracked_device_packet_t data;
+
+		/**
+		 * Indices of the more and less recently used device.
+		 */
+		uint8_t lruPrev = INDEX_NOT_FOUND;
+		uint8_t lruNext = INDEX_NOT_FOUND;
 	};
 
 	uint16_t ticksLeftSecond = TICKS_PER_SECOND;
 	uint16_t ticksLeftMinute = TICKS_PER_MINUTES;
 
 	/**
-	 * List of all tracked devices.
+	 * All tracked devices, the first deviceListSize entries are in use.
 	 *
 	 * Device ID should be unique.
 	 */
-	std::forward_list<TrackedDevice> devices;
+	TrackedDevice devices[MAX_TRACKED_DEVICES];
 
 	uint8_t deviceListSize = 0;
 
+	/**
+	 * Index on device ID.
+	 */
+	HashIndex<MAX_TRACKED_DEVICES> deviceIdIndex;
+
+	/**
+	 * Index on device token, only has the devices of which the token is set.
+	 */
+	HashIndex<MAX_TRACKED_DEVICES> deviceTokenIndex;
+
+	/**
+	 * Most and least recently used device.
+	 */
+	uint8_t lruHead = INDEX_NOT_FOUND;
+	uint8_t lruTail = INDEX_NOT_FOUND;
+
 	/**
 	 * Whether there has been a successful sync of tracked devices.
 	 *
@@ -105,7 +134,8 @@ private:
 	/**
 	 * Find device with given ID, else add a new device with given ID.
 	 *
-	 * returns null if couldn't be added.
+	 * Marks the device as most recently used.
+	 * When the list is full, a device is removed to make space, see getIndexToRemove().
 	 */
 	TrackedDevice* findOrAdd(device_id_t deviceId);
 
@@ -124,18 +154,38 @@ private:
 	TrackedDevice* findToken(uint8_t* deviceToken, uint8_t size);
 
 	/**
-	 * Add device to list.
+	 * Add device with given ID to list.
 	 *
-	 * returns null if couldn't be added.
+	 * Removes a device when the list is full, see getIndexToRemove().
 	 */
-	TrackedDevice* add();
+	TrackedDevice* add(device_id_t deviceId);
+
+	/**
+	 * Get the index of the device to remove to make space: the least recently used device that doesn't have all
+	 * fields set, else the least recently used device.
+	 */
+	uint8_t getIndexToRemove();
 
 	/**
 	 * Remove a device from the list.
 	 *
-	 * Either a record with incomplete data, otherwise the oldest.
+	 * Moves the last device in the list to the freed index.
+	 */
+	void removeDevice(uint8_t index);
+
+	/**
+	 * Mark a device as most recently used.
+	 */
+	void touch(TrackedDevice& device);
+
+	void lruUnlink(uint8_t index);
+
+	uint8_t getIndex(TrackedDevice& device);
+
+	/**
+	 * Get the key of a device token in the token index.
 	 */
-	cs_ret_code_t removeDevice();
+	static uint32_t getTokenKey(const uint8_t* deviceToken);
 
 	cs_ret_code_t handleRegister(internal_register_tracked_device_packet_t& packet);
 	cs_ret_code_t handleUpdate(internal_update_tracked_device_packet_t& packet);
@@ -158,9 +208,9 @@ private:
 	bool isValidTTL(TrackedDevice& device);
 
 	/**
-	 * Returns true when no other device has this token.
+	 * Returns true when no device other than the one with given ID has this token.
 	 */
-	bool isTokenOkToSet(TrackedDevice& device, uint8_t* deviceToken, uint8_t size);
+	bool isTokenOkToSet(device_id_t deviceId, uint8_t* deviceToken, uint8_t size);
 
 	void print(TrackedDevice& device);
 
@@ -36,7 +36,7 @@
  *   coroutine c;
  *   // set stack pointer to end of stack for microapp
  *   coargs args = {&c};
- *   start(&c, &iterate, &args, *stack);
+ *   start(&c, &iterate, &args, stack);
  * }
  * // we step until next returns negative, after that we can init again
  * void bluenet_step() {
@@ -47,8 +47,8 @@
  */
 
 /**
- * We have a buffer to store our stack pointer and registers to if we go back and forth. There are only two coroutines
- * envisioned.
+ * We have a buffer to store our stack pointer and registers to if we go back and forth. Each coroutine has its own
+ * stack, so there can be multiple coroutines, for example one per microapp.
  */
 typedef struct {
 	jmp_buf callee_context;
@@ -59,8 +59,12 @@ typedef void (*coroutine_func)(void*);
 
 /**
  * Start the coroutine.
+ *
+ * Nothing global is used, so other coroutines can be started while this one is yielded.
+ *
+ * @param[in] stack   End (highest address) of the stack of the coroutine, should be 8 byte aligned.
  */
-void start(coroutine* c, coroutine_func f, void* arg);
+void start(coroutine* c, coroutine_func f, void* arg, void* stack);
 
 void yield(coroutine* c);
 
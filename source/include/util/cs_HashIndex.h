@@ -0,0 +1,164 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Number of bits needed for a table of at least the given size.
+ */
+constexpr uint8_t hashIndexTableSizeBits(uint16_t minSize) {
+	uint8_t bits = 0;
+	while ((1 << bits) < minSize) {
+		bits++;
+	}
+	return bits;
+}
+
+/**
+ * Hash index into an array of at most Capacity items.
+ *
+ * The index only stores array indices: the items and their keys are kept by the user of this class.
+ * That's why find() and remove() take a function, to compare or get the key of an item.
+ *
+ * Uses open addressing with linear probing, in a table of at least twice the capacity,
+ * so that lookups stay short and never hit a full table.
+ * Removal shifts entries back instead of leaving tombstones, so lookups don't degrade over time.
+ *
+ * https://en.wikipedia.org/wiki/Linear_probing#Deletion
+ */
+template <uint8_t Capacity>
+class HashIndex {
+public:
+	static constexpr uint8_t INDEX_NOT_FOUND = 0xFF;
+	static_assert(Capacity > 0 && Capacity < INDEX_NOT_FOUND, "Invalid capacity");
+
+	static constexpr uint8_t TABLE_SIZE_BITS = hashIndexTableSizeBits(2 * Capacity);
+	static constexpr uint16_t TABLE_SIZE     = 1 << TABLE_SIZE_BITS;
+
+	HashIndex() {
+		clear();
+	}
+
+	void clear() {
+		for (auto& slot : _slots) {
+			slot = INDEX_NOT_FOUND;
+		}
+	}
+
+	/**
+	 * Find the index of an item.
+	 *
+	 * @param[in] key        Key of the item.
+	 * @param[in] matches    Function that returns true when the item at the given index is the searched item.
+	 *
+	 * @return               Index of the item, or INDEX_NOT_FOUND.
+	 */
+	template <class Matches>
+	uint8_t find(uint32_t key, Matches matches) const {
+		for (uint16_t slot = getHomeSlot(key); _slots[slot] != INDEX_NOT_FOUND; slot = getNextSlot(slot)) {
+			if (matches(_slots[slot])) {
+				return _slots[slot];
+			}
+		}
+		return INDEX_NOT_FOUND;
+	}
+
+	/**
+	 * Add an item to the index.
+	 *
+	 * @param[in] key        Key of the item.
+	 * @param[in] index      Index of the item.
+	 */
+	void insert(uint32_t key, uint8_t index) {
+		uint16_t slot = getHomeSlot(key);
+		while (_slots[slot] != INDEX_NOT_FOUND) {
+			slot = getNextSlot(slot);
+		}
+		_slots[slot] = index;
+	}
+
+	/**
+	 * Remove an item from the index.
+	 *
+	 * @param[in] key        Key of the item.
+	 * @param[in] index      Index of the item.
+	 * @param[in] getKey     Function that returns the key of the item at a given index.
+	 *
+	 * @return               False when the item was not in the index.
+	 */
+	template <class GetKey>
+	bool remove(uint32_t key, uint8_t index, GetKey getKey) {
+		uint16_t hole = findSlot(key, index);
+		if (hole == TABLE_SIZE) {
+			return false;
+		}
+		// Move entries after the hole back, as long as they then are still at or after their home slot.
+		for (uint16_t slot = getNextSlot(hole); _slots[slot] != INDEX_NOT_FOUND; slot = getNextSlot(slot)) {
+			uint16_t homeSlot = getHomeSlot(getKey(_slots[slot]));
+			if (getDistance(homeSlot, slot) >= getDistance(hole, slot)) {
+				_slots[hole] = _slots[slot];
+				hole         = slot;
+			}
+		}
+		_slots[hole] = INDEX_NOT_FOUND;
+		return true;
+	}
+
+	/**
+	 * Let the index point to a new index of an item, for when the item moved in the array.
+	 *
+	 * @param[in] key        Key of the item.
+	 * @param[in] oldIndex   Index of the item before it was moved.
+	 * @param[in] newIndex   Index of the item after it was moved.
+	 *
+	 * @return               False when the item was not in the index.
+	 */
+	bool replace(uint32_t key, uint8_t oldIndex, uint8_t newIndex) {
+		uint16_t slot = findSlot(key, oldIndex);
+		if (slot == TABLE_SIZE) {
+			return false;
+		}
+		_slots[slot] = newIndex;
+		return true;
+	}
+
+	/**
+	 * Slot at which the search for a key starts.
+	 *
+	 * Fibonacci hashing: the top bits of the key multiplied by 2^32 / golden ratio.
+	 */
+	static uint16_t getHomeSlot(uint32_t key) {
+		return static_cast<uint16_t>((key * 2654435769u) >> (32 - TABLE_SIZE_BITS));
+	}
+
+private:
+	uint8_t _slots[TABLE_SIZE];
+
+	static uint16_t getNextSlot(uint16_t slot) {
+		return (slot + 1) & (TABLE_SIZE - 1);
+	}
+
+	/**
+	 * Number of slots from one slot forward to another, wrapping around.
+	 */
+	static uint16_t getDistance(uint16_t from, uint16_t to) {
+		return (to - from) & (TABLE_SIZE - 1);
+	}
+
+	/**
+	 * @return    Slot that holds the index, or TABLE_SIZE when not found.
+	 */
+	uint16_t findSlot(uint32_t key, uint8_t index) const {
+		for (uint16_t slot = getHomeSlot(key); _slots[slot] != INDEX_NOT_FOUND; slot = getNextSlot(slot)) {
+			if (_slots[slot] == index) {
+				return slot;
+			}
+		}
+		return TABLE_SIZE;
+	}
+};
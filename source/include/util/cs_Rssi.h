@@ -52,6 +52,19 @@ inline bool rssiIsCloser(
 	return lhs.rssiHalved < rhs.rssiHalved;
 }
 
+/**
+ * Returns true if the rssi value of lhs represents a shorter
+ * physical distance than rhs, by more than the given margin. Ignores channel.
+ *
+ * @param[in] marginHalved   Margin in steps of 2 dB.
+ */
+inline bool rssiIsCloserBy(
+		const compressed_rssi_data_t& lhs,
+		const compressed_rssi_data_t& rhs,
+		uint8_t marginHalved) {
+	return lhs.rssiHalved + marginHalved < rhs.rssiHalved;
+}
+
 inline bool rssiIsCloserEqual(
 		const compressed_rssi_data_t& lhs,
 		const compressed_rssi_data_t& rhs) {
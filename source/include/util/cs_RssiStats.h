@@ -0,0 +1,166 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Running mean and variance of RSSI values, in fixed point.
+ *
+ * For the first WindowSize values, this is Welford's algorithm: each value has the same weight.
+ * After that, the weight stays 1/WindowSize, which makes it an exponentially weighted moving average and variance.
+ * This way, old values are forgotten, and the values can't overflow.
+ *
+ * https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Welford's_online_algorithm
+ * https://en.wikipedia.org/wiki/Moving_average#Exponentially_weighted_moving_variance_and_standard_deviation
+ *
+ * Notes:
+ * - Mean and variance have FRACTION_BITS fractional bits, so that the mean still moves when a new value
+ *   has a weight of 1/WindowSize.
+ * - The variance is the population variance (divided by N, not N-1), and saturates at MAX_VARIANCE.
+ * - Uses no floats, and takes 10 bytes.
+ */
+template <uint16_t WindowSize>
+class __attribute__((__packed__)) RssiStats {
+public:
+	static_assert(WindowSize >= 1, "Window size must be at least 1");
+
+	static constexpr uint8_t FRACTION_BITS = 16;
+	static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+	/**
+	 * Max variance, 128² dB², so that the difference with a new variance term fits in 32 bits.
+	 */
+	static constexpr int32_t MAX_VARIANCE = (1 << 30) - 1;
+
+	/**
+	 * Update the statistics with a new RSSI value.
+	 */
+	void addValue(int8_t rssi) {
+		if (_count < WindowSize) {
+			_count++;
+		}
+		int32_t value = rssi * ONE;
+		int32_t diffWithOldMean = value - _mean;
+		int32_t mean = _mean + divideRounded(diffWithOldMean, _count);
+		int32_t diffWithNewMean = value - mean;
+
+		// Both diffs have the same sign, so the product is never negative.
+		int64_t varianceTermLarge = (static_cast<int64_t>(diffWithOldMean) * diffWithNewMean) >> FRACTION_BITS;
+		int32_t varianceTerm = varianceTermLarge > MAX_VARIANCE ? MAX_VARIANCE : static_cast<int32_t>(varianceTermLarge);
+		int32_t variance = static_cast<int32_t>(_variance) + divideRounded(varianceTerm - static_cast<int32_t>(_variance), _count);
+
+		_mean = mean;
+		_variance = variance > 0 ? variance : 0;
+	}
+
+	/**
+	 * Number of values added, saturates at WindowSize.
+	 */
+	uint16_t getCount() const {
+		return _count;
+	}
+
+	/**
+	 * Mean RSSI, rounded to the nearest integer.
+	 */
+	int8_t getMean() const {
+		return static_cast<int8_t>(divideRounded(_mean, ONE));
+	}
+
+	/**
+	 * Mean RSSI, with FRACTION_BITS fractional bits.
+	 */
+	int32_t getMeanFixedPoint() const {
+		return _mean;
+	}
+
+	/**
+	 * Variance of the RSSI in dB², with FRACTION_BITS fractional bits.
+	 */
+	uint32_t getVarianceFixedPoint() const {
+		return _variance;
+	}
+
+	void reset() {
+		_count = 0;
+		_mean = 0;
+		_variance = 0;
+	}
+
+private:
+	uint16_t _count = 0;
+	int32_t _mean = 0;
+	uint32_t _variance = 0;
+
+	/**
+	 * Division, rounded to nearest, with ties away from zero.
+	 */
+	static int32_t divideRounded(int32_t numerator, int32_t denominator) {
+		if (numerator >= 0) {
+			return (numerator + denominator / 2) / denominator;
+		}
+		return (numerator - denominator / 2) / denominator;
+	}
+};
+
+/**
+ * Running RSSI statistics of a link, separate for each BLE advertising channel.
+ */
+template <uint16_t WindowSize>
+class __attribute__((__packed__)) RssiChannelStats {
+public:
+	static constexpr uint8_t CHANNEL_COUNT = 3;
+	static constexpr uint8_t FIRST_CHANNEL = 37;
+
+	/**
+	 * Update the statistics of a channel with a new RSSI value.
+	 *
+	 * @param[in] rssi       The RSSI value.
+	 * @param[in] channel    The channel (37, 38, or 39) on which the RSSI was measured.
+	 *
+	 * @return               False when the channel is not an advertising channel.
+	 */
+	bool addValue(int8_t rssi, uint8_t channel) {
+		if (channel < FIRST_CHANNEL || channel >= FIRST_CHANNEL + CHANNEL_COUNT) {
+			return false;
+		}
+		_channels[channel - FIRST_CHANNEL].addValue(rssi);
+		return true;
+	}
+
+	/**
+	 * Get the statistics of a channel.
+	 *
+	 * @param[in] channelIndex   0 for channel 37, 1 for channel 38, 2 for channel 39.
+	 */
+	const RssiStats<WindowSize>& getChannel(uint8_t channelIndex) const {
+		return _channels[channelIndex];
+	}
+
+	/**
+	 * Lowest number of values of all channels.
+	 */
+	uint16_t getMinCount() const {
+		uint16_t count = _channels[0].getCount();
+		for (uint8_t i = 1; i < CHANNEL_COUNT; ++i) {
+			if (_channels[i].getCount() < count) {
+				count = _channels[i].getCount();
+			}
+		}
+		return count;
+	}
+
+	void reset() {
+		for (auto& channel : _channels) {
+			channel.reset();
+		}
+	}
+
+private:
+	RssiStats<WindowSize> _channels[CHANNEL_COUNT];
+};
@@ -0,0 +1,139 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Median, max, and mean of the last WindowSize values, kept up to date on every push.
+ *
+ * Next to the values in order of arrival, the same values are kept sorted. On a push, the oldest
+ * value in the sorted array is replaced by the new value, which is then moved to its place. As the
+ * new value is usually close to the oldest value, it only moves a few places. The median and max
+ * can then simply be read, without copying or sorting the window.
+ *
+ * Notes:
+ * - The median of an odd sized window is the same as the one of opt_med7(), opt_med9(), or opt_med25().
+ *   For an even sized window, it's the upper of the two middle values.
+ * - Uses no dynamic memory, and no floats.
+ */
+template <uint16_t WindowSize>
+class RunningMedian {
+public:
+	static_assert(WindowSize >= 1, "Window size must be at least 1");
+
+	/**
+	 * Add a value, removes the oldest value when the window is full.
+	 */
+	void push(int32_t value) {
+		uint16_t index;
+		if (_count == WindowSize) {
+			int32_t oldest = _values[_next];
+			_sum -= oldest;
+			index = find(oldest);
+		}
+		else {
+			index = _count;
+			_count++;
+		}
+		_values[_next] = value;
+		_next = (_next + 1) % WindowSize;
+		_sum += value;
+
+		// Move the new value to its place, only one of these loops will move it.
+		while (index > 0 && _sorted[index - 1] > value) {
+			_sorted[index] = _sorted[index - 1];
+			--index;
+		}
+		while (index + 1 < _count && _sorted[index + 1] < value) {
+			_sorted[index] = _sorted[index + 1];
+			++index;
+		}
+		_sorted[index] = value;
+	}
+
+	/**
+	 * Number of values in the window, saturates at WindowSize.
+	 */
+	uint16_t size() const {
+		return _count;
+	}
+
+	bool empty() const {
+		return _count == 0;
+	}
+
+	bool full() const {
+		return _count == WindowSize;
+	}
+
+	/**
+	 * Median of the values in the window.
+	 *
+	 * Should not be called when empty.
+	 */
+	int32_t getMedian() const {
+		return _sorted[_count / 2];
+	}
+
+	/**
+	 * Max of the values in the window.
+	 *
+	 * Should not be called when empty.
+	 */
+	int32_t getMax() const {
+		return _sorted[_count - 1];
+	}
+
+	/**
+	 * Mean of the values in the window, rounded towards zero.
+	 *
+	 * Should not be called when empty.
+	 */
+	int32_t getMean() const {
+		return _sum / _count;
+	}
+
+	void clear() {
+		_count = 0;
+		_next = 0;
+		_sum = 0;
+	}
+
+private:
+	/**
+	 * Values in order of arrival, _next is the index of the oldest value once the window is full.
+	 */
+	int32_t _values[WindowSize];
+
+	/**
+	 * The same values, sorted from low to high.
+	 */
+	int32_t _sorted[WindowSize];
+
+	uint16_t _count = 0;
+	uint16_t _next = 0;
+	int64_t _sum = 0;
+
+	/**
+	 * Binary search of a value that is in the sorted array.
+	 */
+	uint16_t find(int32_t value) const {
+		uint16_t low = 0;
+		uint16_t high = _count - 1;
+		while (low < high) {
+			uint16_t mid = (low + high) / 2;
+			if (_sorted[mid] < value) {
+				low = mid + 1;
+			}
+			else {
+				high = mid;
+			}
+		}
+		return low;
+	}
+};
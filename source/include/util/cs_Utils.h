@@ -181,8 +181,12 @@ inline static cs_ret_code_t findAdvType(uint8_t type, uint8_t* advData, uint8_t
 
 
 inline uint32_t getInterruptLevel() {
+#ifdef HOST_TARGET
+	return 0;
+#else
 //	return __get_IPSR() & 0x1FF;
 	return __get_IPSR();
+#endif
 //	0 = Thread mode
 //	1 = Reserved
 //	2 = NMI
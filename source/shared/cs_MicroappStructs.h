@@ -36,6 +36,7 @@ enum CommandMicroappPin {
 enum ErrorCodesMicroapp {
 	ERR_NO_PAYLOAD                        = 0x01,    // need at least an opcode in the payload
 	ERR_TOO_LARGE                         = 0x02,
+	ERR_NOT_IN_RING                       = 0x03,    // command can't be used via the command ring
 };
 
 enum CommandMicroapp {
@@ -44,6 +45,8 @@ enum CommandMicroapp {
 	CS_MICROAPP_COMMAND_PIN               = 0x03,
 	CS_MICROAPP_COMMAND_SERVICE_DATA      = 0x04,
 	CS_MICROAPP_COMMAND_TWI               = 0x05,
+	CS_MICROAPP_COMMAND_SCAN              = 0x06,
+	CS_MICROAPP_COMMAND_COMMAND_RING      = 0x07,
 };
 
 enum CommandMicroappLogOption {
@@ -82,6 +85,18 @@ enum CommandMicroappTwiOpcode {
 	CS_MICROAPP_COMMAND_TWI_DISABLE       = 0x05,
 };
 
+enum CommandMicroappScanOpcode {
+	CS_MICROAPP_COMMAND_SCAN_SET_BUFFER   = 0x01,
+	CS_MICROAPP_COMMAND_SCAN_SUBSCRIBE    = 0x02,
+	CS_MICROAPP_COMMAND_SCAN_UNSUBSCRIBE  = 0x03,
+};
+
+enum CommandMicroappScanInput {
+	CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS        = 0x00, // The 6 bytes of the MAC address, LSB first.
+	CS_MICROAPP_COMMAND_SCAN_INPUT_AD_DATA_TYPE       = 0x01, // The data of the first AD field of a type.
+	CS_MICROAPP_COMMAND_SCAN_INPUT_MASKED_AD_DATA_TYPE = 0x02, // Selected bytes of the first AD field of a type.
+};
+
 enum CommandMicroappPinValue {
 	CS_MICROAPP_COMMAND_VALUE_OFF         = 0x00,
 	CS_MICROAPP_COMMAND_VALUE_ON          = 0x01,
@@ -139,3 +154,126 @@ typedef struct {
 	uint8_t buf[MAX_TWI_PAYLOAD];
 } twi_cmd_t;
 
+
+/*
+ * Number of entries in the command ring, and in the completion ring. Must be a power of 2.
+ */
+const uint8_t MICROAPP_COMMAND_RING_SIZE = 8;
+
+/*
+ * A command in the command ring: the same payload as would be passed to the callback.
+ *
+ * The payload has one spare byte, for the null terminator of a logged string.
+ */
+typedef struct {
+	uint8_t length;
+	uint8_t payload[MAX_PAYLOAD + 1];
+} microapp_ring_command_t;
+
+/*
+ * Result of a command in the command ring.
+ */
+typedef struct {
+	uint8_t id;          // Value of commandTail when the command was handled.
+	uint8_t cmd;         // Opcode of the command.
+	uint16_t result;     // Result code.
+} microapp_ring_completion_t;
+
+/*
+ * Rings in shared memory, so that a microapp can queue many commands, without a call into bluenet for each command.
+ *
+ * The microapp adds commands at commandHead, bluenet handles them in a batch when the microapp yields or its setup or
+ * loop returns. For each handled command, bluenet adds a completion at completionHead, which the microapp reads at
+ * completionTail.
+ *
+ * The heads and tails are free running counters: the entry index is the counter modulo MICROAPP_COMMAND_RING_SIZE.
+ * A ring is empty when head == tail, and full when head - tail == MICROAPP_COMMAND_RING_SIZE.
+ * Bluenet stops handling commands when the completion ring is full.
+ *
+ * Commands that yield, like delay, can't be queued, and complete with ERR_NOT_IN_RING.
+ */
+typedef struct {
+	volatile uint8_t commandHead;        // Written by the microapp.
+	volatile uint8_t commandTail;        // Written by bluenet.
+	volatile uint8_t completionHead;     // Written by bluenet.
+	volatile uint8_t completionTail;     // Written by the microapp.
+	microapp_ring_command_t commands[MICROAPP_COMMAND_RING_SIZE];
+	microapp_ring_completion_t completions[MICROAPP_COMMAND_RING_SIZE];
+} microapp_command_ring_t;
+
+/*
+ * Struct to get the address of the command ring of the microapp.
+ *
+ * Each microapp has its own command ring: bluenet sets the address of the ring of the microapp that sends the command.
+ */
+typedef struct {
+	uint8_t cmd;
+	uint8_t reserved[3];
+	uintptr_t address;                             // Set by bluenet, address of a microapp_command_ring_t.
+} command_ring_cmd_t;
+
+/*
+ * Max number of bytes of the input of a scan subscription that can be compared.
+ */
+const uint8_t MICROAPP_SCAN_VALUE_SIZE = 8;
+
+/*
+ * Struct to subscribe to scanned devices, or to unsubscribe.
+ *
+ * The input of a scanned device is selected like with asset filters: the MAC address, the data of an AD type, or
+ * masked data of an AD type. A scanned device matches when its RSSI is at least the threshold, and the first
+ * valueLength bytes of the input equal the value, for the bits set in the value mask.
+ */
+typedef struct {
+	uint8_t cmd;
+	uint8_t opcode;
+	uint8_t id;                                    // Chosen by the microapp, and set in each forwarded device.
+	int8_t rssiThreshold;
+	uint8_t inputType;                             // See CommandMicroappScanInput.
+	uint8_t adDataType;
+	uint8_t valueLength;                           // 0 matches every device that has the input.
+	uint8_t reserved;
+	uint32_t adDataMask;                           // For masked AD data: bit i set selects byte i of the AD data.
+	uint8_t value[MICROAPP_SCAN_VALUE_SIZE];
+	uint8_t valueMask[MICROAPP_SCAN_VALUE_SIZE];
+} scan_subscription_cmd_t;
+
+const uint8_t MICROAPP_SCAN_DATA_SIZE = 31;
+
+/*
+ * A scanned device, as forwarded to the microapp.
+ */
+typedef struct {
+	uint8_t id;                                    // ID of the first subscription that matched.
+	int8_t rssi;
+	uint8_t channel;
+	uint8_t dataSize;
+	uint8_t address[6];
+	uint8_t data[MICROAPP_SCAN_DATA_SIZE];
+} microapp_scanned_device_t;
+
+/*
+ * Buffer in the RAM of the microapp, to which bluenet writes the scanned devices that matched a subscription.
+ *
+ * The microapp sets the size, followed by that many devices, and passes the buffer with a scan_buffer_cmd_t.
+ * The head and tail are free running counters, like in the command ring. Devices that don't fit are counted as
+ * dropped. The microapp can handle all devices that were scanned since the previous loop in one go.
+ */
+typedef struct {
+	volatile uint8_t head;                         // Written by bluenet.
+	volatile uint8_t tail;                         // Written by the microapp.
+	uint8_t size;                                  // Number of devices, must be a power of 2.
+	uint8_t reserved;
+	volatile uint16_t dropped;                     // Written by bluenet.
+	microapp_scanned_device_t devices[1];          // Actually, size devices.
+} microapp_scan_buffer_t;
+
+/*
+ * Struct to set the scan buffer.
+ */
+typedef struct {
+	uint8_t cmd;
+	uint8_t opcode;
+	uint8_t reserved[2];
+	uintptr_t buffer;                              // Address of a microapp_scan_buffer_t.
+} scan_buffer_cmd_t;
@@ -6,6 +6,7 @@
  */
 
 #include <behaviour/cs_Behaviour.h>
+#include <behaviour/cs_BehaviourSchedule.h>
 #include <util/cs_WireFormat.h>
 #include <logging/cs_Logger.h>
 #include <time/cs_SystemTime.h>
@@ -93,39 +94,12 @@ TimeOfDay Behaviour::until() const {
 	return behaviourAppliesUntil;
 }
 
+DayOfWeekBitMask Behaviour::activeDaysOfWeek() const {
+	return activeDays;
+}
+
 bool Behaviour::isValid(Time currenttime) {
-	bool isValidIntervalOverlapsMidnight = (from() >= until());
-
-	DayOfWeek today = currenttime.dayOfWeek();
-	DayOfWeek yesterday = today - 1;
-	uint32_t now = currenttime.timeOfDay();
-
-	if (isValidIntervalOverlapsMidnight) {
-		// When a behaviour overlaps midnight, the part of [00:00, from())
-		// should use yesterday as active day comparison and the part
-		// [until(), 00:00) should use today. This is to so that all isValid
-		// intervals have the same duration.
-		//
-		// Note: this even works for from() == until() == 00:00, in that
-		// case [today] is used. as active day as now<until() is always false
-		// and from()<=now is always true.
-		if (now < until()) {
-			return activeDays & static_cast<uint8_t>(yesterday);
-		}
-		if (from () <= now) {
-			return activeDays & static_cast<uint8_t>(today);
-		}
-		return false;
-	}
-	else {
-		// behaviour doesn't overlap midnight, just use expected logic here.
-		if (activeDays & static_cast<uint8_t>(today)) {
-			return from() <= now && now < until();
-		}
-		else {
-			return false;
-		}
-	}
+	return BehaviourSchedule::isValid(from(), until(), activeDays, currenttime.timestamp());
 }
 
 void Behaviour::print() {
@@ -8,7 +8,6 @@
 
 #include <behaviour/cs_BehaviourHandler.h>
 
-#include <behaviour/cs_BehaviourConflictResolution.h>
 #include <behaviour/cs_BehaviourStore.h>
 #include <behaviour/cs_SwitchBehaviour.h>
 #include <common/cs_Types.h>
@@ -40,6 +39,7 @@ void BehaviourHandler::handleEvent(event_t& evt) {
 		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS: {
 			behaviour_settings_t* settings = reinterpret_cast<TYPIFY(STATE_BEHAVIOUR_SETTINGS)*>(evt.data);
 			isActive = settings->flags.enabled;
+			cachedIntendedState = std::nullopt;
 			LOGi("settings isActive=%u", isActive);
 			TEST_PUSH_B(this, isActive);
 			update();
@@ -75,17 +75,6 @@ bool BehaviourHandler::update() {
 	return true;
 }
 
-SwitchBehaviour* BehaviourHandler::ValidateSwitchBehaviour(Behaviour* behave, Time currentTime, PresenceStateDescription currentPresence) {
-	if (SwitchBehaviour * switchbehave = dynamic_cast<SwitchBehaviour*>(behave)) {
-		if (switchbehave->isValid(currentTime) &&
-				switchbehave->isValid(currentTime, currentPresence)) {
-			return switchbehave;
-		}
-	}
-
-	return nullptr;
-}
-
 std::optional<uint8_t> BehaviourHandler::computeIntendedState(
 		Time currentTime,
 		PresenceStateDescription currentPresence) {
@@ -98,49 +87,64 @@ std::optional<uint8_t> BehaviourHandler::computeIntendedState(
 		return {};
 	}
 
+	BehaviourSchedule& schedule = BehaviourStore::getSchedule();
+	schedule.update(currentTime.timestamp());
+
+	if (cachedIntendedState && cachedGeneration == schedule.getGeneration()) {
+		// None of the valid behaviours depend on presence, and none became valid or invalid.
+		return cachedIntendedState;
+	}
+
 	LOGBehaviourHandlerDebug("BehaviourHandler computeIntendedState resolves");
 
+	// The schedule only contains time valid behaviours, most relevant first.
 	// 'best' meaning most relevant considering from/until time window.
+	const BehaviourSchedule::entry_t* currentBestEntry = nullptr;
 	SwitchBehaviour* currentBestSwitchBehaviour = nullptr;
-	for (auto candidateBehaviour : BehaviourStore::getActiveBehaviours()) {
-		SwitchBehaviour* candidateSwitchBehaviour = ValidateSwitchBehaviour(
-				candidateBehaviour, currentTime, currentPresence);
+	bool dependsOnPresence = false;
+	for (uint8_t i = 0; i < schedule.getValidCount(); ++i) {
+		const BehaviourSchedule::entry_t& entry = schedule.getValid(i);
+		Behaviour::Type type = static_cast<Behaviour::Type>(entry.type);
+		if (type != Behaviour::Type::Switch && type != Behaviour::Type::Extended) {
+			continue;
+		}
+		// Note: this may also be an extended switch behaviour - which is intended!
+		SwitchBehaviour* candidateSwitchBehaviour = static_cast<SwitchBehaviour*>(BehaviourStore::getActiveBehaviours()[entry.index]);
+
+		// Always check presence of all valid behaviours, as the grace periods rely on it to be called often.
+		dependsOnPresence |= candidateSwitchBehaviour->SwitchBehaviour::requiresPresence()
+				|| candidateSwitchBehaviour->SwitchBehaviour::requiresAbsence();
+		if (!candidateSwitchBehaviour->isValid(currentTime, currentPresence)) {
+			continue;
+		}
 
-		// check for failed transformation from right to left. If either
-		// current or candidate is nullptr, we can continue to the next candidate.
 		if (currentBestSwitchBehaviour == nullptr) {
 			// candidate always wins when there is no current best.
+			currentBestEntry = &entry;
 			currentBestSwitchBehaviour = candidateSwitchBehaviour;
 			continue;
 		}
-		if (candidateSwitchBehaviour == nullptr) {
-			continue;
-		}
 
-		// conflict resolve:
-		if (FromUntilIntervalIsEqual(
-				currentBestSwitchBehaviour,
-				candidateSwitchBehaviour)) {
-			// when interval coincides, lowest intensity behaviour wins:
-			if (candidateSwitchBehaviour->value() < currentBestSwitchBehaviour->value()) {
-				currentBestSwitchBehaviour = candidateSwitchBehaviour;
-			}
-		}
-		else if (FromUntilIntervalIsMoreRelevantOrEqual(
-				candidateSwitchBehaviour,
-				currentBestSwitchBehaviour,
-				currentTime)) {
-			// when interval is more relevant, that behaviour wins
+		// conflict resolve: when interval coincides, lowest intensity behaviour wins.
+		// All other candidates are less relevant.
+		if (BehaviourSchedule::intervalIsEqual(*currentBestEntry, entry)
+				&& candidateSwitchBehaviour->value() < currentBestSwitchBehaviour->value()) {
+			currentBestEntry = &entry;
 			currentBestSwitchBehaviour = candidateSwitchBehaviour;
 		}
 	}
 
+	uint8_t intendedState = currentBestSwitchBehaviour ? currentBestSwitchBehaviour->value() : 0;
 
-	if (currentBestSwitchBehaviour) {
-		return currentBestSwitchBehaviour->value();
+	if (dependsOnPresence) {
+		cachedIntendedState = std::nullopt;
+	}
+	else {
+		cachedIntendedState = intendedState;
+		cachedGeneration = schedule.getGeneration();
 	}
 
-	return 0;
+	return intendedState;
 }
 
 void BehaviourHandler::handleGetBehaviourDebug(event_t& evt) {
@@ -206,26 +210,35 @@ void BehaviourHandler::handleGetBehaviourDebug(event_t& evt) {
 
 	if (checkBehaviours) {
 		for (uint8_t index = 0; index < behaviours.size(); ++index) {
-			if (SwitchBehaviour * switchbehave = dynamic_cast<SwitchBehaviour*>(behaviours[index])) {
-				// cast to switch behaviour succesful.
-				// note: this may also be an extendedswitchbehaviour - which is intended!
-				if (switchbehave->isValid(currentTime, currentPresence.value())) {
-					behaviourDebug->activeBehaviours |= (1 << index);
-
-					behaviourDebug->activeTimeoutPeriod |=
-							switchbehave->gracePeriodForPresenceIsActive() ? (1 << index) : 0;
-				}
-			}
-
-			if (ExtendedSwitchBehaviour* extendedswitchbehave = dynamic_cast<ExtendedSwitchBehaviour*>(behaviours[index])) {
-				behaviourDebug->extensionActive |=
-						extendedswitchbehave->extensionPeriodIsActive() ? (1 << index) : 0;
+			if (behaviours[index] == nullptr) {
+				continue;
 			}
-
-			if (TwilightBehaviour * twilight = dynamic_cast<TwilightBehaviour*>(behaviours[index])) {
-				if (twilight->isValid(currentTime)) {
-					behaviourDebug->activeBehaviours |= (1 << index);
+			switch (behaviours[index]->getType()) {
+				case Behaviour::Type::Extended: {
+					ExtendedSwitchBehaviour* extendedswitchbehave = static_cast<ExtendedSwitchBehaviour*>(behaviours[index]);
+					behaviourDebug->extensionActive |=
+							extendedswitchbehave->extensionPeriodIsActive() ? (1 << index) : 0;
+					[[fallthrough]];
+				}
+				case Behaviour::Type::Switch: {
+					// note: this may also be an extendedswitchbehaviour - which is intended!
+					SwitchBehaviour* switchbehave = static_cast<SwitchBehaviour*>(behaviours[index]);
+					if (switchbehave->isValid(currentTime, currentPresence.value())) {
+						behaviourDebug->activeBehaviours |= (1 << index);
+
+						behaviourDebug->activeTimeoutPeriod |=
+								switchbehave->gracePeriodForPresenceIsActive() ? (1 << index) : 0;
+					}
+					break;
 				}
+				case Behaviour::Type::Twilight: {
+					if (behaviours[index]->isValid(currentTime)) {
+						behaviourDebug->activeBehaviours |= (1 << index);
+					}
+					break;
+				}
+				default:
+					break;
 			}
 		}
 	}
@@ -240,16 +253,14 @@ std::optional<uint8_t> BehaviourHandler::getValue() {
 }
 
 bool BehaviourHandler::requiresPresence(Time t) {
-	uint8_t i = 0;
-	for (auto& behaviourPtr : BehaviourStore::getActiveBehaviours()) {
-		i += 1;
-		if (behaviourPtr != nullptr) {
-			if (behaviourPtr->requiresPresence()) {
-				LOGBehaviourHandlerVerbose("presence requiring behaviour found %d", i);
-				if (behaviourPtr->isValid(t)) {
-					LOGBehaviourHandlerVerbose("presence requiring behaviour is currently valid %d", i);
-					return true;
-				}
+	// Only switch behaviours can require presence.
+	auto behaviours = BehaviourStore::getBehaviours<SwitchBehaviour>();
+	for (auto iter = behaviours.begin(); iter != behaviours.end(); ++iter) {
+		if ((*iter).requiresPresence()) {
+			LOGBehaviourHandlerVerbose("presence requiring behaviour found %d", iter.index());
+			if ((*iter).isValid(t)) {
+				LOGBehaviourHandlerVerbose("presence requiring behaviour is currently valid %d", iter.index());
+				return true;
 			}
 		}
 	}
@@ -258,11 +269,10 @@ bool BehaviourHandler::requiresPresence(Time t) {
 }
 
 bool BehaviourHandler::requiresAbsence(Time t) {
-	for (auto& behaviourPtr : BehaviourStore::getActiveBehaviours()) {
-		if (behaviourPtr != nullptr) {
-			if (behaviourPtr->isValid(t) && behaviourPtr->requiresAbsence()) {
-				return true;
-			}
+	// Only switch behaviours can require absence.
+	for (auto& switchBehaviour : BehaviourStore::getBehaviours<SwitchBehaviour>()) {
+		if (switchBehaviour.isValid(t) && switchBehaviour.requiresAbsence()) {
+			return true;
 		}
 	}
 
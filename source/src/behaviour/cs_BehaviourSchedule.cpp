@@ -0,0 +1,110 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <behaviour/cs_BehaviourSchedule.h>
+#include <util/cs_Math.h>
+
+void BehaviourSchedule::clear() {
+	_entryCount = 0;
+	_validCount = 0;
+	_segmentEnd = 0;
+}
+
+bool BehaviourSchedule::add(uint8_t index, uint8_t type, uint8_t activeDays, uint32_t from, uint32_t until) {
+	if (_entryCount >= MaxEntries) {
+		return false;
+	}
+	entry_t& entry   = _entries[_entryCount++];
+	entry.from       = from % SecondsPerDay;
+	entry.until      = until % SecondsPerDay;
+	entry.activeDays = activeDays;
+	entry.index      = index;
+	entry.type       = type;
+
+	// Mark the valid set as outdated.
+	_segmentEnd = 0;
+	return true;
+}
+
+void BehaviourSchedule::update(uint32_t posixTime) {
+	if (_segmentStart <= posixTime && posixTime < _segmentEnd) {
+		return;
+	}
+
+	uint32_t nowTimeOfDay = posixTime % SecondsPerDay;
+
+	// The day of week changes at midnight, so that's always a boundary.
+	uint32_t secondsToBoundary = SecondsPerDay - nowTimeOfDay;
+
+	_validCount = 0;
+	for (uint8_t i = 0; i < _entryCount; ++i) {
+		const entry_t& entry = _entries[i];
+		uint32_t fromNormalized  = normalize(entry.from, nowTimeOfDay);
+		uint32_t untilNormalized = normalize(entry.until, nowTimeOfDay);
+
+		// When a boundary is at the current time, its normalized value jumps from 0 to almost a day
+		// in the next second, which changes the relevance order. So that second is a segment on its own.
+		secondsToBoundary = CsMath::min(secondsToBoundary, CsMath::max(fromNormalized, 1u));
+		secondsToBoundary = CsMath::min(secondsToBoundary, CsMath::max(untilNormalized, 1u));
+
+		if (!isValid(entry.from, entry.until, entry.activeDays, posixTime)) {
+			continue;
+		}
+
+		// Insertion sort: the later from time comes first, then the earlier until time.
+		// Both are normalized, so that the current time of day corresponds to 0.
+		uint8_t pos = _validCount;
+		while (pos > 0) {
+			const entry_t& prev = _entries[_valid[pos - 1]];
+			uint32_t prevFromNormalized  = normalize(prev.from, nowTimeOfDay);
+			uint32_t prevUntilNormalized = normalize(prev.until, nowTimeOfDay);
+			bool moreRelevant = fromNormalized > prevFromNormalized
+					|| (fromNormalized == prevFromNormalized && untilNormalized < prevUntilNormalized);
+			if (!moreRelevant) {
+				break;
+			}
+			_valid[pos] = _valid[pos - 1];
+			--pos;
+		}
+		_valid[pos] = i;
+		++_validCount;
+	}
+
+	_segmentStart = posixTime;
+	_segmentEnd = posixTime + secondsToBoundary;
+	++_generation;
+}
+
+bool BehaviourSchedule::isValid(uint32_t from, uint32_t until, uint8_t activeDays, uint32_t posixTime) {
+	uint32_t daysSinceEpoch = posixTime / SecondsPerDay;
+	uint32_t now = posixTime % SecondsPerDay;
+
+	// Same as DayOfWeek: 1 jan 1970 was a thursday.
+	uint8_t today     = 1 << ((daysSinceEpoch + 4) % 7);
+	uint8_t yesterday = 1 << ((daysSinceEpoch + 3) % 7);
+
+	if (from >= until) {
+		// When a behaviour overlaps midnight, the part of [00:00, until)
+		// should use yesterday as active day comparison and the part
+		// [from, 00:00) should use today. This is so that all valid
+		// intervals have the same duration.
+		//
+		// Note: this even works for from == until == 00:00, in that
+		// case today is used as active day, as now < until is always false
+		// and from <= now is always true.
+		if (now < until) {
+			return activeDays & yesterday;
+		}
+		if (from <= now) {
+			return activeDays & today;
+		}
+		return false;
+	}
+
+	// Behaviour doesn't overlap midnight.
+	return (activeDays & today) && from <= now && now < until;
+}
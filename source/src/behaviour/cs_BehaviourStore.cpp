@@ -8,6 +8,7 @@
 #include <behaviour/cs_BehaviourStore.h>
 
 #include <algorithm>
+#include <new>
 #include <common/cs_Types.h>
 #include <logging/cs_Logger.h>
 #include <events/cs_EventListener.h>
@@ -20,7 +21,10 @@
 #define LOGBehaviourStoreDebug LOGd
 
 // allocate space for the behaviours.
+BehaviourStore::behaviour_slot_t BehaviourStore::slots[BehaviourStore::MaxBehaviours];
 std::array<Behaviour*, BehaviourStore::MaxBehaviours> BehaviourStore::activeBehaviours = {};
+std::array<Behaviour::Type, BehaviourStore::MaxBehaviours> BehaviourStore::behaviourTypes = {};
+BehaviourSchedule BehaviourStore::schedule;
 
 void BehaviourStore::handleEvent(event_t& evt) {
 	switch (evt.type) {
@@ -51,12 +55,34 @@ void BehaviourStore::handleEvent(event_t& evt) {
 			clearActiveBehavioursArray();
 			break;
 		}
+		case CS_TYPE::STATE_SUN_TIME: {
+			// Sunrise and sunset based times have moved.
+			compileSchedule();
+			break;
+		}
 		default: {
 			break;
 		}
 	}
 }
 
+template<class BehaviourType>
+Behaviour* BehaviourStore::emplaceBehaviour(uint8_t index, const BehaviourType& behaviour) {
+	static_assert(sizeof(BehaviourType) <= MaxBehaviourSize, "Behaviour doesn't fit in a slot");
+	if (activeBehaviours[index] != nullptr) {
+		destroyBehaviour(index);
+	}
+	activeBehaviours[index] = new (slots[index].data) BehaviourType(behaviour);
+	behaviourTypes[index] = activeBehaviours[index]->getType();
+	return activeBehaviours[index];
+}
+
+void BehaviourStore::destroyBehaviour(uint8_t index) {
+	activeBehaviours[index]->~Behaviour();
+	activeBehaviours[index] = nullptr;
+	behaviourTypes[index] = Behaviour::Type::Undefined;
+}
+
 // ==================== handler functions ====================
 
 void BehaviourStore::handleSaveBehaviour(event_t& evt) {
@@ -112,9 +138,9 @@ ErrorCodesGeneral BehaviourStore::addBehaviour(uint8_t* buf, cs_buffer_size_t bu
 						);
 				return ERR_WRONG_PAYLOAD_LENGTH;
 			}
-			LOGBehaviourStoreDebug("Allocating new SwitchBehaviour");
-			// no need to delete previous entry, already checked for nullptr
-			activeBehaviours[empty_index] = new SwitchBehaviour(WireFormat::deserialize<SwitchBehaviour>(buf, bufSize));
+			LOGBehaviourStoreDebug("Construct new SwitchBehaviour");
+			// no need to destroy previous entry, already checked for nullptr
+			emplaceBehaviour<SwitchBehaviour>(empty_index, WireFormat::deserialize<SwitchBehaviour>(buf, bufSize));
 			activeBehaviours[empty_index]->print();
 
 			cs_state_data_t data(CS_TYPE::STATE_BEHAVIOUR_RULE, empty_index, buf, bufSize);
@@ -132,9 +158,9 @@ ErrorCodesGeneral BehaviourStore::addBehaviour(uint8_t* buf, cs_buffer_size_t bu
 						);
 				return ERR_WRONG_PAYLOAD_LENGTH;
 			}
-			LOGBehaviourStoreDebug("Allocating new TwilightBehaviour");
-			// no need to delete previous entry, already checked for nullptr
-			activeBehaviours[empty_index] = new TwilightBehaviour(WireFormat::deserialize<TwilightBehaviour>(buf, bufSize));
+			LOGBehaviourStoreDebug("Construct new TwilightBehaviour");
+			// no need to destroy previous entry, already checked for nullptr
+			emplaceBehaviour<TwilightBehaviour>(empty_index, WireFormat::deserialize<TwilightBehaviour>(buf, bufSize));
 			activeBehaviours[empty_index]->print();
 
 			cs_state_data_t data (CS_TYPE::STATE_TWILIGHT_RULE, empty_index, buf, bufSize);
@@ -152,9 +178,9 @@ ErrorCodesGeneral BehaviourStore::addBehaviour(uint8_t* buf, cs_buffer_size_t bu
 						);
 				return ERR_WRONG_PAYLOAD_LENGTH;
 			}
-			LOGBehaviourStoreDebug("Allocating new ExtendedSwitchBehaviour");
-			// no need to delete previous entry, already checked for nullptr
-			activeBehaviours[empty_index] = new ExtendedSwitchBehaviour(WireFormat::deserialize<ExtendedSwitchBehaviour>(buf, bufSize));
+			LOGBehaviourStoreDebug("Construct new ExtendedSwitchBehaviour");
+			// no need to destroy previous entry, already checked for nullptr
+			emplaceBehaviour<ExtendedSwitchBehaviour>(empty_index, WireFormat::deserialize<ExtendedSwitchBehaviour>(buf, bufSize));
 			activeBehaviours[empty_index]->print();
 
 			cs_state_data_t data(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE, empty_index, buf, bufSize);
@@ -221,8 +247,8 @@ void BehaviourStore::handleReplaceBehaviour(event_t& evt) {
 
 			removeBehaviour(index);
 
-			LOGBehaviourStoreDebug("Allocating new SwitchBehaviour");
-			activeBehaviours[index] = new SwitchBehaviour(WireFormat::deserialize<SwitchBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
+			LOGBehaviourStoreDebug("Construct new SwitchBehaviour");
+			emplaceBehaviour<SwitchBehaviour>(index, WireFormat::deserialize<SwitchBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
 			activeBehaviours[index]->print();
 
 			cs_state_data_t data (CS_TYPE::STATE_BEHAVIOUR_RULE, index, evt.getData() + indexSize, evt.size - indexSize);
@@ -238,8 +264,8 @@ void BehaviourStore::handleReplaceBehaviour(event_t& evt) {
 
 			removeBehaviour(index);
 
-			LOGBehaviourStoreDebug("Allocating new TwilightBehaviour");
-			activeBehaviours[index] = new TwilightBehaviour( WireFormat::deserialize<TwilightBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
+			LOGBehaviourStoreDebug("Construct new TwilightBehaviour");
+			emplaceBehaviour<TwilightBehaviour>(index, WireFormat::deserialize<TwilightBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
 			activeBehaviours[index]->print();
 
 			cs_state_data_t data (CS_TYPE::STATE_TWILIGHT_RULE, index, evt.getData() + indexSize, evt.size - indexSize);
@@ -256,8 +282,8 @@ void BehaviourStore::handleReplaceBehaviour(event_t& evt) {
 
 			removeBehaviour(index);
 
-			LOGBehaviourStoreDebug("Allocating new SwitchBehaviour");
-			activeBehaviours[index] = new ExtendedSwitchBehaviour(WireFormat::deserialize<ExtendedSwitchBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
+			LOGBehaviourStoreDebug("Construct new SwitchBehaviour");
+			emplaceBehaviour<ExtendedSwitchBehaviour>(index, WireFormat::deserialize<ExtendedSwitchBehaviour>(evt.getData() + indexSize, evt.size - indexSize));
 			activeBehaviours[index]->print();
 
 			cs_state_data_t data (CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE, index, evt.getData() + indexSize, evt.size - indexSize);
@@ -369,10 +395,26 @@ void BehaviourStore::handleGetBehaviourIndices(event_t& evt) {
 }
 
 void BehaviourStore::dispatchBehaviourMutationEvent() {
+	compileSchedule();
 	event_t evt(CS_TYPE::EVT_BEHAVIOURSTORE_MUTATION, nullptr, 0);
 	evt.dispatch();
 }
 
+void BehaviourStore::compileSchedule() {
+	schedule.clear();
+	for (uint8_t index = 0; index < MaxBehaviours; ++index) {
+		Behaviour* behaviour = activeBehaviours[index];
+		if (behaviour != nullptr) {
+			schedule.add(
+					index,
+					static_cast<uint8_t>(behaviourTypes[index]),
+					behaviour->activeDaysOfWeek(),
+					behaviour->from(),
+					behaviour->until());
+		}
+	}
+}
+
 // ==================== public functions ====================
 
 ErrorCodesGeneral BehaviourStore::removeBehaviour(uint8_t index) {
@@ -383,11 +425,10 @@ ErrorCodesGeneral BehaviourStore::removeBehaviour(uint8_t index) {
 		LOGBehaviourStoreDebug("Already removed");
 		return ERR_SUCCESS;
 	}
-	auto type = activeBehaviours[index]->getType();
+	auto type = behaviourTypes[index];
 
 	LOGBehaviourStoreDebug("deleting behaviour");
-	delete activeBehaviours[index];
-	activeBehaviours[index] = nullptr;
+	destroyBehaviour(index);
 
 	switch (type) {
 		case Behaviour::Type::Switch:
@@ -447,9 +488,8 @@ void BehaviourStore::LoadBehavioursFromMemory(CS_TYPE BehaviourCsType) {
 			if (retCode == ERR_SUCCESS) {
 				if (activeBehaviours[iter] != nullptr) {
 					LOGw("Overwrite ind=%u", iter);
-					delete activeBehaviours[iter];
 				}
-				activeBehaviours[iter] = new BehaviourType(WireFormat::deserialize<BehaviourType>(data_array, data_size));
+				emplaceBehaviour<BehaviourType>(iter, WireFormat::deserialize<BehaviourType>(data_array, data_size));
 				LOGBehaviourStoreInfo("Loaded behaviour at ind=%u:", iter);
 //				activeBehaviours[iter]->print();
 			}
@@ -463,6 +503,7 @@ void BehaviourStore::init() {
 	LoadBehavioursFromMemory<SwitchBehaviour>(CS_TYPE::STATE_BEHAVIOUR_RULE);
 	LoadBehavioursFromMemory<TwilightBehaviour>(CS_TYPE::STATE_TWILIGHT_RULE);
 	LoadBehavioursFromMemory<ExtendedSwitchBehaviour>(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE);
+	compileSchedule();
 }
 
 void BehaviourStore::clearActiveBehavioursArray() {
@@ -470,6 +511,7 @@ void BehaviourStore::clearActiveBehavioursArray() {
 	for (size_t i = 0; i < MaxBehaviours; i++) {
 		removeBehaviour(i);
 	}
+	compileSchedule();
 }
 
 BehaviourStore::~BehaviourStore() {
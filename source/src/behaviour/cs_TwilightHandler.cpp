@@ -8,7 +8,6 @@
 #include <behaviour/cs_TwilightHandler.h>
 #include <behaviour/cs_TwilightBehaviour.h>
 #include <behaviour/cs_BehaviourStore.h>
-#include <behaviour/cs_BehaviourConflictResolution.h>
 
 #include <test/cs_Test.h>
 #include <time/cs_SystemTime.h>
@@ -31,6 +30,7 @@ void TwilightHandler::handleEvent(event_t& evt) {
 		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS: {
 			behaviour_settings_t* settings = reinterpret_cast<TYPIFY(STATE_BEHAVIOUR_SETTINGS)*>(evt.data);
 			isActive = settings->flags.enabled;
+			cachedIntendedState = std::nullopt;
 			LOGTwilightHandlerDebug("TwilightHandler.isActive=%u", isActive);
 			TEST_PUSH_B(this, isActive);
 			update();
@@ -63,55 +63,46 @@ std::optional<uint8_t> TwilightHandler::computeIntendedState(Time currentTime) {
 		return {};
 	}
 
-	uint32_t nowTimeOfDay = currentTime.timeOfDay();
-	uint32_t winningFromTimeOfDay = 0;
-	uint32_t winningUntilTimeOfDay = 0;
+	BehaviourSchedule& schedule = BehaviourStore::getSchedule();
+	schedule.update(currentTime.timestamp());
+
+	if (cachedIntendedState && cachedGeneration == schedule.getGeneration()) {
+		// No twilight became valid or invalid.
+		return cachedIntendedState;
+	}
+
+	// The schedule only contains time valid behaviours, most relevant first.
+	const BehaviourSchedule::entry_t* winningEntry = nullptr;
 	uint8_t winningValue = 0xFF;
 
-	// loop through all twilight behaviours searching for valid ones.
-	for (auto& b : BehaviourStore::getActiveBehaviours()) {
-		if (TwilightBehaviour * behaviour = dynamic_cast<TwilightBehaviour*>(b)) {
-			// cast to twilight behaviour succesful.
-			if (behaviour->isValid(currentTime)) {
-				// cache some values.
-				uint32_t candidateFromTimeOfDay = behaviour->from();
-				uint32_t candidateUntilTimeOfDay = behaviour->until();
-
-				bool okToOverwriteWinningValue;
-
-				if (winningValue == 0xFF) {
-					// no previous values, anything will do
-					okToOverwriteWinningValue = true;
-				}
-				else {
-					// previous value found, conflict resolution
-					okToOverwriteWinningValue = FromUntilIntervalIsMoreRelevantOrEqual(
-							candidateFromTimeOfDay, candidateUntilTimeOfDay,
-							winningFromTimeOfDay, winningUntilTimeOfDay,
-							nowTimeOfDay
-					);
-				}
-
-				if (okToOverwriteWinningValue) {
-					// what a silly edge case, there are two (or more) twilights with the exact same
-					// boundary times. Let's use the minimum value in that case.
-					if (candidateFromTimeOfDay == winningFromTimeOfDay && candidateUntilTimeOfDay == winningUntilTimeOfDay) {
-						winningValue = CsMath::min(behaviour->value(), winningValue);
-					}
-					else {
-						winningValue = behaviour->value();
-					}
-
-					// update winning value and winning from/until boundaries
-					winningFromTimeOfDay = candidateFromTimeOfDay;
-					winningUntilTimeOfDay = candidateUntilTimeOfDay;
-				}
-			}
+	for (uint8_t i = 0; i < schedule.getValidCount(); ++i) {
+		const BehaviourSchedule::entry_t& entry = schedule.getValid(i);
+		if (static_cast<Behaviour::Type>(entry.type) != Behaviour::Type::Twilight) {
+			continue;
+		}
+		uint8_t candidateValue = BehaviourStore::getActiveBehaviours()[entry.index]->value();
+
+		if (winningEntry == nullptr) {
+			winningEntry = &entry;
+			winningValue = candidateValue;
+			continue;
 		}
+
+		if (!BehaviourSchedule::intervalIsEqual(*winningEntry, entry)) {
+			// All remaining twilights are less relevant.
+			break;
+		}
+
+		// what a silly edge case, there are two (or more) twilights with the exact same
+		// boundary times. Let's use the minimum value in that case.
+		winningValue = CsMath::min(candidateValue, winningValue);
 	}
 
 	// if no winning_value is found at all, return 100.
-	return winningValue == 0xFF ? 100 : winningValue;
+	cachedIntendedState = winningEntry == nullptr ? 100 : winningValue;
+	cachedGeneration = schedule.getGeneration();
+	LOGTwilightHandlerDebug("TwilightHandler resolved %u", cachedIntendedState.value());
+	return cachedIntendedState;
 }
 
 std::optional<uint8_t> TwilightHandler::getValue() {
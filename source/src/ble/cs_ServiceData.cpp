@@ -27,6 +27,8 @@ ServiceData::ServiceData() {
 //	_stateErrors.asInt = 0;
 	// Initialize the service data
 	memset(_serviceData.array, 0, sizeof(_serviceData.array));
+	memset(_nextServiceData.array, 0, sizeof(_nextServiceData.array));
+	memset(_advertisedServiceData.array, 0, sizeof(_advertisedServiceData.array));
 	assert(sizeof(service_data_encrypted_t) == AES_BLOCK_SIZE, "Size of service_data_encrypted_t must be 1 block.");
 };
 
@@ -47,9 +49,16 @@ void ServiceData::init(uint8_t deviceType) {
 
 	_extraFlags.asInt = 0;
 
+	// Cache the state that is put in the service data, it's kept up to date via events.
+	_encryptionEnabled = State::getInstance().isTrue(CS_TYPE::CONFIG_ENCRYPTION_ENABLED);
+	State::getInstance().get(CS_TYPE::STATE_ERRORS, &_stateErrors, sizeof(_stateErrors));
+	State::getInstance().get(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &_behaviourMasterHash, sizeof(_behaviourMasterHash));
+	State::getInstance().get(CS_TYPE::STATE_ASSET_FILTERS_VERSION, &_assetFiltersVersion, sizeof(_assetFiltersVersion));
+
 	// Set the device type.
 	TYPIFY(STATE_HUB_MODE) hubMode;
 	State::getInstance().get(CS_TYPE::STATE_HUB_MODE, &hubMode, sizeof(hubMode));
+	_hubMode = hubMode;
 	if (hubMode) {
 		LOGd("Set device type hub");
 		setDeviceType(DEVICE_CROWNSTONE_HUB);
@@ -97,7 +106,7 @@ void ServiceData::init(uint8_t deviceType) {
 
 void ServiceData::setDeviceType(uint8_t deviceType) {
 //	_deviceType = deviceType;
-	_serviceData.params.deviceType = deviceType;
+	_nextServiceData.params.deviceType = deviceType;
 }
 
 void ServiceData::updatePowerUsage(int32_t powerUsage) {
@@ -139,9 +148,6 @@ void ServiceData::updateServiceData(bool initial) {
 
 	uint32_t timestamp = SystemTime::posix();
 
-	// Update the state errors.
-	State::getInstance().get(CS_TYPE::STATE_ERRORS, &_stateErrors, sizeof(_stateErrors));
-
 	// Update flags.
 	_flags.flags.timeSet = (timestamp != 0);
 	_flags.flags.error = _stateErrors.asInt != 0;
@@ -150,7 +156,7 @@ void ServiceData::updateServiceData(bool initial) {
 	if (_stateErrors.asInt == 0) {
 		_firstErrorTimestamp = 0;
 	}
-	else if (_firstErrorTimestamp != 0) {
+	else if (_firstErrorTimestamp == 0) {
 		_firstErrorTimestamp = timestamp;
 	}
 
@@ -158,27 +164,82 @@ void ServiceData::updateServiceData(bool initial) {
 
 #ifdef PRINT_DEBUG_EXTERNAL_DATA
 	_log(SERIAL_DEBUG, false, "servideData: ");
-	_logArray(SERIAL_DEBUG, true, _serviceData.array, sizeof(service_data_t));
+	_logArray(SERIAL_DEBUG, true, _nextServiceData.array, sizeof(service_data_t));
 //		LOGd("serviceData: type=%u id=%u switch=%u bitmask=%u temp=%i P=%i E=%i time=%u", serviceData->params.type, serviceData->params.crownstoneId, serviceData->params.switchState, serviceData->params.flagBitmask, serviceData->params.temperature, serviceData->params.powerUsageReal, serviceData->params.accumulatedEnergy, serviceData->params.partialTimestamp);
 #endif
 
-	UartHandler::getInstance().writeMsg(UART_OPCODE_TX_SERVICE_DATA, _serviceData.array, sizeof(_serviceData.array));
+	UartHandler::getInstance().writeMsg(UART_OPCODE_TX_SERVICE_DATA, _nextServiceData.array, sizeof(_nextServiceData.array));
 
-	if (encrypt && State::getInstance().isTrue(CS_TYPE::CONFIG_ENCRYPTION_ENABLED)) {
-		encryptServiceData();
-	}
+	// Encrypting and reconfiguring the advertisement is relatively expensive, so skip it when only the timestamp
+	// or counter changed. Do update once in a while, so that the advertised data keeps changing.
+	uint16_t refreshPeriod = (_operationMode == OperationMode::OPERATION_MODE_SETUP) ? ADVERTISING_REFRESH_PERIOD_SETUP : ADVERTISING_REFRESH_PERIOD;
+	if (initial || _unchangedUpdates + 1 >= ADVERTISING_UNCHANGED_REFRESH_PERIOD / refreshPeriod || !onlyCounterChanged()) {
+		_unchangedUpdates = 0;
+		memcpy(_advertisedServiceData.array, _nextServiceData.array, sizeof(_nextServiceData.array));
+		memcpy(_serviceData.array, _nextServiceData.array, sizeof(_nextServiceData.array));
 
-	if (!initial) {
-		event_t event(CS_TYPE::EVT_ADVERTISEMENT_UPDATED);
-		EventDispatcher::getInstance().dispatch(event);
-	}
+		if (encrypt && _encryptionEnabled) {
+			encryptServiceData();
+		}
 
-	// start the timer again.
-	if (_operationMode == OperationMode::OPERATION_MODE_SETUP) {
-		Timer::getInstance().start(_updateTimerId, MS_TO_TICKS(ADVERTISING_REFRESH_PERIOD_SETUP), this);
+		if (!initial) {
+			event_t event(CS_TYPE::EVT_ADVERTISEMENT_UPDATED);
+			EventDispatcher::getInstance().dispatch(event);
+		}
 	}
 	else {
-		Timer::getInstance().start(_updateTimerId, MS_TO_TICKS(ADVERTISING_REFRESH_PERIOD), this);
+		_unchangedUpdates++;
+	}
+
+	// start the timer again.
+	Timer::getInstance().start(_updateTimerId, MS_TO_TICKS(refreshPeriod), this);
+}
+
+bool ServiceData::onlyCounterChanged() {
+	service_data_t next = _nextServiceData;
+	service_data_t advertised = _advertisedServiceData;
+	clearCounter(next);
+	clearCounter(advertised);
+	return memcmp(next.array, advertised.array, sizeof(next.array)) == 0;
+}
+
+void ServiceData::clearCounter(service_data_t& serviceData) {
+	switch (serviceData.params.type) {
+		case SERVICE_DATA_TYPE_SETUP: {
+			switch (serviceData.params.setup.type) {
+				case SERVICE_DATA_DATA_TYPE_STATE:
+					serviceData.params.setup.state.counter = 0;
+					break;
+				case SERVICE_DATA_DATA_TYPE_HUB_STATE:
+					serviceData.params.setup.hubState.partialTimestamp = 0;
+					break;
+				default:
+					break;
+			}
+			break;
+		}
+		case SERVICE_DATA_TYPE_ENCRYPTED: {
+			// The timestamps of external states and microapp data are not the current timestamp, so they're kept.
+			switch (serviceData.params.encrypted.type) {
+				case SERVICE_DATA_DATA_TYPE_STATE:
+					serviceData.params.encrypted.state.partialTimestamp = 0;
+					break;
+				case SERVICE_DATA_DATA_TYPE_ERROR:
+					serviceData.params.encrypted.error.partialTimestamp = 0;
+					break;
+				case SERVICE_DATA_DATA_TYPE_ALTERNATIVE_STATE:
+					serviceData.params.encrypted.altState.partialTimestamp = 0;
+					break;
+				case SERVICE_DATA_DATA_TYPE_HUB_STATE:
+					serviceData.params.encrypted.hubState.partialTimestamp = 0;
+					break;
+				default:
+					break;
+			}
+			break;
+		}
+		default:
+			break;
 	}
 }
 
@@ -187,9 +248,7 @@ void ServiceData::updateServiceData(bool initial) {
 bool ServiceData::fillServiceData(uint32_t timestamp) {
 	bool serviceDataSet = false;
 
-	TYPIFY(STATE_HUB_MODE) hubMode;
-	State::getInstance().get(CS_TYPE::STATE_HUB_MODE, &hubMode, sizeof(hubMode));
-	if (hubMode) {
+	if (_hubMode) {
 		// In hub mode, only use hub state as service data.
 		fillWithHubState(timestamp);
 		return _operationMode != OperationMode::OPERATION_MODE_SETUP;
@@ -233,11 +292,11 @@ bool ServiceData::fillServiceData(uint32_t timestamp) {
 
 void ServiceData::encryptServiceData() {
 	// encrypt the array using the guest key ECB if encryption is enabled.
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
-	if (KeysAndAccess::getInstance().getKey(SERVICE_DATA, key, sizeof(key))) {
+	cs_data_t key = KeysAndAccess::getInstance().getKey(SERVICE_DATA);
+	if (key.data != nullptr) {
 		cs_buffer_size_t writtenSize;
 		AES::getInstance().encryptEcb(
-				cs_data_t(key, sizeof(key)),
+				key,
 				cs_data_t(),
 				cs_data_t(_serviceData.params.encryptedArray, sizeof(_serviceData.params.encryptedArray)),
 				cs_data_t(_serviceData.params.encryptedArray, sizeof(_serviceData.params.encryptedArray)),
@@ -248,43 +307,43 @@ void ServiceData::encryptServiceData() {
 
 
 void ServiceData::fillWithSetupState(uint32_t timestamp) {
-	_serviceData.params.type = SERVICE_DATA_TYPE_SETUP;
-	_serviceData.params.setup.type = SERVICE_DATA_DATA_TYPE_STATE;
-	_serviceData.params.setup.state.switchState = _switchState;
-	_serviceData.params.setup.state.flags = _flags;
-	_serviceData.params.setup.state.temperature = _temperature;
-	_serviceData.params.setup.state.powerFactor = _powerFactor;
-	_serviceData.params.setup.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
-	_serviceData.params.setup.state.errors = _stateErrors.asInt;
-	_serviceData.params.setup.state.counter = _updateCount;
-	memset(_serviceData.params.setup.state.reserved, 0, sizeof(_serviceData.params.setup.state.reserved));
+	_nextServiceData.params.type = SERVICE_DATA_TYPE_SETUP;
+	_nextServiceData.params.setup.type = SERVICE_DATA_DATA_TYPE_STATE;
+	_nextServiceData.params.setup.state.switchState = _switchState;
+	_nextServiceData.params.setup.state.flags = _flags;
+	_nextServiceData.params.setup.state.temperature = _temperature;
+	_nextServiceData.params.setup.state.powerFactor = _powerFactor;
+	_nextServiceData.params.setup.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+	_nextServiceData.params.setup.state.errors = _stateErrors.asInt;
+	_nextServiceData.params.setup.state.counter = _updateCount;
+	memset(_nextServiceData.params.setup.state.reserved, 0, sizeof(_nextServiceData.params.setup.state.reserved));
 }
 
 void ServiceData::fillWithState(uint32_t timestamp) {
-	_serviceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
-	_serviceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_STATE;
-	_serviceData.params.encrypted.state.id = _crownstoneId;
-	_serviceData.params.encrypted.state.switchState = _switchState;
-	_serviceData.params.encrypted.state.flags = _flags;
-	_serviceData.params.encrypted.state.temperature = _temperature;
-	_serviceData.params.encrypted.state.powerFactor = _powerFactor;
-	_serviceData.params.encrypted.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
-	_serviceData.params.encrypted.state.energyUsed = _energyUsed;
-	_serviceData.params.encrypted.state.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
-	_serviceData.params.encrypted.state.extraFlags = _extraFlags;
-	_serviceData.params.encrypted.state.validation = SERVICE_DATA_VALIDATION;
+	_nextServiceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
+	_nextServiceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_STATE;
+	_nextServiceData.params.encrypted.state.id = _crownstoneId;
+	_nextServiceData.params.encrypted.state.switchState = _switchState;
+	_nextServiceData.params.encrypted.state.flags = _flags;
+	_nextServiceData.params.encrypted.state.temperature = _temperature;
+	_nextServiceData.params.encrypted.state.powerFactor = _powerFactor;
+	_nextServiceData.params.encrypted.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+	_nextServiceData.params.encrypted.state.energyUsed = _energyUsed;
+	_nextServiceData.params.encrypted.state.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
+	_nextServiceData.params.encrypted.state.extraFlags = _extraFlags;
+	_nextServiceData.params.encrypted.state.validation = SERVICE_DATA_VALIDATION;
 }
 
 void ServiceData::fillWithError(uint32_t timestamp) {
-	_serviceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
-	_serviceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_ERROR;
-	_serviceData.params.encrypted.error.id = _crownstoneId;
-	_serviceData.params.encrypted.error.errors = _stateErrors.asInt;
-	_serviceData.params.encrypted.error.timestamp = _firstErrorTimestamp;
-	_serviceData.params.encrypted.error.flags = _flags;
-	_serviceData.params.encrypted.error.temperature = _temperature;
-	_serviceData.params.encrypted.error.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
-	_serviceData.params.encrypted.error.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+	_nextServiceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
+	_nextServiceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_ERROR;
+	_nextServiceData.params.encrypted.error.id = _crownstoneId;
+	_nextServiceData.params.encrypted.error.errors = _stateErrors.asInt;
+	_nextServiceData.params.encrypted.error.timestamp = _firstErrorTimestamp;
+	_nextServiceData.params.encrypted.error.flags = _flags;
+	_nextServiceData.params.encrypted.error.temperature = _temperature;
+	_nextServiceData.params.encrypted.error.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
+	_nextServiceData.params.encrypted.error.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
 }
 
 bool ServiceData::fillWithExternalState() {
@@ -292,42 +351,37 @@ bool ServiceData::fillWithExternalState() {
 	if (extState == NULL) {
 		return false;
 	}
-	memcpy(&_serviceData.params.encrypted, extState, sizeof(*extState));
+	memcpy(&_nextServiceData.params.encrypted, extState, sizeof(*extState));
 	return true;
 }
 
 void ServiceData::fillWithAlternativeState(uint32_t timestamp) {
-	TYPIFY(STATE_BEHAVIOUR_MASTER_HASH) behaviourHash;
-	State::getInstance().get(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &behaviourHash, sizeof(behaviourHash));
-	_serviceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
-	_serviceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_ALTERNATIVE_STATE;
-	_serviceData.params.encrypted.altState.id = _crownstoneId;
-	_serviceData.params.encrypted.altState.switchState = _switchState;
-	_serviceData.params.encrypted.altState.flags = _flags;
-	_serviceData.params.encrypted.altState.behaviourMasterHash = getPartialBehaviourHash(behaviourHash);
-
-	TYPIFY(STATE_ASSET_FILTERS_VERSION) filtersVersion;
-	State::getInstance().get(CS_TYPE::STATE_ASSET_FILTERS_VERSION, &filtersVersion, sizeof(filtersVersion));
-	_serviceData.params.encrypted.altState.assetFiltersVersion = filtersVersion.masterVersion;
-	_serviceData.params.encrypted.altState.assetFiltersCrc = filtersVersion.masterCrc;
-
-//	_serviceData.params.encrypted.altState.reserved = {0};
-	_serviceData.params.encrypted.altState.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
-	_serviceData.params.encrypted.altState.reserved2 = 0;
-	_serviceData.params.encrypted.altState.validation = SERVICE_DATA_VALIDATION;
+	_nextServiceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
+	_nextServiceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_ALTERNATIVE_STATE;
+	_nextServiceData.params.encrypted.altState.id = _crownstoneId;
+	_nextServiceData.params.encrypted.altState.switchState = _switchState;
+	_nextServiceData.params.encrypted.altState.flags = _flags;
+	_nextServiceData.params.encrypted.altState.behaviourMasterHash = getPartialBehaviourHash(_behaviourMasterHash);
+	_nextServiceData.params.encrypted.altState.assetFiltersVersion = _assetFiltersVersion.masterVersion;
+	_nextServiceData.params.encrypted.altState.assetFiltersCrc = _assetFiltersVersion.masterCrc;
+
+//	_nextServiceData.params.encrypted.altState.reserved = {0};
+	_nextServiceData.params.encrypted.altState.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
+	_nextServiceData.params.encrypted.altState.reserved2 = 0;
+	_nextServiceData.params.encrypted.altState.validation = SERVICE_DATA_VALIDATION;
 }
 
 void ServiceData::fillWithHubState(uint32_t timestamp) {
 	service_data_hub_state_t* serviceDataHubState = nullptr;
 	if (_operationMode == OperationMode::OPERATION_MODE_SETUP) {
-		_serviceData.params.type = SERVICE_DATA_TYPE_SETUP;
-		_serviceData.params.setup.type = SERVICE_DATA_DATA_TYPE_HUB_STATE;
-		serviceDataHubState = &(_serviceData.params.setup.hubState);
+		_nextServiceData.params.type = SERVICE_DATA_TYPE_SETUP;
+		_nextServiceData.params.setup.type = SERVICE_DATA_DATA_TYPE_HUB_STATE;
+		serviceDataHubState = &(_nextServiceData.params.setup.hubState);
 	}
 	else {
-		_serviceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
-		_serviceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_HUB_STATE;
-		serviceDataHubState = &(_serviceData.params.encrypted.hubState);
+		_nextServiceData.params.type = SERVICE_DATA_TYPE_ENCRYPTED;
+		_nextServiceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_HUB_STATE;
+		serviceDataHubState = &(_nextServiceData.params.encrypted.hubState);
 	}
 
 	serviceDataHubState->id = _crownstoneId;
@@ -359,8 +413,8 @@ bool ServiceData::fillWithMicroapp(uint32_t timestamp) {
 	if (!_microappServiceDataSet) {
 		return false;
 	}
-	_serviceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_MICROAPP;
-	_serviceData.params.encrypted.microapp = _microappServiceData;
+	_nextServiceData.params.encrypted.type = SERVICE_DATA_DATA_TYPE_MICROAPP;
+	_nextServiceData.params.encrypted.microapp = _microappServiceData;
 	// Stone ID and validation are set at init.
 	// Timestamp is set when microapp service data was received.
 	return true;
@@ -382,8 +436,20 @@ void ServiceData::handleEvent(event_t & event) {
 		}
 		case CS_TYPE::STATE_ERRORS: {
 			LOGd("Event: $typeName(%u)", event.type);
-			state_errors_t* stateErrors = (TYPIFY(STATE_ERRORS)*) event.data;
-			_flags.flags.error = stateErrors->asInt;
+			_stateErrors = *(TYPIFY(STATE_ERRORS)*) event.data;
+			_flags.flags.error = _stateErrors.asInt != 0;
+			break;
+		}
+		case CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH: {
+			_behaviourMasterHash = *(TYPIFY(STATE_BEHAVIOUR_MASTER_HASH)*)event.data;
+			break;
+		}
+		case CS_TYPE::STATE_ASSET_FILTERS_VERSION: {
+			_assetFiltersVersion = *(TYPIFY(STATE_ASSET_FILTERS_VERSION)*)event.data;
+			break;
+		}
+		case CS_TYPE::CONFIG_ENCRYPTION_ENABLED: {
+			_encryptionEnabled = *(TYPIFY(CONFIG_ENCRYPTION_ENABLED)*)event.data;
 			break;
 		}
 		case CS_TYPE::CONFIG_CROWNSTONE_ID: {
@@ -463,6 +529,7 @@ void ServiceData::handleEvent(event_t & event) {
 		}
 		case CS_TYPE::STATE_HUB_MODE: {
 			TYPIFY(STATE_HUB_MODE)* hubMode = reinterpret_cast<TYPIFY(STATE_HUB_MODE)*>(event.data);
+			_hubMode = *hubMode;
 			if (*hubMode) {
 				LOGd("Set device type hub");
 				setDeviceType(DEVICE_CROWNSTONE_HUB);
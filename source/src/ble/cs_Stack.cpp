@@ -15,6 +15,7 @@
 #include <common/cs_Handlers.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <processing/cs_Scanner.h>
 #include <storage/cs_State.h>
 #include "structs/buffer/cs_CharacteristicReadBuffer.h"
@@ -441,6 +442,7 @@ void csStackOnScan(const ble_gap_evt_adv_report_t* advReport) {
 //		LOGi("  adv_type=%u len=%u data=", type, scan.dataSize);
 //		BLEutil::printArray(scan.data, scan.dataSize);
 //	}
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_STACK_SCANNED);
 	event_t event(CS_TYPE::EVT_DEVICE_SCANNED, (void*)&scan, sizeof(scan));
 	EventDispatcher::getInstance().dispatch(event);
 }
@@ -59,6 +59,9 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_UART_ENABLED:
@@ -71,6 +74,7 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::STATE_OPERATION_MODE:
 	case CS_TYPE::STATE_SWITCH_STATE:
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 	case CS_TYPE::STATE_POWER_USAGE:
 	case CS_TYPE::STATE_TEMPERATURE:
 	case CS_TYPE::STATE_SUN_TIME:
@@ -232,6 +236,8 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -240,6 +246,7 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -366,6 +373,12 @@ size16_t TypeSize(CS_TYPE const & type) {
 		return sizeof(TYPIFY(CONFIG_SWITCHCRAFT_ENABLED));
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
 		return sizeof(TYPIFY(CONFIG_SWITCHCRAFT_THRESHOLD));
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+		return sizeof(TYPIFY(CONFIG_ADC_SAMPLING_PROFILE));
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+		return sizeof(TYPIFY(CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS));
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
+		return sizeof(TYPIFY(CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD));
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 		return sizeof(TYPIFY(CONFIG_TAP_TO_TOGGLE_ENABLED));
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
@@ -388,6 +401,8 @@ size16_t TypeSize(CS_TYPE const & type) {
 		return sizeof(TYPIFY(STATE_SWITCH_STATE));
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
 		return sizeof(TYPIFY(STATE_ACCUMULATED_ENERGY));
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
+		return sizeof(TYPIFY(STATE_ENERGY_CHECKPOINT));
 	case CS_TYPE::STATE_POWER_USAGE:
 		return sizeof(TYPIFY(STATE_POWER_USAGE));
 	case CS_TYPE::STATE_OPERATION_MODE:
@@ -712,6 +727,10 @@ size16_t TypeSize(CS_TYPE const & type) {
 		return 0;
 	case CS_TYPE::CMD_GET_RAM_STATS:
 		return 0;
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+		return 0;
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
+		return 0;
 	case CS_TYPE::EVT_GENERIC_TEST:
 		return 0;
 	case CS_TYPE::CMD_TEST_SET_TIME:
@@ -728,6 +747,8 @@ size16_t TypeSize(CS_TYPE const & type) {
 		return sizeof(TYPIFY(CMD_MICROAPP_ENABLE));
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
 		return sizeof(TYPIFY(CMD_MICROAPP_DISABLE));
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
+		return sizeof(TYPIFY(CMD_MICROAPP_GET_CPU_STATS));
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 		return sizeof(TYPIFY(EVT_MICROAPP_UPLOAD_RESULT));
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
@@ -809,6 +830,9 @@ bool hasMultipleIds(CS_TYPE const & type) {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_UART_ENABLED:
@@ -817,6 +841,7 @@ bool hasMultipleIds(CS_TYPE const & type) {
 	case CS_TYPE::STATE_RESET_COUNTER:
 	case CS_TYPE::CONFIG_DO_NOT_USE:
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 	case CS_TYPE::STATE_BEHAVIOUR_SETTINGS:
 	case CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH:
 	case CS_TYPE::STATE_POWER_USAGE:
@@ -972,6 +997,8 @@ bool hasMultipleIds(CS_TYPE const & type) {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -980,6 +1007,7 @@ bool hasMultipleIds(CS_TYPE const & type) {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -1068,6 +1096,9 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_UART_ENABLED:
@@ -1078,6 +1109,7 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 	case CS_TYPE::CONFIG_DO_NOT_USE:
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 	case CS_TYPE::STATE_BEHAVIOUR_SETTINGS:
 	case CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH:
 	case CS_TYPE::STATE_POWER_USAGE:
@@ -1241,6 +1273,8 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -1249,6 +1283,7 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -1304,6 +1339,9 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_TX_POWER:
@@ -1334,6 +1372,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 	case CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH:
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 	case CS_TYPE::STATE_ERRORS:
 	case CS_TYPE::STATE_FACTORY_RESET:
 	case CS_TYPE::STATE_OPERATION_MODE:
@@ -1494,6 +1533,8 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -1502,6 +1543,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -1558,6 +1600,9 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_TX_POWER:
@@ -1578,6 +1623,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::STATE_ASSET_FILTER_512:
 		return ADMIN;
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 	case CS_TYPE::STATE_ERRORS:
 	case CS_TYPE::STATE_POWER_USAGE:
 	case CS_TYPE::STATE_RESET_COUNTER:
@@ -1747,6 +1793,8 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -1755,6 +1803,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -52,10 +52,12 @@
 #include <logging/cs_CLogger.h>
 #include <logging/cs_Logger.h>
 #include <processing/cs_BackgroundAdvHandler.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <processing/cs_TapToToggle.h>
 #include <storage/cs_State.h>
 #include <structs/buffer/cs_EncryptionBuffer.h>
 #include <time/cs_SystemTime.h>
+#include <time/cs_TimerWheel.h>
 #include <uart/cs_UartHandler.h>
 #include <util/cs_Utils.h>
 
@@ -750,6 +752,10 @@ void Crownstone::tick() {
 	updateHeapStats();
 	if (_tickCount % (60*1000/TICK_INTERVAL_MS) == 0) {
 		printLoadStats();
+#ifdef DEBUG
+		// Developer message, like the other UART messages with an opcode >= 50000.
+		ScanPipelineStats::getInstance().sendStats();
+#endif
 	}
 
 	if (_tickCount % (500/TICK_INTERVAL_MS) == 0) {
@@ -768,6 +774,10 @@ void Crownstone::tick() {
 
 	Watchdog::kick();
 
+	if (_tickCount % (1000/TICK_INTERVAL_MS) == 0) {
+		TimerWheel::getInstance().tickSecond();
+	}
+
 	event_t event(CS_TYPE::EVT_TICK, &_tickCount, sizeof(_tickCount));
 	event.dispatch();
 	++_tickCount;
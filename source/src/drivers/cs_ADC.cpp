@@ -62,7 +62,6 @@ void adc_restart(void * p_event_data, uint16_t event_size) {
 
 
 ADC::ADC() :
-		_bufferQueue(CS_ADC_NUM_BUFFERS),
 		_saadcBufferQueue(CS_ADC_NUM_SAADC_BUFFERS)
 {
 	_ppiChannelSample = getPpiChannel(CS_ADC_PPI_CHANNEL_START);
@@ -162,7 +161,11 @@ cs_ret_code_t ADC::init(const adc_config_t & config) {
 	// NRF52_PAN_74
 	nrf_saadc_enable();
 
-	initBufferQueue();
+	cs_ret_code_t retCode = initBufferQueue();
+	if (retCode != ERR_SUCCESS) {
+		LOGe("Failed to init buffers: %u", retCode);
+		return retCode;
+	}
 
 	this->listen();
 
@@ -197,18 +200,8 @@ cs_ret_code_t ADC::initBufferQueue() {
 	if (!_saadcBufferQueue.init()) {
 		return ERR_NO_SPACE;
 	}
-	if (!_bufferQueue.init()) {
-		return ERR_NO_SPACE;
-	}
-	cs_ret_code_t retCode = AdcBuffer::getInstance().init();
-	if (retCode != ERR_SUCCESS) {
-		return retCode;
-	}
-	adc_buffer_id_t bufCount = AdcBuffer::getInstance().getBufferCount();
-	for (adc_buffer_id_t id = 0; id < bufCount; ++id) {
-		_bufferQueue.push(id);
-	}
-	return ERR_SUCCESS;
+	// Each buffer holds the same duration, whatever the sampling interval.
+	return AdcBuffer::getInstance().init(CS_ADC_BUFFER_DURATION_US / _config.samplingIntervalUs);
 }
 
 /** Configure an ADC channel.
@@ -332,6 +325,17 @@ void ADC::setDoneCallback(adc_done_cb_t callback) {
 	_doneCallback = callback;
 }
 
+void ADC::releaseBuffer(adc_buffer_id_t bufIndex) {
+	if (!AdcBuffer::getInstance().changeState(bufIndex, ADC_BUFFER_STATE_PROCESSING, ADC_BUFFER_STATE_FREE)) {
+		LOGw("buf %u not held", bufIndex);
+		return;
+	}
+	if (_state == ADC_STATE_WAITING_TO_START) {
+		LOGAdcVerbose("buf %u released, try to start", bufIndex);
+		start();
+	}
+}
+
 void ADC::stop() {
 	LOGAdcDebug("stop");
 	switch (_state) {
@@ -370,9 +374,9 @@ void ADC::stop() {
 		while (_saadcState != ADC_SAADC_STATE_IDLE);
 	}
 
-	// The SAADC queue is now cleared, so move the queued buffers to the regular queue.
+	// The SAADC queue is now cleared, so the queued buffers are free again.
 	while (!_saadcBufferQueue.empty()) {
-		_bufferQueue.pushUnique(_saadcBufferQueue.pop());
+		AdcBuffer::getInstance().changeState(_saadcBufferQueue.pop(), ADC_BUFFER_STATE_QUEUED, ADC_BUFFER_STATE_FREE);
 	}
 	printQueues();
 
@@ -460,10 +464,12 @@ cs_ret_code_t ADC::_fillSaadcQueue(bool fromInterrupt) {
 			break;
 	}
 
-	bool keepLooping = true;
-	while (keepLooping && !_bufferQueue.empty()) {
-		// Try to add a buffer from queue to the SAADC queue.
-		auto bufIndex = _bufferQueue.peek();
+	while (!_saadcBufferQueue.full()) {
+		// Try to add a free buffer to the SAADC queue.
+		adc_buffer_id_t bufIndex = AdcBuffer::getInstance().acquireFree();
+		if (bufIndex == ADC_BUFFER_ID_NONE) {
+			break;
+		}
 		if (fromInterrupt) {
 			retCode = _addBufferToSaadcQueue(bufIndex);
 		}
@@ -471,20 +477,11 @@ cs_ret_code_t ADC::_fillSaadcQueue(bool fromInterrupt) {
 			retCode = addBufferToSaadcQueue(bufIndex);
 		}
 
-		switch (retCode) {
-			case ERR_SUCCESS:
-			case ERR_ALREADY_EXISTS:
-				// Buffer has been added to SAADC queue, so remove it from regular queue.
-				_bufferQueue.pop();
-				break;
-			case ERR_NO_SPACE:
-				// The SAADC queue is full, we can stop looping.
-				keepLooping = false;
-				break;
-			default:
-				// Stop on failure.
-				LOGAdcInterruptWarn("Error %u", retCode);
-				return retCode;
+		if (retCode != ERR_SUCCESS) {
+			// Stop on failure, and give the buffer back.
+			LOGAdcInterruptWarn("Error %u", retCode);
+			AdcBuffer::getInstance().changeState(bufIndex, ADC_BUFFER_STATE_QUEUED, ADC_BUFFER_STATE_FREE);
+			return retCode;
 		}
 	}
 
@@ -560,9 +557,9 @@ cs_ret_code_t ADC::_addBufferToSaadcQueue(adc_buffer_id_t bufIndex) {
 void ADC::printQueues() {
 	if (ADC_LOG_QUEUES) {
 		enterCriticalRegion();
-		_log(SERIAL_DEBUG, false, "queued: ");
-		for (uint8_t i = 0; i < _bufferQueue.size(); ++i) {
-			_log(SERIAL_DEBUG, false, "%u, ", _bufferQueue[i]);
+		_log(SERIAL_DEBUG, false, "buffer states: ");
+		for (adc_buffer_id_t i = 0; i < AdcBuffer::getInstance().getBufferCount(); ++i) {
+			_log(SERIAL_DEBUG, false, "%u, ", AdcBuffer::getInstance().getState(i));
 		}
 		_log(SERIAL_DEBUG, true, "");
 
@@ -658,6 +655,12 @@ void ADC::_handleAdcDone(adc_buffer_id_t bufIndex) {
 	nrf_gpio_pin_toggle(TEST_PIN_PROCESS);
 #endif
 
+	// Take over the buffer from the interrupt.
+	if (!AdcBuffer::getInstance().changeState(bufIndex, ADC_BUFFER_STATE_FILLED, ADC_BUFFER_STATE_PROCESSING)) {
+		LOGw("buf %u not filled", bufIndex);
+		return;
+	}
+
 	if (dataCallbackRegistered()) {
 		if (_firstBuffer) {
 			LOGw("ADC restarted (ignore first warning on boot)");
@@ -671,6 +674,9 @@ void ADC::_handleAdcDone(adc_buffer_id_t bufIndex) {
 
 		_doneCallback(bufIndex);
 	}
+	else {
+		releaseBuffer(bufIndex);
+	}
 }
 
 void ADC::enterCriticalRegion() {
@@ -748,17 +754,17 @@ void ADC::_handleAdcInterrupt() {
 			return;
 		}
 
-		// This buffer is no longer in use by saadc: move it to the buffer queue.
+		// This buffer is no longer in use by saadc.
 		adc_buffer_id_t bufIndex = _saadcBufferQueue.pop();
 
 		// Mark buffer valid.
-		// TODO: In case processing is really slow, it might be marked valid again while it's being processed.
-		// Idea: Only have 1 call in the app scheduler, without buf index.
-		//       Let processing loop over all valid buffers in _bufferQueue.
-		AdcBuffer::getInstance().getBuffer(bufIndex)->valid = true;
-		AdcBuffer::getInstance().getBuffer(bufIndex)->seqNr = _bufSeqNr++;
+		adc_buffer_t* buf = AdcBuffer::getInstance().getBuffer(bufIndex);
+		buf->valid = true;
+		buf->seqNr = _bufSeqNr++;
 
-		_bufferQueue.pushUnique(bufIndex);
+		// Hand the buffer over to the main thread.
+		// It won't be queued in the SAADC again, until processing released it.
+		AdcBuffer::getInstance().changeState(bufIndex, ADC_BUFFER_STATE_QUEUED, ADC_BUFFER_STATE_FILLED);
 
 		// Decouple handling of buffer from adc interrupt handler, copy buffer index.
 		uint32_t errorCode = app_sched_event_put(&bufIndex, sizeof(bufIndex), adc_done);
@@ -767,6 +773,7 @@ void ADC::_handleAdcInterrupt() {
 //		APP_ERROR_CHECK(errorCode);
 		if (errorCode != NRF_SUCCESS) {
 			LOGAdcInterruptWarn("Failed to schedule");
+			AdcBuffer::getInstance().changeState(bufIndex, ADC_BUFFER_STATE_FILLED, ADC_BUFFER_STATE_FREE);
 		}
 
 		LOGAdcInterruptDebug("Done bufIndex=%u queueSize=%u nextBuf=%u", bufIndex, _saadcBufferQueue.size(), _saadcBufferQueue.peek());
@@ -0,0 +1,241 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <encryption/cs_AesEngine.h>
+
+#include <cstring>
+#include <algorithm> // for std::min
+
+#ifndef HOST_TARGET
+#include <util/cs_BleError.h>
+#endif
+
+#ifdef HOST_TARGET
+/**
+ * Software implementation of AES-128, only used when the ECB peripheral is not available.
+ *
+ * See FIPS-197.
+ */
+namespace AesSoftware {
+
+static const uint8_t sbox[256] = {
+		0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+		0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+		0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+		0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+		0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+		0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+		0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+		0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+		0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+		0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+		0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+		0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+		0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+		0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+		0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+		0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static uint8_t xtime(uint8_t x) {
+	return (x << 1) ^ ((x & 0x80) ? 0x1b : 0x00);
+}
+
+static void encryptBlock(const uint8_t* key, const uint8_t* input, uint8_t* output) {
+	uint8_t roundKey[AES_BLOCK_SIZE];
+	uint8_t state[AES_BLOCK_SIZE];
+	uint8_t rcon = 0x01;
+	memcpy(roundKey, key, AES_BLOCK_SIZE);
+	for (int i = 0; i < AES_BLOCK_SIZE; ++i) {
+		state[i] = input[i] ^ roundKey[i];
+	}
+	for (int round = 1; round <= 10; ++round) {
+		// SubBytes and ShiftRows, state is column major.
+		uint8_t shifted[AES_BLOCK_SIZE];
+		for (int col = 0; col < 4; ++col) {
+			for (int row = 0; row < 4; ++row) {
+				shifted[4 * col + row] = sbox[state[4 * ((col + row) % 4) + row]];
+			}
+		}
+
+		// MixColumns, skipped in the last round.
+		if (round < 10) {
+			for (int col = 0; col < 4; ++col) {
+				uint8_t* column = shifted + 4 * col;
+				uint8_t all = column[0] ^ column[1] ^ column[2] ^ column[3];
+				uint8_t first = column[0];
+				column[0] ^= all ^ xtime(column[0] ^ column[1]);
+				column[1] ^= all ^ xtime(column[1] ^ column[2]);
+				column[2] ^= all ^ xtime(column[2] ^ column[3]);
+				column[3] ^= all ^ xtime(column[3] ^ first);
+			}
+		}
+
+		// Next round key.
+		roundKey[0] ^= sbox[roundKey[13]] ^ rcon;
+		roundKey[1] ^= sbox[roundKey[14]];
+		roundKey[2] ^= sbox[roundKey[15]];
+		roundKey[3] ^= sbox[roundKey[12]];
+		for (int i = 4; i < AES_BLOCK_SIZE; ++i) {
+			roundKey[i] ^= roundKey[i - 4];
+		}
+		rcon = xtime(rcon);
+
+		// AddRoundKey.
+		for (int i = 0; i < AES_BLOCK_SIZE; ++i) {
+			state[i] = shifted[i] ^ roundKey[i];
+		}
+	}
+	memcpy(output, state, AES_BLOCK_SIZE);
+}
+
+}
+#endif
+
+AesEngine::AesEngine() {
+#ifndef HOST_TARGET
+	for (uint8_t i = 0; i < AES_ENGINE_BATCH_NUM_BLOCKS; ++i) {
+		_blocks[i].p_key = &_key;
+		_blocks[i].p_cleartext = &_cleartext[i];
+		_blocks[i].p_ciphertext = &_ciphertext[i];
+	}
+#endif
+}
+
+void AesEngine::setKey(const uint8_t* key) {
+	memcpy(_key, key, sizeof(_key));
+}
+
+void AesEngine::encryptBlocks(uint8_t numBlocks) {
+#ifdef HOST_TARGET
+	for (uint8_t i = 0; i < numBlocks; ++i) {
+		AesSoftware::encryptBlock(_key, _cleartext[i], _ciphertext[i]);
+	}
+#else
+	uint32_t errCode = sd_ecb_blocks_encrypt(numBlocks, _blocks);
+	APP_ERROR_CHECK(errCode);
+#endif
+}
+
+void AesEngine::xorBytes(uint8_t* output, const uint8_t* input, const uint8_t* keystream, cs_buffer_size_t size) {
+	if (((reinterpret_cast<uintptr_t>(output) | reinterpret_cast<uintptr_t>(input) | reinterpret_cast<uintptr_t>(keystream)) & 0x03) == 0) {
+		uint32_t* output32 = reinterpret_cast<uint32_t*>(output);
+		const uint32_t* input32 = reinterpret_cast<const uint32_t*>(input);
+		const uint32_t* keystream32 = reinterpret_cast<const uint32_t*>(keystream);
+		cs_buffer_size_t numWords = size / sizeof(uint32_t);
+		for (cs_buffer_size_t i = 0; i < numWords; ++i) {
+			output32[i] = input32[i] ^ keystream32[i];
+		}
+		cs_buffer_size_t wordBytes = numWords * sizeof(uint32_t);
+		output += wordBytes;
+		input += wordBytes;
+		keystream += wordBytes;
+		size -= wordBytes;
+	}
+	for (cs_buffer_size_t i = 0; i < size; ++i) {
+		output[i] = input[i] ^ keystream[i];
+	}
+}
+
+void AesEngine::ecb(cs_data_t prefix, cs_data_t input, cs_data_t output, uint16_t numBlocks) {
+	// The cleartext batch is contiguous, so prefix and input can be copied in one go per batch.
+	cs_buffer_size_t prefixReadSize = 0;
+	cs_buffer_size_t inputReadSize = 0;
+	cs_buffer_size_t writtenSize = 0;
+	uint16_t blocksDone = 0;
+	while (blocksDone < numBlocks) {
+		uint8_t batchNumBlocks = std::min(numBlocks - blocksDone, AES_ENGINE_BATCH_NUM_BLOCKS);
+		cs_buffer_size_t batchSize = batchNumBlocks * AES_BLOCK_SIZE;
+		uint8_t* cleartext = _cleartext[0];
+		cs_buffer_size_t batchWrittenSize = 0;
+
+		cs_buffer_size_t copySize = std::min(prefix.len - prefixReadSize, batchSize - batchWrittenSize);
+		memcpy(cleartext + batchWrittenSize, prefix.data + prefixReadSize, copySize);
+		prefixReadSize += copySize;
+		batchWrittenSize += copySize;
+
+		copySize = std::min(input.len - inputReadSize, batchSize - batchWrittenSize);
+		memcpy(cleartext + batchWrittenSize, input.data + inputReadSize, copySize);
+		inputReadSize += copySize;
+		batchWrittenSize += copySize;
+
+		// Zero padding.
+		memset(cleartext + batchWrittenSize, 0, batchSize - batchWrittenSize);
+
+		encryptBlocks(batchNumBlocks);
+
+		memcpy(output.data + writtenSize, _ciphertext[0], batchSize);
+		writtenSize += batchSize;
+		blocksDone += batchNumBlocks;
+	}
+}
+
+cs_buffer_size_t AesEngine::ctr(cs_data_t nonce, cs_data_t inputPrefix, cs_data_t input, cs_data_t outputPrefix, cs_data_t output, uint16_t numBlocks, uint8_t blockCtr) {
+	// Prepare the counter blocks (concatenation of nonce and counter) once, only the counter changes per block.
+	cs_buffer_size_t nonceSize = std::min(nonce.len, (cs_buffer_size_t)AES_BLOCK_SIZE);
+	for (uint8_t i = 0; i < AES_ENGINE_BATCH_NUM_BLOCKS; ++i) {
+		memset(_cleartext[i], 0, AES_BLOCK_SIZE);
+		memcpy(_cleartext[i], nonce.data, nonceSize);
+	}
+
+	// The input stream consists of these buffers, followed by zero padding.
+	cs_data_t inputs[] = {inputPrefix, input};
+	uint8_t inputIndex = 0;
+	cs_buffer_size_t inputReadSize = 0;
+
+	// The output stream consists of these buffers.
+	cs_data_t outputs[] = {outputPrefix, output};
+	uint8_t outputIndex = 0;
+	cs_buffer_size_t outputWrittenSize = 0;
+
+	cs_buffer_size_t writtenSize = 0;
+	uint16_t blocksDone = 0;
+	while (blocksDone < numBlocks) {
+		uint8_t batchNumBlocks = std::min(numBlocks - blocksDone, AES_ENGINE_BATCH_NUM_BLOCKS);
+		for (uint8_t i = 0; i < batchNumBlocks; ++i) {
+			_cleartext[i][AES_BLOCK_SIZE - 1] = blockCtr + blocksDone + i;
+		}
+		encryptBlocks(batchNumBlocks);
+		blocksDone += batchNumBlocks;
+
+		const uint8_t* keystream = _ciphertext[0];
+		cs_buffer_size_t keystreamSize = batchNumBlocks * AES_BLOCK_SIZE;
+		while (keystreamSize > 0) {
+			while (inputIndex < 2 && inputReadSize == inputs[inputIndex].len) {
+				++inputIndex;
+				inputReadSize = 0;
+			}
+			while (outputIndex < 2 && outputWrittenSize == outputs[outputIndex].len) {
+				++outputIndex;
+				outputWrittenSize = 0;
+			}
+			if (outputIndex == 2) {
+				// Output is full, this has been checked by the caller.
+				return writtenSize;
+			}
+
+			cs_buffer_size_t size = std::min(keystreamSize, (cs_buffer_size_t)(outputs[outputIndex].len - outputWrittenSize));
+			uint8_t* outputData = outputs[outputIndex].data + outputWrittenSize;
+			if (inputIndex < 2) {
+				size = std::min(size, (cs_buffer_size_t)(inputs[inputIndex].len - inputReadSize));
+				xorBytes(outputData, inputs[inputIndex].data + inputReadSize, keystream, size);
+				inputReadSize += size;
+			}
+			else {
+				// XOR with zero padding.
+				memcpy(outputData, keystream, size);
+			}
+			outputWrittenSize += size;
+			if (outputIndex == 1) {
+				writtenSize += size;
+			}
+			keystream += size;
+			keystreamSize -= size;
+		}
+	}
+	return writtenSize;
+}
@@ -27,8 +27,8 @@ void ConnectionEncryption::init() {
 }
 
 cs_ret_code_t ConnectionEncryption::encrypt(cs_data_t input, cs_data_t output, EncryptionAccessLevel accessLevel, ConnectionEncryptionType encryptionType) {
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
-	if (!KeysAndAccess::getInstance().getKey(accessLevel, key, sizeof(key))) {
+	cs_data_t key = KeysAndAccess::getInstance().getKey(accessLevel);
+	if (key.data == nullptr) {
 		return ERR_NOT_FOUND;
 	}
 
@@ -49,7 +49,7 @@ cs_ret_code_t ConnectionEncryption::encrypt(cs_data_t input, cs_data_t output, E
 			// Encrypt the payload
 			cs_buffer_size_t writtenSize;
 			cs_ret_code_t retCode = AES::getInstance().encryptCtr(
-					cs_data_t(key, sizeof(key)),
+					key,
 					cs_data_t((uint8_t*)&_nonce, sizeof(_nonce)),
 					cs_data_t(_sessionData.validationKey, sizeof(_sessionData.validationKey)),
 					input,
@@ -63,7 +63,7 @@ cs_ret_code_t ConnectionEncryption::encrypt(cs_data_t input, cs_data_t output, E
 			validationKey.asInt = DEFAULT_VALIDATION_KEY;
 			cs_buffer_size_t writtenSize;
 			cs_ret_code_t retCode = AES::getInstance().encryptEcb(
-					cs_data_t(key, sizeof(key)),
+					key,
 					cs_data_t(validationKey.asBuf, sizeof(validationKey.asBuf)),
 					input,
 					output,
@@ -105,8 +105,8 @@ cs_ret_code_t ConnectionEncryption::decrypt(cs_data_t input, cs_data_t output, E
 					break;
 			}
 
-			uint8_t key[ENCRYPTION_KEY_LENGTH];
-			if (!KeysAndAccess::getInstance().getKey(accessLevel, key, sizeof(key))) {
+			cs_data_t key = KeysAndAccess::getInstance().getKey(accessLevel);
+			if (key.data == nullptr) {
 				return ERR_NOT_FOUND;
 			}
 
@@ -118,7 +118,7 @@ cs_ret_code_t ConnectionEncryption::decrypt(cs_data_t input, cs_data_t output, E
 			encryption_header_encrypted_t encryptedHeader;
 			cs_buffer_size_t decryptedPayloadSize;
 			cs_ret_code_t retCode = AES::getInstance().decryptCtr(
-					cs_data_t(key, sizeof(key)),
+					key,
 					cs_data_t((uint8_t*)&_nonce, sizeof(_nonce)),
 					cs_data_t(input.data + sizeof(*header), input.len - sizeof(*header)),
 					cs_data_t((uint8_t*)&encryptedHeader, sizeof(encryptedHeader)),
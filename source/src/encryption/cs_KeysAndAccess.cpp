@@ -8,6 +8,7 @@
 #include <drivers/cs_RNG.h>
 #include <encryption/cs_KeysAndAccess.h>
 #include <storage/cs_State.h>
+#include <util/cs_Utils.h>
 
 #define LOGKeysAndAccessDebug LOGnone
 
@@ -23,6 +24,7 @@ void KeysAndAccess::init() {
 	_operationMode = getOperationMode(mode);
 
 	generateSetupKey();
+	listen();
 }
 
 bool KeysAndAccess::allowAccess(EncryptionAccessLevel minimum, EncryptionAccessLevel provided) {
@@ -64,41 +66,122 @@ bool KeysAndAccess::getKey(EncryptionAccessLevel accessLevel, buffer_ptr_t outBu
 		return false;
 	}
 
+	cs_data_t key = getKey(accessLevel);
+	if (key.data == nullptr) {
+		return false;
+	}
+	memcpy(outBuf, key.data, ENCRYPTION_KEY_LENGTH);
+	return true;
+}
+
+cs_data_t KeysAndAccess::getKey(EncryptionAccessLevel accessLevel) {
+	if (accessLevel == SETUP) {
+		// Don't check if in setup mode: we want to use this for outgoing connections too.
+		// The check _setupKeyValid == true should be enough.
+		if (_setupKeyValid) {
+			return cs_data_t(_setupKey, sizeof(_setupKey));
+		}
+		// This error is generated once on boot
+		LOGe("Can't use this setup key (yet)");
+		return cs_data_t();
+	}
+
 	CS_TYPE keyConfigType;
+	int8_t index = getCacheIndex(accessLevel, keyConfigType);
+	if (index < 0) {
+		LOGe("Invalid access level");
+		return cs_data_t();
+	}
+
+	if (!BLEutil::isBitSet(_keysCachedBitmask, index)) {
+		LOGKeysAndAccessDebug("Read key accessLevel=%u from state", accessLevel);
+		if (State::getInstance().get(keyConfigType, _keys[index], ENCRYPTION_KEY_LENGTH) != ERR_SUCCESS) {
+			return cs_data_t();
+		}
+		BLEutil::setBit(_keysCachedBitmask, index);
+	}
+	return cs_data_t(_keys[index], ENCRYPTION_KEY_LENGTH);
+}
+
+cs_data_t KeysAndAccess::getUartKey(cs_state_id_t keyId) {
+	for (uint8_t i = 0; i < KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS; ++i) {
+		if (BLEutil::isBitSet(_uartKeysCachedBitmask, i) && _uartKeyIds[i] == keyId) {
+			_uartKeyLastUsedIndex = i;
+			return cs_data_t(_uartKeys[i], ENCRYPTION_KEY_LENGTH);
+		}
+	}
+
+	// Replace an empty entry, or else the least recently used one.
+	uint8_t index = (_uartKeyLastUsedIndex + 1) % KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS;
+	for (uint8_t i = 0; i < KEYS_AND_ACCESS_NUM_CACHED_UART_KEYS; ++i) {
+		if (!BLEutil::isBitSet(_uartKeysCachedBitmask, i)) {
+			index = i;
+			break;
+		}
+	}
+	LOGKeysAndAccessDebug("Read UART key id=%u from state into index %u", keyId, index);
+	BLEutil::clearBit(_uartKeysCachedBitmask, index);
+	cs_state_data_t stateData(CS_TYPE::STATE_UART_KEY, keyId, _uartKeys[index], ENCRYPTION_KEY_LENGTH);
+	if (State::getInstance().get(stateData) != ERR_SUCCESS) {
+		return cs_data_t();
+	}
+	_uartKeyIds[index] = keyId;
+	BLEutil::setBit(_uartKeysCachedBitmask, index);
+	_uartKeyLastUsedIndex = index;
+	return cs_data_t(_uartKeys[index], ENCRYPTION_KEY_LENGTH);
+}
+
+uint8_t KeysAndAccess::getKeysVersion() {
+	return _keysVersion;
+}
+
+int8_t KeysAndAccess::getCacheIndex(EncryptionAccessLevel accessLevel, CS_TYPE& type) {
 	switch (accessLevel) {
 		case ADMIN:
-			keyConfigType = CS_TYPE::CONFIG_KEY_ADMIN;
-			break;
+			type = CS_TYPE::CONFIG_KEY_ADMIN;
+			return 0;
 		case MEMBER:
-			keyConfigType = CS_TYPE::CONFIG_KEY_MEMBER;
-			break;
+			type = CS_TYPE::CONFIG_KEY_MEMBER;
+			return 1;
 		case BASIC:
-			keyConfigType = CS_TYPE::CONFIG_KEY_BASIC;
-			break;
+			type = CS_TYPE::CONFIG_KEY_BASIC;
+			return 2;
 		case SERVICE_DATA:
-			keyConfigType = CS_TYPE::CONFIG_KEY_SERVICE_DATA;
-			break;
+			type = CS_TYPE::CONFIG_KEY_SERVICE_DATA;
+			return 3;
 		case LOCALIZATION:
-			keyConfigType = CS_TYPE::CONFIG_KEY_LOCALIZATION;
-			break;
-		case SETUP: {
-			// Don't check if in setup mode: we want to use this for outgoing connections too.
-			// The check _setupKeyValid == true should be enough.
-			if (_setupKeyValid) {
-				memcpy(outBuf, _setupKey, ENCRYPTION_KEY_LENGTH);
-				return true;
-			}
-			// This error is generated once on boot
-			LOGe("Can't use this setup key (yet)");
-			return false;
-		}
+			type = CS_TYPE::CONFIG_KEY_LOCALIZATION;
+			return 4;
 		default:
-			LOGe("Invalid access level");
-			return false;
+			return -1;
 	}
+}
 
-	State::getInstance().get(keyConfigType, outBuf, ENCRYPTION_KEY_LENGTH);
-	return true;
+void KeysAndAccess::onKeyChange(CS_TYPE type) {
+	LOGKeysAndAccessDebug("onKeyChange type=%u", type);
+	switch (type) {
+		case CS_TYPE::CONFIG_KEY_ADMIN:
+			BLEutil::clearBit(_keysCachedBitmask, 0);
+			break;
+		case CS_TYPE::CONFIG_KEY_MEMBER:
+			BLEutil::clearBit(_keysCachedBitmask, 1);
+			break;
+		case CS_TYPE::CONFIG_KEY_BASIC:
+			BLEutil::clearBit(_keysCachedBitmask, 2);
+			break;
+		case CS_TYPE::CONFIG_KEY_SERVICE_DATA:
+			BLEutil::clearBit(_keysCachedBitmask, 3);
+			break;
+		case CS_TYPE::CONFIG_KEY_LOCALIZATION:
+			BLEutil::clearBit(_keysCachedBitmask, 4);
+			break;
+		case CS_TYPE::STATE_UART_KEY:
+			_uartKeysCachedBitmask = 0;
+			break;
+		default:
+			return;
+	}
+	++_keysVersion;
 }
 
 cs_data_t KeysAndAccess::getSetupKey() {
@@ -132,3 +215,21 @@ void KeysAndAccess::invalidateSetupKey() {
 	_setupKeyValid = false;
 }
 
+void KeysAndAccess::handleEvent(event_t& event) {
+	switch (event.type) {
+		case CS_TYPE::CONFIG_KEY_ADMIN:
+		case CS_TYPE::CONFIG_KEY_MEMBER:
+		case CS_TYPE::CONFIG_KEY_BASIC:
+		case CS_TYPE::CONFIG_KEY_SERVICE_DATA:
+		case CS_TYPE::CONFIG_KEY_LOCALIZATION:
+		case CS_TYPE::STATE_UART_KEY:
+			onKeyChange(event.type);
+			break;
+		case CS_TYPE::CONFIG_ENCRYPTION_ENABLED:
+			_encryptionEnabled = *reinterpret_cast<TYPIFY(CONFIG_ENCRYPTION_ENABLED)*>(event.data);
+			break;
+		default:
+			break;
+	}
+}
+
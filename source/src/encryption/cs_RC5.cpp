@@ -16,6 +16,15 @@
 #define RC5_16BIT_P 0xB7E1
 #define RC5_16BIT_Q 0x9E37
 
+static_assert(RC5_ROUNDS == 12, "Decrypt is unrolled for 12 rounds.");
+
+// A single decryption round, with 16 bit words a and b, the rotation amount is the lowest 4 bits.
+#define RC5_DECRYPT_ROUND(i) \
+	sum = b - _subKeys[2 * (i) + 1]; \
+	b = ROTR_16BIT(sum, a & 0x0F) ^ a; \
+	sum = a - _subKeys[2 * (i)]; \
+	a = ROTR_16BIT(sum, b & 0x0F) ^ b;
+
 RC5::RC5() {
 
 }
@@ -25,13 +34,15 @@ void RC5::init() {
 }
 
 bool RC5::initKey(EncryptionAccessLevel accessLevel) {
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
-	bool result = KeysAndAccess::getInstance().getKey(accessLevel, key, sizeof(key));
-	if (!result) {
+	_keysVersion = KeysAndAccess::getInstance().getKeysVersion();
+	cs_data_t key = KeysAndAccess::getInstance().getKey(accessLevel);
+	if (key.data == nullptr) {
+		_keyPrepared = false;
 		return false;
 	}
 
-	return prepareKey(key, sizeof(key));
+	_keyPrepared = prepareKey(key.data, key.len);
+	return _keyPrepared;
 }
 
 // See https://en.wikipedia.org/wiki/RC5
@@ -86,15 +97,28 @@ bool RC5::decrypt(uint16_t* inBuf, uint16_t inBufSize, uint16_t* outBuf, uint16_
 	if (inBufSize < RC5_BLOCK_SIZE || outBufSize < RC5_BLOCK_SIZE) {
 		return false;
 	}
+	if (!_keyPrepared || _keysVersion != KeysAndAccess::getInstance().getKeysVersion()) {
+		// Only expand the key again when it changed.
+		if (!initKey(EncryptionAccessLevel::LOCALIZATION)) {
+			return false;
+		}
+	}
 	uint16_t a = inBuf[0];
 	uint16_t b = inBuf[1];
 	uint16_t sum;
-	for (uint16_t i = RC5_ROUNDS; i > 0; --i) {
-		sum = b - _subKeys[2*i + 1];
-		b = ROTR_16BIT(sum, a % 16) ^ a;
-		sum = a - _subKeys[2*i];
-		a = ROTR_16BIT(sum, b % 16) ^ b;
-	}
+	// This runs for every received broadcast, so the rounds are unrolled.
+	RC5_DECRYPT_ROUND(12);
+	RC5_DECRYPT_ROUND(11);
+	RC5_DECRYPT_ROUND(10);
+	RC5_DECRYPT_ROUND(9);
+	RC5_DECRYPT_ROUND(8);
+	RC5_DECRYPT_ROUND(7);
+	RC5_DECRYPT_ROUND(6);
+	RC5_DECRYPT_ROUND(5);
+	RC5_DECRYPT_ROUND(4);
+	RC5_DECRYPT_ROUND(3);
+	RC5_DECRYPT_ROUND(2);
+	RC5_DECRYPT_ROUND(1);
 	outBuf[0] = a - _subKeys[0];
 	outBuf[1] = b - _subKeys[1];
 	return true;
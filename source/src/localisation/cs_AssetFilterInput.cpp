@@ -0,0 +1,61 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <localisation/cs_AssetFilterInput.h>
+#include <logging/cs_Logger.h>
+
+
+#define LogAssetFilterInputWarn LOGw
+
+
+AssetFilterInputType* AssetFilterInput::type() {
+	return reinterpret_cast<AssetFilterInputType*>(_data + 0);
+}
+
+ad_data_type_selector_t* AssetFilterInput::AdTypeField() {
+	if (*type() == AssetFilterInputType::AdDataType) {
+		return reinterpret_cast<ad_data_type_selector_t*>(_data + sizeof(AssetFilterInputType));
+	}
+	return nullptr;
+}
+
+masked_ad_data_type_selector_t* AssetFilterInput::AdTypeMasked() {
+	if (*type() == AssetFilterInputType::MaskedAdDataType) {
+		return reinterpret_cast<masked_ad_data_type_selector_t*>(_data + sizeof(AssetFilterInputType));
+	}
+	return nullptr;
+}
+
+bool AssetFilterInput::isValid() {
+	switch (*type()) {
+		case AssetFilterInputType::MacAddress:
+		case AssetFilterInputType::AdDataType:
+		case AssetFilterInputType::MaskedAdDataType: {
+			return true;
+		}
+	}
+	LogAssetFilterInputWarn("invalid assetfilter input type");
+	return false;
+}
+
+size_t AssetFilterInput::length() {
+	size_t len = sizeof(AssetFilterInputType);
+	switch (*type()) {
+		case AssetFilterInputType::MacAddress: {
+			break;
+		}
+		case AssetFilterInputType::AdDataType: {
+			len += sizeof(ad_data_type_selector_t);
+			break;
+		}
+		case AssetFilterInputType::MaskedAdDataType: {
+			len += sizeof(masked_ad_data_type_selector_t);
+			break;
+		}
+	}
+	return len;
+}
@@ -12,54 +12,6 @@
 #define LogAssetFilterPacketAccessorsWarn LOGw
 
 
-AssetFilterInputType* AssetFilterInput::type() {
-	return reinterpret_cast<AssetFilterInputType*>(_data + 0);
-}
-
-ad_data_type_selector_t* AssetFilterInput::AdTypeField() {
-	if (*type() == AssetFilterInputType::AdDataType) {
-		return reinterpret_cast<ad_data_type_selector_t*>(_data + sizeof(AssetFilterInputType));
-	}
-	return nullptr;
-}
-
-masked_ad_data_type_selector_t* AssetFilterInput::AdTypeMasked() {
-	if (*type() == AssetFilterInputType::MaskedAdDataType) {
-		return reinterpret_cast<masked_ad_data_type_selector_t*>(_data + sizeof(AssetFilterInputType));
-	}
-	return nullptr;
-}
-
-bool AssetFilterInput::isValid() {
-	switch (*type()) {
-		case AssetFilterInputType::MacAddress:
-		case AssetFilterInputType::AdDataType:
-		case AssetFilterInputType::MaskedAdDataType: {
-			return true;
-		}
-	}
-	LogAssetFilterPacketAccessorsWarn("invalid assetfilter input type");
-	return false;
-}
-
-size_t AssetFilterInput::length() {
-	size_t len = sizeof(AssetFilterInputType);
-	switch (*type()) {
-		case AssetFilterInputType::MacAddress: {
-			break;
-		}
-		case AssetFilterInputType::AdDataType: {
-			len += sizeof(ad_data_type_selector_t);
-			break;
-		}
-		case AssetFilterInputType::MaskedAdDataType: {
-			len += sizeof(masked_ad_data_type_selector_t);
-			break;
-		}
-	}
-	return len;
-}
-
 AssetFilterOutputFormat* AssetFilterOutput::outFormat() {
 	return reinterpret_cast<AssetFilterOutputFormat*>(_data + 0);
 }
@@ -66,10 +66,6 @@ void AssetFilterStore::handleEvent(event_t& evt) {
 			handleGetFilterSummariesCommand(evt.result);
 			break;
 		}
-		case CS_TYPE::EVT_TICK: {
-			onTick();
-			break;
-		}
 		default: break;
 	}
 }
@@ -383,15 +379,6 @@ void AssetFilterStore::handleGetFilterSummariesCommand(cs_result_t& result) {
 	result.returnCode = ERR_SUCCESS;
 }
 
-void AssetFilterStore::onTick() {
-	if (_modificationInProgressCountdown) {
-		_modificationInProgressCountdown--;
-		if (_modificationInProgressCountdown == 0) {
-			inProgressTimeout();
-		}
-	}
-}
-
 // -------------------------------------------------------------
 // ---------------------- Utility functions --------------------
 // -------------------------------------------------------------
@@ -404,16 +391,18 @@ bool AssetFilterStore::isReady() {
 
 void AssetFilterStore::startInProgress() {
 	LOGAssetFilterDebug("startInProgress");
-	_modificationInProgressCountdown = 1000 * MODIFICATION_IN_PROGRESS_TIMEOUT_SECONDS / TICK_INTERVAL_MS;
-	_masterVersion                   = 0;
+	_modificationInProgressTimeout.callback = onInProgressTimeout;
+	_modificationInProgressTimeout.context  = this;
+	TimerWheel::getInstance().schedule(_modificationInProgressTimeout, MODIFICATION_IN_PROGRESS_TIMEOUT_SECONDS);
+	_masterVersion = 0;
 	sendInProgressStatus();
 }
 
 void AssetFilterStore::endInProgress(uint16_t newMasterVersion, uint32_t newMasterCrc) {
 	LOGAssetFilterDebug("endInProgress version=%u crc=%u", newMasterVersion, newMasterCrc);
-	_masterVersion                   = newMasterVersion;
-	_masterCrc                       = newMasterCrc;
-	_modificationInProgressCountdown = 0;
+	_masterVersion = newMasterVersion;
+	_masterCrc     = newMasterCrc;
+	TimerWheel::getInstance().cancel(_modificationInProgressTimeout);
 
 	TYPIFY(STATE_ASSET_FILTERS_VERSION) stateVal = {
 			.masterVersion = _masterVersion,
@@ -425,7 +414,7 @@ void AssetFilterStore::endInProgress(uint16_t newMasterVersion, uint32_t newMast
 }
 
 bool AssetFilterStore::isInProgress() {
-	return _modificationInProgressCountdown != 0;
+	return TimerWheel::isScheduled(_modificationInProgressTimeout);
 }
 
 void AssetFilterStore::inProgressTimeout() {
@@ -452,6 +441,10 @@ void AssetFilterStore::inProgressTimeout() {
 	sendInProgressStatus();
 }
 
+void AssetFilterStore::onInProgressTimeout(void* context) {
+	static_cast<AssetFilterStore*>(context)->inProgressTimeout();
+}
+
 void AssetFilterStore::sendInProgressStatus() {
 	TYPIFY(EVT_FILTER_MODIFICATION) modification = isInProgress();
 	event_t event(CS_TYPE::EVT_FILTER_MODIFICATION, &modification, sizeof(modification));
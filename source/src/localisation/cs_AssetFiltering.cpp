@@ -6,13 +6,14 @@
  */
 
 #include <localisation/cs_AssetFiltering.h>
+#include <localisation/cs_FilterInputPreparation.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <util/cs_Utils.h>
 
 #define LOGAssetFilteringWarn LOGw
 #define LOGAssetFilteringInfo LOGvv
 #define LOGAssetFilteringDebug LOGvv
 #define LogLevelAssetFilteringDebug   SERIAL_VERY_VERBOSE
-#define LogLevelAssetFilteringVerbose SERIAL_VERY_VERBOSE
 
 
 void LogAcceptedDevice(AssetFilter filter, const scanned_device_t& device, bool excluded){
@@ -132,6 +133,7 @@ void AssetFiltering::handleScannedDevice(const scanned_device_t& asset) {
 	}
 
 	if (isAssetRejected(asset)) {
+		ScanPipelineStats::getInstance().count(SCAN_PIPELINE_ASSET_REJECTED);
 		return;
 	}
 
@@ -139,8 +141,10 @@ void AssetFiltering::handleScannedDevice(const scanned_device_t& asset) {
 
 	if (!masks.combined()) {
 		// early return when no filter accepts the advertisement.
+		ScanPipelineStats::getInstance().count(SCAN_PIPELINE_ASSET_REJECTED);
 		return;
 	}
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_ASSET_ACCEPTED);
 
 	LOGAssetFilteringDebug("bitmask forwardSid: %x. forwardMac: %x, nearestSid: %x",
 			masks._forwardAssetId,
@@ -195,6 +199,7 @@ void AssetFiltering::handleScannedDevice(filter_output_bitmasks_t masks, const s
 		}
 	}
 	else {
+		ScanPipelineStats::getInstance().count(SCAN_PIPELINE_ASSET_THROTTLED);
 		LOGAssetFilteringInfo("throttled incoming asset advertisement");
 		if (assetRecord != nullptr) {
 			LOGAssetFilteringDebug("counter: %u", assetRecord->throttlingCountdownTicks);
@@ -286,9 +291,7 @@ bool AssetFiltering::isAssetRejected(const scanned_device_t& device) {
  * delegateExpression should be of the form (FilterInterface&, void*, size_t) -> ReturnType.
  *
  * The argument that is passed into `delegateExpression` is based on the AssetFilterInputType
- * of the `assetFilter`.Buffers are only allocated when strictly necessary.
- * (E.g. MacAddress is already available in the `device`, but for MaskedAdDataType a buffer
- * of 31 bytes needs to be allocated on the stack.)
+ * of the `assetFilter`, see cs_FilterInputPreparation.h.
  *
  * The delegate return type is left as free template parameter so that this template can be
  * used for both `contains` and `shortAssetId` return values.
@@ -325,64 +328,13 @@ ReturnType prepareFilterInputAndCallDelegate(
 	}
 
 	// split out input type for the filter and prepare the input
-	switch (*filterInputDescription.type()) {
-		case AssetFilterInputType::MacAddress: {
-			return delegateExpression(filter, device.address, sizeof(device.address));
-		}
-		case AssetFilterInputType::AdDataType: {
-			// selects the first found field of configured type and checks if that field's
-			// data is contained in the filter. returns defaultValue if it can't be found.
-			cs_data_t result                  = {};
-			ad_data_type_selector_t* selector = filterInputDescription.AdTypeField();
-
-			if (selector == nullptr) {
-				LOGe("Filter metadata type check failed");
-				return defaultValue;
-			}
-
-			if (BLEutil::findAdvType(selector->adDataType, device.data, device.dataSize, &result) == ERR_SUCCESS) {
-				return delegateExpression(filter, result.data, result.len);
-			}
-
-			return defaultValue;
-		}
-		case AssetFilterInputType::MaskedAdDataType: {
-			// selects the first found field of configured type and checks if that field's
-			// data is contained in the filter. returns false if it can't be found.
-			cs_data_t result                         = {};
-			masked_ad_data_type_selector_t* selector = filterInputDescription.AdTypeMasked();
-
-			if (selector == nullptr) {
-				LOGe("Filter metadata type check failed");
-				return defaultValue;
-			}
-
-			if (BLEutil::findAdvType(selector->adDataType, device.data, device.dataSize, &result) == ERR_SUCCESS) {
-				// A normal advertisement payload size is 31B at most.
-				// We are also limited by the 32b bitmask.
-				if (result.len > 31) {
-					LOGw("Advertisement too large");
-					return defaultValue;
-				}
-				uint8_t buff[31];
-
-				// apply the mask
-				uint8_t buffIndex = 0;
-				for (uint8_t bitIndex = 0; bitIndex < result.len; bitIndex++) {
-					if (BLEutil::isBitSet(selector->adDataMask, bitIndex)) {
-						buff[buffIndex] = result.data[bitIndex];
-						buffIndex++;
-					}
-				}
-				_logArray(LogLevelAssetFilteringVerbose, true, buff, buffIndex);
-				return delegateExpression(filter, buff, buffIndex);
-			}
-
-			return defaultValue;
-		}
-	}
-
-	return defaultValue;
+	return prepareFilterInputAndCallDelegate(
+			device,
+			filterInputDescription,
+			[&](const uint8_t* data, size_t len) {
+				return delegateExpression(filter, data, len);
+			},
+			defaultValue);
 }
 
 bool AssetFiltering::filterAcceptsScannedDevice(AssetFilter assetFilter, const scanned_device_t& asset) {
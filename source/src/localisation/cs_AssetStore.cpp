@@ -51,7 +51,7 @@ void AssetStore::handleEvent(event_t& event) {
 void AssetStore::handleAcceptedAsset(const scanned_device_t& asset, const short_asset_id_t& assetId) {
 	auto record = getOrCreateRecord(assetId);
 	if (record != nullptr) {
-		record->myRssi = compressRssi(asset.rssi, asset.channel);
+		record->addRssi(asset.rssi, asset.channel);
 		record->lastReceivedCounter = 0;
 	}
 }
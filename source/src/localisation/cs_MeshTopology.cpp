@@ -24,6 +24,12 @@ cs_ret_code_t MeshTopology::init() {
 	if (_neighbours == nullptr) {
 		return ERR_NO_SPACE;
 	}
+	_neighbourIndices = new (std::nothrow) uint8_t[0xFF + 1];
+	if (_neighbourIndices == nullptr) {
+		return ERR_NO_SPACE;
+	}
+	_timeoutCheck.callback = onTimeoutCheck;
+	_timeoutCheck.context  = this;
 	reset();
 	listen();
 
@@ -39,6 +45,8 @@ void MeshTopology::reset() {
 
 	// Remove stored neighbours.
 	_neighbourCount = 0;
+	memset(_neighbourIndices, INDEX_NOT_FOUND, 0xFF + 1);
+	TimerWheel::getInstance().schedule(_timeoutCheck, TIMEOUT_SECONDS);
 
 	// Let everyone first send a noop, and then the first result.
 	_sendNoopCountdown = 1;
@@ -96,6 +104,7 @@ void MeshTopology::add(stone_id_t id, int8_t rssi, uint8_t channel) {
 			_neighbours[_neighbourCount].rssiChannel38 = RSSI_INIT;
 			_neighbours[_neighbourCount].rssiChannel39 = RSSI_INIT;
 			updateNeighbour(_neighbours[_neighbourCount], id, rssi, channel);
+			_neighbourIndices[id] = _neighbourCount;
 			_neighbourCount++;
 		}
 		else {
@@ -125,16 +134,60 @@ void MeshTopology::updateNeighbour(neighbour_node_t& node, stone_id_t id, int8_t
 			break;
 		}
 	}
-	node.lastSeenSecondsAgo = 0;
+	node.lastSeenSeconds = static_cast<uint16_t>(TimerWheel::getInstance().getSeconds());
 }
 
 uint8_t MeshTopology::find(stone_id_t id) {
-	for (uint8_t index = 0; index < _neighbourCount; ++index) {
-		if (_neighbours[index].id == id) {
-			return index;
+	return _neighbourIndices[id];
+}
+
+void MeshTopology::move(uint8_t from, uint8_t to) {
+	if (from != to) {
+		_neighbours[to] = _neighbours[from];
+		_neighbourIndices[_neighbours[to].id] = to;
+	}
+}
+
+void MeshTopology::remove(uint8_t index) {
+	_neighbourIndices[_neighbours[index].id] = INDEX_NOT_FOUND;
+	_neighbourCount--;
+	if (index < _nextSendIndex) {
+		// The neighbours before the next send index have been sent this round.
+		// Fill the gap with the last one of those, so that the last neighbour ends up at the next send index,
+		// and every neighbour is still sent exactly once this round.
+		_nextSendIndex--;
+		move(_nextSendIndex, index);
+		index = _nextSendIndex;
+	}
+	move(_neighbourCount, index);
+}
+
+void MeshTopology::removeTimedOut() {
+	uint16_t maxSecondsAgo = 0;
+	// Iterate backwards: a removal only moves neighbours from higher indices, which have been checked already.
+	for (uint8_t i = _neighbourCount; i > 0; --i) {
+		uint16_t secondsAgo = getLastSeenSecondsAgo(_neighbours[i - 1]);
+		if (secondsAgo >= TIMEOUT_SECONDS) {
+			remove(i - 1);
+		}
+		else {
+			maxSecondsAgo = std::max(maxSecondsAgo, secondsAgo);
 		}
 	}
-	return INDEX_NOT_FOUND;
+
+	// Neighbours are only ever seen more recently, so none can time out before the current oldest.
+	TimerWheel::getInstance().schedule(_timeoutCheck, TIMEOUT_SECONDS - maxSecondsAgo);
+}
+
+void MeshTopology::onTimeoutCheck(void* context) {
+	MeshTopology* meshTopology = static_cast<MeshTopology*>(context);
+	meshTopology->removeTimedOut();
+	LOGMeshTopologyVerbose("Result: nextSendIndex=%u", meshTopology->_nextSendIndex);
+	meshTopology->print();
+}
+
+uint16_t MeshTopology::getLastSeenSecondsAgo(const neighbour_node_t& node) {
+	return static_cast<uint16_t>(TimerWheel::getInstance().getSeconds()) - node.lastSeenSeconds;
 }
 
 void MeshTopology::getRssi(stone_id_t stoneId, cs_result_t& result) {
@@ -193,7 +246,8 @@ void MeshTopology::sendNext() {
 	}
 
 	auto& node = _neighbours[_nextSendIndex];
-	LOGMeshTopologyDebug("sendNextMeshMessage index=%u id=%u lastSeenSecondsAgo=%u", _nextSendIndex, node.id, node.lastSeenSecondsAgo);
+	uint8_t lastSeenSecondsAgo = std::min(getLastSeenSecondsAgo(node), (uint16_t)0xFF);
+	LOGMeshTopologyDebug("sendNextMeshMessage index=%u id=%u lastSeenSecondsAgo=%u", _nextSendIndex, node.id, lastSeenSecondsAgo);
 
 	cs_mesh_model_msg_neighbour_rssi_t meshPayload = {
 			.type = 0,
@@ -201,7 +255,7 @@ void MeshTopology::sendNext() {
 			.rssiChannel37 = node.rssiChannel37,
 			.rssiChannel38 = node.rssiChannel38,
 			.rssiChannel39 = node.rssiChannel39,
-			.lastSeenSecondsAgo = node.lastSeenSecondsAgo,
+			.lastSeenSecondsAgo = lastSeenSecondsAgo,
 			.counter = _msgCount++
 	};
 
@@ -302,31 +356,6 @@ void MeshTopology::onMeshMsg(MeshMsgEvent& packet, cs_result_t& result) {
 
 void MeshTopology::onTickSecond() {
 	LOGMeshTopologyVerbose("onTickSecond nextSendIndex=%u", _nextSendIndex);
-	print();
-	[[maybe_unused]] bool change = false;
-	for (uint8_t i = 0; i < _neighbourCount; /**/ ) {
-		_neighbours[i].lastSeenSecondsAgo++;
-		if (_neighbours[i].lastSeenSecondsAgo == TIMEOUT_SECONDS) {
-			change = true;
-			// Remove item, by shifting all items after this item.
-			_neighbourCount--;
-			for (uint8_t j = i; j < _neighbourCount; ++j) {
-				_neighbours[j] = _neighbours[j + 1];
-			}
-			// Also change shift the next send index.
-			if (_nextSendIndex > i) {
-				_nextSendIndex--;
-			}
-		}
-		else {
-			i++;
-		}
-	}
-	if (change) {
-		LOGMeshTopologyVerbose("Result: nextSendIndex=%u", _nextSendIndex);
-		print();
-	}
-
 	if (_sendCountdown != 0) {
 		_sendCountdown--;
 	}
@@ -364,7 +393,7 @@ void MeshTopology::print() {
 				_neighbours[i].rssiChannel37,
 				_neighbours[i].rssiChannel38,
 				_neighbours[i].rssiChannel39,
-				_neighbours[i].lastSeenSecondsAgo);
+				getLastSeenSecondsAgo(_neighbours[i]));
 	}
 }
 
@@ -40,36 +40,31 @@ void MeshTopologyResearch::init() {
 }
 
 void MeshTopologyResearch::recordRssiValue(stone_id_t sender_id, int8_t rssi, uint8_t channel) {
-	auto channel_index = channel - CHANNEL_START;
-
-	if (channel_index < 0 || CHANNEL_COUNT <= channel_index) {
+	if (channel < rssi_stats_t::FIRST_CHANNEL || channel >= rssi_stats_t::FIRST_CHANNEL + rssi_stats_t::CHANNEL_COUNT) {
 		return;
 	}
 
-	auto& recorder = variance_map[channel_index][sender_id];
-
-	recorder.addValue(rssi);
+	rssi_stats_map[sender_id].addValue(rssi, channel);
 }
 
-uint8_t MeshTopologyResearch::getVarianceRepresentation(float variance) {
-	variance = std::abs(variance);
-	if (variance <  2 *  2) return 0;
-	if (variance <  4 *  4) return 1;
-	if (variance <  6 *  6) return 2;
-	if (variance <  8 *  8) return 3;
-	if (variance < 10 * 10) return 4;
-	if (variance < 15 * 15) return 5;
-	if (variance < 20 * 15) return 6;
+uint8_t MeshTopologyResearch::getVarianceRepresentation(uint32_t variance) {
+	constexpr uint32_t one = RssiStats<RSSI_STATS_WINDOW_SIZE>::ONE;
+	if (variance <  2 *  2 * one) return 0;
+	if (variance <  4 *  4 * one) return 1;
+	if (variance <  6 *  6 * one) return 2;
+	if (variance <  8 *  8 * one) return 3;
+	if (variance < 10 * 10 * one) return 4;
+	if (variance < 15 * 15 * one) return 5;
+	if (variance < 20 * 15 * one) return 6;
 	return 7;
 }
 
-uint8_t MeshTopologyResearch::getMeanRssiRepresentation(float mean) {
-	mean = std::abs(mean);
-	if (mean >= 1<<7 ) {
-		// mean rssi is worse than -128 dB, return 127.
+uint8_t MeshTopologyResearch::getMeanRssiRepresentation(int8_t mean) {
+	if (mean <= -(1 << 7) + 1) {
+		// mean rssi is -127 dB or worse, return 127.
 		return (1<<7) - 1;
 	}
-	return static_cast<uint8_t>(mean);
+	return static_cast<uint8_t>(mean < 0 ? -mean : mean);
 }
 
 uint8_t MeshTopologyResearch::getCountRepresentation(uint32_t count) {
@@ -91,57 +86,37 @@ uint32_t MeshTopologyResearch::flushAggregatedRssiData() {
 	// start flushing phase, here we wait quite a bit shorter until the map is empty.
 
 	// ** begin burst loop **
-	for (auto main_iter = variance_map[0].upper_bound(last_stone_id_broadcasted_in_burst);
-			main_iter != variance_map[0].end(); ++main_iter) {
+	for (auto iter = rssi_stats_map.upper_bound(last_stone_id_broadcasted_in_burst);
+			iter != rssi_stats_map.end(); ++iter) {
 
-		stone_id_t id = main_iter->first;
+		stone_id_t id = iter->first;
+		const rssi_stats_t& stats = iter->second;
 
 		LOGMeshTopologyResearchDebug("Burst start for id=%u", id);
 
-		// the maps may not have the same key sets, this depends
+		// the channels may not have the same number of samples, this depends
 		// on possible loss differences between the channels.
-
-		// Intersecting the key sets of these maps is pure ugly.
-		// Fortunately we only doing this once every half hour or so.
-		decltype(main_iter) rec_iters[] = {
-				main_iter,
-				variance_map[1].find(id),
-				variance_map[2].find(id),
-		};
-
-		bool all_maps_have_sufficient_data_for_id = true;
-		for (auto i = 0; i < CHANNEL_COUNT; ++i) {
-			if (rec_iters[i] == variance_map[i].end() ||
-					rec_iters[i]->second.getCount() < Settings.min_samples_to_trigger_burst) {
-				all_maps_have_sufficient_data_for_id = false;
-				break;
-			}
-		}
-
-		if (all_maps_have_sufficient_data_for_id) {
+		if (stats.getMinCount() >= Settings.min_samples_to_trigger_burst) {
 			rssi_data_message_t rssi_data;
 
 			rssi_data.sender_id = id;
 
-			rssi_data.channel37.sampleCount = getCountRepresentation(rec_iters[0]->second.getCount());
-			rssi_data.channel38.sampleCount = getCountRepresentation(rec_iters[1]->second.getCount());
-			rssi_data.channel39.sampleCount = getCountRepresentation(rec_iters[2]->second.getCount());
+			rssi_data.channel37.sampleCount = getCountRepresentation(stats.getChannel(0).getCount());
+			rssi_data.channel38.sampleCount = getCountRepresentation(stats.getChannel(1).getCount());
+			rssi_data.channel39.sampleCount = getCountRepresentation(stats.getChannel(2).getCount());
 
-			rssi_data.channel37.rssi = getMeanRssiRepresentation(rec_iters[0]->second.getMean());
-			rssi_data.channel38.rssi = getMeanRssiRepresentation(rec_iters[1]->second.getMean());
-			rssi_data.channel39.rssi = getMeanRssiRepresentation(rec_iters[2]->second.getMean());
+			rssi_data.channel37.rssi = getMeanRssiRepresentation(stats.getChannel(0).getMean());
+			rssi_data.channel38.rssi = getMeanRssiRepresentation(stats.getChannel(1).getMean());
+			rssi_data.channel39.rssi = getMeanRssiRepresentation(stats.getChannel(2).getMean());
 
-			rssi_data.channel37.variance = getVarianceRepresentation(rec_iters[0]->second.getVariance());
-			rssi_data.channel38.variance = getVarianceRepresentation(rec_iters[1]->second.getVariance());
-			rssi_data.channel39.variance = getVarianceRepresentation(rec_iters[2]->second.getVariance());
+			rssi_data.channel37.variance = getVarianceRepresentation(stats.getChannel(0).getVarianceFixedPoint());
+			rssi_data.channel38.variance = getVarianceRepresentation(stats.getChannel(1).getVarianceFixedPoint());
+			rssi_data.channel39.variance = getVarianceRepresentation(stats.getChannel(2).getVarianceFixedPoint());
 
 			sendRssiDataOverMesh(&rssi_data);
 
-			// delete entry from map
-			for (auto i = 0; i < 3; ++i) {
-				variance_map[i].erase(rec_iters[i]);
-				// this invalidates main_iter, so we _must_ return after deleting.
-			}
+			// delete entry from map, this invalidates iter, so we _must_ return after deleting.
+			rssi_stats_map.erase(iter);
 
 			last_stone_id_broadcasted_in_burst = id;
 
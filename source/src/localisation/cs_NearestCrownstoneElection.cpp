@@ -0,0 +1,127 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <localisation/cs_NearestCrownstoneElection.h>
+
+void NearestCrownstoneElection::init(stone_id_t myStoneId, const nearest_crownstone_election_config_t& config) {
+	_myStoneId = myStoneId;
+	_config = config;
+	_stats = {};
+}
+
+void NearestCrownstoneElection::setConfig(const nearest_crownstone_election_config_t& config) {
+	_config = config;
+}
+
+NearestCrownstoneElection::WinnerChange NearestCrownstoneElection::onAdvertisement(asset_record_t& record, compressed_rssi_data_t rssi) {
+	if (record.nearestStoneId == 0 || record.nearestStoneId == _myStoneId) {
+		// First time this asset was seen, or we already believed we were nearest: send an update towards the mesh.
+		// Only a repetition of the RSSI we broadcasted last can wait for the suppression period.
+		bool firstTime = (record.nearestStoneId == 0);
+		bool changed   = (rssi.rssiHalved != record.broadcastRssi.rssiHalved);
+		saveWinner(record, rssi, _myStoneId);
+		queueReports(record, PENDING_BROADCAST | PENDING_UART_UPDATE, firstTime || changed);
+		return firstTime ? WinnerChange::WON : WinnerChange::NONE;
+	}
+
+	if (isCloser(rssi, record.nearestRssi)) {
+		// We win because the incoming report is a first hand observation.
+		saveWinner(record, rssi, _myStoneId);
+		queueReports(record, PENDING_BROADCAST | PENDING_UART_UPDATE, true);
+		return WinnerChange::WON;
+	}
+	return WinnerChange::NONE;
+}
+
+NearestCrownstoneElection::WinnerChange NearestCrownstoneElection::onReport(asset_record_t& record, compressed_rssi_data_t rssi, stone_id_t reporter) {
+	if (reporter == _myStoneId) {
+		return WinnerChange::NONE;
+	}
+
+	if (reporter == record.nearestStoneId) {
+		// Update from the winner.
+		if (isCloser(record.myRssi, rssi)) {
+			// It dropped below our own value, so we win now.
+			saveWinner(record, record.myRssi, _myStoneId);
+			queueReports(record, PENDING_BROADCAST | PENDING_UART_UPDATE, true);
+			return WinnerChange::WON;
+		}
+		// It still wins, just update the value.
+		saveWinner(record, rssi, reporter);
+		queueReports(record, PENDING_UART_UPDATE);
+		return WinnerChange::NONE;
+	}
+
+	if (record.nearestStoneId == 0 || rssiIsCloser(rssi, record.nearestRssi)) {
+		// Report from another crownstone that is better than the winner.
+		// The reporter already applied the hysteresis when it took over, so it's not applied again:
+		// otherwise crownstones within the hysteresis of each other would keep disagreeing on the winner.
+		bool wasWinner = (record.nearestStoneId == _myStoneId);
+		saveWinner(record, rssi, reporter);
+		queueReports(record, PENDING_UART_UPDATE);
+		return wasWinner ? WinnerChange::LOST : WinnerChange::NONE;
+	}
+
+	if (record.nearestStoneId == _myStoneId) {
+		// The reporter believes it's nearest, but we are closer: let it know right away.
+		queueReports(record, PENDING_BROADCAST, true);
+	}
+	return WinnerChange::NONE;
+}
+
+uint8_t NearestCrownstoneElection::tick(asset_record_t& record) {
+	if (record.reportSuppressionCountdown != 0) {
+		record.reportSuppressionCountdown--;
+		return 0;
+	}
+	uint8_t reports = record.pendingReports;
+	if (reports == 0) {
+		return 0;
+	}
+
+	if ((reports & PENDING_BROADCAST) && record.nearestStoneId != _myStoneId) {
+		// We lost in the meantime, the winner will report instead.
+		reports &= ~PENDING_BROADCAST;
+		_stats.broadcastsAvoided++;
+	}
+	if (reports & PENDING_BROADCAST) {
+		record.broadcastRssi = record.nearestRssi;
+		_stats.broadcastsSent++;
+	}
+	if (reports & PENDING_UART_UPDATE) {
+		_stats.uartUpdatesSent++;
+	}
+
+	record.pendingReports = 0;
+	if (_config.reportSuppressionTicks > 0) {
+		record.reportSuppressionCountdown = _config.reportSuppressionTicks - 1;
+	}
+	return reports;
+}
+
+void NearestCrownstoneElection::queueReports(asset_record_t& record, uint8_t reports, bool urgent) {
+	uint8_t merged = record.pendingReports & reports;
+	if (merged & PENDING_BROADCAST) {
+		_stats.broadcastsAvoided++;
+	}
+	if (merged & PENDING_UART_UPDATE) {
+		_stats.uartUpdatesAvoided++;
+	}
+	record.pendingReports |= reports;
+	if (urgent) {
+		record.reportSuppressionCountdown = 0;
+	}
+}
+
+bool NearestCrownstoneElection::isCloser(const compressed_rssi_data_t& lhs, const compressed_rssi_data_t& rhs) {
+	return rssiIsCloserBy(lhs, rhs, _config.rssiHysteresisHalved);
+}
+
+void NearestCrownstoneElection::saveWinner(asset_record_t& record, compressed_rssi_data_t rssi, stone_id_t winnerId) {
+	record.nearestStoneId = winnerId;
+	record.nearestRssi = rssi;
+}
@@ -29,6 +29,8 @@
 cs_ret_code_t NearestCrownstoneTracker::init() {
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_myStoneId, sizeof(_myStoneId));
 
+	_election.init(_myStoneId, loadElectionConfig());
+
 	_assetStore = getComponent<AssetStore>();
 	if (_assetStore == nullptr) {
 		LOGd("no asset store found, Nearest crownstone refuses init.");
@@ -50,6 +52,15 @@ void NearestCrownstoneTracker::handleEvent(event_t &evt) {
 			handleMeshMsgEvent(evt);
 			break;
 		}
+		case CS_TYPE::EVT_TICK: {
+			onTick(*CS_TYPE_CAST(EVT_TICK, evt.data));
+			break;
+		}
+		case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+		case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD: {
+			_election.setConfig(loadElectionConfig());
+			break;
+		}
 		default: {
 			break;
 		}
@@ -89,33 +100,11 @@ void NearestCrownstoneTracker::onReceiveAssetAdvertisement(report_asset_id_t& in
 		// might just have been an old record. simply return.
 		return;
 	}
-	auto& record = *recordPtr;
 
-	if (record.nearestStoneId == 0 || record.nearestStoneId == _myStoneId) {
-		if (record.nearestStoneId == 0) {
-			LOGNearestCrownstoneTrackerDebug("First time this asset was seen, consider us nearest.");
-			onWinnerChanged(true);
-		}
-		else {
-			LOGNearestCrownstoneTrackerVerbose("We already believed we were nearest, so it's time to send an update towards the mesh");
-		}
-		saveWinningReport(record, incomingReport.compressedRssi, _myStoneId);
-		broadcastReport(incomingReport);
-		sendUartUpdate(record);
-	}
-	else {
-		LOGNearestCrownstoneTrackerVerbose("We didn't win before");
-		if (rssiIsCloser(incomingReport.compressedRssi, record.nearestRssi))  {
-			// we win because the incoming report is a first hand observation.
-			LOGNearestCrownstoneTrackerVerbose("but now we do, so have to send an update towards the mesh");
-			saveWinningReport(record, incomingReport.compressedRssi, _myStoneId);
-			broadcastReport(incomingReport);
-			sendUartUpdate(record);
-			onWinnerChanged(true);
-		}
-		else {
-			LOGNearestCrownstoneTrackerVerbose("We still don't, so we're done.");
-		}
+	auto winnerChange = _election.onAdvertisement(*recordPtr, incomingReport.compressedRssi);
+	schedule(*recordPtr);
+	if (winnerChange == NearestCrownstoneElection::WinnerChange::WON) {
+		onWinnerChanged(true);
 	}
 }
 
@@ -123,45 +112,79 @@ void NearestCrownstoneTracker::onReceiveAssetReport(report_asset_id_t& incomingR
 	LOGNearestCrownstoneTrackerVerbose("onReceive witness report, myId(%u), reporter(%u), rssi(%i #%u)",
 			_myStoneId, reporter, getRssi(incomingReport.compressedRssi), getChannel(incomingReport.compressedRssi));
 
-	if (reporter == _myStoneId) {
-		// REVIEW: is this possible at all?
-		LOGNearestCrownstoneTrackerVerbose("Received an old report from myself. Dropped: not relevant.");
-		return;
-	}
-
 	auto recordPtr = getRecordFiltered(incomingReport.id);
 	if (recordPtr == nullptr) {
 		// if we don't have a record in the assetStore it means we're not close
 		// and can simply ignore the message.
 		return;
 	}
-	auto& record = *recordPtr;
 
 	// REVIEW: doesn't use the RSSI with fall off.
-	if (reporter == record.nearestStoneId) {
-		LOGNearestCrownstoneTrackerVerbose("Received an update from the winner.");
+	auto winnerChange = _election.onReport(*recordPtr, incomingReport.compressedRssi, reporter);
+	schedule(*recordPtr);
+	switch (winnerChange) {
+		case NearestCrownstoneElection::WinnerChange::WON: {
+			onWinnerChanged(true);
+			break;
+		}
+		case NearestCrownstoneElection::WinnerChange::LOST: {
+			onWinnerChanged(false);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
 
-		if (rssiIsCloser(record.myRssi, incomingReport.compressedRssi) ) {
-			LOGNearestCrownstoneTrackerVerbose("It dropped below my own value, so I win now.");
-			saveWinningReport(record, record.myRssi, _myStoneId);
-			broadcastPersonalReport(record);
+void NearestCrownstoneTracker::onTick(uint32_t tickCount) {
+	uint8_t i = 0;
+	while (i < _scheduledRecordCount) {
+		asset_record_t& record = *_scheduledRecords[i];
+		uint8_t reports = _election.tick(record);
+		if (reports & NearestCrownstoneElection::PENDING_BROADCAST) {
+			report_asset_id_t report = {};
+			report.id = record.assetId;
+			report.compressedRssi = record.nearestRssi;
+			broadcastReport(report);
+		}
+		if (reports & NearestCrownstoneElection::PENDING_UART_UPDATE) {
 			sendUartUpdate(record);
-			onWinnerChanged(true);
+		}
+
+		if (record.pendingReports == 0 && record.reportSuppressionCountdown == 0) {
+			// Nothing left to do for this record: replace it by the last one.
+			_scheduledRecordCount--;
+			_scheduledRecords[i] = _scheduledRecords[_scheduledRecordCount];
 		}
 		else {
-			LOGNearestCrownstoneTrackerVerbose("It still wins, so I'll just update the value of my winning report.");
-			saveWinningReport(record, incomingReport.compressedRssi, reporter);
-			sendUartUpdate(record);
+			i++;
 		}
 	}
-	else {
-		if (record.nearestStoneId == 0 || rssiIsCloser(incomingReport.compressedRssi, record.nearestRssi)) {
-			LOGNearestCrownstoneTrackerVerbose("Received a witnessreport from another crownstone that is better than my winner.");
-			saveWinningReport(record, incomingReport.compressedRssi, reporter);
-			sendUartUpdate(record);
-			onWinnerChanged(false);
+
+	if (tickCount % (STATS_LOG_PERIOD_MS / TICK_INTERVAL_MS) == 0) {
+		[[maybe_unused]] auto& stats = _election.getStats();
+		LOGNearestCrownstoneTrackerInfo("broadcasts sent=%u avoided=%u, uart updates sent=%u avoided=%u",
+				stats.broadcastsSent,
+				stats.broadcastsAvoided,
+				stats.uartUpdatesSent,
+				stats.uartUpdatesAvoided);
+	}
+}
+
+void NearestCrownstoneTracker::schedule(asset_record_t& record) {
+	if (record.pendingReports == 0 && record.reportSuppressionCountdown == 0) {
+		return;
+	}
+	for (uint8_t i = 0; i < _scheduledRecordCount; ++i) {
+		if (_scheduledRecords[i] == &record) {
+			return;
 		}
 	}
+	if (_scheduledRecordCount < AssetStore::MAX_RECORDS) {
+		_scheduledRecords[_scheduledRecordCount] = &record;
+		_scheduledRecordCount++;
+	}
 }
 
 // -------------------------------------------
@@ -183,14 +206,6 @@ void NearestCrownstoneTracker::broadcastReport(report_asset_id_t& report) {
 	reportMsgEvt.dispatch();
 }
 
-void NearestCrownstoneTracker::broadcastPersonalReport(asset_record_t& record) {
-	report_asset_id_t report = {};
-	report.id = record.assetId;
-	report.compressedRssi = record.myRssi;
-
-	broadcastReport(report);
-}
-
 void NearestCrownstoneTracker::sendUartUpdate(asset_record_t& record) {
 	auto uartMsg = cs_nearest_stone_update_t{
 			.assetId = record.assetId,
@@ -225,11 +240,6 @@ void NearestCrownstoneTracker::onWinnerChanged(bool winnerIsThisCrownstone) {
 // ---------------------------------
 
 
-void NearestCrownstoneTracker::saveWinningReport(asset_record_t& rec, compressed_rssi_data_t winningRssi, stone_id_t winningId) {
-	rec.nearestStoneId = winningId;
-	rec.nearestRssi = winningRssi;
-}
-
 asset_record_t* NearestCrownstoneTracker::getRecordFiltered(const short_asset_id_t& assetId) {
 	asset_record_t* record = _assetStore->getRecord(assetId);
 
@@ -257,4 +267,19 @@ asset_record_t* NearestCrownstoneTracker::getRecordFiltered(const short_asset_id
 	return record;
 }
 
+nearest_crownstone_election_config_t NearestCrownstoneTracker::loadElectionConfig() {
+	TYPIFY(CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS) rssiHysteresis;
+	State::getInstance().get(CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS, &rssiHysteresis, sizeof(rssiHysteresis));
+	TYPIFY(CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD) suppressionPeriodMs;
+	State::getInstance().get(CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD, &suppressionPeriodMs, sizeof(suppressionPeriodMs));
+
+	nearest_crownstone_election_config_t config;
+	// The RSSI is compressed to steps of 2 dB.
+	config.rssiHysteresisHalved = rssiHysteresis / 2;
+	uint16_t suppressionTicks = suppressionPeriodMs / TICK_INTERVAL_MS;
+	config.reportSuppressionTicks = suppressionTicks > 0xFF ? 0xFF : suppressionTicks;
+	LOGNearestCrownstoneTrackerInfo("Election config: hysteresis=%u dB, suppression=%u ms", rssiHysteresis, suppressionPeriodMs);
+	return config;
+}
+
 
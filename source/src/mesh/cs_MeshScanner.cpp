@@ -8,6 +8,7 @@
 #include <common/cs_Types.h>
 #include <events/cs_Event.h>
 #include <mesh/cs_MeshScanner.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <structs/cs_PacketsInternal.h>
 
 #include <cstring>
@@ -29,6 +30,7 @@ void MeshScanner::onScan(const nrf_mesh_adv_packet_rx_data_t *scanData) {
 			_scannedDevice.dataSize = scanData->length;
 			_scannedDevice.data = const_cast<uint8_t*>(scanData->p_payload);
 
+			ScanPipelineStats::getInstance().count(SCAN_PIPELINE_MESH_SCANNED);
 			event_t event(CS_TYPE::EVT_DEVICE_SCANNED, static_cast<void*>(&_scannedDevice), sizeof(_scannedDevice));
 			event.dispatch();
 			break;
@@ -19,6 +19,7 @@
 #include <cfg/cs_Config.h>
 #include <common/cs_Types.h>
 #include <logging/cs_Logger.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
 #include <ipc/cs_IpcRamData.h>
@@ -197,10 +198,20 @@ bool Microapp::canRunApp(uint8_t index) {
 
 void Microapp::tick() {
 	MicroappProtocol & protocol = MicroappProtocol::getInstance();
+	uint32_t tickStartCount = RTC::getCount();
+	uint8_t firstAppIndex = _firstAppIndex;
+	_firstAppIndex = (firstAppIndex + 1) % MAX_MICROAPPS;
 	for (uint8_t i = 0; i < MAX_MICROAPPS; ++i) {
-		if (canRunApp(i)) {
-			protocol.callSetupAndLoop(i);
+		uint8_t index = (firstAppIndex + i) % MAX_MICROAPPS;
+		if (!canRunApp(index)) {
+			continue;
 		}
+		if (RTC::differenceMs(RTC::getCount(), tickStartCount) >= MICROAPP_TICK_BUDGET_MS) {
+			LOGMicroappDebug("Tick budget used up, call app %u first next tick", index);
+			_firstAppIndex = index;
+			break;
+		}
+		protocol.callSetupAndLoop(index);
 	}
 }
 
@@ -347,12 +358,28 @@ cs_ret_code_t Microapp::handleDisable(microapp_ctrl_header_t* packet) {
 	return storeState(index);
 }
 
+cs_ret_code_t Microapp::handleGetCpuStats(microapp_ctrl_header_t* packet, cs_result_t& result) {
+	LOGMicroappInfo("handleGetCpuStats %u", packet->index);
+	cs_ret_code_t retCode = checkHeader(packet);
+	if (retCode != ERR_SUCCESS) {
+		return retCode;
+	}
+	if (result.buf.len < sizeof(microapp_cpu_stats_t)) {
+		LOGw("Buffer too small len=%u required=%u", result.buf.len, sizeof(microapp_cpu_stats_t));
+		return ERR_BUFFER_TOO_SMALL;
+	}
+	const microapp_cpu_stats_t& stats = MicroappProtocol::getInstance().getCpuStats(packet->index);
+	memcpy(result.buf.data, &stats, sizeof(stats));
+	result.dataSize = sizeof(stats);
+	return ERR_SUCCESS;
+}
+
 cs_ret_code_t Microapp::checkHeader(microapp_ctrl_header_t* packet) {
 	if (packet->protocol != MICROAPP_PROTOCOL) {
 		LOGw("Unsupported protocol: %u", packet->protocol);
 		return ERR_PROTOCOL_UNSUPPORTED;
 	}
-	if (packet->index > MAX_MICROAPPS) {
+	if (packet->index >= MAX_MICROAPPS) {
 		LOGw("Index too large: %u", packet->index);
 		return ERR_WRONG_PARAMETER;
 	}
@@ -390,6 +417,11 @@ void Microapp::handleEvent(event_t & evt) {
 			evt.result.returnCode = handleDisable(packet);
 			break;
 		}
+		case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS: {
+			auto packet = CS_TYPE_CAST(CMD_MICROAPP_GET_CPU_STATS, evt.data);
+			evt.result.returnCode = handleGetCpuStats(packet, evt.result);
+			break;
+		}
 		case CS_TYPE::EVT_TICK: {
 			tick();
 			break;
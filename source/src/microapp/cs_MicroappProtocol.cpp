@@ -18,9 +18,11 @@
 #include <common/cs_Types.h>
 #include <logging/cs_Logger.h>
 #include <drivers/cs_Gpio.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
 #include <ipc/cs_IpcRamData.h>
+#include <microapp/cs_MicroappCommandRing.h>
 #include <microapp/cs_MicroappProtocol.h>
 #include <protocol/cs_ErrorCodes.h>
 #include <storage/cs_State.h>
@@ -328,6 +330,12 @@ int handleCommand(uint8_t* payload, uint16_t length) {
 			handleTwiCommand(twi_cmd);
 			break;
 		}
+		case CS_MICROAPP_COMMAND_SCAN: {
+			return MicroappProtocol::getInstance().handleScanCommand(payload, length);
+		}
+		case CS_MICROAPP_COMMAND_COMMAND_RING: {
+			return MicroappProtocol::getInstance().handleCommandRingCommand(payload, length);
+		}
 		case CS_MICROAPP_COMMAND_SERVICE_DATA: {
 			LOGd("Service data:");
 			_logArray(SERIAL_DEBUG, true, payload, length);
@@ -381,10 +389,6 @@ MicroappProtocol::MicroappProtocol(): EventListener() {
 
 	EventDispatcher::getInstance().addListener(this);
 
-	_setup = 0;
-	_loop = 0;
-	_booted = false;
-
 	for (int i = 0; i < MAX_ISR_COUNT; ++i) {
 		_isr[i].pin = 0;
 		_isr[i].callback = 0;
@@ -396,6 +400,9 @@ MicroappProtocol::MicroappProtocol(): EventListener() {
 /*
  * Set the microapp_callback in the IPC ram data bank. It can later on be used by the microapp to find the address
  * of that function to call back into the bluenet code.
+ *
+ * All microapps share this IPC ram item, so it only holds what is the same for every microapp. A microapp gets the
+ * address of its own command ring with the command ring command.
  */
 void MicroappProtocol::setIpcRam() {
 	LOGi("Set IPC info for microapp");
@@ -425,7 +432,7 @@ void MicroappProtocol::setIpcRam() {
 /**
  * Get the ram structure in which loop and setup of the microapp are stored.
  */
-uint16_t MicroappProtocol::interpretRamdata() {
+uint16_t MicroappProtocol::interpretRamdata(microapp_context_t& app) {
 	LOGi("Get IPC info for microapp");
 	uint8_t buf[BLUENET_IPC_RAM_DATA_ITEM_SIZE];
 	for (int i = 0; i < BLUENET_IPC_RAM_DATA_ITEM_SIZE; ++i) {
@@ -455,20 +462,20 @@ uint16_t MicroappProtocol::interpretRamdata() {
 
 		uint8_t protocol = buf[0];
 		if (protocol == 0) {
-			_setup = 0, _loop =0;
+			app.setup = 0, app.loop = 0;
 			uint8_t offset = 1;
 			for (int i = 0; i < 4; ++i) {
-				_setup = _setup | ( (uintptr_t)(buf[i+offset]) << (i*8));
+				app.setup = app.setup | ( (uintptr_t)(buf[i+offset]) << (i*8));
 			}
 			offset = 5;
 			for (int i = 0; i < 4; ++i) {
-				_loop = _loop | ( (uintptr_t)(buf[i+offset]) << (i*8));
+				app.loop = app.loop | ( (uintptr_t)(buf[i+offset]) << (i*8));
 			}
 		}
 
-		LOGi("Found setup at %p", _setup);
-		LOGi("Found loop at %p", _loop);
-		if (_loop && _setup) {
+		LOGi("Found setup at %p", app.setup);
+		LOGi("Found loop at %p", app.loop);
+		if (app.loop && app.setup) {
 			return ERR_SUCCESS;
 		}
 	} else {
@@ -481,15 +488,19 @@ uint16_t MicroappProtocol::interpretRamdata() {
 /**
  * Call the app, boot it.
  *
- * TODO: Return setup and loop addresses
+ * The main of the microapp registers its setup and loop functions in IPC ram. All microapps use the same IPC ram
+ * item, so it's read right after main returns.
  */
 void MicroappProtocol::callApp(uint8_t appIndex) {
 	static bool thumbMode = true;
+	microapp_context_t& app = _apps[appIndex];
+	app = microapp_context_t();
 
-	initMemory();
+	initMemory(appIndex);
+	_currentAppIndex = appIndex;
 
 	uintptr_t address = MicroappStorage::getInstance().getStartInstructionAddress(appIndex);
-	LOGi("Microapp: start at 0x%08X", address);
+	LOGi("Microapp %u: start at 0x%08X", appIndex, address);
 
 	if (thumbMode) {
 		address += 1;
@@ -502,75 +513,90 @@ void MicroappProtocol::callApp(uint8_t appIndex) {
 		(*microappMain)();
 		LOGi("Module did run.");
 	}
-	_booted = true;
-	LOGi("Booted is at address: 0x%p", &_booted);
+	app.booted = true;
+
+	uint16_t ret_code = interpretRamdata(app);
+	if (ret_code == ERR_SUCCESS) {
+		app.loaded = true;
+	}
+	else {
+		LOGw("Disable microapp %u. After boot not the right info available", appIndex);
+		app.booted = false;
+	}
 }
 
-uint16_t MicroappProtocol::initMemory() {
+uint16_t MicroappProtocol::initMemory(uint8_t appIndex) {
 	// We have a reserved area of RAM. For now let us clear it to 0
 	// This is actually incorrect (we should skip) and it probably can be done at once as well
-	LOGi("Init memory: clear 0x%p to 0x%p", g_RAM_MICROAPP_BASE, g_RAM_MICROAPP_BASE + g_RAM_MICROAPP_AMOUNT);
-	for (uint32_t i = 0; i < g_RAM_MICROAPP_AMOUNT; ++i) {
-		uint32_t *const val = (uint32_t *)(uintptr_t)(g_RAM_MICROAPP_BASE + i);
-		*val = 0;
-	}
+	uintptr_t ramStart = getRamStart(appIndex);
+	LOGi("Init memory: clear 0x%p to 0x%p", ramStart, ramStart + getRamSize());
+	memset((void*)ramStart, 0, getRamSize());
 
 	// The above is fine for .bss (which is uninitialized) but not for .data. It needs to be copied
 	// to the right addresses.
 	return ERR_SUCCESS;
 }
 
+uintptr_t MicroappProtocol::getRamStart(uint8_t appIndex) {
+	return g_RAM_MICROAPP_BASE + appIndex * getRamSize();
+}
+
+uint32_t MicroappProtocol::getRamSize() {
+	// Keep the size a multiple of 8, so that each stack is aligned.
+	return (g_RAM_MICROAPP_AMOUNT / MAX_MICROAPPS) & ~0x7;
+}
+
 /*
- * Called from cs_Microapp every time tick. Only when _booted gets up will this function become active.
+ * Called from cs_Microapp every time tick. Only when booted gets up will this function become active.
  */
 void MicroappProtocol::callSetupAndLoop(uint8_t appIndex) {
+	microapp_context_t& app = _apps[appIndex];
+	if (!app.booted || !app.loaded) {
+		return;
+	}
+	_currentAppIndex = appIndex;
+
+	if (!app.setupDone) {
+		// TODO: we cannot call delay in setup in this way...
+		void (*setup_func)() = (void (*)()) app.setup;
+		LOGi("Call setup of microapp %u at 0x%x", appIndex, app.setup);
+		uint32_t startCount = RTC::getCount();
+		setup_func();
+		handleCommandRing(appIndex);
+		accountCpuTime(appIndex, startCount);
+		LOGi("Setup done");
+		app.setupDone = true;
+		app.cocounter = 0;
+		app.coskip = 0;
+		// Spread the loops of the microapps over the loop interval.
+		app.loopCountdown = MICROAPP_LOOP_FREQUENCY + appIndex * MICROAPP_LOOP_FREQUENCY / MAX_MICROAPPS;
+		return;
+	}
 
-	static uint16_t counter = 0;
-	if (_booted) {
+	if (--app.loopCountdown != 0) {
+		return;
+	}
+	app.loopCountdown = MICROAPP_LOOP_FREQUENCY;
 
-		if (!_loaded) {
-			LOGi("Start loading");
-			uint16_t ret_code = interpretRamdata();
-			if (ret_code == ERR_SUCCESS) {
-				LOGi("Set loaded to true");
-				_loaded = true;
-			} else {
-				LOGw("Disable microapp. After boot not the right info available");
-				// Apparently, something went wrong?
-				_booted = false;
-			}
-		}
+	if (app.coskip > 0) {
+		// Skip (due to by the microapp communicated delay)
+		app.coskip--;
+		return;
+	}
+	if (app.penaltyLoops > 0) {
+		// Skip, because the microapp took too long before.
+		app.penaltyLoops--;
+		return;
+	}
 
-		if (_loaded) {
-			if (counter == 0) {
-				// TODO: we cannot call delay in setup in this way...
-				void (*setup_func)() = (void (*)()) _setup;
-				LOGi("Call setup at 0x%x", _setup);
-				setup_func();
-				LOGi("Setup done");
-				_cocounter = 0;
-				_coskip = 0;
-			}
-			counter++;
-			if (counter % MICROAPP_LOOP_FREQUENCY == 0) {
-				if (_coskip > 0) {
-					// Skip (due to by the microapp communicated delay)
-					_coskip--;
-				} else {
-					//LOGd("Call loop");
-					callLoop(_cocounter, _coskip);
-					if (_cocounter == -1) {
-						// Done, reset flags
-						_cocounter = 0;
-						_coskip = 0;
-					}
-				}
-			}
-			// Loop around, but do not hit 0 again
-			if (counter == 0) {
-				counter = 1;
-			}
-		}
+	uint32_t startCount = RTC::getCount();
+	callLoop(appIndex);
+	handleCommandRing(appIndex);
+	accountCpuTime(appIndex, startCount);
+	if (app.cocounter == -1) {
+		// Done, reset flags
+		app.cocounter = 0;
+		app.coskip = 0;
 	}
 }
 
@@ -578,26 +604,94 @@ void MicroappProtocol::callSetupAndLoop(uint8_t appIndex) {
  * Call loop (internally).
  *
  * This function can be improved in clearity for the developer. It now works as follows:
- *   - when cntr = 0 we start a new loop
- *   - we call next and set skip if we actually were "yielded"
+ *   - when cocounter = 0 we start a new loop
+ *   - we call next and set coskip if we actually were "yielded"
  */
-void MicroappProtocol::callLoop(int & cntr, int & skip) {
-	if (cntr == 0) {
-		// start a new loop
-		_coargs = {&_coroutine, 1, 0};
-		void (*loop_func)(void*) = (void (*)(void*)) _loop;
-		start(&_coroutine, loop_func, &_coargs);
+void MicroappProtocol::callLoop(uint8_t appIndex) {
+	microapp_context_t& app = _apps[appIndex];
+	if (app.cocounter == 0) {
+		// start a new loop, with the stack at the end of the RAM of this microapp
+		app.loopCoargs = {&app.loopCoroutine, 1, 0};
+		void (*loop_func)(void*) = (void (*)(void*)) app.loop;
+		void* stack = (void*)(getRamStart(appIndex) + getRamSize());
+		start(&app.loopCoroutine, loop_func, &app.loopCoargs, stack);
 	}
 
-	if (next(&_coroutine)) {
+	if (next(&app.loopCoroutine)) {
 		// here we come only on yield
-		cntr = _coargs.cntr;
-		skip = _coargs.delay / MICROAPP_LOOP_INTERVAL_MS;
+		app.cocounter = app.loopCoargs.cntr;
+		app.coskip = app.loopCoargs.delay / MICROAPP_LOOP_INTERVAL_MS;
+		app.stats.yields++;
 		return;
 	}
 
 	// indicate that we are done
-	cntr = -1;
+	app.cocounter = -1;
+}
+
+void MicroappProtocol::accountCpuTime(uint8_t appIndex, uint32_t startCount) {
+	microapp_context_t& app = _apps[appIndex];
+	uint32_t durationMs = RTC::differenceMs(RTC::getCount(), startCount);
+	app.stats.calls++;
+	if (durationMs > app.stats.maxCallMs) {
+		app.stats.maxCallMs = durationMs;
+	}
+	if (durationMs > MICROAPP_CALL_BUDGET_MS) {
+		app.stats.overruns++;
+		app.penaltyLoops = std::min(durationMs / MICROAPP_CALL_BUDGET_MS, (uint32_t)MICROAPP_MAX_PENALTY_LOOPS);
+		LOGw("Microapp %u took %u ms, skip %u loops", appIndex, durationMs, app.penaltyLoops);
+	}
+}
+
+void MicroappProtocol::handleCommandRing(uint8_t appIndex) {
+	uint8_t handledCount = 0;
+	cs_ret_code_t retCode = handleMicroappCommandRing(_apps[appIndex].commandRing, handleCommand, handledCount);
+	if (retCode != ERR_SUCCESS) {
+		LOGw("Microapp %u: invalid command ring", appIndex);
+	}
+	_apps[appIndex].stats.ringCommands += handledCount;
+}
+
+cs_ret_code_t MicroappProtocol::handleCommandRingCommand(uint8_t* payload, uint16_t length) {
+	if (length < sizeof(command_ring_cmd_t)) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	command_ring_cmd_t* cmd = reinterpret_cast<command_ring_cmd_t*>(payload);
+	microapp_command_ring_t* ring = &(_apps[_currentAppIndex].commandRing);
+	LOGi("Microapp %u: command ring at %p", _currentAppIndex, ring);
+	cmd->address = (uintptr_t)ring;
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappProtocol::handleScanCommand(uint8_t* payload, uint16_t length) {
+	MicroappScanForwarder& forwarder = _apps[_currentAppIndex].scanForwarder;
+	if (length < 2) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	switch (payload[1]) {
+		case CS_MICROAPP_COMMAND_SCAN_SET_BUFFER: {
+			if (length < sizeof(scan_buffer_cmd_t)) {
+				return ERR_WRONG_PAYLOAD_LENGTH;
+			}
+			scan_buffer_cmd_t* cmd = (scan_buffer_cmd_t*)payload;
+			return forwarder.setBuffer(cmd->buffer, getRamStart(_currentAppIndex), getRamSize());
+		}
+		case CS_MICROAPP_COMMAND_SCAN_SUBSCRIBE: {
+			if (length < sizeof(scan_subscription_cmd_t)) {
+				return ERR_WRONG_PAYLOAD_LENGTH;
+			}
+			return forwarder.subscribe(*(scan_subscription_cmd_t*)payload);
+		}
+		case CS_MICROAPP_COMMAND_SCAN_UNSUBSCRIBE: {
+			if (length < 3) {
+				return ERR_WRONG_PAYLOAD_LENGTH;
+			}
+			return forwarder.unsubscribe(payload[2]);
+		}
+		default:
+			LOGw("Unknown scan opcode: %i", payload[1]);
+			return ERR_UNKNOWN_OP_CODE;
+	}
 }
 
 /**
@@ -621,6 +715,15 @@ void MicroappProtocol::handleEvent(event_t & event) {
 			}
 			break;
 		}
+		case CS_TYPE::EVT_DEVICE_SCANNED: {
+			auto device = CS_TYPE_CAST(EVT_DEVICE_SCANNED, event.data);
+			for (auto& app : _apps) {
+				if (app.booted && app.loaded) {
+					app.scanForwarder.onScannedDevice(*device);
+				}
+			}
+			break;
+		}
 		case CS_TYPE::EVT_GPIO_UPDATE: {
 			TYPIFY(EVT_GPIO_UPDATE) gpio = *(TYPIFY(EVT_GPIO_UPDATE)*)event.data;
 			LOGi("Get GPIO update for pin %i", gpio.pin_index);
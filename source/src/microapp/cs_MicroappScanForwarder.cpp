@@ -0,0 +1,158 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <localisation/cs_FilterInputPreparation.h>
+#include <logging/cs_Logger.h>
+#include <microapp/cs_MicroappScanForwarder.h>
+#include <protocol/cs_ErrorCodes.h>
+
+#include <cstddef>
+#include <cstring>
+
+#define LOGMicroappScanDebug LOGnone
+
+cs_ret_code_t MicroappScanForwarder::setBuffer(uintptr_t address, uintptr_t ramStart, uint32_t ramSize) {
+	if (address == 0) {
+		_buffer = nullptr;
+		_bufferSize = 0;
+		return ERR_SUCCESS;
+	}
+	if (address % alignof(microapp_scan_buffer_t) != 0) {
+		return ERR_WRONG_PARAMETER;
+	}
+	if (address < ramStart || address + offsetof(microapp_scan_buffer_t, devices) > ramStart + ramSize) {
+		return ERR_WRONG_PARAMETER;
+	}
+	microapp_scan_buffer_t* buffer = reinterpret_cast<microapp_scan_buffer_t*>(address);
+	uint8_t size = buffer->size;
+	if (size == 0 || (size & (size - 1)) != 0) {
+		return ERR_WRONG_PARAMETER;
+	}
+	if (address + offsetof(microapp_scan_buffer_t, devices) + size * sizeof(microapp_scanned_device_t) > ramStart + ramSize) {
+		return ERR_BUFFER_TOO_SMALL;
+	}
+	LOGMicroappScanDebug("Scan buffer at %p with size %u", buffer, size);
+	buffer->head = buffer->tail;
+	buffer->dropped = 0;
+	_buffer = buffer;
+	_bufferSize = size;
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappScanForwarder::subscribe(const scan_subscription_cmd_t& cmd) {
+	if (cmd.valueLength > MICROAPP_SCAN_VALUE_SIZE) {
+		return ERR_WRONG_PARAMETER;
+	}
+
+	microapp_scan_subscription_t subscription;
+	subscription.active = true;
+	subscription.id = cmd.id;
+	subscription.rssiThreshold = cmd.rssiThreshold;
+	subscription.valueLength = cmd.valueLength;
+	memcpy(subscription.value, cmd.value, sizeof(subscription.value));
+	memcpy(subscription.valueMask, cmd.valueMask, sizeof(subscription.valueMask));
+
+	AssetFilterInput input(subscription.input);
+	switch (cmd.inputType) {
+		case CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS: {
+			*input.type() = AssetFilterInputType::MacAddress;
+			break;
+		}
+		case CS_MICROAPP_COMMAND_SCAN_INPUT_AD_DATA_TYPE: {
+			*input.type() = AssetFilterInputType::AdDataType;
+			input.AdTypeField()->adDataType = cmd.adDataType;
+			break;
+		}
+		case CS_MICROAPP_COMMAND_SCAN_INPUT_MASKED_AD_DATA_TYPE: {
+			*input.type() = AssetFilterInputType::MaskedAdDataType;
+			input.AdTypeMasked()->adDataType = cmd.adDataType;
+			input.AdTypeMasked()->adDataMask = cmd.adDataMask;
+			break;
+		}
+		default:
+			return ERR_WRONG_PARAMETER;
+	}
+
+	microapp_scan_subscription_t* emptySlot = nullptr;
+	for (auto& existing : _subscriptions) {
+		if (existing.active && existing.id == cmd.id) {
+			existing = subscription;
+			return ERR_SUCCESS;
+		}
+		if (!existing.active && emptySlot == nullptr) {
+			emptySlot = &existing;
+		}
+	}
+	if (emptySlot == nullptr) {
+		return ERR_NO_SPACE;
+	}
+	*emptySlot = subscription;
+	_subscriptionCount++;
+	LOGMicroappScanDebug("Scan subscription id=%u input=%u", cmd.id, cmd.inputType);
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t MicroappScanForwarder::unsubscribe(uint8_t id) {
+	for (auto& subscription : _subscriptions) {
+		if (subscription.active && subscription.id == id) {
+			subscription.active = false;
+			_subscriptionCount--;
+			return ERR_SUCCESS;
+		}
+	}
+	return ERR_NOT_FOUND;
+}
+
+void MicroappScanForwarder::onScannedDevice(const scanned_device_t& device) {
+	if (_subscriptionCount == 0 || _buffer == nullptr) {
+		return;
+	}
+	for (auto& subscription : _subscriptions) {
+		if (subscription.active && matches(subscription, device)) {
+			forward(subscription.id, device);
+			return;
+		}
+	}
+}
+
+bool MicroappScanForwarder::matches(microapp_scan_subscription_t& subscription, const scanned_device_t& device) {
+	// Check the RSSI first, it's cheap.
+	if (device.rssi < subscription.rssiThreshold) {
+		return false;
+	}
+	return prepareFilterInputAndCallDelegate(
+			device,
+			AssetFilterInput(subscription.input),
+			[&](const uint8_t* data, size_t len) {
+				if (len < subscription.valueLength) {
+					return false;
+				}
+				for (uint8_t i = 0; i < subscription.valueLength; ++i) {
+					if ((data[i] ^ subscription.value[i]) & subscription.valueMask[i]) {
+						return false;
+					}
+				}
+				return true;
+			},
+			false);
+}
+
+void MicroappScanForwarder::forward(uint8_t id, const scanned_device_t& device) {
+	uint8_t head = _buffer->head;
+	if ((uint8_t)(head - _buffer->tail) >= _bufferSize) {
+		_buffer->dropped = _buffer->dropped + 1;
+		return;
+	}
+	microapp_scanned_device_t& forwarded = _buffer->devices[head & (_bufferSize - 1)];
+	forwarded.id = id;
+	forwarded.rssi = device.rssi;
+	forwarded.channel = device.channel;
+	forwarded.dataSize = device.dataSize < MICROAPP_SCAN_DATA_SIZE ? device.dataSize : MICROAPP_SCAN_DATA_SIZE;
+	memcpy(forwarded.address, device.address, sizeof(forwarded.address));
+	memcpy(forwarded.data, device.data, forwarded.dataSize);
+	_buffer->head = head + 1;
+}
@@ -68,6 +68,11 @@ cs_ret_code_t MicroappStorage::init() {
 			break;
 	}
 
+	if (CS_FLASH_PAGE_SIZE * g_FLASH_MICROAPP_PAGES < MAX_MICROAPPS * MICROAPP_MAX_SIZE) {
+		LOGe("Flash space for %u microapps of %u bytes does not fit in %u pages", MAX_MICROAPPS, MICROAPP_MAX_SIZE, g_FLASH_MICROAPP_PAGES);
+		return ERR_NO_SPACE;
+	}
+
 
 	return ERR_SUCCESS;
 }
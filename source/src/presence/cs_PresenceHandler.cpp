@@ -18,7 +18,10 @@
 
 //#define PRESENCE_HANDLER_TESTING_CODE
 
-std::list<PresenceHandler::PresenceRecord> PresenceHandler::WhenWhoWhere;
+PresenceHandler::PresenceRecord PresenceHandler::records[max_records];
+uint32_t PresenceHandler::usedRecordsMask = 0;
+uint64_t PresenceHandler::profileLocationsMask[max_profile_id + 1] = {};
+uint64_t PresenceHandler::occupiedRoomsMask = 0;
 
 void PresenceHandler::init() {
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_ownId, sizeof(_ownId));
@@ -93,13 +96,6 @@ void PresenceHandler::handleEvent(event_t& evt) {
 			evt.result.returnCode   = ERR_SUCCESS;
 			return;
 		}
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK)* tickCount = reinterpret_cast<TYPIFY(EVT_TICK)*>(evt.data);
-			if (*tickCount % (1000 / TICK_INTERVAL_MS) == 0) {
-				tickSecond();
-			}
-			return;
-		}
 		default: return;
 	}
 }
@@ -141,7 +137,7 @@ PresenceHandler::MutationType PresenceHandler::handleProfileLocationAdministrati
 
 		if (prevdescription.value_or(0) != 0) {
 			// sphere exit
-			WhenWhoWhere.clear();
+			clearRecords();
 			return MutationType::LastUserExitSphere;
 		}
 
@@ -149,42 +145,34 @@ PresenceHandler::MutationType PresenceHandler::handleProfileLocationAdministrati
 	}
 #endif
 
-	// purge whowhenwhere of old entries
-	if (WhenWhoWhere.size() >= max_records) {
-		LOGw("Reached max number of records");
-		PresenceRecord record = WhenWhoWhere.back();
-		sendPresenceChange(PresenceChange::PROFILE_LOCATION_EXIT, record.who, record.where);
-		WhenWhoWhere.pop_back();
-	}
-
-	uint8_t meshCountdown = 0;
-	bool newLocation = true;
+	uint8_t index = findRecord(profile, location);
+	bool newLocation = (index == max_records);
 
-	for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end(); ++iter) {
-		if (iter->timeoutCountdownSeconds == 0) {
-			// Should not happen, record should've been removed.
-			LOGw("timed out record");
-		}
-		if (iter->who == profile && iter->where == location) {
-			LOGPresenceHandlerDebug("erasing old record profile(%u) location(%u)", profile, location);
-			meshCountdown = iter->meshSendCountdownSeconds;
-			WhenWhoWhere.erase(iter);
-			newLocation = false;
-			break;
+	if (newLocation) {
+		if (usedRecordsMask == all_records_mask) {
+			LOGw("Reached max number of records");
+			uint8_t oldest = findOldestRecord();
+			sendPresenceChange(PresenceChange::PROFILE_LOCATION_EXIT, records[oldest].who, records[oldest].where);
+			removeRecord(oldest);
 		}
+		LOGPresenceHandlerDebug("add record profile(%u) location(%u)", profile, location);
+		index = addRecord(profile, location);
+	}
+	else {
+		LOGPresenceHandlerDebug("refresh record profile(%u) location(%u)", profile, location);
+		refreshRecord(index);
 	}
-	// When record is new, or the old record mesh send countdown was 0: send profile location over the mesh.
-	if (meshCountdown == 0) {
+
+	// When record is new, or the mesh send throttle of the record has passed: send profile location over the mesh.
+	uint32_t seconds = TimerWheel::getInstance().getSeconds();
+	if (seconds >= records[index].meshSendAllowedSeconds) {
 		if (forwardToMesh) {
 			propagateMeshMessage(profile, location);
 		}
-		meshCountdown = presence_mesh_send_throttle_seconds + (RNG::getInstance().getRandom8() % presence_mesh_send_throttle_seconds_variation);
+		records[index].meshSendAllowedSeconds = seconds + presence_mesh_send_throttle_seconds
+				+ (RNG::getInstance().getRandom8() % presence_mesh_send_throttle_seconds_variation);
 	}
 
-	// Add the new entry
-	LOGPresenceHandlerDebug("add record profile(%u) location(%u)", profile, location);
-	WhenWhoWhere.push_front(PresenceRecord(profile, location, presence_time_out_s, meshCountdown));
-
 	if (newLocation) {
 		sendPresenceChange(PresenceChange::PROFILE_LOCATION_ENTER, profile, location);
 	}
@@ -226,16 +214,96 @@ PresenceHandler::MutationType PresenceHandler::getMutationType(
 	return MutationType::NothingChanged;
 }
 
-void PresenceHandler::removeOldRecords() {
-	WhenWhoWhere.remove_if(
-			[&] (PresenceRecord www) {
-		if (www.timeoutCountdownSeconds == 0) {
-			LOGPresenceHandlerDebug("erasing timed out record profile=%u location=%u", www.who, www.where);
-			return true;
+uint8_t PresenceHandler::findRecord(uint8_t profile, uint8_t location) {
+	if (!(profileLocationsMask[profile] & (1ULL << location))) {
+		// Quick check: there is no record of this profile at this location.
+		return max_records;
+	}
+	for (uint8_t i = 0; i < max_records; ++i) {
+		if ((usedRecordsMask & (1 << i)) && records[i].who == profile && records[i].where == location) {
+			return i;
+		}
+	}
+	return max_records;
+}
+
+uint8_t PresenceHandler::findOldestRecord() {
+	TimerWheel& timerWheel = TimerWheel::getInstance();
+	uint8_t oldest = max_records;
+	uint32_t oldestSecondsLeft = UINT32_MAX;
+	for (uint8_t i = 0; i < max_records; ++i) {
+		if (!(usedRecordsMask & (1 << i))) {
+			continue;
+		}
+		uint32_t secondsLeft = timerWheel.getSecondsLeft(records[i].timeout);
+		if (secondsLeft < oldestSecondsLeft) {
+			oldestSecondsLeft = secondsLeft;
+			oldest = i;
 		}
-		return false;
 	}
-	);
+	return oldest;
+}
+
+uint8_t PresenceHandler::addRecord(uint8_t profile, uint8_t location) {
+	uint8_t index = __builtin_ctz(~usedRecordsMask);
+	usedRecordsMask |= (1 << index);
+	records[index].who = profile;
+	records[index].where = location;
+	records[index].meshSendAllowedSeconds = TimerWheel::getInstance().getSeconds();
+	records[index].timeout.callback = onRecordTimeout;
+	records[index].timeout.context = &records[index];
+	TimerWheel::getInstance().schedule(records[index].timeout, presence_time_out_s);
+
+	profileLocationsMask[profile] |= (1ULL << location);
+	occupiedRoomsMask |= (1ULL << location);
+	return index;
+}
+
+void PresenceHandler::refreshRecord(uint8_t index) {
+	TimerWheel::getInstance().schedule(records[index].timeout, presence_time_out_s);
+}
+
+void PresenceHandler::removeRecord(uint8_t index) {
+	LOGPresenceHandlerDebug("erasing record profile=%u location=%u", records[index].who, records[index].where);
+	TimerWheel::getInstance().cancel(records[index].timeout);
+	usedRecordsMask &= ~(1 << index);
+
+	profileLocationsMask[records[index].who] &= ~(1ULL << records[index].where);
+	occupiedRoomsMask = 0;
+	for (auto mask : profileLocationsMask) {
+		occupiedRoomsMask |= mask;
+	}
+}
+
+void PresenceHandler::clearRecords() {
+	for (auto& record : records) {
+		TimerWheel::getInstance().cancel(record.timeout);
+	}
+	usedRecordsMask = 0;
+	occupiedRoomsMask = 0;
+	for (auto& mask : profileLocationsMask) {
+		mask = 0;
+	}
+}
+
+void PresenceHandler::onRecordTimeout(void* context) {
+	uint8_t index = static_cast<PresenceRecord*>(context) - records;
+
+	auto prevdescription = getCurrentPresenceDescription();
+	sendPresenceChange(PresenceChange::PROFILE_LOCATION_EXIT, records[index].who, records[index].where);
+	removeRecord(index);
+	auto nextdescription = getCurrentPresenceDescription();
+	auto mutation = getMutationType(prevdescription, nextdescription);
+
+	switch (mutation) {
+		case MutationType::LastUserExitSphere: {
+			sendPresenceChange(PresenceChange::LAST_SPHERE_EXIT);
+			sendPresenceChange(PresenceChange::PROFILE_SPHERE_EXIT, 0);
+			break;
+		}
+		default:
+			break;
+	}
 }
 
 void PresenceHandler::triggerPresenceMutation(MutationType mutationtype) {
@@ -266,50 +334,7 @@ std::optional<PresenceStateDescription> PresenceHandler::getCurrentPresenceDescr
 		LOGPresenceHandlerDebug("presence_uncertain_due_reboot_time_out_s hasn't expired");
 		return {};
 	}
-	PresenceStateDescription presence;
-	for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end(); ++iter) {
-		if (iter->timeoutCountdownSeconds == 0) {
-			// Should not happen, record should've been removed.
-			LOGw("timed out record");
-		}
-		else {
-			// appearently iter is valid, so the .where field describes an occupied room.
-			presence.setRoom(iter->where);
-			// LOGPresenceHandlerDebug("adding room %d to currentPresenceDescription", iter->where);
-		}
-	}
-	return presence;
-}
-
-void PresenceHandler::tickSecond() {
-	auto prevdescription = getCurrentPresenceDescription();
-	for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end();) {
-		if (iter->timeoutCountdownSeconds) {
-			iter->timeoutCountdownSeconds--;
-		}
-		if (iter->timeoutCountdownSeconds == 0) {
-			sendPresenceChange(PresenceChange::PROFILE_LOCATION_EXIT, iter->who, iter->where);
-			iter = WhenWhoWhere.erase(iter);
-		}
-		else {
-			if (iter->meshSendCountdownSeconds) {
-				iter->meshSendCountdownSeconds--;
-			}
-			++iter;
-		}
-	}
-	auto nextdescription = getCurrentPresenceDescription();
-	auto mutation = getMutationType(prevdescription, nextdescription);
-
-	switch (mutation) {
-		case MutationType::LastUserExitSphere: {
-			sendPresenceChange(PresenceChange::LAST_SPHERE_EXIT);
-			sendPresenceChange(PresenceChange::PROFILE_SPHERE_EXIT, 0);
-			break;
-		}
-		default:
-			break;
-	}
+	return PresenceStateDescription(occupiedRoomsMask);
 }
 
 void PresenceHandler::print() {
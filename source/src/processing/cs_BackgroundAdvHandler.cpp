@@ -10,9 +10,11 @@
 #include <processing/cs_BackgroundAdvHandler.h>
 #include <ble/cs_Nordic.h>
 #include <logging/cs_Logger.h>
+#include <encryption/cs_KeysAndAccess.h>
 #include <encryption/cs_RC5.h>
 #include <events/cs_EventDispatcher.h>
 #include <processing/cs_CommandHandler.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <storage/cs_State.h>
 #include <time/cs_SystemTime.h>
 #include <util/cs_Utils.h>
@@ -33,6 +35,12 @@
 #define BACKGROUND_SERVICES_MASK_HEADER_LEN 3
 #define BACKGROUND_SERVICES_MASK_LEN 16
 
+// Each of the 3 parts of the majority vote is 42 bits, starting with 2 bits protocol and 8 bits sphere id.
+#define BACKGROUND_PART_MASK 0x03FFFFFFFFFF
+#define BACKGROUND_PART_HEADER_MASK 0x03FF00000000
+#define BACKGROUND_PART_PROTOCOL_MASK 0x030000000000
+#define BACKGROUND_PART_PROTOCOL_1 0x010000000000
+
 BackgroundAdvertisementHandler::BackgroundAdvertisementHandler() {
 	State::getInstance().get(CS_TYPE::CONFIG_SPHERE_ID, &_sphereId, sizeof(_sphereId));
 	EventDispatcher::getInstance().addListener(this);
@@ -136,9 +144,9 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 
 	// Divide the data into 3 parts, and do a bitwise majority vote, to correct for errors.
 	// Each part is 42 bits.
-	uint64_t part1 = (left >> (64-42)) & 0x03FFFFFFFFFF; // First 42 bits from left.
+	uint64_t part1 = (left >> (64-42)) & BACKGROUND_PART_MASK; // First 42 bits from left.
 	uint64_t part2 = ((left & 0x3FFFFF) << 20) | ((right >> (64-20)) & 0x0FFFFF); // Last 64-42=22 bits from left, and first 42−(64−42)=20 bits from right.
-	uint64_t part3 = (right >> 2) & 0x03FFFFFFFFFF; // Bits 21-62 from right.
+	uint64_t part3 = (right >> 2) & BACKGROUND_PART_MASK; // Bits 21-62 from right.
 	uint64_t result = ((part1 & part2) | (part2 & part3) | (part1 & part3)); // The majority vote
 	LOGBackgroundAdvVerbose("part1=0x%08X%08X part2=0x%08X%08X part3=0x%08X%08X result=0x%08X%08X",
 			(uint32_t)(part1 >> 32), (uint32_t)(part1),
@@ -146,6 +154,14 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 			(uint32_t)(part3 >> 32), (uint32_t)(part3),
 			(uint32_t)(result >> 32), (uint32_t)(result));
 
+	// Most advertisements are from phones in other spheres, or not background advertisements at all.
+	// Reject those with a mask check of protocol and sphere id, before parsing any further.
+	if ((result & BACKGROUND_PART_PROTOCOL_MASK) != BACKGROUND_PART_PROTOCOL_1
+			&& (result & BACKGROUND_PART_HEADER_MASK) != ((uint64_t)_sphereId << 32)) {
+		LOGBackgroundAdvVerbose("wrong protocol or sphereId");
+		return;
+	}
+
 	// Parse the resulting data.
 	uint8_t protocol = (result >> (42-2)) & 0x03;
 
@@ -161,6 +177,7 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 		parsed.deviceToken[1] = (result >> (42-2-8-8)) & 0xFF;
 		parsed.deviceToken[2] = (result >> (42-2-8-8-8)) & 0xFF;
 		LOGBackgroundAdvDebug("v1 token=[%u %u %u]", parsed.deviceToken[0], parsed.deviceToken[1], parsed.deviceToken[2]);
+		ScanPipelineStats::getInstance().count(SCAN_PIPELINE_BACKGROUND_PARSED);
 		event_t event(CS_TYPE::EVT_ADV_BACKGROUND_PARSED_V1, &parsed, sizeof(parsed));
 		EventDispatcher::getInstance().dispatch(event);
 		return;
@@ -178,17 +195,11 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 	encryptedPayload[1] = (result >> (42-2-8-32)) & 0xFFFF;
 	backgroundAdvertisement.macAddress = scannedDevice->address;
 	backgroundAdvertisement.rssi = scannedDevice->rssi;
-
-	if (backgroundAdvertisement.protocol != 0 || backgroundAdvertisement.sphereId != _sphereId) {
-		LOGBackgroundAdvVerbose("wrong protocol (%u) or sphereId (%u vs %u)", backgroundAdvertisement.protocol, backgroundAdvertisement.sphereId, _sphereId);
-		return;
-	}
+	// Protocol 0 with our sphere id is the only other option the mask check above lets through.
 
 	LOGBackgroundAdvVerbose("encrypted=[%u %u]", encryptedPayload[0], encryptedPayload[1]);
-	// TODO: can decrypt to same buffer?
 	uint16_t decryptedPayload[2];
-	bool success = RC5::getInstance().decrypt(encryptedPayload, sizeof(encryptedPayload), decryptedPayload, sizeof(decryptedPayload));
-	if (!success) {
+	if (!decryptPayload(encryptedPayload, decryptedPayload)) {
 		return;
 	}
 	LOGBackgroundAdvVerbose("decrypted=[%u %u]", decryptedPayload[0], decryptedPayload[1]);
@@ -220,6 +231,40 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 	handleBackgroundAdvertisement(&backgroundAdvertisement);
 }
 
+bool BackgroundAdvertisementHandler::decryptPayload(uint16_t encryptedPayload[2], uint16_t decryptedPayload[2]) {
+	// The decrypted payload depends on the key, so start over when the keys changed.
+	uint8_t keysVersion = KeysAndAccess::getInstance().getKeysVersion();
+	if (keysVersion != _replayCacheKeysVersion) {
+		_replayCacheSize = 0;
+		_replayCacheNextIndex = 0;
+		_replayCacheKeysVersion = keysVersion;
+	}
+
+	uint32_t encrypted = ((uint32_t)encryptedPayload[0] << 16) | encryptedPayload[1];
+	for (uint8_t i = 0; i < _replayCacheSize; ++i) {
+		if (_replayCache[i].encryptedPayload == encrypted) {
+			LOGBackgroundAdvVerbose("replay cache hit index=%u", i);
+			decryptedPayload[0] = _replayCache[i].decryptedPayload[0];
+			decryptedPayload[1] = _replayCache[i].decryptedPayload[1];
+			return true;
+		}
+	}
+
+	if (!RC5::getInstance().decrypt(encryptedPayload, sizeof(uint16_t) * 2, decryptedPayload, sizeof(uint16_t) * 2)) {
+		return false;
+	}
+
+	// Overwrite the oldest entry.
+	_replayCache[_replayCacheNextIndex].encryptedPayload = encrypted;
+	_replayCache[_replayCacheNextIndex].decryptedPayload[0] = decryptedPayload[0];
+	_replayCache[_replayCacheNextIndex].decryptedPayload[1] = decryptedPayload[1];
+	_replayCacheNextIndex = (_replayCacheNextIndex + 1) % BACKGROUND_ADV_REPLAY_CACHE_SIZE;
+	if (_replayCacheSize < BACKGROUND_ADV_REPLAY_CACHE_SIZE) {
+		++_replayCacheSize;
+	}
+	return true;
+}
+
 void BackgroundAdvertisementHandler::handleBackgroundAdvertisement(adv_background_t* backgroundAdvertisement) {
 	if (backgroundAdvertisement->dataSize != sizeof(uint16_t) * 2) {
 		return;
@@ -247,6 +292,7 @@ void BackgroundAdvertisementHandler::handleBackgroundAdvertisement(adv_backgroun
 	uint8_t rssiOffset = (decryptedPayload[1] >> (16-6-3-4)) & 0x0F;
 	parsed.flags =       (decryptedPayload[1] >> (16-6-3-4-3)) & 0x07;
 	parsed.adjustedRssi = getAdjustedRssi(backgroundAdvertisement->rssi, rssiOffset);
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_BACKGROUND_PARSED);
 	LOGBackgroundAdvDebug("validation=%u locationId=%u profileId=%u rssiOffset=%u flags=%u rssi=%i adjusted_rssi=%i", decryptedPayload[0], parsed.locationId, parsed.profileId, rssiOffset, parsed.flags, backgroundAdvertisement->rssi, parsed.adjustedRssi);
 	event_t event(CS_TYPE::EVT_ADV_BACKGROUND_PARSED, &parsed, sizeof(parsed));
 	EventDispatcher::getInstance().dispatch(event);
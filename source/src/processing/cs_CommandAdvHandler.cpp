@@ -12,9 +12,11 @@
 #include <encryption/cs_RC5.h>
 #include <events/cs_EventDispatcher.h>
 #include <processing/cs_CommandAdvHandler.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <storage/cs_State.h>
 #include <time/cs_SystemTime.h>
 #include <util/cs_BleError.h>
+#include <util/cs_Hash.h>
 #include <util/cs_Utils.h>
 
 // Defines to enable extra debug logs.
@@ -37,6 +39,12 @@
 #error "Timeout counter will overflow."
 #endif
 
+#if CMD_ADV_RECENT_TIME_MS / TICK_INTERVAL_MS > 250
+#error "Recent timeout counter will overflow."
+#endif
+
+static_assert((CMD_ADV_RECENT_TABLE_SIZE & (CMD_ADV_RECENT_TABLE_SIZE - 1)) == 0, "Recent table size must be a power of 2.");
+
 constexpr int8_t RSSI_LOG_THRESHOLD = -40;
 
 CommandAdvHandler::CommandAdvHandler() {
@@ -156,6 +164,8 @@ void CommandAdvHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
 	nonceData.data = nonce;
 	nonceData.len = sizeof(nonce);
 
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_COMMAND_RECEIVED);
+
 	uint16_t decryptedPayloadRC5[2];
 	bool validated = handleEncryptedCommandPayload(scannedDevice, header, nonceData, services128bit, encryptedPayloadRC5, decryptedPayloadRC5);
 	if (validated) {
@@ -215,7 +225,60 @@ void CommandAdvHandler::tickClaims() {
 	}
 }
 
+command_adv_recent_t* CommandAdvHandler::findRecent(uint32_t hash, const cs_data_t& nonce, const cs_data_t& encryptedData) {
+	assert(nonce.len == sizeof(command_adv_recent_t::nonce) && encryptedData.len == CMD_ADC_ENCRYPTED_DATA_SIZE, "Invalid size");
+	// The decrypted data depends on the keys, so forget everything when the keys changed.
+	uint8_t keysVersion = KeysAndAccess::getInstance().getKeysVersion();
+	if (keysVersion != _recentKeysVersion) {
+		for (int i = 0; i < CMD_ADV_RECENT_TABLE_SIZE; ++i) {
+			_recent[i].timeoutCounter = 0;
+		}
+		_recentKeysVersion = keysVersion;
+	}
+
+	command_adv_recent_t& recent = _recent[hash & (CMD_ADV_RECENT_TABLE_SIZE - 1)];
+	// The hash is only used as index: the advertisement has to be exactly the same.
+	if (recent.timeoutCounter
+			&& memcmp(recent.nonce, nonce.data, sizeof(recent.nonce)) == 0
+			&& memcmp(recent.encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE) == 0) {
+		return &recent;
+	}
+	return nullptr;
+}
+
+void CommandAdvHandler::addRecent(uint32_t hash, const cs_data_t& nonce, const cs_data_t& encryptedData, uint16_t decryptedRC5[2]) {
+	assert(nonce.len == sizeof(command_adv_recent_t::nonce) && encryptedData.len == CMD_ADC_ENCRYPTED_DATA_SIZE, "Invalid size");
+	// Simply overwrite whatever was in this slot.
+	command_adv_recent_t& recent = _recent[hash & (CMD_ADV_RECENT_TABLE_SIZE - 1)];
+	memcpy(recent.nonce, nonce.data, sizeof(recent.nonce));
+	memcpy(recent.encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE);
+	recent.timeoutCounter = CMD_ADV_RECENT_TIME_MS / TICK_INTERVAL_MS;
+	recent.decryptedRC5[0] = decryptedRC5[0];
+	recent.decryptedRC5[1] = decryptedRC5[1];
+}
+
+void CommandAdvHandler::tickRecent() {
+	for (int i = 0; i < CMD_ADV_RECENT_TABLE_SIZE; ++i) {
+		if (_recent[i].timeoutCounter) {
+			--_recent[i].timeoutCounter;
+		}
+	}
+}
+
 bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedDevice, const command_adv_header_t& header, const cs_data_t& nonce, cs_data_t& encryptedPayload, uint16_t encryptedPayloadRC5[2], uint16_t decryptedPayloadRC5[2]) {
+	// The nonce consists of all 16 bit service UUIDs, so together with the encrypted payload it covers the whole advertisement.
+	uint32_t hash = Fletcher(nonce.data, nonce.len);
+	hash = Fletcher(encryptedPayload.data, encryptedPayload.len, hash);
+	command_adv_recent_t* recent = findRecent(hash, nonce, encryptedPayload);
+	if (recent != nullptr) {
+		LOGCommandAdvVerbose("Recently handled");
+		ScanPipelineStats::getInstance().count(SCAN_PIPELINE_COMMAND_RECENT_HIT);
+		// Command was already handled, only the RC5 payload has to be handled.
+		decryptedPayloadRC5[0] = recent->decryptedRC5[0];
+		decryptedPayloadRC5[1] = recent->decryptedRC5[1];
+		return true;
+	}
+
 	int claimIndex = checkSimilarCommand(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5[1]);
 	if (claimIndex == -2) {
 		LOGCommandAdvVerbose("Ignore already handled command");
@@ -250,11 +313,11 @@ bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedD
 	// TODO: can decrypt to same buffer?
 	cs_ret_code_t decryptionResult = ERR_NO_ACCESS;
 	uint8_t decryptedData[AES_BLOCK_SIZE];
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
 	cs_buffer_size_t decryptedPayloadSize;
-	if (KeysAndAccess::getInstance().getKey(accessLevel, key, sizeof(key))) {
+	cs_data_t key = KeysAndAccess::getInstance().getKey(accessLevel);
+	if (key.data != nullptr) {
 		decryptionResult = AES::getInstance().decryptCtr(
-				cs_data_t(key, sizeof(key)),
+				key,
 				nonce,
 				encryptedPayload,
 				cs_data_t(),
@@ -266,6 +329,7 @@ bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedD
 		LOGCommandAdvVerbose("Decrypt failed");
 		return false;
 	}
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_COMMAND_DECRYPTED);
 
 #ifdef COMMAND_ADV_VERBOSE
 	_log(SERIAL_DEBUG, false, "decrypted data: ");
@@ -297,11 +361,14 @@ bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedD
 		return false;
 	}
 	// Validated, so from here on, return true.
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_COMMAND_VALIDATED);
 
 	// Claim only after validation
 	if (!claim(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5[1], claimIndex)) {
+		// Don't remember it as handled, so it's handled once there is a claim spot.
 		return true;
 	}
+	addRecent(hash, nonce, encryptedPayload, decryptedPayloadRC5);
 
 	cmd_source_with_counter_t source(cmd_source_t(CS_CMD_SOURCE_TYPE_BROADCAST, header.deviceToken), (decryptedPayloadRC5[0] >> 8) & 0xFF);
 	TYPIFY(CMD_CONTROL_CMD) controlCmd;
@@ -446,6 +513,7 @@ void CommandAdvHandler::handleEvent(event_t & event) {
 		}
 		case CS_TYPE::EVT_TICK: {
 			tickClaims();
+			tickRecent();
 			break;
 		}
 		default:
@@ -196,6 +196,10 @@ void CommandHandler::handleCommand(
 			return dispatchEventForCommand(CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS, commandData, source, result);
 		case CTRL_CMD_GET_RAM_STATS:
 			return dispatchEventForCommand(CS_TYPE::CMD_GET_RAM_STATS, commandData, source, result);
+		case CTRL_CMD_GET_ADC_PROCESSING_STATS:
+			return dispatchEventForCommand(CS_TYPE::CMD_GET_ADC_PROCESSING_STATS, commandData, source, result);
+		case CTRL_CMD_GET_POWER_HARMONICS:
+			return dispatchEventForCommand(CS_TYPE::CMD_GET_POWER_HARMONICS, commandData, source, result);
 		case CTRL_CMD_MICROAPP_GET_INFO:
 			return dispatchEventForCommand(CS_TYPE::CMD_MICROAPP_GET_INFO, commandData, source, result);
 		case CTRL_CMD_MICROAPP_VALIDATE:
@@ -206,6 +210,8 @@ void CommandHandler::handleCommand(
 			return dispatchEventForCommand(CS_TYPE::CMD_MICROAPP_ENABLE, commandData, source, result);
 		case CTRL_CMD_MICROAPP_DISABLE:
 			return dispatchEventForCommand(CS_TYPE::CMD_MICROAPP_DISABLE, commandData, source, result);
+		case CTRL_CMD_MICROAPP_GET_CPU_STATS:
+			return dispatchEventForCommand(CS_TYPE::CMD_MICROAPP_GET_CPU_STATS, commandData, source, result);
 		case CTRL_CMD_CLEAN_FLASH:
 			return dispatchEventForCommand(CS_TYPE::CMD_STORAGE_GARBAGE_COLLECT, commandData, source, result);
 		case CTRL_CMD_FILTER_UPLOAD:
@@ -1026,12 +1032,15 @@ EncryptionAccessLevel CommandHandler::getRequiredAccessLevel(const CommandHandle
 		case CTRL_CMD_GET_GPREGRET:
 		case CTRL_CMD_GET_ADC_CHANNEL_SWAPS:
 		case CTRL_CMD_GET_RAM_STATS:
+		case CTRL_CMD_GET_ADC_PROCESSING_STATS:
+		case CTRL_CMD_GET_POWER_HARMONICS:
 		case CTRL_CMD_MICROAPP_GET_INFO:
 		case CTRL_CMD_MICROAPP_UPLOAD:
 		case CTRL_CMD_MICROAPP_VALIDATE:
 		case CTRL_CMD_MICROAPP_REMOVE:
 		case CTRL_CMD_MICROAPP_ENABLE:
 		case CTRL_CMD_MICROAPP_DISABLE:
+		case CTRL_CMD_MICROAPP_GET_CPU_STATS:
 		case CTRL_CMD_CLEAN_FLASH:
 		case CTRL_CMD_FILTER_UPLOAD:
 		case CTRL_CMD_FILTER_REMOVE:
@@ -0,0 +1,130 @@
+/**
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <processing/cs_PowerHarmonics.h>
+#include <protocol/cs_ErrorCodes.h>
+
+#include <cmath>
+
+namespace {
+constexpr float PI = 3.14159265358979f;
+
+int32_t toFixedPoint(float value, uint8_t fractionBits) {
+	return (int32_t)lroundf(value * (float)((int32_t)1 << fractionBits));
+}
+
+int16_t toPermille(float value) {
+	return (int16_t)lroundf(value * 1000);
+}
+
+uint16_t toUint16(float value) {
+	if (value > UINT16_MAX) {
+		return UINT16_MAX;
+	}
+	return (uint16_t)lroundf(value);
+}
+}
+
+cs_ret_code_t PowerHarmonics::init(uint16_t numSamples) {
+	// The fundamental must be below the Nyquist frequency.
+	if (numSamples < 3 || numSamples > CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL) {
+		return ERR_WRONG_PARAMETER;
+	}
+	_harmonicCount = 0;
+	for (uint8_t i = 0; i < POWER_HARMONICS_COUNT; ++i) {
+		uint16_t harmonic = 2 * i + 1;
+		if (2 * harmonic >= numSamples) {
+			break;
+		}
+		float w = 2 * PI * harmonic / numSamples;
+		_coefficients[i].coefficient = toFixedPoint(2 * cosf(w), COEFFICIENT_FRACTION_BITS);
+		_coefficients[i].cos = toFixedPoint(cosf(w), COEFFICIENT_FRACTION_BITS);
+		_coefficients[i].sin = toFixedPoint(sinf(w), COEFFICIENT_FRACTION_BITS);
+		_harmonicCount++;
+	}
+	_numSamples = numSamples;
+	return ERR_SUCCESS;
+}
+
+void PowerHarmonics::update(goertzel_state_t& state, int32_t coefficient, int32_t sample) {
+	int32_t product = ((int64_t)coefficient * state.prev + ((int64_t)1 << (COEFFICIENT_FRACTION_BITS - 1))) >> COEFFICIENT_FRACTION_BITS;
+	int32_t output = sample + product - state.prevPrev;
+	state.prevPrev = state.prev;
+	state.prev = output;
+}
+
+void PowerHarmonics::getBin(const goertzel_state_t& state, const goertzel_coefficients_t& coefficients, float& real, float& imag) {
+	int64_t realFixed = ((int64_t)state.prev << COEFFICIENT_FRACTION_BITS) - (int64_t)coefficients.cos * state.prevPrev;
+	int64_t imagFixed = (int64_t)coefficients.sin * state.prevPrev;
+	real = (float)realFixed / (float)((int32_t)1 << COEFFICIENT_FRACTION_BITS);
+	imag = (float)imagFixed / (float)((int32_t)1 << COEFFICIENT_FRACTION_BITS);
+}
+
+void PowerHarmonics::analyse(
+		const adc_sample_value_t* samples,
+		uint8_t channelCount,
+		uint8_t voltageChannel,
+		uint8_t currentChannel,
+		int32_t voltageZero,
+		int32_t currentZero,
+		float currentMultiplier,
+		cs_power_harmonics_t& result) {
+	goertzel_state_t voltageState;
+	goertzel_state_t currentStates[POWER_HARMONICS_COUNT];
+
+	// The int64_t sums are large enough, see PowerSampling::calculatePower().
+	int64_t pSum = 0;
+	int64_t vSquareSum = 0;
+	int64_t cSquareSum = 0;
+
+	for (uint16_t i = 0; i < _numSamples; ++i) {
+		// Round to whole sample values, this is only a small error for the power factor, and none for the harmonics.
+		int32_t voltage = ((int32_t)samples[i * channelCount + voltageChannel] * 1024 - voltageZero + 512) >> 10;
+		int32_t current = ((int32_t)samples[i * channelCount + currentChannel] * 1024 - currentZero + 512) >> 10;
+		pSum += (int64_t)voltage * current;
+		vSquareSum += (int64_t)voltage * voltage;
+		cSquareSum += (int64_t)current * current;
+
+		update(voltageState, _coefficients[0].coefficient, voltage);
+		for (uint8_t h = 0; h < _harmonicCount; ++h) {
+			update(currentStates[h], _coefficients[h].coefficient, current);
+		}
+	}
+
+	// The multipliers cancel out in the power factor.
+	float apparentPowerSquared = (float)vSquareSum * (float)cSquareSum;
+	result.powerFactor = apparentPowerSquared > 0 ? toPermille(pSum / sqrtf(apparentPowerSquared)) : 0;
+
+	float voltageReal, voltageImag;
+	getBin(voltageState, _coefficients[0], voltageReal, voltageImag);
+	float voltageMagnitude = sqrtf(voltageReal * voltageReal + voltageImag * voltageImag);
+
+	// RMS of a sine with the amplitude of a bin.
+	float binToMilliAmp = sqrtf(2.0f) / _numSamples * currentMultiplier * 1000;
+	float fundamentalMagnitude = 0;
+	float harmonicsSquareSum = 0;
+	for (uint8_t h = 0; h < POWER_HARMONICS_COUNT; ++h) {
+		if (h >= _harmonicCount) {
+			result.currentHarmonicsMilliAmp[h] = 0;
+			continue;
+		}
+		float real, imag;
+		getBin(currentStates[h], _coefficients[h], real, imag);
+		float magnitudeSquared = real * real + imag * imag;
+		float magnitude = sqrtf(magnitudeSquared);
+		result.currentHarmonicsMilliAmp[h] = toUint16(magnitude * binToMilliAmp);
+		if (h == 0) {
+			fundamentalMagnitude = magnitude;
+			float magnitudes = voltageMagnitude * magnitude;
+			result.displacementPowerFactor = magnitudes > 0 ? toPermille((voltageReal * real + voltageImag * imag) / magnitudes) : 0;
+		}
+		else {
+			harmonicsSquareSum += magnitudeSquared;
+		}
+	}
+	result.currentThd = fundamentalMagnitude > 0 ? toUint16(sqrtf(harmonicsSquareSum) / fundamentalMagnitude * 1000) : 0;
+}
@@ -18,7 +18,6 @@
 #include "storage/cs_State.h"
 #include "structs/buffer/cs_AdcBuffer.h"
 #include "third/SortMedian.h"
-#include "third/optmed.h"
 #include "time/cs_SystemTime.h"
 
 #include <cmath>
@@ -51,25 +50,14 @@
 #endif
 
 PowerSampling::PowerSampling() :
-		_bufferQueue(CS_ADC_NUM_BUFFERS),
+		_bufferQueue(numFilteredBuffersForProcessing + numUnfilteredBuffers),
 		_switchHist(switchHistSize)
 {
 	_adc = &(ADC::getInstance());
 	_powerMilliWattHist = new CircularBuffer<int32_t>(POWER_SAMPLING_RMS_WINDOW_SIZE);
-	_currentRmsMilliAmpHist = new CircularBuffer<int32_t>(POWER_SAMPLING_RMS_WINDOW_SIZE);
-	_voltageRmsMilliVoltHist = new CircularBuffer<int32_t>(POWER_SAMPLING_RMS_WINDOW_SIZE);
-	_filteredCurrentRmsHistMA = new CircularBuffer<int32_t>(POWER_SAMPLING_RMS_WINDOW_SIZE);
 	_logsEnabled.asInt = 0;
 }
 
-#if POWER_SAMPLING_RMS_WINDOW_SIZE == 7
-#define opt_med(arr) opt_med7(arr)
-#elif POWER_SAMPLING_RMS_WINDOW_SIZE == 9
-#define opt_med(arr) opt_med9(arr)
-#elif POWER_SAMPLING_RMS_WINDOW_SIZE == 25
-#define opt_med(arr) opt_med25(arr)
-#endif
-
 #ifdef PRINT_POWER_SAMPLES
 static int printPower = 0;
 #endif
@@ -91,6 +79,14 @@ void PowerSampling::init(const boards_config_t& boardConfig) {
 	settings.get(CS_TYPE::CONFIG_SOFT_FUSE_CURRENT_THRESHOLD, &_currentMilliAmpThreshold, sizeof(_currentMilliAmpThreshold));
 	settings.get(CS_TYPE::CONFIG_SOFT_FUSE_CURRENT_THRESHOLD_DIMMER, &_currentMilliAmpThresholdDimmer, sizeof(_currentMilliAmpThresholdDimmer));
 	bool switchcraftEnabled = settings.isTrue(CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED);
+	TYPIFY(CONFIG_ADC_SAMPLING_PROFILE) samplingProfile;
+	settings.get(CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE, &samplingProfile, sizeof(samplingProfile));
+	initSamplingProfile((AdcSamplingProfile)samplingProfile);
+	TYPIFY(STATE_ENERGY_CHECKPOINT) energyCheckpoint;
+	settings.get(CS_TYPE::STATE_ENERGY_CHECKPOINT, &energyCheckpoint, sizeof(energyCheckpoint));
+	_energyUsedmicroJoule = energyCheckpoint.energyMicroJoule;
+	_checkpointEnergyMicroJoule = energyCheckpoint.energyMicroJoule;
+	LOGi("Energy checkpoint: %i J at %u", (int32_t)(energyCheckpoint.energyMicroJoule / 1000000), energyCheckpoint.unixTimestamp);
 
 	switch (boardConfig.hardwareBoard) {
 		// Builtin zero
@@ -141,22 +137,8 @@ void PowerSampling::init(const boards_config_t& boardConfig) {
 
 	LOGi(FMT_INIT, "buffers");
 	_powerMilliWattHist->init(); // Allocates buffer
-	_currentRmsMilliAmpHist->init(); // Allocates buffer
-	_voltageRmsMilliVoltHist->init(); // Allocates buffer
-	_filteredCurrentRmsHistMA->init(); // Allocates buffer
 	_switchHist.init(); // Allocates buffer
 
-	// Init moving median filter
-	unsigned halfWindowSize = POWER_SAMPLING_CURVE_HALF_WINDOW_SIZE;
-//	unsigned halfWindowSize = 5;  // Takes 0.74ms
-//	unsigned halfWindowSize = 16; // Takes 0.93ms
-	unsigned windowSize = halfWindowSize * 2 + 1;
-	uint16_t bufSize = AdcBuffer::getInstance().getChannelLength();
-	unsigned blockCount = (bufSize + halfWindowSize*2) / windowSize; // Shouldn't have a remainder!
-	_filterParams = new MedianFilter(halfWindowSize, blockCount);
-	_inputSamples = new PowerVector(bufSize + halfWindowSize*2);
-	_outputSamples = new PowerVector(bufSize);
-
 	LOGd(FMT_INIT, "ADC");
 	adc_config_t adcConfig;
 	adcConfig.channelCount = 2;
@@ -166,11 +148,37 @@ void PowerSampling::init(const boards_config_t& boardConfig) {
 	adcConfig.channels[CURRENT_CHANNEL_IDX].pin = boardConfig.pinAinCurrentGainLow;
 	adcConfig.channels[CURRENT_CHANNEL_IDX].rangeMilliVolt = boardConfig.currentRange;
 	adcConfig.channels[CURRENT_CHANNEL_IDX].referencePin = boardConfig.flags.hasAdcZeroRef ? boardConfig.pinAinZeroRef : CS_ADC_REF_PIN_NOT_AVAILABLE;
-	adcConfig.samplingIntervalUs = CS_ADC_SAMPLE_INTERVAL_US;
+	adcConfig.samplingIntervalUs = _samplingIntervalUs;
 	_adc->init(adcConfig);
 
 	_adc->setDoneCallback(adc_done_callback);
 
+	// Don't queue more buffers than the ADC can spare: leave 2 for the SAADC queue, and 1 that is handed over.
+	if (_maxQueuedBuffers > AdcBuffer::getInstance().getBufferCount() - 3) {
+		_maxQueuedBuffers = AdcBuffer::getInstance().getBufferCount() - 3;
+	}
+	LOGi("Sampling profile=%u interval=%uus buffers=%u queued=%u", _samplingProfile, _samplingIntervalUs, AdcBuffer::getInstance().getBufferCount(), _maxQueuedBuffers);
+
+	// Init moving median filter, now that the number of samples per buffer is known.
+	unsigned halfWindowSize = POWER_SAMPLING_CURVE_HALF_WINDOW_SIZE;
+//	unsigned halfWindowSize = 5;  // Takes 0.74ms
+//	unsigned halfWindowSize = 16; // Takes 0.93ms
+	unsigned windowSize = halfWindowSize * 2 + 1;
+	uint16_t bufSize = AdcBuffer::getInstance().getChannelLength();
+	// Enough blocks for the result to cover the whole buffer, the input is padded up to the block size.
+	unsigned blockCount = (bufSize - 1 + windowSize - 1) / windowSize + 1;
+	_filterParams = new MedianFilter(halfWindowSize, blockCount);
+	_inputSamples = new PowerVector(_filterParams->n);
+	_outputSamples = new PowerVector(_filterParams->result);
+
+	_sampleCopyStep = (bufSize + AdcBuffer::getDefaultChannelLength() - 1) / AdcBuffer::getDefaultChannelLength();
+
+#if POWER_HARMONICS_INTERVAL_PERIODS > 0
+	if (_harmonics.init(bufSize) != ERR_SUCCESS) {
+		LOGw("Can't analyse harmonics with %u samples", bufSize);
+	}
+#endif
+
 	// init the adc config
 	_adcConfig.rangeMilliVolt[VOLTAGE_CHANNEL_IDX] = boardConfig.voltageRange;
 	_adcConfig.rangeMilliVolt[CURRENT_CHANNEL_IDX] = boardConfig.currentRange;
@@ -189,6 +197,10 @@ void PowerSampling::init(const boards_config_t& boardConfig) {
 	_lastSoftfuse.index = 0;
 	_lastSoftfuse.count = 0;
 	_lastSoftfuse.unixTimestamp = 0;
+
+	_adcProcessingStats.samplingProfile = _samplingProfile;
+	_adcProcessingStats.samplingIntervalUs = _samplingIntervalUs;
+	_adcProcessingStats.budgetUs = (uint32_t)CS_ADC_BUFFER_DURATION_US * CS_ADC_PROCESSING_BUDGET_PERCENT / 100;
 //	_lastSoftfuse.delayUs = 0;
 //	_lastSoftfuse.sampleIntervalUs = CS_ADC_SAMPLE_INTERVAL_US;
 //	_lastSoftfuse.offset = 0;
@@ -201,6 +213,25 @@ void PowerSampling::init(const boards_config_t& boardConfig) {
 	_isInitialized = true;
 }
 
+void PowerSampling::initSamplingProfile(AdcSamplingProfile profile) {
+	switch (profile) {
+		case ADC_SAMPLING_PROFILE_DEFAULT:
+			_samplingIntervalUs = CS_ADC_SAMPLE_INTERVAL_US;
+			break;
+		case ADC_SAMPLING_PROFILE_HIGH_RATE:
+			_samplingIntervalUs = CS_ADC_SAMPLE_INTERVAL_HIGH_RATE_US;
+			break;
+		case ADC_SAMPLING_PROFILE_LOW_POWER:
+			_samplingIntervalUs = CS_ADC_SAMPLE_INTERVAL_LOW_POWER_US;
+			break;
+		default:
+			LOGw("Unknown sampling profile %u", profile);
+			initSamplingProfile(ADC_SAMPLING_PROFILE_DEFAULT);
+			return;
+	}
+	_samplingProfile = profile;
+}
+
 void PowerSampling::startSampling() {
 	LOGi(FMT_START, "power sample");
 
@@ -270,6 +301,30 @@ void PowerSampling::handleEvent(event_t & event) {
 			event.result.returnCode = ERR_SUCCESS;
 			break;
 		}
+		case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS: {
+			if (event.result.buf.len < sizeof(_adcProcessingStats)) {
+				event.result.returnCode = ERR_BUFFER_TOO_SMALL;
+				return;
+			}
+			memcpy(event.result.buf.data, &_adcProcessingStats, sizeof(_adcProcessingStats));
+			event.result.dataSize = sizeof(_adcProcessingStats);
+			event.result.returnCode = ERR_SUCCESS;
+			break;
+		}
+		case CS_TYPE::CMD_GET_POWER_HARMONICS: {
+			if (!_harmonicsAnalysed) {
+				event.result.returnCode = ERR_NOT_AVAILABLE;
+				return;
+			}
+			if (event.result.buf.len < sizeof(_lastHarmonics)) {
+				event.result.returnCode = ERR_BUFFER_TOO_SMALL;
+				return;
+			}
+			memcpy(event.result.buf.data, &_lastHarmonics, sizeof(_lastHarmonics));
+			event.result.dataSize = sizeof(_lastHarmonics);
+			event.result.returnCode = ERR_SUCCESS;
+			break;
+		}
 		case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS: {
 			if (event.result.buf.len < sizeof(_adcChannelSwaps)) {
 				event.result.returnCode = ERR_BUFFER_TOO_SMALL;
@@ -280,10 +335,17 @@ void PowerSampling::handleEvent(event_t & event) {
 			event.result.returnCode = ERR_SUCCESS;
 			break;
 		}
+		case CS_TYPE::EVT_BROWNOUT_IMPENDING:
+		case CS_TYPE::EVT_GOING_TO_DFU: {
+			// Write the energy to flash before the reset.
+			setEnergyCheckpoint();
+			State::getInstance().flushQueuedWrites();
+			break;
+		}
 		case CS_TYPE::EVT_ADC_RESTARTED: {
 			_adcRestarts.count++;
 			_adcRestarts.lastTimestamp = SystemTime::posix();
-			_bufferQueue.clear();
+			clearBufs();
 			UartHandler::getInstance().writeMsg(UART_OPCODE_TX_ADC_RESTART, NULL, 0);
 			//		RecognizeSwitch::getInstance().skip(2);
 			break;
@@ -298,6 +360,10 @@ void PowerSampling::handleEvent(event_t & event) {
 			if (_calibratePowerZeroCountDown) {
 				--_calibratePowerZeroCountDown;
 			}
+			if (--_energyCheckpointCountDown == 0) {
+				_energyCheckpointCountDown = 1000 / TICK_INTERVAL_MS;
+				setEnergyCheckpoint();
+			}
 //			toggleVoltageChannelInput();
 			break;
 		}
@@ -325,6 +391,35 @@ void PowerSampling::handleEvent(event_t & event) {
  * @param[in] bufIndex                           The buffer index, can be used in InterleavedBuffer.
  */
 void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
+	uint32_t startTicks = RTC::getCount();
+	processBuf(bufIndex);
+	updateProcessingStats(RTC::ticksToUs(RTC::difference(RTC::getCount(), startTicks)));
+}
+
+void PowerSampling::updateProcessingStats(uint32_t processingTimeUs) {
+	_adcProcessingStats.processedCount++;
+	_adcProcessingStats.lastProcessingUs = processingTimeUs;
+	if (processingTimeUs > _adcProcessingStats.maxProcessingUs) {
+		_adcProcessingStats.maxProcessingUs = processingTimeUs;
+	}
+	if (_adcProcessingStats.processedCount == 1) {
+		_adcProcessingStats.avgProcessingUs = processingTimeUs;
+	}
+	else {
+		// Exponential moving average, with a discount of 1/16.
+		_adcProcessingStats.avgProcessingUs = (15 * _adcProcessingStats.avgProcessingUs + processingTimeUs) / 16;
+	}
+	if (processingTimeUs > _adcProcessingStats.budgetUs) {
+		_adcProcessingStats.overBudgetCount++;
+		LOGPowerSamplingDebug("Over budget: %u us", processingTimeUs);
+	}
+	if (processingTimeUs > CS_ADC_BUFFER_DURATION_US) {
+		// The next buffer has been filled before this one was processed.
+		_adcProcessingStats.overrunCount++;
+	}
+}
+
+void PowerSampling::processBuf(adc_buffer_id_t bufIndex) {
 	adc_buffer_seq_nr_t seqNr = AdcBuffer::getInstance().getBuffer(bufIndex)->seqNr;
 	LOGPowerSamplingVerbose("bufId=%u seqNr=%u", bufIndex, seqNr);
 	PS_TEST_PIN_TOGGLE
@@ -332,15 +427,20 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 
 	if (!isConsecutiveBuf(seqNr, _lastBufSeqNr)) {
 		LOGw("buf skipped (prev=%u cur=%u)", _lastBufSeqNr, seqNr);
+		if (_adcProcessingStats.processedCount) {
+			// Only counts up to 255 skipped buffers at once, as the sequence nr wraps.
+			_adcProcessingStats.skippedCount += (adc_buffer_seq_nr_t)(seqNr - _lastBufSeqNr - 1);
+		}
 		// Clear buffer queue, as these are no longer consecutive.
-		_bufferQueue.clear();
+		clearBufs();
 	}
 	_lastBufSeqNr = seqNr;
 
 	if (!isValidBuf(bufIndex)) {
 		LOGPowerSamplingWarn("buf %u invalid", bufIndex);
 		// Clear buffer queue, as these are no longer valid.
-		_bufferQueue.clear();
+		clearBufs();
+		_adc->releaseBuffer(bufIndex);
 		return;
 	}
 
@@ -357,7 +457,8 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 	if (!isValidBuf(filteredBufIndex)) {
 		LOGPowerSamplingWarn("buf %u invalid", filteredBufIndex);
 		// Clear buffer queue, as these are no longer valid.
-		_bufferQueue.clear();
+		clearBufs();
+		_adc->releaseBuffer(bufIndex);
 		return;
 	}
 
@@ -365,7 +466,7 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 	_lastBufIndex = bufIndex;
 	_lastFilteredBufIndex = filteredBufIndex;
 
-	_bufferQueue.push(bufIndex);
+	pushBuf(bufIndex);
 
 	TYPIFY(STATE_SWITCH_STATE) switchState;
 	State::getInstance().get(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
@@ -377,7 +478,7 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 
 	if (!isValidBuf(filteredBufIndex)) {
 		LOGPowerSamplingWarn("buf %u invalid", filteredBufIndex);
-		_bufferQueue.clear();
+		clearBufs();
 		return;
 	}
 
@@ -414,8 +515,13 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 		LOGw("Failed to calculate power");
 	}
 
-	// TODO: if buffer is invalid, assume power remained similar and increase energy regardless?
-	calculateEnergy();
+	// When the power could not be calculated, assume the power remained similar.
+	calculateEnergy(seqNr);
+
+	if (bufIndex != filteredBufIndex) {
+		// Only the unfiltered samples can be used: the median filter attenuates the higher harmonics.
+		analyseHarmonics(bufIndex);
+	}
 
 	if (_operationMode == OperationMode::OPERATION_MODE_NORMAL) {
 //		int32_t powerUsage = _slowAvgPowerMilliWatt;
@@ -436,35 +542,45 @@ void PowerSampling::powerSampleAdcDone(adc_buffer_id_t bufIndex) {
 	}
 
 
-	if (_switchHist.size() >= 3) {
+	// The previous filtered buffer is only in the queue when enough buffers are queued.
+	if (_switchHist.size() >= 3 && _bufferQueue.size() >= 2 + numUnfilteredBuffers) {
 		if (_switchHist[_switchHist.size() - 2].asInt != _switchHist[_switchHist.size() - 1].asInt) {
 			// Switch changed state since previous buffer.
 			// Store the current and previous buffer.
 			adc_buffer_id_t prevFilteredBufferIndex = _bufferQueue[_bufferQueue.size() - 2 - numUnfilteredBuffers]; // Previous filtered buffer.
-			uint16_t count = AdcBuffer::getChannelLength();
+			uint16_t count = getCopySampleCount();
+			copySamples(prevFilteredBufferIndex, VOLTAGE_CHANNEL_IDX, _lastSwitchSamples + 0 * count);
+			copySamples(prevFilteredBufferIndex, CURRENT_CHANNEL_IDX, _lastSwitchSamples + 1 * count);
+			copySamples(filteredBufIndex, VOLTAGE_CHANNEL_IDX, _lastSwitchSamples + 2 * count);
+			copySamples(filteredBufIndex, CURRENT_CHANNEL_IDX, _lastSwitchSamples + 3 * count);
 			_lastSwitchSamplesHeader.type = POWER_SAMPLES_TYPE_SWITCH;
 			_lastSwitchSamplesHeader.count = count;
 			_lastSwitchSamplesHeader.unixTimestamp = SystemTime::posix();
 			_lastSwitchSamplesHeader.delayUs = 0;
-			_lastSwitchSamplesHeader.sampleIntervalUs = AdcBuffer::getInstance().getBuffer(prevFilteredBufferIndex)->config[0].samplingIntervalUs;
-			for (adc_sample_value_id_t i = 0; i < count; ++i) {
-				_lastSwitchSamples[i + 0 * count] = AdcBuffer::getInstance().getValue(prevFilteredBufferIndex, VOLTAGE_CHANNEL_IDX, i);
-				_lastSwitchSamples[i + 1 * count] = AdcBuffer::getInstance().getValue(prevFilteredBufferIndex, CURRENT_CHANNEL_IDX, i);
-				_lastSwitchSamples[i + 2 * count] = AdcBuffer::getInstance().getValue(filteredBufIndex, VOLTAGE_CHANNEL_IDX, i);
-				_lastSwitchSamples[i + 3 * count] = AdcBuffer::getInstance().getValue(filteredBufIndex, CURRENT_CHANNEL_IDX, i);
-			}
+			_lastSwitchSamplesHeader.sampleIntervalUs = AdcBuffer::getInstance().getBuffer(prevFilteredBufferIndex)->config[0].samplingIntervalUs * _sampleCopyStep;
 		}
 		else if (_switchHist[_switchHist.size() - 3].asInt != _switchHist[_switchHist.size() - 1].asInt) {
 			// Switch changed state in previous buffer.
-			uint16_t count = AdcBuffer::getChannelLength();
-			for (adc_sample_value_id_t i = 0; i < count; ++i) {
-				_lastSwitchSamples[i + 4 * count] = AdcBuffer::getInstance().getValue(filteredBufIndex, VOLTAGE_CHANNEL_IDX, i);
-				_lastSwitchSamples[i + 5 * count] = AdcBuffer::getInstance().getValue(filteredBufIndex, CURRENT_CHANNEL_IDX, i);
-			}
+			uint16_t count = getCopySampleCount();
+			copySamples(filteredBufIndex, VOLTAGE_CHANNEL_IDX, _lastSwitchSamples + 4 * count);
+			copySamples(filteredBufIndex, CURRENT_CHANNEL_IDX, _lastSwitchSamples + 5 * count);
 		}
 	}
 }
 
+uint16_t PowerSampling::getCopySampleCount() {
+	return (AdcBuffer::getInstance().getChannelLength() + _sampleCopyStep - 1) / _sampleCopyStep;
+}
+
+uint16_t PowerSampling::copySamples(adc_buffer_id_t bufIndex, adc_channel_id_t channel, adc_sample_value_t* samples) {
+	AdcBuffer& adcBuffer = AdcBuffer::getInstance();
+	uint16_t count = 0;
+	for (adc_sample_value_id_t i = 0; i < adcBuffer.getChannelLength(); i += _sampleCopyStep) {
+		samples[count++] = adcBuffer.getValue(bufIndex, channel, i);
+	}
+	return count;
+}
+
 void PowerSampling::initAverages() {
 	_avgZeroVoltage = _voltageZero * 1024;
 	_avgZeroCurrent = _currentZero * 1024;
@@ -494,11 +610,28 @@ void PowerSampling::removeInvalidBufs() {
 		// Remove this and older buffers from queue.
 		for (uint16_t i = 0; i <= newestInvalidIndex; ++i) {
 			LOGPowerSamplingDebug("remove buf %u from queue", _bufferQueue.peek());
-			_bufferQueue.pop();
+			popBuf();
 		}
 	}
 }
 
+void PowerSampling::pushBuf(adc_buffer_id_t bufIndex) {
+	while (!_bufferQueue.empty() && _bufferQueue.size() >= _maxQueuedBuffers) {
+		popBuf();
+	}
+	_bufferQueue.push(bufIndex);
+}
+
+void PowerSampling::popBuf() {
+	_adc->releaseBuffer(_bufferQueue.pop());
+}
+
+void PowerSampling::clearBufs() {
+	while (!_bufferQueue.empty()) {
+		popBuf();
+	}
+}
+
 /*
  * Other idea:
  * - compare Vrms[t-1] with Vrms[t] and Irms[t]. If Vrms[t-1] is more similar to Irms[t] than to Vrms[t], then swapped.
@@ -522,7 +655,7 @@ bool PowerSampling::isVoltageAndCurrentSwapped(adc_buffer_id_t bufIndex, adc_buf
 	int16_t minVoltageSample =   INT16_MAX;
 	int16_t minCurrentSample =   INT16_MAX;
 
-	for (adc_sample_value_id_t i =0; i < AdcBuffer::getChannelLength(); ++i) {
+	for (adc_sample_value_id_t i =0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
 		prevSample = AdcBuffer::getInstance().getValue(prevBufIndex, VOLTAGE_CHANNEL_IDX, i);
 		voltageSample = AdcBuffer::getInstance().getValue(bufIndex, VOLTAGE_CHANNEL_IDX, i);
 		currentSample = AdcBuffer::getInstance().getValue(bufIndex, CURRENT_CHANNEL_IDX, i);
@@ -557,7 +690,7 @@ bool PowerSampling::isVoltageAndCurrentSwapped(adc_buffer_id_t bufIndex, adc_buf
 void PowerSampling::calculateVoltageZero(adc_buffer_id_t bufIndex) {
 	// Simply use the average of an AC period.
 	adc_sample_value_id_t numSamples = AC_PERIOD_US / AdcBuffer::getInstance().getBuffer(bufIndex)->config[VOLTAGE_CHANNEL_IDX].samplingIntervalUs;
-	assert(numSamples <= AdcBuffer::getChannelLength(), "Not enough samples");
+	assert(numSamples <= AdcBuffer::getInstance().getChannelLength(), "Not enough samples");
 
 	int64_t sum = 0;
 	for (adc_sample_value_id_t i = 0; i < numSamples; ++i) {
@@ -592,7 +725,7 @@ void PowerSampling::calculateVoltageZero(adc_buffer_id_t bufIndex) {
 void PowerSampling::calculateCurrentZero(adc_buffer_id_t bufIndex) {
 	// Simply use the average of an AC period.
 	adc_sample_value_id_t numSamples = AC_PERIOD_US / AdcBuffer::getInstance().getBuffer(bufIndex)->config[CURRENT_CHANNEL_IDX].samplingIntervalUs;
-	assert(numSamples <= AdcBuffer::getChannelLength(), "Not enough samples");
+	assert(numSamples <= AdcBuffer::getInstance().getChannelLength(), "Not enough samples");
 
 	int64_t sum = 0;
 	for (adc_sample_value_id_t i = 0; i < numSamples; ++i) {
@@ -659,38 +792,46 @@ void PowerSampling::calculateCurrentZero(adc_buffer_id_t bufIndex) {
  */
 void PowerSampling::filter(adc_buffer_id_t bufIndexIn, adc_buffer_id_t bufIndexOut, adc_channel_id_t channel_id) {
 
+	// Both buffers are held, so read and write the interleaved samples of the channel directly.
+	const adc_channel_id_t stride = AdcBuffer::getChannelCount();
+	const adc_sample_value_id_t channel_length = AdcBuffer::getInstance().getChannelLength();
+	const adc_sample_value_t* samplesIn = AdcBuffer::getInstance().getBuffer(bufIndexIn)->samples + channel_id;
+	adc_sample_value_t* samplesOut = AdcBuffer::getInstance().getBuffer(bufIndexOut)->samples + channel_id;
+	PowerVector& inputSamples = *_inputSamples;
+
 	// Pad the start of the input vector with the first sample in the buffer
 	uint16_t j = 0;
-	adc_sample_value_t padded_value = AdcBuffer::getInstance().getValue(bufIndexIn, channel_id, 0);
+	adc_sample_value_t padded_value = samplesIn[0];
 	for (uint16_t i = 0; i < _filterParams->half; ++i, ++j) {
-		_inputSamples->at(j) = padded_value;
+		inputSamples[j] = padded_value;
 	}
 
-	// Copy samples from buffer to input vector
-	uint8_t channel_length = AdcBuffer::getInstance().getChannelLength();
-	for (int i = 0; i < channel_length; ++i, ++j) {
-		_inputSamples->at(j) = AdcBuffer::getInstance().getValue(bufIndexIn, channel_id, i);
+	// Gather the samples of the channel into the input vector
+	for (adc_sample_value_id_t i = 0; i < channel_length; ++i, ++j) {
+		inputSamples[j] = samplesIn[i * stride];
 	}
 
-	// Pad the end of the buffer with the last sample in the buffer
-	padded_value = AdcBuffer::getInstance().getValue(bufIndexIn, channel_id, channel_length - 1);
-	for (uint16_t i = 0; i < _filterParams->half; ++i, ++j) {
-		_inputSamples->at(j) = padded_value;
+	// Pad the end of the buffer with the last sample in the buffer, up to the size of the filter input.
+	padded_value = samplesIn[(channel_length - 1) * stride];
+	for (; j < _filterParams->n; ++j) {
+		inputSamples[j] = padded_value;
 	}
 
 	// Filter the data
-	sort_median(*_filterParams, *_inputSamples, *_outputSamples);
+	sort_median(*_filterParams, inputSamples, *_outputSamples);
 
-	// Copy the result back into the buffer
-	for (int i = 0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
-		AdcBuffer::getInstance().setValue(bufIndexOut, channel_id, i, _outputSamples->at(i));
+	// Write the result back into the buffer
+	const PowerVector& outputSamples = *_outputSamples;
+	for (adc_sample_value_id_t i = 0; i < channel_length; ++i) {
+		samplesOut[i * stride] = outputSamples[i];
 	}
 }
 
 bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 
-	adc_sample_value_id_t numSamples = AC_PERIOD_US / AdcBuffer::getInstance().getBuffer(bufIndex)->config[VOLTAGE_CHANNEL_IDX].samplingIntervalUs;
-	assert(numSamples <= AdcBuffer::getChannelLength(), "Not enough samples");
+	uint32_t samplingIntervalUs = AdcBuffer::getInstance().getBuffer(bufIndex)->config[VOLTAGE_CHANNEL_IDX].samplingIntervalUs;
+	adc_sample_value_id_t numSamples = AC_PERIOD_US / samplingIntervalUs;
+	assert(numSamples <= AdcBuffer::getInstance().getChannelLength(), "Not enough samples");
 
 	//////////////////////////////////////////////////
 	// Calculatate power, Irms, and Vrms
@@ -714,7 +855,8 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 		return false;
 	}
 
-	int32_t powerMilliWattReal = pSum * _currentMultiplier * _voltageMultiplier * 1000 / numSamples;
+	float periodPowerMilliWatt = pSum * _currentMultiplier * _voltageMultiplier * 1000 / numSamples;
+	int32_t powerMilliWattReal = periodPowerMilliWatt;
 	int32_t currentRmsMA = sqrt((double)cSquareSum * _currentMultiplier * _currentMultiplier / numSamples) * 1000;
 	int32_t voltageRmsMilliVolt = sqrt((double)vSquareSum * _voltageMultiplier * _voltageMultiplier / numSamples) * 1000;
 
@@ -743,18 +885,14 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 //	}
 
 	// Calculate median when there are enough values in history, else calculate the average.
-	_filteredCurrentRmsHistMA->push(filteredCurrentRmsMA);
+	// The statistics are kept up to date on push, so the soft fuse check takes the same time every period.
+	_filteredCurrentRmsHistMA.push(filteredCurrentRmsMA);
 	int32_t filteredCurrentRmsMedianMA;
-	if (_filteredCurrentRmsHistMA->full()) {
-		memcpy(_histCopy, _filteredCurrentRmsHistMA->getBuffer(), _filteredCurrentRmsHistMA->getMaxByteSize());
-		filteredCurrentRmsMedianMA = opt_med(_histCopy);
+	if (_filteredCurrentRmsHistMA.full()) {
+		filteredCurrentRmsMedianMA = _filteredCurrentRmsHistMA.getMedian();
 	}
 	else {
-		int64_t currentRmsSumMA = 0;
-		for (uint16_t i=0; i<_filteredCurrentRmsHistMA->size(); ++i) {
-			currentRmsSumMA += _filteredCurrentRmsHistMA->operator[](i);
-		}
-		filteredCurrentRmsMedianMA = currentRmsSumMA / _filteredCurrentRmsHistMA->size();
+		filteredCurrentRmsMedianMA = _filteredCurrentRmsHistMA.getMean();
 	}
 
 	// Now that Irms is known: first check the soft fuse.
@@ -771,18 +909,13 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 	/////////////////////////////////////////////////////////
 
 	// Calculate median when there are enough values in history, else calculate the average.
-	_currentRmsMilliAmpHist->push(currentRmsMA);
+	_currentRmsMilliAmpHist.push(currentRmsMA);
 	int32_t currentRmsMedianMA;
-	if (_currentRmsMilliAmpHist->full()) {
-		memcpy(_histCopy, _currentRmsMilliAmpHist->getBuffer(), _currentRmsMilliAmpHist->getMaxByteSize());
-		currentRmsMedianMA = opt_med(_histCopy);
+	if (_currentRmsMilliAmpHist.full()) {
+		currentRmsMedianMA = _currentRmsMilliAmpHist.getMedian();
 	}
 	else {
-		int64_t currentRmsMilliAmpSum = 0;
-		for (uint16_t i=0; i<_currentRmsMilliAmpHist->size(); ++i) {
-			currentRmsMilliAmpSum += _currentRmsMilliAmpHist->operator[](i);
-		}
-		currentRmsMedianMA = currentRmsMilliAmpSum / _currentRmsMilliAmpHist->size();
+		currentRmsMedianMA = _currentRmsMilliAmpHist.getMean();
 	}
 
 //	// Exponential moving average of the median
@@ -792,17 +925,12 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 	_avgCurrentRmsMilliAmp = currentRmsMedianMA;
 
 	// Calculate median when there are enough values in history, else calculate the average.
-	_voltageRmsMilliVoltHist->push(voltageRmsMilliVolt);
-	if (_voltageRmsMilliVoltHist->full()) {
-		memcpy(_histCopy, _voltageRmsMilliVoltHist->getBuffer(), _voltageRmsMilliVoltHist->getMaxByteSize());
-		_avgVoltageRmsMilliVolt = opt_med(_histCopy);
+	_voltageRmsMilliVoltHist.push(voltageRmsMilliVolt);
+	if (_voltageRmsMilliVoltHist.full()) {
+		_avgVoltageRmsMilliVolt = _voltageRmsMilliVoltHist.getMedian();
 	}
 	else {
-		int64_t voltageRmsMilliVoltSum = 0;
-		for (uint16_t i=0; i<_voltageRmsMilliVoltHist->size(); ++i) {
-			voltageRmsMilliVoltSum += _voltageRmsMilliVoltHist->operator[](i);
-		}
-		_avgVoltageRmsMilliVolt = voltageRmsMilliVoltSum / _voltageRmsMilliVoltHist->size();
+		_avgVoltageRmsMilliVolt = _voltageRmsMilliVoltHist.getMean();
 	}
 
 	// Calculate apparent power: current_rms * voltage_rms
@@ -813,8 +941,13 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 	}
 	else {
 		powerMilliWattReal -= _powerZero;
+		periodPowerMilliWatt -= _powerZero;
 	}
 
+	// Keep the unrounded power of this period, for the energy.
+	_periodPowerMilliWatt = periodPowerMilliWatt;
+	_periodDurationUs = numSamples * samplingIntervalUs;
+
 	// Exponential moving average
 	int64_t avgPowerDiscount = _avgPowerDiscount;
 	_avgPowerMilliWatt = ((1000-avgPowerDiscount) * _avgPowerMilliWatt + avgPowerDiscount * powerMilliWattReal) / 1000;
@@ -846,6 +979,8 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 #endif
 
 	uint32_t rtcCount = RTC::getCount();
+	// Like uart_msg_current_t and uart_msg_voltage_t, but with the number of samples of the sampling profile.
+	__attribute__((unused)) uint16_t uartSamplesMsgSize = sizeof(rtcCount) + AdcBuffer::getInstance().getChannelLength() * sizeof(adc_sample_value_t);
 	if (_logsEnabled.flags.power) {
 		// Calculated values
 		uart_msg_power_t powerMsg;
@@ -865,10 +1000,10 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 
 	if (_logsEnabled.flags.current) {
 		// Write uart_msg_current_t without allocating a buffer.
-		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_CURRENT, sizeof(uart_msg_current_t));
+		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_CURRENT, uartSamplesMsgSize);
 		UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_CURRENT, (uint8_t*)&(rtcCount), sizeof(rtcCount));
 		adc_sample_value_t val;
-		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getChannelLength(); ++i) {
+		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
 			val = AdcBuffer::getInstance().getValue(bufIndex, CURRENT_CHANNEL_IDX, i);
 			UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_CURRENT, (uint8_t*)&val, sizeof(val));
 		}
@@ -877,10 +1012,10 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 
 	if (_logsEnabled.flags.filteredCurrent) {
 		// Write uart_msg_current_t without allocating a buffer.
-		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_FILTERED_CURRENT, sizeof(uart_msg_current_t));
+		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_FILTERED_CURRENT, uartSamplesMsgSize);
 		UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_FILTERED_CURRENT, (uint8_t*)&(rtcCount), sizeof(rtcCount));
 		adc_sample_value_t val;
-		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getChannelLength(); ++i) {
+		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
 			val = AdcBuffer::getInstance().getValue(bufIndex, CURRENT_CHANNEL_IDX, i);
 			UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_FILTERED_CURRENT, (uint8_t*)&val, sizeof(val));
 		}
@@ -889,10 +1024,10 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 
 	if (_logsEnabled.flags.voltage) {
 		// Write uart_msg_voltage_t without allocating a buffer.
-		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_VOLTAGE, sizeof(uart_msg_voltage_t));
+		UartHandler::getInstance().writeMsgStart(UART_OPCODE_TX_POWER_LOG_VOLTAGE, uartSamplesMsgSize);
 		UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_VOLTAGE, (uint8_t*)&(rtcCount), sizeof(rtcCount));
 		adc_sample_value_t val;
-		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getChannelLength(); ++i) {
+		for (adc_sample_value_id_t i = 0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
 			val = AdcBuffer::getInstance().getValue(bufIndex, VOLTAGE_CHANNEL_IDX, i);
 			UartHandler::getInstance().writeMsgPart(UART_OPCODE_TX_POWER_LOG_VOLTAGE, (uint8_t*)&val, sizeof(val));
 		}
@@ -902,6 +1037,41 @@ bool PowerSampling::calculatePower(adc_buffer_id_t bufIndex) {
 	return true;
 }
 
+void PowerSampling::analyseHarmonics(adc_buffer_id_t bufIndex) {
+	if (!_harmonics.isInitialized()) {
+		return;
+	}
+	if (_harmonicsCountDown > 1) {
+		--_harmonicsCountDown;
+		return;
+	}
+	AdcBuffer& adcBuffer = AdcBuffer::getInstance();
+	cs_power_harmonics_t harmonics;
+	_harmonics.analyse(
+			adcBuffer.getBuffer(bufIndex)->samples,
+			adcBuffer.getChannelCount(),
+			VOLTAGE_CHANNEL_IDX,
+			CURRENT_CHANNEL_IDX,
+			_avgZeroVoltage,
+			_avgZeroCurrent,
+			_currentMultiplier,
+			harmonics);
+	if (!isValidBuf(bufIndex)) {
+		// Try again with the next buffer.
+		LOGPowerSamplingWarn("buf %u invalid", bufIndex);
+		return;
+	}
+	_harmonicsCountDown = POWER_HARMONICS_INTERVAL_PERIODS;
+	harmonics.unixTimestamp = SystemTime::posix();
+	_lastHarmonics = harmonics;
+	_harmonicsAnalysed = true;
+	LOGPowerSamplingDebug("PF=%i DPF=%i THD=%u I1=%umA", harmonics.powerFactor, harmonics.displacementPowerFactor, harmonics.currentThd, harmonics.currentHarmonicsMilliAmp[0]);
+
+	if (_logsEnabled.flags.power) {
+		UartHandler::getInstance().writeMsg(UART_OPCODE_TX_POWER_LOG_HARMONICS, (uint8_t*)&_lastHarmonics, sizeof(_lastHarmonics));
+	}
+}
+
 void PowerSampling::calculateSlowAveragePower(float powerMilliWatt, float fastAvgPowerMilliWatt) {
 	if (_switchHist.size() >= 2) {
 		if (_switchHist[_switchHist.size() - 2].asInt != _switchHist[_switchHist.size() - 1].asInt) {
@@ -970,11 +1140,33 @@ void PowerSampling::calibratePowerZero(int32_t powerMilliWatt) {
 	State::getInstance().set(CS_TYPE::CONFIG_POWER_ZERO, &_powerZero, sizeof(_powerZero));
 }
 
-void PowerSampling::calculateEnergy() {
-	// Assume we process every buffer, so simply only multiple power with the buffer duration.
+void PowerSampling::calculateEnergy(adc_buffer_seq_nr_t seqNr) {
+	// Also count the periods of the buffers that were skipped or invalid since the last time.
+	adc_buffer_seq_nr_t numPeriods = _lastEnergySeqNrValid ? (adc_buffer_seq_nr_t)(seqNr - _lastEnergySeqNr) : 1;
+	_lastEnergySeqNr = seqNr;
+	_lastEnergySeqNrValid = true;
+
 	// Only add negative energy when power is below the threshold.
+	// The slow average decides, so that noise around zero doesn't add up.
 	if (_slowAvgPowerMilliWatt > 0.0f || _slowAvgPowerMilliWatt < _negativePowerThresholdMilliWatt) {
-		_energyUsedmicroJoule += _slowAvgPowerMilliWatt * (CS_ADC_SAMPLE_INTERVAL_US / 1000.0f * AdcBuffer::getChannelLength());
+		// mW * μs = nJ. Carry the fraction of a μJ over to the next period, so that small powers add up as well.
+		float energyMicroJoule = _periodPowerMilliWatt * _periodDurationUs * numPeriods / 1000 + _energyRemainderMicroJoule;
+		int64_t wholeMicroJoule = energyMicroJoule;
+		_energyRemainderMicroJoule = energyMicroJoule - wholeMicroJoule;
+		_energyUsedmicroJoule += wholeMicroJoule;
+	}
+}
+
+void PowerSampling::setEnergyCheckpoint() {
+	if (_energyUsedmicroJoule == _checkpointEnergyMicroJoule) {
+		return;
+	}
+	TYPIFY(STATE_ENERGY_CHECKPOINT) checkpoint;
+	checkpoint.energyMicroJoule = _energyUsedmicroJoule;
+	checkpoint.unixTimestamp = SystemTime::posix();
+	cs_state_data_t data(CS_TYPE::STATE_ENERGY_CHECKPOINT, reinterpret_cast<uint8_t*>(&checkpoint), sizeof(checkpoint));
+	if (State::getInstance().setBatched(data, ENERGY_CHECKPOINT_MAX_DELAY_SECONDS) == ERR_SUCCESS) {
+		_checkpointEnergyMicroJoule = _energyUsedmicroJoule;
 	}
 }
 
@@ -1029,15 +1221,12 @@ void PowerSampling::checkSoftfuse(int32_t currentRmsMilliAmp, int32_t currentRms
 				) {
 			_lastSoftfuse.type = POWER_SAMPLES_TYPE_SOFTFUSE;
 			_lastSoftfuse.index = 0;
-			_lastSoftfuse.count = AdcBuffer::getChannelLength();
+			_lastSoftfuse.count = copySamples(bufIndex, CURRENT_CHANNEL_IDX, _lastSoftfuseSamples);
 			_lastSoftfuse.unixTimestamp = SystemTime::posix();
 			_lastSoftfuse.delayUs = 0;
-			_lastSoftfuse.sampleIntervalUs = AdcBuffer::getInstance().getBuffer(bufIndex)->config[CURRENT_CHANNEL_IDX].samplingIntervalUs;
+			_lastSoftfuse.sampleIntervalUs = AdcBuffer::getInstance().getBuffer(bufIndex)->config[CURRENT_CHANNEL_IDX].samplingIntervalUs * _sampleCopyStep;
 			_lastSoftfuse.offset = _avgZeroCurrent / 1024;
 			_lastSoftfuse.multiplier = _currentMultiplier;
-			for (adc_sample_value_id_t i = 0; i < AdcBuffer::getChannelLength(); ++i) {
-				_lastSoftfuseSamples[i] = AdcBuffer::getInstance().getValue(bufIndex, CURRENT_CHANNEL_IDX, i);
-			}
 		}
 	}
 
@@ -1138,7 +1327,7 @@ void PowerSampling::handleGetPowerSamples(PowerSamplesType type, uint8_t index,
 
 			// Check size
 			cs_power_samples_header_t* header = (cs_power_samples_header_t*)result.buf.data;
-			uint16_t numSamples = AdcBuffer::getInstance().getChannelLength();
+			uint16_t numSamples = getCopySampleCount();
 			uint16_t samplesSize = numSamples * sizeof(adc_sample_value_t);
 			size16_t requiredSize = sizeof(*header) + samplesSize;
 			if (result.buf.len < requiredSize) {
@@ -1153,7 +1342,7 @@ void PowerSampling::handleGetPowerSamples(PowerSamplesType type, uint8_t index,
 			header->count = numSamples;
 			header->unixTimestamp = SystemTime::posix();
 			header->delayUs = 0;
-			header->sampleIntervalUs = CS_ADC_SAMPLE_INTERVAL_US;
+			header->sampleIntervalUs = _samplingIntervalUs * _sampleCopyStep;
 			if (index == VOLTAGE_CHANNEL_IDX) {
 				header->offset = _avgZeroVoltage / 1024;
 				header->multiplier = _voltageMultiplier;
@@ -1166,9 +1355,7 @@ void PowerSampling::handleGetPowerSamples(PowerSamplesType type, uint8_t index,
 			// Copy samples
 			adc_buffer_id_t bufIndex = (type == POWER_SAMPLES_TYPE_NOW_FILTERED) ? _lastFilteredBufIndex : _lastBufIndex;
 			adc_sample_value_t* samples = (adc_sample_value_t*)(result.buf.data + sizeof(*header));
-			for (adc_sample_value_id_t i = 0; i < numSamples; ++i) {
-				samples[i] = AdcBuffer::getInstance().getValue(bufIndex, index, i);
-			}
+			copySamples(bufIndex, index, samples);
 
 			// After reading the buffer, check if it was valid
 			if (!isValidBuf(bufIndex)) {
@@ -1341,6 +1528,11 @@ void PowerSampling::changeRange(uint8_t channel, int32_t amount) {
 }
 
 void PowerSampling::enableSwitchcraft(bool enable) {
+	if (enable && _samplingProfile != ADC_SAMPLING_PROFILE_DEFAULT) {
+		// The switchcraft thresholds are tuned for the default sampling interval.
+		LOGw("Switchcraft not available with sampling profile %u", _samplingProfile);
+		enable = false;
+	}
 	if (enable) {
 		RecognizeSwitch::getInstance().start();
 	}
@@ -1356,7 +1548,7 @@ void PowerSampling::printBuf(adc_buffer_id_t bufIndex) {
 	__attribute__((unused)) adc_sample_value_id_t buf[10];
 	for (adc_channel_id_t channel = 0; channel < AdcBuffer::getChannelCount(); ++channel) {
 		LOGd("channel %u:", channel);
-		for (adc_sample_value_id_t i = 0, j = 0; i < AdcBuffer::getChannelLength(); ++i) {
+		for (adc_sample_value_id_t i = 0, j = 0; i < AdcBuffer::getInstance().getChannelLength(); ++i) {
 			buf[j] = AdcBuffer::getInstance().getValue(bufIndex, channel, i);
 			if (++j == 10) {
 				_logArray(SERIAL_DEBUG, true, buf, sizeof(buf));
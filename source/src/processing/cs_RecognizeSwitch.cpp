@@ -50,6 +50,10 @@ bool RecognizeSwitch::detect(const CircularBuffer<adc_buffer_id_t>& bufQueue, ad
 	if (!_running) {
 		return false;
 	}
+	// The thresholds and stored samples are for the default sampling interval.
+	if (AdcBuffer::getInstance().getChannelLength() != AdcBuffer::getDefaultChannelLength()) {
+		return false;
+	}
 	if (_skipSwitchDetectionTriggers > 0) {
 		_skipSwitchDetectionTriggers--;
 		return false;
@@ -331,7 +335,7 @@ void RecognizeSwitch::setLastDetection(bool aboveThreshold, const CircularBuffer
 		bufIndices[i] = bufQueue[bufQueue.size() - 4 + i]; // Last buffer is the unfiltered version.
 	}
 
-	uint16_t numSamples = ib.getChannelLength();
+	uint16_t numSamples = AdcBuffer::getDefaultChannelLength();
 	for (uint8_t i = 0; i < _numStoredBuffers; ++i) {
 		for (adc_sample_value_id_t j = 0; j < numSamples; ++j) {
 			buf[i * numSamples + j] = ib.getValue(bufIndices[i], voltageChannelId, j);
@@ -366,7 +370,7 @@ void RecognizeSwitch::getLastDetection(PowerSamplesType type, uint8_t index, cs_
 	}
 
 	// Check size.
-	uint16_t numSamples = AdcBuffer::getInstance().getChannelLength();
+	uint16_t numSamples = AdcBuffer::getDefaultChannelLength();
 	uint16_t samplesSize = numSamples * sizeof(adc_sample_value_t);
 	uint16_t requiredSize = sizeof(*header) + samplesSize;
 	if (result.buf.len < requiredSize) {
@@ -0,0 +1,30 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <logging/cs_Logger.h>
+#include <processing/cs_ScanPipelineStats.h>
+#include <time/cs_SystemTime.h>
+#include <uart/cs_UartHandler.h>
+
+#define LOGScanPipelineStatsDebug LOGvv
+
+void ScanPipelineStats::sendStats() {
+	_stats.uptime = SystemTime::up();
+	LOGScanPipelineStatsDebug("scanned: stack=%u mesh=%u asset: rejected=%u accepted=%u throttled=%u background=%u command: received=%u recentHits=%u decrypted=%u validated=%u tracked=%u",
+			_stats.counters[SCAN_PIPELINE_STACK_SCANNED],
+			_stats.counters[SCAN_PIPELINE_MESH_SCANNED],
+			_stats.counters[SCAN_PIPELINE_ASSET_REJECTED],
+			_stats.counters[SCAN_PIPELINE_ASSET_ACCEPTED],
+			_stats.counters[SCAN_PIPELINE_ASSET_THROTTLED],
+			_stats.counters[SCAN_PIPELINE_BACKGROUND_PARSED],
+			_stats.counters[SCAN_PIPELINE_COMMAND_RECEIVED],
+			_stats.counters[SCAN_PIPELINE_COMMAND_RECENT_HIT],
+			_stats.counters[SCAN_PIPELINE_COMMAND_DECRYPTED],
+			_stats.counters[SCAN_PIPELINE_COMMAND_VALIDATED],
+			_stats.counters[SCAN_PIPELINE_TRACKED_DEVICE_UPDATED]);
+	UartHandler::getInstance().writeMsg(UART_OPCODE_TX_SCAN_PIPELINE_STATS, reinterpret_cast<uint8_t*>(&_stats), sizeof(_stats));
+}
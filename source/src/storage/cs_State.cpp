@@ -296,6 +296,9 @@ cs_ret_code_t State::setInternal(const cs_state_data_t & data, const Persistence
 			if (ret_code == ERR_BUSY) {
 				return addToQueue(CS_STATE_QUEUE_OP_WRITE, type, id, STATE_RETRY_STORE_DELAY_MS, StateQueueMode::DELAY);
 			}
+			if (ret_code == ERR_SUCCESS) {
+				triggerBatchedWrites();
+			}
 			break;
 		}
 		case PersistenceMode::FIRMWARE_DEFAULT: {
@@ -714,6 +717,21 @@ cs_ret_code_t State::setDelayed(const cs_state_data_t & data, uint8_t delaySecon
 	return addToQueue(CS_STATE_QUEUE_OP_WRITE, data.type, data.id, delayMs, StateQueueMode::DELAY);
 }
 
+/**
+ * Like setDelayed(), but the write is not pushed forward in time, and can be done earlier.
+ */
+cs_ret_code_t State::setBatched(const cs_state_data_t & data, uint32_t maxDelaySeconds) {
+	if (maxDelaySeconds == 0 || maxDelaySeconds >= CS_STATE_QUEUE_DELAY_SECONDS_MAX) {
+		return ERR_WRONG_PARAMETER;
+	}
+	cs_ret_code_t ret_code = set(data, PersistenceMode::RAM);
+	if (ret_code != ERR_SUCCESS) {
+		return ret_code;
+	}
+	uint32_t delayMs = 1000 * maxDelaySeconds;
+	return addToQueue(CS_STATE_QUEUE_OP_WRITE, data.type, data.id, delayMs, StateQueueMode::BATCH);
+}
+
 /**
  * Add a type to the queue to be written to flash.
  */
@@ -737,6 +755,12 @@ cs_ret_code_t State::addToQueue(StateQueueOp operation, const CS_TYPE & type, cs
 					if (mode == StateQueueMode::THROTTLE) {
 						_store_queue[i].init_counter = delayTicks;
 					}
+					else if (mode == StateQueueMode::BATCH) {
+						// Don't postpone the write.
+						if (!_store_queue[i].execute || _store_queue[i].counter > delayTicks) {
+							_store_queue[i].counter = delayTicks;
+						}
+					}
 					else {
 						_store_queue[i].counter = delayTicks;
 					}
@@ -777,7 +801,8 @@ cs_ret_code_t State::addToQueue(StateQueueOp operation, const CS_TYPE & type, cs
 		item.id = id;
 		item.counter = delayTicks;
 		item.init_counter = 0;
-		item.execute = (mode == StateQueueMode::DELAY);
+		item.execute = (mode == StateQueueMode::DELAY || mode == StateQueueMode::BATCH);
+		item.batched = (mode == StateQueueMode::BATCH);
 		_store_queue.push_back(item);
 	}
 	LOGStateDebug("queue is now of size %u", _store_queue.size());
@@ -811,6 +836,9 @@ void State::delayedStoreTick() {
 						if (ret_code == ERR_BUSY) {
 							keepItem = true;
 						}
+						else if (ret_code == ERR_SUCCESS && !it->batched) {
+							triggerBatchedWrites();
+						}
 					}
 					break;
 				}
@@ -862,6 +890,24 @@ void State::delayedStoreTick() {
 	}
 }
 
+void State::triggerBatchedWrites() {
+	for (auto& item : _store_queue) {
+		if (item.batched && item.execute) {
+			item.counter = 0;
+		}
+	}
+}
+
+void State::flushQueuedWrites() {
+	LOGd("flushQueuedWrites");
+	for (auto& item : _store_queue) {
+		if (item.operation == CS_STATE_QUEUE_OP_WRITE && item.execute) {
+			item.counter = 0;
+		}
+	}
+	delayedStoreTick();
+}
+
 void State::startWritesToFlash() {
 	LOGd("startWritesToFlash");
 	_startedWritingToFlash = true;
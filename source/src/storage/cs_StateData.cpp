@@ -156,6 +156,15 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
 		*(TYPIFY(CONFIG_SWITCHCRAFT_THRESHOLD)*)data.value = SWITCHCRAFT_THRESHOLD;
 		return ERR_SUCCESS;
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+		*(TYPIFY(CONFIG_ADC_SAMPLING_PROFILE)*)data.value = ADC_SAMPLING_PROFILE_DEFAULT;
+		return ERR_SUCCESS;
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+		*(TYPIFY(CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS)*)data.value = NEAREST_CROWNSTONE_RSSI_HYSTERESIS_DB;
+		return ERR_SUCCESS;
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
+		*(TYPIFY(CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD)*)data.value = NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD_MS;
+		return ERR_SUCCESS;
 	case CS_TYPE::CONFIG_UART_ENABLED:
 		*(TYPIFY(CONFIG_UART_ENABLED)*)data.value = g_CS_SERIAL_ENABLED;
 		return ERR_SUCCESS;
@@ -168,6 +177,9 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
 		*(TYPIFY(STATE_ACCUMULATED_ENERGY)*)data.value = STATE_ACCUMULATED_ENERGY_DEFAULT;
 		return ERR_SUCCESS;
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
+		*reinterpret_cast<TYPIFY(STATE_ENERGY_CHECKPOINT)*>(data.value) = cs_energy_checkpoint_t();
+		return ERR_SUCCESS;
 	case CS_TYPE::STATE_POWER_USAGE:
 		*(TYPIFY(STATE_POWER_USAGE)*)data.value = STATE_POWER_USAGE_DEFAULT;
 		return ERR_SUCCESS;
@@ -387,6 +399,8 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -395,6 +409,7 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -463,6 +478,9 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::CONFIG_SWITCH_LOCKED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED:
 	case CS_TYPE::CONFIG_SWITCHCRAFT_THRESHOLD:
+	case CS_TYPE::CONFIG_ADC_SAMPLING_PROFILE:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_RSSI_HYSTERESIS:
+	case CS_TYPE::CONFIG_NEAREST_CROWNSTONE_REPORT_SUPPRESSION_PERIOD:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED:
 	case CS_TYPE::CONFIG_TAP_TO_TOGGLE_RSSI_THRESHOLD_OFFSET:
 	case CS_TYPE::CONFIG_UART_ENABLED:
@@ -487,6 +505,7 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::STATE_ASSET_FILTER_128:
 	case CS_TYPE::STATE_ASSET_FILTER_256:
 	case CS_TYPE::STATE_ASSET_FILTER_512:
+	case CS_TYPE::STATE_ENERGY_CHECKPOINT:
 		return PersistenceMode::FLASH;
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
 	case CS_TYPE::STATE_POWER_USAGE:
@@ -639,6 +658,8 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::CMD_GET_GPREGRET:
 	case CS_TYPE::CMD_GET_ADC_CHANNEL_SWAPS:
 	case CS_TYPE::CMD_GET_RAM_STATS:
+	case CS_TYPE::CMD_GET_ADC_PROCESSING_STATS:
+	case CS_TYPE::CMD_GET_POWER_HARMONICS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_TEST_SET_TIME:
 	case CS_TYPE::CMD_MICROAPP_GET_INFO:
@@ -647,6 +668,7 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::CMD_MICROAPP_REMOVE:
 	case CS_TYPE::CMD_MICROAPP_ENABLE:
 	case CS_TYPE::CMD_MICROAPP_DISABLE:
+	case CS_TYPE::CMD_MICROAPP_GET_CPU_STATS:
 	case CS_TYPE::EVT_MICROAPP_UPLOAD_RESULT:
 	case CS_TYPE::EVT_MICROAPP_ERASE_RESULT:
 	case CS_TYPE::CMD_MICROAPP_ADVERTISE:
@@ -23,11 +23,7 @@
 
 // ========================= Public ========================
 
-SwitchAggregator::SwitchAggregator():
-	_switchHistory(_maxSwitchHistoryItems)
-{
-
-}
+SwitchAggregator::SwitchAggregator() {}
 
 void SwitchAggregator::init(const boards_config_t& board) {
 	smartSwitch.onUnexpextedIntensityChange([&](uint8_t newState) -> void {
@@ -35,9 +31,6 @@ void SwitchAggregator::init(const boards_config_t& board) {
 	});
 	smartSwitch.init(board);
 
-	// Allocate buffer.
-	_switchHistory.init();
-
 	listen();
 
 	twilightHandler.listen();
@@ -89,12 +82,14 @@ cs_ret_code_t SwitchAggregator::updateState(bool allowOverrideReset, const cmd_s
 		}
 	}
 
-	if (overrideState && !shouldResetOverrideState) {
-		aggregatedState = resolveOverrideState();
-	}
-	else if (behaviourState) {
-		// only use aggr. if no SwitchBehaviour conflict is found
-		aggregatedState = aggregatedBehaviourIntensity();
+	aggregation_inputs_t inputs = {
+			.overrideState  = overrideState,
+			.behaviourState = behaviourState,
+			.twilightState  = twilightState,
+			.useOverride    = overrideState && !shouldResetOverrideState};
+	std::optional<uint8_t> newAggregatedState = getAggregatedState(inputs);
+	if (newAggregatedState) {
+		aggregatedState = newAggregatedState;
 	}
 	// If override and behaviour don't have an opinion, keep previous value.
 
@@ -117,15 +112,43 @@ cs_ret_code_t SwitchAggregator::updateState(bool allowOverrideReset, const cmd_s
 		}
 	}
 
-	TYPIFY(EVT_BEHAVIOUR_OVERRIDDEN) eventData = overrideState.has_value();
-	event_t overrideEvent(CS_TYPE::EVT_BEHAVIOUR_OVERRIDDEN, &eventData, sizeof(eventData));
-	overrideEvent.dispatch();
+	dispatchBehaviourOverridden();
 
 	pushTestDataToHost();
 
 	return retCode;
 }
 
+std::optional<uint8_t> SwitchAggregator::getAggregatedState(const aggregation_inputs_t& inputs) {
+	if (_cachedAggregationInputs == inputs) {
+		return _cachedAggregationResult;
+	}
+	LOGSwitchAggregatorDebug("getAggregatedState inputs changed");
+
+	if (inputs.useOverride) {
+		_cachedAggregationResult = resolveOverrideState();
+	}
+	else if (inputs.behaviourState) {
+		// only use aggr. if no SwitchBehaviour conflict is found
+		_cachedAggregationResult = aggregatedBehaviourIntensity();
+	}
+	else {
+		_cachedAggregationResult = {};
+	}
+	_cachedAggregationInputs = inputs;
+	return _cachedAggregationResult;
+}
+
+void SwitchAggregator::dispatchBehaviourOverridden() {
+	TYPIFY(EVT_BEHAVIOUR_OVERRIDDEN) eventData = overrideState.has_value();
+	if (_lastBehaviourOverridden == eventData) {
+		return;
+	}
+	_lastBehaviourOverridden = eventData;
+	event_t overrideEvent(CS_TYPE::EVT_BEHAVIOUR_OVERRIDDEN, &eventData, sizeof(eventData));
+	overrideEvent.dispatch();
+}
+
 // ========================= Event handling =========================
 
 void SwitchAggregator::handleEvent(event_t& event) {
@@ -152,7 +175,7 @@ bool SwitchAggregator::handleSwitchAggregatorCommand(event_t& event) {
 	switch (event.type) {
 		case CS_TYPE::CMD_GET_SWITCH_HISTORY: {
 			cs_switch_history_header_t header;
-			header.count = _switchHistory.size();
+			header.count = _switchHistoryCount;
 			cs_buffer_size_t requiredSize = sizeof(header) + header.count * sizeof(cs_switch_history_item_t);
 			if (event.result.buf.len < requiredSize) {
 				event.result.returnCode = ERR_BUFFER_TOO_SMALL;
@@ -160,8 +183,8 @@ bool SwitchAggregator::handleSwitchAggregatorCommand(event_t& event) {
 			}
 			memcpy(event.result.buf.data, &header, sizeof(header));
 			int offset = sizeof(header);
-			for (uint16_t i = 0; i < _switchHistory.size(); ++i) {
-				const auto& item = _switchHistory[i];
+			for (uint8_t i = 0; i < _switchHistoryCount; ++i) {
+				const auto& item = getSwitchHistoryItem(i);
 				memcpy(event.result.buf.data + offset, &item, sizeof(item));
 				offset += sizeof(item);
 			}
@@ -466,15 +489,24 @@ void SwitchAggregator::handleGetBehaviourDebug(event_t& evt) {
 
 void SwitchAggregator::addToSwitchHistory(const cs_switch_history_item_t& cmd) {
 	LOGd("addToSwitchHistory val=%u state=%u srcType=%u, srcId=%u", cmd.value, cmd.state.asInt, cmd.source.type, cmd.source.id);
-	_switchHistory.push(cmd);
+	_switchHistory[_switchHistoryNextIndex] = cmd;
+	_switchHistoryNextIndex = (_switchHistoryNextIndex + 1) % _maxSwitchHistoryItems;
+	if (_switchHistoryCount < _maxSwitchHistoryItems) {
+		_switchHistoryCount++;
+	}
 	printSwitchHistory();
 }
 
+const cs_switch_history_item_t& SwitchAggregator::getSwitchHistoryItem(uint8_t index) {
+	uint8_t oldestIndex = (_switchHistoryNextIndex + _maxSwitchHistoryItems - _switchHistoryCount) % _maxSwitchHistoryItems;
+	return _switchHistory[(oldestIndex + index) % _maxSwitchHistoryItems];
+}
+
 void SwitchAggregator::printSwitchHistory() {
 #if LOGSwitchHistory == true
 	LOGd("Switch history:");
-	for (uint16_t i = 0; i < _switchHistory.size(); ++i) {
-		__attribute__((unused)) const auto& iter = _switchHistory[i];
+	for (uint8_t i = 0; i < _switchHistoryCount; ++i) {
+		__attribute__((unused)) const auto& iter = getSwitchHistoryItem(i);
 		LOGd("  t=%u val=%u state=%u srcType=%u, srcId=%u", iter.timestamp, iter.value, iter.state.asInt, iter.source.type, iter.source.id);
 	}
 #endif
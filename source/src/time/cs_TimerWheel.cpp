@@ -0,0 +1,97 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <time/cs_TimerWheel.h>
+
+void TimerWheel::schedule(timer_wheel_entry_t& entry, uint32_t delaySeconds) {
+	if (isScheduled(entry)) {
+		unlink(entry);
+	}
+	if (delaySeconds == 0) {
+		// The slot of the current second has already been handled.
+		delaySeconds = 1;
+	}
+	entry.expirySeconds = _seconds + delaySeconds;
+	insert(entry);
+}
+
+void TimerWheel::cancel(timer_wheel_entry_t& entry) {
+	if (isScheduled(entry)) {
+		unlink(entry);
+	}
+}
+
+uint32_t TimerWheel::getSecondsLeft(const timer_wheel_entry_t& entry) const {
+	if (!isScheduled(entry)) {
+		return 0;
+	}
+	return entry.expirySeconds - _seconds;
+}
+
+void TimerWheel::tickSecond() {
+	++_seconds;
+	uint32_t index = _seconds & SLOT_MASK;
+
+	// When a level wrapped around, move the entries of the next slot of the level above down.
+	if (index == 0) {
+		for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+			if (cascade(level) != 0) {
+				break;
+			}
+		}
+	}
+
+	// All entries in this slot expire now.
+	timer_wheel_entry_t** slot = &_slots[0][index];
+	while (*slot != nullptr) {
+		timer_wheel_entry_t& entry = **slot;
+		unlink(entry);
+		// The callback may schedule entries again.
+		entry.callback(entry.context);
+	}
+}
+
+void TimerWheel::insert(timer_wheel_entry_t& entry) {
+	uint32_t delta = entry.expirySeconds - _seconds;
+	uint32_t expiry = entry.expirySeconds;
+	uint8_t level = 0;
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << ((level + 1) * TIMER_WHEEL_SLOT_BITS))) {
+		++level;
+	}
+	if (delta >= (1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS))) {
+		// Too far in the future: put it in the last slot, it will be inserted again when that slot is reached.
+		expiry = _seconds + (1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1;
+	}
+
+	timer_wheel_entry_t** slot = &_slots[level][(expiry >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK];
+	entry.next = *slot;
+	if (entry.next != nullptr) {
+		entry.next->pprev = &entry.next;
+	}
+	*slot = &entry;
+	entry.pprev = slot;
+}
+
+void TimerWheel::unlink(timer_wheel_entry_t& entry) {
+	*entry.pprev = entry.next;
+	if (entry.next != nullptr) {
+		entry.next->pprev = entry.pprev;
+	}
+	entry.next = nullptr;
+	entry.pprev = nullptr;
+}
+
+uint32_t TimerWheel::cascade(uint8_t level) {
+	uint32_t index = (_seconds >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK;
+	timer_wheel_entry_t** slot = &_slots[level][index];
+	while (*slot != nullptr) {
+		timer_wheel_entry_t& entry = **slot;
+		unlink(entry);
+		insert(entry);
+	}
+	return index;
+}
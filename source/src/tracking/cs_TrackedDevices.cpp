@@ -8,6 +8,7 @@
 #include <drivers/cs_RNG.h>
 #include <encryption/cs_KeysAndAccess.h>
 #include <events/cs_EventDispatcher.h>
+#include <processing/cs_ScanPipelineStats.h>
 #include <tracking/cs_TrackedDevices.h>
 #include <util/cs_BleError.h>
 #include <util/cs_Utils.h>
@@ -24,19 +25,23 @@ void TrackedDevices::init() {
 
 cs_ret_code_t TrackedDevices::handleRegister(internal_register_tracked_device_packet_t& packet) {
 	LOGTrackedDevicesDebug("handleRegister id=%u", packet.data.deviceId);
-	TrackedDevice* device = findOrAdd(packet.data.deviceId);
-	if (device == nullptr) {
-		return ERR_NO_SPACE;
-	}
+	// Only add the device once the registration is accepted, so that a rejected one doesn't remove another device.
+	TrackedDevice* device = find(packet.data.deviceId);
 
 	// When device token timed out, anyone is allowed to set a token for the device.
-	if (isValidTTL(*device) && !hasAccess(*device, packet.accessLevel)) {
+	if (device != nullptr && isValidTTL(*device) && !hasAccess(*device, packet.accessLevel)) {
 		LOGw("No access id=%u oldLevel=%u newLevel=%u", packet.data.deviceId, device->data.accessLevel, packet.accessLevel);
 		return ERR_NO_ACCESS;
 	}
-	if (!isTokenOkToSet(*device, packet.data.deviceToken, sizeof(packet.data.deviceToken))) {
+	if (!isTokenOkToSet(packet.data.deviceId, packet.data.deviceToken, sizeof(packet.data.deviceToken))) {
 		return ERR_ALREADY_EXISTS;
 	}
+	if (device == nullptr) {
+		device = add(packet.data.deviceId);
+	}
+	else {
+		touch(*device);
+	}
 	setAccessLevel(*device, packet.accessLevel);
 	setLocation(   *device, packet.data.locationId);
 	setProfile(    *device, packet.data.profileId);
@@ -74,12 +79,12 @@ void TrackedDevices::handleMeshRegister(TYPIFY(EVT_MESH_TRACKED_DEVICE_REGISTER)
 
 void TrackedDevices::handleMeshToken(TYPIFY(EVT_MESH_TRACKED_DEVICE_TOKEN)& packet) {
 	LOGTrackedDevicesDebug("handleMeshToken id=%u", packet.deviceId);
-	TrackedDevice* device = findOrAdd(packet.deviceId);
-	if (device == nullptr) {
+	// Access has been checked by sending crownstone.
+	if (!isTokenOkToSet(packet.deviceId, packet.deviceToken, sizeof(packet.deviceToken))) {
 		return;
 	}
-	// Access has been checked by sending crownstone.
-	if (!isTokenOkToSet(*device, packet.deviceToken, sizeof(packet.deviceToken))) {
+	TrackedDevice* device = findOrAdd(packet.deviceId);
+	if (device == nullptr) {
 		return;
 	}
 	setDevicetoken(*device, packet.deviceToken, sizeof(packet.deviceToken));
@@ -108,6 +113,8 @@ void TrackedDevices::handleScannedDevice(adv_background_parsed_v1_t& packet) {
 		return;
 	}
 	device->locationIdTTLMinutes = LOCATION_ID_TTL_MINUTES;
+	touch(*device);
+	ScanPipelineStats::getInstance().count(SCAN_PIPELINE_TRACKED_DEVICE_UPDATED);
 
 	sendBackgroundAdv(*device, packet.macAddress, packet.rssi);
 }
@@ -136,6 +143,7 @@ cs_ret_code_t TrackedDevices::handleHeartbeat(internal_tracked_device_heartbeat_
 		return ERR_NO_ACCESS;
 	}
 
+	touch(*device);
 	cs_ret_code_t retCode = handleHeartbeat(*device, packet.data.locationId, packet.data.timeToLiveMinutes, false);
 	if (retCode == ERR_SUCCESS) {
 		sendHeartbeatToMesh(*device);
@@ -149,6 +157,7 @@ void TrackedDevices::handleMeshHeartbeat(TYPIFY(EVT_MESH_TRACKED_DEVICE_HEARTBEA
 	if (device == nullptr) {
 		return;
 	}
+	touch(*device);
 	handleHeartbeat(*device, packet.locationId, packet.ttlMinutes, true);
 }
 
@@ -171,74 +180,143 @@ cs_ret_code_t TrackedDevices::handleHeartbeat(TrackedDevice& device, uint8_t loc
 TrackedDevices::TrackedDevice* TrackedDevices::findOrAdd(device_id_t deviceId) {
 	TrackedDevice* device = find(deviceId);
 	if (device == nullptr) {
-		device = add();
-		if (device != nullptr) {
-			device->data.data.deviceId = deviceId;
-		}
+		return add(deviceId);
 	}
+	touch(*device);
 	return device;
 }
 
 TrackedDevices::TrackedDevice* TrackedDevices::find(device_id_t deviceId) {
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->data.data.deviceId == deviceId) {
-			LOGTrackedDevicesVerbose("found device");
-			return &(*iter);
-		}
+	uint8_t index = deviceIdIndex.find(deviceId, [&](uint8_t i) { return devices[i].data.data.deviceId == deviceId; });
+	if (index == INDEX_NOT_FOUND) {
+		return nullptr;
 	}
-	return nullptr;
+	LOGTrackedDevicesVerbose("found device");
+	return &devices[index];
 }
 
 TrackedDevices::TrackedDevice* TrackedDevices::findToken(uint8_t* deviceToken, uint8_t size) {
 	assert(size == TRACKED_DEVICE_TOKEN_SIZE, "Wrong device token size");
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (memcmp(iter->data.data.deviceToken, deviceToken, size) == 0) {
-			LOGTrackedDevicesVerbose("found token id=%u", iter->data.data.deviceId);
-			return &(*iter);
-		}
+	uint8_t index = deviceTokenIndex.find(getTokenKey(deviceToken), [&](uint8_t i) {
+		return memcmp(devices[i].data.data.deviceToken, deviceToken, size) == 0;
+	});
+	if (index == INDEX_NOT_FOUND) {
+		return nullptr;
 	}
-	return nullptr;
+	LOGTrackedDevicesVerbose("found token id=%u", devices[index].data.data.deviceId);
+	return &devices[index];
 }
 
-TrackedDevices::TrackedDevice* TrackedDevices::add() {
-	// Check number of devices.
+TrackedDevices::TrackedDevice* TrackedDevices::add(device_id_t deviceId) {
 	if (deviceListSize >= MAX_TRACKED_DEVICES) {
-		cs_ret_code_t retCode = removeDevice();
-		if (retCode != ERR_SUCCESS) {
-			LOGTrackedDevicesDebug("no space to add");
-			return nullptr;
+		removeDevice(getIndexToRemove());
+	}
+	LOGTrackedDevicesDebug("add device id=%u", deviceId);
+	uint8_t index = deviceListSize++;
+	devices[index] = TrackedDevice();
+	devices[index].data.data.deviceId = deviceId;
+	deviceIdIndex.insert(deviceId, index);
+	touch(devices[index]);
+	return &devices[index];
+}
+
+uint8_t TrackedDevices::getIndexToRemove() {
+	// Prefer the least recently used device that doesn't have all fields set.
+	for (uint8_t index = lruTail; index != INDEX_NOT_FOUND; index = devices[index].lruPrev) {
+		if (!allFieldsSet(devices[index])) {
+			return index;
 		}
 	}
-	LOGTrackedDevicesDebug("add device");
-	TrackedDevice device;
-	devices.push_front(device);
-	++deviceListSize;
-	return &(devices.front());
+	return lruTail;
 }
 
-cs_ret_code_t TrackedDevices::removeDevice() {
-	uint16_t lowestTTL = 0xFFFF;
-	auto iterToRemove = devices.end();
-	auto prevIter = devices.before_begin();
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->fieldsSet != ALL_FIELDS_SET) {
-			iterToRemove = prevIter;
-			break;
+void TrackedDevices::removeDevice(uint8_t index) {
+	LOGTrackedDevicesDebug("remove device id=%u", devices[index].data.data.deviceId);
+	auto getDeviceId = [&](uint8_t i) { return devices[i].data.data.deviceId; };
+	auto getToken    = [&](uint8_t i) { return getTokenKey(devices[i].data.data.deviceToken); };
+
+	deviceIdIndex.remove(devices[index].data.data.deviceId, index, getDeviceId);
+	if (BLEutil::isBitSet(devices[index].fieldsSet, BIT_POS_DEVICE_TOKEN)) {
+		deviceTokenIndex.remove(getToken(index), index, getToken);
+	}
+	lruUnlink(index);
+
+	uint8_t lastIndex = --deviceListSize;
+	if (index == lastIndex) {
+		return;
+	}
+
+	// Move the last device to the freed index.
+	TrackedDevice& last = devices[lastIndex];
+	deviceIdIndex.replace(last.data.data.deviceId, lastIndex, index);
+	if (BLEutil::isBitSet(last.fieldsSet, BIT_POS_DEVICE_TOKEN)) {
+		deviceTokenIndex.replace(getToken(lastIndex), lastIndex, index);
+	}
+	if (last.lruPrev == INDEX_NOT_FOUND) {
+		lruHead = index;
+	}
+	else {
+		devices[last.lruPrev].lruNext = index;
+	}
+	if (last.lruNext == INDEX_NOT_FOUND) {
+		lruTail = index;
+	}
+	else {
+		devices[last.lruNext].lruPrev = index;
+	}
+	devices[index] = last;
+}
+
+void TrackedDevices::touch(TrackedDevice& device) {
+	uint8_t index = getIndex(device);
+	if (index == lruHead) {
+		return;
+	}
+	lruUnlink(index);
+	device.lruPrev = INDEX_NOT_FOUND;
+	device.lruNext = lruHead;
+	if (lruHead == INDEX_NOT_FOUND) {
+		lruTail = index;
+	}
+	else {
+		devices[lruHead].lruPrev = index;
+	}
+	lruHead = index;
+}
+
+void TrackedDevices::lruUnlink(uint8_t index) {
+	TrackedDevice& device = devices[index];
+	if (device.lruPrev == INDEX_NOT_FOUND) {
+		if (lruHead == index) {
+			lruHead = device.lruNext;
 		}
-		if (iter->data.data.timeToLiveMinutes <= lowestTTL) {
-			lowestTTL = iter->data.data.timeToLiveMinutes;
-			iterToRemove = prevIter;
+	}
+	else {
+		devices[device.lruPrev].lruNext = device.lruNext;
+	}
+	if (device.lruNext == INDEX_NOT_FOUND) {
+		if (lruTail == index) {
+			lruTail = device.lruPrev;
 		}
-		prevIter = iter;
-	}
-	[[maybe_unused]] auto removedIter = iterToRemove;
-	LOGTrackedDevicesDebug("remove device id=%u", (++removedIter)->data.data.deviceId);
-//	if (lowestTTL == 0xFFFF) {
-//		return ERR_NOT_AVAILABLE;
-//	}
-	devices.erase_after(iterToRemove);
-	--deviceListSize;
-	return ERR_SUCCESS;
+	}
+	else {
+		devices[device.lruNext].lruPrev = device.lruPrev;
+	}
+	device.lruPrev = INDEX_NOT_FOUND;
+	device.lruNext = INDEX_NOT_FOUND;
+}
+
+uint8_t TrackedDevices::getIndex(TrackedDevice& device) {
+	return static_cast<uint8_t>(&device - devices);
+}
+
+uint32_t TrackedDevices::getTokenKey(const uint8_t* deviceToken) {
+	static_assert(TRACKED_DEVICE_TOKEN_SIZE <= sizeof(uint32_t));
+	uint32_t key = 0;
+	for (uint8_t i = 0; i < TRACKED_DEVICE_TOKEN_SIZE; ++i) {
+		key |= static_cast<uint32_t>(deviceToken[i]) << (8 * i);
+	}
+	return key;
 }
 
 
@@ -250,12 +328,12 @@ bool TrackedDevices::hasAccess(TrackedDevice& device, uint8_t accessLevel) {
 	return true;
 }
 
-bool TrackedDevices::isTokenOkToSet(TrackedDevice& device, uint8_t* deviceToken, uint8_t size) {
+bool TrackedDevices::isTokenOkToSet(device_id_t deviceId, uint8_t* deviceToken, uint8_t size) {
 	TrackedDevice* otherDevice = findToken(deviceToken, size);
 	if (otherDevice == nullptr) {
 		return true;
 	}
-	if (otherDevice->data.data.deviceId == device.data.data.deviceId) {
+	if (otherDevice->data.data.deviceId == deviceId) {
 		return true;
 	}
 	LOGw("Token already exists (id=%u)", otherDevice->data.data.deviceId);
@@ -274,9 +352,9 @@ void TrackedDevices::checkSynced() {
 		LOGTrackedDevicesDebug("Expecting more devices, current=%u expected=%u", deviceListSize, expectedDeviceListSize);
 		return;
 	}
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (!allFieldsSet(*iter)) {
-			LOGTrackedDevicesDebug("Not all fields set for id=%u", iter->data.data.deviceId);
+	for (uint8_t i = 0; i < deviceListSize; ++i) {
+		if (!allFieldsSet(devices[i])) {
+			LOGTrackedDevicesDebug("Not all fields set for id=%u", devices[i].data.data.deviceId);
 			return;
 		}
 	}
@@ -314,8 +392,15 @@ void TrackedDevices::setFlags(TrackedDevice& device, uint8_t flags) {
 
 void TrackedDevices::setDevicetoken(TrackedDevice& device, uint8_t* deviceToken, uint8_t size) {
 	assert(size == TRACKED_DEVICE_TOKEN_SIZE, "Wrong device token size");
+	uint8_t index = getIndex(device);
+	if (BLEutil::isBitSet(device.fieldsSet, BIT_POS_DEVICE_TOKEN)) {
+		deviceTokenIndex.remove(getTokenKey(device.data.data.deviceToken), index, [&](uint8_t i) {
+			return getTokenKey(devices[i].data.data.deviceToken);
+		});
+	}
 	memcpy(device.data.data.deviceToken, deviceToken, sizeof(device.data.data.deviceToken));
 	BLEutil::setBit(device.fieldsSet, BIT_POS_DEVICE_TOKEN);
+	deviceTokenIndex.insert(getTokenKey(device.data.data.deviceToken), index);
 }
 
 void TrackedDevices::setTTL(TrackedDevice& device, uint16_t ttlMinutes) {
@@ -347,29 +432,33 @@ void TrackedDevices::print(TrackedDevice& device) {
 
 void TrackedDevices::tickMinute() {
 	LOGTrackedDevicesDebug("tickMinute");
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->locationIdTTLMinutes != 0) {
-			iter->locationIdTTLMinutes--;
-			if (iter->locationIdTTLMinutes == 0) {
-				iter->data.data.locationId = 0;
+	// Iterate backwards, so that removing a device only moves an already handled device.
+	for (uint8_t i = deviceListSize; i-- > 0;) {
+		TrackedDevice& device = devices[i];
+		if (device.locationIdTTLMinutes != 0) {
+			device.locationIdTTLMinutes--;
+			if (device.locationIdTTLMinutes == 0) {
+				device.data.data.locationId = 0;
 			}
 		}
-		if (iter->data.data.timeToLiveMinutes != 0) {
-			iter->data.data.timeToLiveMinutes--;
+		if (device.data.data.timeToLiveMinutes != 0) {
+			device.data.data.timeToLiveMinutes--;
+		}
+		if (device.heartbeatTTLMinutes != 0) {
+			device.heartbeatTTLMinutes--;
 		}
-		if (iter->heartbeatTTLMinutes != 0) {
-			iter->heartbeatTTLMinutes--;
+		print(device);
+		// Remove timed out devices.
+		if (device.data.data.timeToLiveMinutes == 0) {
+			removeDevice(i);
 		}
-		print(*iter);
 	}
-	// Removed timed out devices.
-	devices.remove_if([](const TrackedDevice& device) { return device.data.data.timeToLiveMinutes == 0; });
 }
 
 void TrackedDevices::tickSecond() {
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (isValidTTL(*iter) && iter->heartbeatTTLMinutes != 0) {
-			sendHeartbeatLocation(*iter, false, true);
+	for (uint8_t i = 0; i < deviceListSize; ++i) {
+		if (isValidTTL(devices[i]) && devices[i].heartbeatTTLMinutes != 0) {
+			sendHeartbeatLocation(devices[i], false, true);
 		}
 	}
 }
@@ -449,9 +538,9 @@ void TrackedDevices::sendListSizeToMesh() {
 
 void TrackedDevices::sendDeviceList() {
 	LOGTrackedDevicesDebug("sendDeviceList %u devices", deviceListSize);
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		sendRegisterToMesh(*iter);
-		sendTokenToMesh(*iter);
+	for (uint8_t i = 0; i < deviceListSize; ++i) {
+		sendRegisterToMesh(devices[i]);
+		sendTokenToMesh(devices[i]);
 	}
 	sendListSizeToMesh();
 }
@@ -7,6 +7,7 @@
 
 #include <drivers/cs_RNG.h>
 #include <drivers/cs_Serial.h>
+#include <encryption/cs_KeysAndAccess.h>
 #include <events/cs_EventDispatcher.h>
 #include <logging/cs_Logger.h>
 #include <storage/cs_State.h>
@@ -317,11 +318,9 @@ cs_ret_code_t UartHandler::writeEncryptedPart(cs_data_t data) {
 	// Keep up how much data we read from the input data buffer.
 	uint8_t dataSizeRead = 0;
 
-	// TODO: use KeysAndAccess class instead.
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
-	retCode = State::getInstance().get(CS_TYPE::STATE_UART_KEY, key, sizeof(key));
-	if (retCode != ERR_SUCCESS) {
-		return retCode;
+	cs_data_t key = KeysAndAccess::getInstance().getUartKey(0);
+	if (key.data == nullptr) {
+		return ERR_NOT_FOUND;
 	}
 
 	while (dataSizeRead < data.len) {
@@ -338,7 +337,7 @@ cs_ret_code_t UartHandler::writeEncryptedPart(cs_data_t data) {
 
 		// Check if we encryption buffer is full, so we can encrypt a block and write to uart.
 		if (_encryptionBufferWritten >= AES_BLOCK_SIZE) {
-			retCode = writeEncryptedBlock(cs_data_t(key, sizeof(key)));
+			retCode = writeEncryptedBlock(key);
 			if (retCode != ERR_SUCCESS) {
 				return retCode;
 			}
@@ -355,14 +354,12 @@ cs_ret_code_t UartHandler::writeEncryptedEnd() {
 		// Zero pad the remaining bytes.
 		memset(_encryptionBuffer + _encryptionBufferWritten, 0, AES_BLOCK_SIZE - _encryptionBufferWritten);
 
-		// TODO: use KeysAndAccess class instead.
-		uint8_t key[ENCRYPTION_KEY_LENGTH];
-		cs_ret_code_t retCode = State::getInstance().get(CS_TYPE::STATE_UART_KEY, key, sizeof(key));
-		if (retCode != ERR_SUCCESS) {
-			return retCode;
+		cs_data_t key = KeysAndAccess::getInstance().getUartKey(0);
+		if (key.data == nullptr) {
+			return ERR_NOT_FOUND;
 		}
 
-		retCode = writeEncryptedBlock(cs_data_t(key, sizeof(key)));
+		cs_ret_code_t retCode = writeEncryptedBlock(key);
 		if (retCode != ERR_SUCCESS) {
 			return retCode;
 		}
@@ -557,11 +554,8 @@ void UartHandler::handleEncryptedUartMsg(uint8_t* data, uint16_t size) {
 	}
 	cs_data_t encryptedData(data + sizeof(*encryptionHeader), size - sizeof(*encryptionHeader));
 
-	// TODO: use KeysAndAccess class instead.
-	uint8_t key[ENCRYPTION_KEY_LENGTH];
-	cs_state_data_t stateData(CS_TYPE::STATE_UART_KEY, encryptionHeader->keyId, key, sizeof(key));
-	retCode = State::getInstance().get(stateData);
-	if (retCode != ERR_SUCCESS) {
+	cs_data_t key = KeysAndAccess::getInstance().getUartKey(encryptionHeader->keyId);
+	if (key.data == nullptr) {
 		LOGw("Can't find key %u", encryptionHeader->keyId);
 		writeMsg(UART_OPCODE_TX_ERR_REPLY_DECRYPTION_FAILED);
 		return;
@@ -581,7 +575,7 @@ void UartHandler::handleEncryptedUartMsg(uint8_t* data, uint16_t size) {
 	cs_buffer_size_t decryptedPayloadSize; // How much payload data is actually decrypted.
 
 	retCode = AES::getInstance().decryptCtr(
-			cs_data_t(key, sizeof(key)),
+			key,
 			cs_data_t(reinterpret_cast<uint8_t*>(&nonce), sizeof(nonce)),
 			encryptedData,
 			cs_data_t(reinterpret_cast<uint8_t*>(&encryptedHeader), sizeof(encryptedHeader)),
@@ -1,5 +1,4 @@
 #include <util/cs_DoubleStackCoroutine.h>
-#include <cfg/cs_StaticConfig.h>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -22,38 +21,38 @@ int next(coroutine* c) {
 	}
 }
 
-typedef struct {
-	coroutine* c;
-	coroutine_func f;
-	void* arg;
-	void* old_sp;
-} start_params;
-
-#define get_sp(p) asm volatile("mov %0, sp" : "=r"(p) : : )
-#define set_sp(p) asm volatile("mov sp, %0" : : "r"(p))
-
-// We hardcode the stack at the end of the RAM dedicated to the microapp
-start_params *const params = (start_params *)(uintptr_t)(g_RAM_MICROAPP_END);
-
-void start(coroutine* c, coroutine_func f, void* arg) {
-	//save parameters before stack switching
-	params->c = c;
-	params->f = f;
-	params->arg = arg;
-	get_sp(params->old_sp);
-	
-	// set stack pointer for the coroutine (starts with start_params and goes down)
-	size_t move_down = sizeof(start_params);
-	set_sp(params - move_down);
-
-	if(!setjmp(params->c->callee_context)) {
-		set_sp(params->old_sp);
+/**
+ * Runs on the stack of the coroutine.
+ *
+ * The parameters are kept in the frame of this function, on the stack of the coroutine, or in registers that are
+ * restored by longjmp(). So each coroutine has its own, and they are still valid when the coroutine is resumed.
+ */
+static void __attribute__((noinline)) run(coroutine* c, coroutine_func f, void* arg) {
+	if(!setjmp(c->callee_context)) {
+		// return to start(), which switches back to the stack of the caller
 		return;
 	}
-		
+
 	// call the function that will - in the end - yield
-	(*params->f)(params->arg);
+	(*f)(arg);
 
 	// jump to caller
-	longjmp(params->c->caller_context, DONE);
+	longjmp(c->caller_context, DONE);
+}
+
+void __attribute__((noinline)) start(coroutine* c, coroutine_func f, void* arg, void* stack) {
+	// Switch the stack pointer, call run() with the parameters in registers, and switch back.
+	// This is done in a single asm block, so that no variable is read from memory while on the other stack.
+	// The stack pointer of the caller is kept in r4, which is preserved by run().
+	asm volatile(
+			"mov r4, sp\n\t"
+			"mov sp, %[stack]\n\t"
+			"mov r0, %[c]\n\t"
+			"mov r1, %[f]\n\t"
+			"mov r2, %[arg]\n\t"
+			"blx %[run]\n\t"
+			"mov sp, r4\n\t"
+			:
+			: [stack] "r"(stack), [c] "r"(c), [f] "r"(f), [arg] "r"(arg), [run] "r"(run)
+			: "r0", "r1", "r2", "r3", "r4", "r12", "lr", "memory", "cc");
 }
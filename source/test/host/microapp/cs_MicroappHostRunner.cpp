@@ -0,0 +1,377 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include "cs_MicroappHostRunner.h"
+
+#include <ipc/cs_IpcRamData.h>
+#include <microapp/cs_MicroappCommandRing.h>
+#include <protocol/cs_ErrorCodes.h>
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+const size_t LOOP_STACK_SIZE = 64 * 1024;
+
+uint64_t getCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+uint64_t getNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeAddress(uint8_t* buf, uintptr_t address) {
+	for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
+		buf[i] = (uint8_t)(0xFF & (address >> (i * 8)));
+	}
+}
+
+uintptr_t readAddress(const uint8_t* buf) {
+	uintptr_t address = 0;
+	for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
+		address |= (uintptr_t)buf[i] << (i * 8);
+	}
+	return address;
+}
+
+const char* getCommandName(uint8_t command) {
+	switch (command) {
+		case CS_MICROAPP_COMMAND_LOG: return "log";
+		case CS_MICROAPP_COMMAND_DELAY: return "delay";
+		case CS_MICROAPP_COMMAND_PIN: return "pin";
+		case CS_MICROAPP_COMMAND_SERVICE_DATA: return "service data";
+		case CS_MICROAPP_COMMAND_TWI: return "twi";
+		case CS_MICROAPP_COMMAND_SCAN: return "scan";
+		case CS_MICROAPP_COMMAND_COMMAND_RING: return "command ring";
+		default: return "unknown";
+	}
+}
+
+void printStats(std::ostream& out, const char* name, const microapp_host_call_stats_t& stats) {
+	out << "  " << std::left << std::setw(14) << name << std::right
+			<< " calls=" << std::setw(6) << stats.count
+			<< " avg=" << std::setw(8) << (stats.count ? stats.totalNs / stats.count : 0) << " ns"
+			<< " max=" << std::setw(8) << stats.maxNs << " ns"
+			<< " avg=" << std::setw(8) << (stats.count ? stats.totalCycles / stats.count : 0) << " cycles"
+			<< std::endl;
+}
+
+}  // namespace
+
+extern "C" int microapp_callback(uint8_t* payload, uint16_t length) {
+	return MicroappHostRunner::callback(payload, length);
+}
+
+void microapp_host_call_stats_t::add(uint64_t ns, uint64_t cycles) {
+	count++;
+	totalNs += ns;
+	totalCycles += cycles;
+	if (ns > maxNs) {
+		maxNs = ns;
+	}
+}
+
+int MicroappHostBackend::handleCommand(uint8_t* payload, uint16_t length) {
+	switch (payload[0]) {
+		case CS_MICROAPP_COMMAND_LOG: {
+			return handleLogCommand(payload, length);
+		}
+		case CS_MICROAPP_COMMAND_PIN: {
+			if (length < sizeof(pin_cmd_t)) {
+				return ERR_NO_PAYLOAD;
+			}
+			return handlePinCommand((pin_cmd_t*)payload);
+		}
+		case CS_MICROAPP_COMMAND_TWI: {
+			if (length < sizeof(twi_cmd_t)) {
+				return ERR_NO_PAYLOAD;
+			}
+			return handleTwiCommand((twi_cmd_t*)payload);
+		}
+		case CS_MICROAPP_COMMAND_SERVICE_DATA: {
+			// Byte 0 is command, byte 1 is type, byte 2 is unused, then the app UUID.
+			if (length < 5) {
+				return ERR_NO_PAYLOAD;
+			}
+			serviceData.assign(payload + 5, payload + length);
+			serviceDataUpdates++;
+			return ERR_SUCCESS;
+		}
+		default:
+			return ERR_UNKNOWN_OP_CODE;
+	}
+}
+
+int MicroappHostBackend::handleLogCommand(uint8_t* payload, uint16_t length) {
+	if (length < 3) {
+		return ERR_NO_PAYLOAD;
+	}
+	switch (payload[1]) {
+		case CS_MICROAPP_COMMAND_LOG_CHAR: {
+			_logLine += std::to_string((int)(char)payload[3]);
+			break;
+		}
+		case CS_MICROAPP_COMMAND_LOG_SHORT: {
+			uint16_t value;
+			memcpy(&value, payload + 3, sizeof(value));
+			_logLine += std::to_string(value);
+			break;
+		}
+		case CS_MICROAPP_COMMAND_LOG_UINT:
+		case CS_MICROAPP_COMMAND_LOG_INT: {
+			int value;
+			memcpy(&value, payload + 3, sizeof(value));
+			_logLine += std::to_string(value);
+			break;
+		}
+		case CS_MICROAPP_COMMAND_LOG_STR: {
+			_logLine.append((const char*)payload + 3, length - 3);
+			break;
+		}
+		default:
+			return ERR_UNKNOWN_OP_CODE;
+	}
+	if (payload[2] == CS_MICROAPP_COMMAND_LOG_NEWLINE) {
+		logLines.push_back(_logLine);
+		_logLine.clear();
+	}
+	return ERR_SUCCESS;
+}
+
+int MicroappHostBackend::handlePinCommand(pin_cmd_t* cmd) {
+	if (cmd->pin >= PIN_COUNT) {
+		return ERR_UNKNOWN_OP_CODE;
+	}
+	if (cmd->pin == CS_MICROAPP_COMMAND_PIN_SWITCH) {
+		if (cmd->opcode2 != CS_MICROAPP_COMMAND_PIN_WRITE) {
+			return ERR_UNKNOWN_OP_CODE;
+		}
+		bool on = (cmd->value == CS_MICROAPP_COMMAND_VALUE_ON);
+		if (on != switchOn) {
+			switchChanges++;
+		}
+		switchOn = on;
+		return ERR_SUCCESS;
+	}
+	switch (cmd->opcode1) {
+		case CS_MICROAPP_COMMAND_PIN_MODE:
+			pinMode[cmd->pin] = cmd->opcode2;
+			return ERR_SUCCESS;
+		case CS_MICROAPP_COMMAND_PIN_ACTION:
+			if (cmd->opcode2 == CS_MICROAPP_COMMAND_PIN_WRITE) {
+				pinValue[cmd->pin] = cmd->value;
+			}
+			return ERR_SUCCESS;
+		default:
+			return ERR_UNKNOWN_OP_CODE;
+	}
+}
+
+int MicroappHostBackend::handleTwiCommand(twi_cmd_t* cmd) {
+	switch (cmd->opcode) {
+		case CS_MICROAPP_COMMAND_TWI_INIT:
+			twiInitialized = true;
+			return ERR_SUCCESS;
+		case CS_MICROAPP_COMMAND_TWI_WRITE: {
+			uint8_t length = cmd->length < MAX_TWI_PAYLOAD ? cmd->length : MAX_TWI_PAYLOAD;
+			twiWrittenData[cmd->address].assign(cmd->buf, cmd->buf + length);
+			return ERR_SUCCESS;
+		}
+		case CS_MICROAPP_COMMAND_TWI_READ: {
+			const std::vector<uint8_t>& data = twiReadData[cmd->address];
+			uint8_t length = cmd->length < MAX_TWI_PAYLOAD ? cmd->length : MAX_TWI_PAYLOAD;
+			if (length > data.size()) {
+				length = data.size();
+			}
+			memcpy(cmd->buf, data.data(), length);
+			cmd->length = length;
+			cmd->ack = ERR_SUCCESS;
+			return ERR_SUCCESS;
+		}
+		default:
+			return ERR_UNKNOWN_OP_CODE;
+	}
+}
+
+MicroappHostRunner* MicroappHostRunner::_current = nullptr;
+
+MicroappHostRunner::MicroappHostRunner() {
+	for (auto& app : _apps) {
+		app.loopStack.resize(LOOP_STACK_SIZE);
+	}
+	_current = this;
+}
+
+MicroappHostRunner::~MicroappHostRunner() {
+	if (_current == this) {
+		_current = nullptr;
+	}
+}
+
+bool MicroappHostRunner::boot(void (*microappMain)()) {
+	if (_appCount >= MAX_MICROAPPS) {
+		return false;
+	}
+	// Same layout as MicroappProtocol::setIpcRam().
+	uint8_t buf[BLUENET_IPC_RAM_DATA_ITEM_SIZE];
+	buf[0] = 0;
+	writeAddress(buf + 1, (uintptr_t)&microapp_callback);
+	setRamData(IPC_INDEX_CROWNSTONE_APP, buf, 1 + sizeof(uintptr_t));
+
+	_currentAppIndex = _appCount;
+	microappMain();
+
+	uint8_t size = 0;
+	if (getRamData(IPC_INDEX_MICROAPP, buf, sizeof(buf), &size) != IPC_RET_SUCCESS
+			|| size < 1 + 2 * sizeof(uintptr_t) || buf[0] != 0) {
+		return false;
+	}
+	microapp_host_app_t& app = _apps[_appCount];
+	app.setup = (void (*)())readAddress(buf + 1);
+	app.loop = (void (*)(void*))readAddress(buf + 1 + sizeof(uintptr_t));
+	if (app.setup == nullptr || app.loop == nullptr) {
+		return false;
+	}
+	_appCount++;
+	return true;
+}
+
+void MicroappHostRunner::run(uint32_t loopIntervals) {
+	for (_currentAppIndex = 0; _currentAppIndex < _appCount; ++_currentAppIndex) {
+		if (!_apps[_currentAppIndex].setupDone) {
+			callSetup();
+		}
+	}
+
+	for (uint32_t i = 0; i < loopIntervals; ++i) {
+		for (_currentAppIndex = 0; _currentAppIndex < _appCount; ++_currentAppIndex) {
+			microapp_host_app_t& app = _apps[_currentAppIndex];
+			if (app.skip > 0) {
+				app.skip--;
+				continue;
+			}
+			uint64_t startNs = getNs();
+			uint64_t startCycles = getCycles();
+			callLoop();
+			handleCommandRing();
+			app.loopStats.add(getNs() - startNs, getCycles() - startCycles);
+		}
+	}
+}
+
+void MicroappHostRunner::callSetup() {
+	microapp_host_app_t& app = _apps[_currentAppIndex];
+	uint64_t startNs = getNs();
+	uint64_t startCycles = getCycles();
+	app.setup();
+	handleCommandRing();
+	app.setupStats.add(getNs() - startNs, getCycles() - startCycles);
+	app.setupDone = true;
+}
+
+void MicroappHostRunner::callLoop() {
+	microapp_host_app_t& app = _apps[_currentAppIndex];
+	if (!app.loopRunning) {
+		getcontext(&app.loopContext);
+		app.loopContext.uc_stack.ss_sp = app.loopStack.data();
+		app.loopContext.uc_stack.ss_size = app.loopStack.size();
+		app.loopContext.uc_link = &_callerContext;
+		makecontext(&app.loopContext, &MicroappHostRunner::loopEntry, 0);
+		app.loopRunning = true;
+	}
+	_inLoop = true;
+	swapcontext(&_callerContext, &app.loopContext);
+	_inLoop = false;
+}
+
+void MicroappHostRunner::loopEntry() {
+	microapp_host_app_t& app = _current->_apps[_current->_currentAppIndex];
+	app.loop(nullptr);
+	// Returning continues at uc_link, which is the caller.
+	app.loopRunning = false;
+}
+
+int MicroappHostRunner::callback(uint8_t* payload, uint16_t length) {
+	if (_current == nullptr) {
+		return ERR_NO_PAYLOAD;
+	}
+	return _current->handleCallback(payload, length);
+}
+
+int MicroappHostRunner::handleCallback(uint8_t* payload, uint16_t length) {
+	if (length == 0) {
+		return ERR_NO_PAYLOAD;
+	}
+	if (length > 255) {
+		return ERR_TOO_LARGE;
+	}
+	microapp_host_app_t& app = _apps[_currentAppIndex];
+	if (payload[0] == CS_MICROAPP_COMMAND_DELAY) {
+		_commandStats[payload[0]].add(0, 0);
+		if (!_inLoop || length < 3) {
+			// Like on a crownstone, there is nothing to yield from outside the loop.
+			return ERR_SUCCESS;
+		}
+		uint16_t delayMs = (payload[1] << 8) + payload[2];
+		app.skip = delayMs / MICROAPP_HOST_LOOP_INTERVAL_MS;
+		app.yields++;
+		swapcontext(&app.loopContext, &_callerContext);
+		return ERR_SUCCESS;
+	}
+	if (payload[0] == CS_MICROAPP_COMMAND_COMMAND_RING) {
+		if (length < sizeof(command_ring_cmd_t)) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+		((command_ring_cmd_t*)payload)->address = (uintptr_t)&app.commandRing;
+		return ERR_SUCCESS;
+	}
+	return handleCommand(payload, length);
+}
+
+int MicroappHostRunner::handleCommand(uint8_t* payload, uint16_t length) {
+	uint64_t startNs = getNs();
+	uint64_t startCycles = getCycles();
+	int result = _backend.handleCommand(payload, length);
+	_commandStats[payload[0]].add(getNs() - startNs, getCycles() - startCycles);
+	return result;
+}
+
+void MicroappHostRunner::handleCommandRing() {
+	microapp_host_app_t& app = _apps[_currentAppIndex];
+	uint8_t handledCount = 0;
+	handleMicroappCommandRing(
+			app.commandRing,
+			[this](uint8_t* payload, uint16_t length) { return handleCommand(payload, length); },
+			handledCount);
+	app.ringCommands += handledCount;
+}
+
+void MicroappHostRunner::printReport(std::ostream& out) const {
+	for (uint8_t i = 0; i < _appCount; ++i) {
+		const microapp_host_app_t& app = _apps[i];
+		out << "Microapp " << (int)i << " report:" << std::endl;
+		printStats(out, "setup", app.setupStats);
+		printStats(out, "loop", app.loopStats);
+		out << "  yields=" << app.yields << " ring commands=" << app.ringCommands << std::endl;
+	}
+	out << "Commands:" << std::endl;
+	for (auto& commandStats : _commandStats) {
+		printStats(out, getCommandName(commandStats.first), commandStats.second);
+	}
+}
@@ -0,0 +1,205 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cs_MicroappStructs.h>
+#include <protocol/cs_MicroappPackets.h>
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <ucontext.h>
+
+/**
+ * Same as MICROAPP_LOOP_INTERVAL_MS of the firmware.
+ */
+#define MICROAPP_HOST_LOOP_INTERVAL_MS 1000
+
+/**
+ * Timing of calls.
+ */
+struct microapp_host_call_stats_t {
+	uint32_t count = 0;
+	uint64_t totalNs = 0;
+	uint64_t maxNs = 0;
+	// Only measured on x86.
+	uint64_t totalCycles = 0;
+
+	void add(uint64_t ns, uint64_t cycles);
+};
+
+/**
+ * Simulates what the commands of a microapp do on a crownstone.
+ */
+struct MicroappHostBackend {
+	static constexpr uint8_t PIN_COUNT = CS_MICROAPP_COMMAND_PIN_LED4 + 1;
+
+	bool switchOn = false;
+	uint32_t switchChanges = 0;
+
+	uint8_t pinMode[PIN_COUNT] = {};
+	uint8_t pinValue[PIN_COUNT] = {};
+
+	bool twiInitialized = false;
+
+	/**
+	 * Data that a read from a TWI device returns, per address.
+	 */
+	std::map<uint8_t, std::vector<uint8_t>> twiReadData;
+
+	/**
+	 * Data last written to a TWI device, per address.
+	 */
+	std::map<uint8_t, std::vector<uint8_t>> twiWrittenData;
+
+	std::vector<std::string> logLines;
+
+	std::vector<uint8_t> serviceData;
+	uint32_t serviceDataUpdates = 0;
+
+	/**
+	 * Handle a command, except delay.
+	 *
+	 * @return   ERR_SUCCESS, or an error code.
+	 */
+	int handleCommand(uint8_t* payload, uint16_t length);
+
+private:
+	std::string _logLine;
+
+	int handlePinCommand(pin_cmd_t* cmd);
+	int handleTwiCommand(twi_cmd_t* cmd);
+	int handleLogCommand(uint8_t* payload, uint16_t length);
+};
+
+/**
+ * Runtime state of a microapp in the host runner, like microapp_context_t of the firmware.
+ */
+struct microapp_host_app_t {
+	void (*setup)() = nullptr;
+	void (*loop)(void*) = nullptr;
+
+	microapp_command_ring_t commandRing = {};
+
+	ucontext_t loopContext;
+	std::vector<uint8_t> loopStack;
+	bool setupDone = false;
+	bool loopRunning = false;
+
+	/**
+	 * Number of loop intervals to skip, because the microapp delayed.
+	 */
+	uint32_t skip = 0;
+
+	microapp_host_call_stats_t setupStats;
+	microapp_host_call_stats_t loopStats;
+	uint32_t yields = 0;
+	uint32_t ringCommands = 0;
+};
+
+/**
+ * Runs microapps in a host process, the way MicroappProtocol runs them on a crownstone.
+ *
+ * Each microapp has its own command ring, and its loop runs in a coroutine with its own stack, so that the
+ * microapp can delay. The microapps share the backend, like they share the crownstone.
+ * Each call into a microapp, and each command, is timed.
+ *
+ * Only one runner can be used at a time, as the callback of the microapps is a plain function.
+ */
+class MicroappHostRunner {
+public:
+	MicroappHostRunner();
+	~MicroappHostRunner();
+
+	/**
+	 * Set IPC ram, call main of the next microapp, and read its setup and loop from IPC ram.
+	 *
+	 * The microapps get an index in the order they are booted.
+	 *
+	 * @return   False when there is no room for another microapp, or the microapp didn't register setup and loop.
+	 */
+	bool boot(void (*microappMain)());
+
+	/**
+	 * Call setup of each microapp the first time, and then loop of each microapp every loop interval,
+	 * unless the microapp delayed.
+	 *
+	 * @param[in] loopIntervals   Number of loop intervals to simulate.
+	 */
+	void run(uint32_t loopIntervals);
+
+	MicroappHostBackend& getBackend() {
+		return _backend;
+	}
+
+	uint8_t getAppCount() const {
+		return _appCount;
+	}
+
+	const microapp_host_app_t& getApp(uint8_t appIndex) const {
+		return _apps[appIndex];
+	}
+
+	/**
+	 * Timing per command opcode, of all microapps together.
+	 */
+	const std::map<uint8_t, microapp_host_call_stats_t>& getCommandStats() const {
+		return _commandStats;
+	}
+
+	void printReport(std::ostream& out) const;
+
+	/**
+	 * Callback of the microapps.
+	 */
+	static int callback(uint8_t* payload, uint16_t length);
+
+private:
+	static MicroappHostRunner* _current;
+
+	MicroappHostBackend _backend;
+
+	microapp_host_app_t _apps[MAX_MICROAPPS];
+	uint8_t _appCount = 0;
+
+	/**
+	 * Index of the microapp that is called, so that commands know from which microapp they are.
+	 */
+	uint8_t _currentAppIndex = 0;
+
+	ucontext_t _callerContext;
+	bool _inLoop = false;
+
+	std::map<uint8_t, microapp_host_call_stats_t> _commandStats;
+
+	int handleCallback(uint8_t* payload, uint16_t length);
+
+	/**
+	 * Handle a command, except delay, and time it.
+	 */
+	int handleCommand(uint8_t* payload, uint16_t length);
+
+	/**
+	 * Call setup of the current microapp.
+	 */
+	void callSetup();
+
+	/**
+	 * Start or resume the loop coroutine of the current microapp, until it yields or returns.
+	 */
+	void callLoop();
+
+	static void loopEntry();
+
+	/**
+	 * Handle the command ring of the current microapp, with handleMicroappCommandRing() like the firmware.
+	 */
+	void handleCommandRing();
+};
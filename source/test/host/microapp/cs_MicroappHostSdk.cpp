@@ -0,0 +1,215 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include "cs_MicroappHostSdk.h"
+
+#include <ipc/cs_IpcRamData.h>
+#include <protocol/cs_ErrorCodes.h>
+#include <protocol/cs_MicroappPackets.h>
+
+#include <cstring>
+#include <utility>
+
+namespace {
+
+typedef int (*callback_func)(uint8_t*, uint16_t);
+typedef void (*setup_func)();
+typedef void (*loop_func)(void*);
+
+callback_func bluenetCallback = nullptr;
+
+/**
+ * What each microapp keeps in its own memory on a crownstone.
+ */
+struct microapp_sdk_app_t {
+	void (*setup)() = nullptr;
+	void (*loop)() = nullptr;
+	microapp_command_ring_t* commandRing = nullptr;
+};
+
+microapp_sdk_app_t apps[MAX_MICROAPPS];
+uint8_t appCount = 0;
+
+/**
+ * The microapp that is called.
+ */
+microapp_sdk_app_t* currentApp = nullptr;
+
+/**
+ * Setup as called by bluenet, one per microapp, so that the SDK knows which microapp is called.
+ */
+template <size_t AppIndex>
+void setupEntry() {
+	currentApp = &apps[AppIndex];
+	currentApp->setup();
+}
+
+/**
+ * Loop as called by bluenet: with the coroutine arguments.
+ */
+template <size_t AppIndex>
+void loopEntry(void* coargs) {
+	(void)coargs;
+	currentApp = &apps[AppIndex];
+	currentApp->loop();
+}
+
+template <size_t... Indices>
+setup_func getSetupEntry(uint8_t appIndex, std::index_sequence<Indices...>) {
+	const setup_func entries[] = {&setupEntry<Indices>...};
+	return entries[appIndex];
+}
+
+template <size_t... Indices>
+loop_func getLoopEntry(uint8_t appIndex, std::index_sequence<Indices...>) {
+	const loop_func entries[] = {&loopEntry<Indices>...};
+	return entries[appIndex];
+}
+
+void writeAddress(uint8_t* buf, uintptr_t address) {
+	for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
+		buf[i] = (uint8_t)(0xFF & (address >> (i * 8)));
+	}
+}
+
+uintptr_t readAddress(const uint8_t* buf) {
+	uintptr_t address = 0;
+	for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
+		address |= (uintptr_t)buf[i] << (i * 8);
+	}
+	return address;
+}
+
+}  // namespace
+
+bool microappRegister(void (*setup)(), void (*loop)()) {
+	if (appCount >= MAX_MICROAPPS) {
+		return false;
+	}
+	uint8_t appIndex = appCount++;
+	currentApp = &apps[appIndex];
+	currentApp->setup = setup;
+	currentApp->loop = loop;
+
+	uint8_t buf[BLUENET_IPC_RAM_DATA_ITEM_SIZE];
+	uint8_t size = 0;
+	if (getRamData(IPC_INDEX_CROWNSTONE_APP, buf, sizeof(buf), &size) == IPC_RET_SUCCESS
+			&& size >= 1 + sizeof(uintptr_t)) {
+		bluenetCallback = (callback_func)readAddress(buf + 1);
+	}
+
+	// The IPC ram is shared by all microapps, bluenet tells each microapp where its own command ring is.
+	command_ring_cmd_t cmd = {};
+	cmd.cmd = CS_MICROAPP_COMMAND_COMMAND_RING;
+	if (microappSendCommand((uint8_t*)&cmd, sizeof(cmd)) == ERR_SUCCESS) {
+		currentApp->commandRing = (microapp_command_ring_t*)cmd.address;
+	}
+
+	buf[0] = 0;  // protocol version
+	writeAddress(buf + 1, (uintptr_t)getSetupEntry(appIndex, std::make_index_sequence<MAX_MICROAPPS>()));
+	writeAddress(buf + 1 + sizeof(uintptr_t), (uintptr_t)getLoopEntry(appIndex, std::make_index_sequence<MAX_MICROAPPS>()));
+	setRamData(IPC_INDEX_MICROAPP, buf, 1 + 2 * sizeof(uintptr_t));
+	return true;
+}
+
+int microappSendCommand(uint8_t* payload, uint16_t length) {
+	if (bluenetCallback == nullptr) {
+		return -1;
+	}
+	return bluenetCallback(payload, length);
+}
+
+bool microappQueueCommand(const uint8_t* payload, uint8_t length) {
+	if (currentApp == nullptr || currentApp->commandRing == nullptr || length > MAX_PAYLOAD) {
+		return false;
+	}
+	microapp_command_ring_t* commandRing = currentApp->commandRing;
+	uint8_t head = commandRing->commandHead;
+	if ((uint8_t)(head - commandRing->commandTail) >= MICROAPP_COMMAND_RING_SIZE) {
+		return false;
+	}
+	microapp_ring_command_t& command = commandRing->commands[head & (MICROAPP_COMMAND_RING_SIZE - 1)];
+	memcpy(command.payload, payload, length);
+	command.length = length;
+	commandRing->commandHead = head + 1;
+	return true;
+}
+
+bool microappGetCompletion(microapp_ring_completion_t& completion) {
+	if (currentApp == nullptr || currentApp->commandRing == nullptr) {
+		return false;
+	}
+	microapp_command_ring_t* commandRing = currentApp->commandRing;
+	uint8_t tail = commandRing->completionTail;
+	if (tail == commandRing->completionHead) {
+		return false;
+	}
+	completion = commandRing->completions[tail & (MICROAPP_COMMAND_RING_SIZE - 1)];
+	commandRing->completionTail = tail + 1;
+	return true;
+}
+
+void microappDelay(uint16_t delayMs) {
+	// The coroutine arguments don't fit in the payload on the host, the runner knows them.
+	uint8_t payload[7] = {CS_MICROAPP_COMMAND_DELAY, (uint8_t)(delayMs >> 8), (uint8_t)delayMs, 0, 0, 0, 0};
+	// Other microapps may run during the delay.
+	microapp_sdk_app_t* app = currentApp;
+	microappSendCommand(payload, sizeof(payload));
+	currentApp = app;
+}
+
+void microappLog(const char* str) {
+	uint8_t payload[MAX_PAYLOAD];
+	size_t length = strnlen(str, MAX_PAYLOAD - 4);
+	payload[0] = CS_MICROAPP_COMMAND_LOG;
+	payload[1] = CS_MICROAPP_COMMAND_LOG_STR;
+	payload[2] = CS_MICROAPP_COMMAND_LOG_NEWLINE;
+	memcpy(payload + 3, str, length);
+	microappSendCommand(payload, 3 + length);
+}
+
+void microappPinMode(uint8_t pin, CommandMicroappPinOpcode2 mode) {
+	pin_cmd_t cmd = {};
+	cmd.cmd = CS_MICROAPP_COMMAND_PIN;
+	cmd.pin = pin;
+	cmd.opcode1 = CS_MICROAPP_COMMAND_PIN_MODE;
+	cmd.opcode2 = mode;
+	microappSendCommand((uint8_t*)&cmd, sizeof(cmd));
+}
+
+void microappDigitalWrite(uint8_t pin, CommandMicroappPinValue value) {
+	pin_cmd_t cmd = {};
+	cmd.cmd = CS_MICROAPP_COMMAND_PIN;
+	cmd.pin = pin;
+	cmd.opcode1 = CS_MICROAPP_COMMAND_PIN_ACTION;
+	cmd.opcode2 = CS_MICROAPP_COMMAND_PIN_WRITE;
+	cmd.value = value;
+	microappSendCommand((uint8_t*)&cmd, sizeof(cmd));
+}
+
+uint8_t microappTwiRead(uint8_t address, uint8_t* buf, uint8_t length) {
+	twi_cmd_t cmd = {};
+	cmd.cmd = CS_MICROAPP_COMMAND_TWI;
+	cmd.address = address;
+	cmd.opcode = CS_MICROAPP_COMMAND_TWI_READ;
+	cmd.length = length < MAX_TWI_PAYLOAD ? length : MAX_TWI_PAYLOAD;
+	cmd.stop = 1;
+	microappSendCommand((uint8_t*)&cmd, sizeof(cmd));
+	memcpy(buf, cmd.buf, cmd.length);
+	return cmd.length;
+}
+
+void microappTwiWrite(uint8_t address, const uint8_t* buf, uint8_t length) {
+	twi_cmd_t cmd = {};
+	cmd.cmd = CS_MICROAPP_COMMAND_TWI;
+	cmd.address = address;
+	cmd.opcode = CS_MICROAPP_COMMAND_TWI_WRITE;
+	cmd.length = length < MAX_TWI_PAYLOAD ? length : MAX_TWI_PAYLOAD;
+	cmd.stop = 1;
+	memcpy(cmd.buf, buf, cmd.length);
+	microappSendCommand((uint8_t*)&cmd, sizeof(cmd));
+}
@@ -0,0 +1,68 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cs_MicroappStructs.h>
+
+/**
+ * Minimal microapp side of the protocol, for microapps that run on the host.
+ *
+ * Just like on a crownstone, the microapp finds bluenet via the IPC ram, and registers its setup and loop there.
+ * Addresses are stored with the size of a pointer of the host, instead of 4 bytes.
+ *
+ * On a crownstone, each microapp has its own copy of this code. On the host, several microapps share it, so it keeps
+ * the state of each microapp separately, and registers setup and loop via an entry per microapp that selects it.
+ */
+
+/**
+ * To be called from the main of the microapp: registers setup and loop in IPC ram, and finds bluenet and the command
+ * ring of the microapp.
+ *
+ * @return   False when MAX_MICROAPPS microapps have already been registered.
+ */
+bool microappRegister(void (*setup)(), void (*loop)());
+
+/**
+ * Send a command to bluenet, via the callback.
+ *
+ * @return   Result of the command.
+ */
+int microappSendCommand(uint8_t* payload, uint16_t length);
+
+/**
+ * Queue a command in the command ring. It will be handled when the microapp yields or returns.
+ *
+ * @return   False when the ring is full, or the command is too large.
+ */
+bool microappQueueCommand(const uint8_t* payload, uint8_t length);
+
+/**
+ * Get the result of a queued command.
+ *
+ * @return   False when there is no result.
+ */
+bool microappGetCompletion(microapp_ring_completion_t& completion);
+
+/**
+ * Yield to bluenet, which calls loop again after the given delay.
+ */
+void microappDelay(uint16_t delayMs);
+
+void microappLog(const char* str);
+
+void microappPinMode(uint8_t pin, CommandMicroappPinOpcode2 mode);
+
+void microappDigitalWrite(uint8_t pin, CommandMicroappPinValue value);
+
+/**
+ * Read from a TWI device.
+ *
+ * @return   Number of bytes read.
+ */
+uint8_t microappTwiRead(uint8_t address, uint8_t* buf, uint8_t length);
+
+void microappTwiWrite(uint8_t address, const uint8_t* buf, uint8_t length);
@@ -0,0 +1,46 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+/**
+ * Runs a microapp with Arduino style setup() and loop() on the host, and prints what it did.
+ *
+ * Usage: microapp_host_runner [loop intervals]
+ */
+
+#include "cs_MicroappHostRunner.h"
+#include "cs_MicroappHostSdk.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// Implemented by the microapp.
+void setup();
+void loop();
+
+static void microappMain() {
+	microappRegister(&setup, &loop);
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t loopIntervals = 60;
+	if (argc > 1) {
+		loopIntervals = strtoul(argv[1], nullptr, 10);
+	}
+
+	MicroappHostRunner runner;
+	if (!runner.boot(&microappMain)) {
+		std::cerr << "Microapp did not register setup and loop" << std::endl;
+		return 1;
+	}
+	runner.run(loopIntervals);
+
+	for (auto& line : runner.getBackend().logLines) {
+		std::cout << "microapp: " << line << std::endl;
+	}
+	runner.printReport(std::cout);
+	return 0;
+}
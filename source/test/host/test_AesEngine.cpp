@@ -0,0 +1,148 @@
+#include <encryption/cs_AesEngine.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+
+// FIPS-197, appendix C.1.
+const uint8_t fipsKey[]        = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+const uint8_t fipsPlaintext[]  = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+const uint8_t fipsCiphertext[] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+// NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt, first block.
+// Only the first block can be used, as the block counter is a single byte.
+const uint8_t nistKey[]        = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+const uint8_t nistNonce[]      = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe};
+const uint8_t nistBlockCtr     = 0xff;
+const uint8_t nistPlaintext[]  = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a};
+const uint8_t nistCiphertext[] = {0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce};
+
+#define MAX_TEST_SIZE (20 * AES_BLOCK_SIZE)
+
+AesEngine engine;
+
+/**
+ * Encrypt the stream of prefix + input one block at a time, like the original implementation did.
+ */
+void referenceCtr(const uint8_t* key, const uint8_t* nonce, uint8_t nonceSize, const uint8_t* data, uint16_t size, uint8_t blockCtr, uint8_t* output) {
+	AesEngine blockEngine;
+	blockEngine.setKey(key);
+	uint16_t numBlocks = (size + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+	uint8_t padded[MAX_TEST_SIZE] = {0};
+	memcpy(padded, data, size);
+	for (uint16_t i = 0; i < numBlocks; ++i) {
+		uint8_t counterBlock[AES_BLOCK_SIZE] = {0};
+		memcpy(counterBlock, nonce, nonceSize);
+		counterBlock[AES_BLOCK_SIZE - 1] = blockCtr + i;
+		uint8_t keystream[AES_BLOCK_SIZE];
+		blockEngine.ecb(cs_data_t(), cs_data_t(counterBlock, sizeof(counterBlock)), cs_data_t(keystream, sizeof(keystream)), 1);
+		for (int j = 0; j < AES_BLOCK_SIZE; ++j) {
+			output[i * AES_BLOCK_SIZE + j] = padded[i * AES_BLOCK_SIZE + j] ^ keystream[j];
+		}
+	}
+}
+
+void testVectors() {
+	cout << "Test ECB with FIPS-197 vector." << endl;
+	uint8_t output[AES_BLOCK_SIZE];
+	engine.setKey(fipsKey);
+	engine.ecb(cs_data_t(), cs_data_t((uint8_t*)fipsPlaintext, sizeof(fipsPlaintext)), cs_data_t(output, sizeof(output)), 1);
+	assert(memcmp(output, fipsCiphertext, sizeof(output)) == 0);
+
+	cout << "Test ECB with FIPS-197 vector, split in prefix and input." << endl;
+	engine.ecb(cs_data_t((uint8_t*)fipsPlaintext, 5), cs_data_t((uint8_t*)fipsPlaintext + 5, sizeof(fipsPlaintext) - 5), cs_data_t(output, sizeof(output)), 1);
+	assert(memcmp(output, fipsCiphertext, sizeof(output)) == 0);
+
+	cout << "Test CTR with SP 800-38A vector." << endl;
+	engine.setKey(nistKey);
+	cs_buffer_size_t writtenSize = engine.ctr(
+			cs_data_t((uint8_t*)nistNonce, sizeof(nistNonce)),
+			cs_data_t(),
+			cs_data_t((uint8_t*)nistPlaintext, sizeof(nistPlaintext)),
+			cs_data_t(),
+			cs_data_t(output, sizeof(output)),
+			1,
+			nistBlockCtr);
+	assert(writtenSize == AES_BLOCK_SIZE);
+	assert(memcmp(output, nistCiphertext, sizeof(output)) == 0);
+}
+
+void testCtr(uint16_t inputPrefixSize, uint16_t inputSize, uint16_t outputPrefixSize, uint8_t alignmentOffset) {
+	uint8_t key[AES_BLOCK_SIZE];
+	uint8_t nonce[8];
+	uint8_t data[MAX_TEST_SIZE];
+	for (int i = 0; i < AES_BLOCK_SIZE; ++i) {
+		key[i] = 3 * i + inputSize;
+	}
+	for (int i = 0; i < (int)sizeof(nonce); ++i) {
+		nonce[i] = 7 * i + 1;
+	}
+	for (int i = 0; i < MAX_TEST_SIZE; ++i) {
+		data[i] = i ^ inputPrefixSize;
+	}
+	uint16_t totalSize = inputPrefixSize + inputSize;
+	uint16_t numBlocks = (totalSize + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+	uint8_t blockCtr = 250;
+
+	uint8_t expected[MAX_TEST_SIZE];
+	referenceCtr(key, nonce, sizeof(nonce), data, totalSize, blockCtr, expected);
+
+	uint8_t inputBuf[MAX_TEST_SIZE + 4];
+	memcpy(inputBuf + alignmentOffset, data, totalSize);
+	uint8_t outputPrefix[MAX_TEST_SIZE];
+	uint8_t outputBuf[MAX_TEST_SIZE + 4] __attribute__ ((aligned (4)));
+	uint16_t outputSize = numBlocks * AES_BLOCK_SIZE - outputPrefixSize;
+
+	engine.setKey(key);
+	cs_buffer_size_t writtenSize = engine.ctr(
+			cs_data_t(nonce, sizeof(nonce)),
+			cs_data_t(inputBuf + alignmentOffset, inputPrefixSize),
+			cs_data_t(inputBuf + alignmentOffset + inputPrefixSize, inputSize),
+			cs_data_t(outputPrefix, outputPrefixSize),
+			cs_data_t(outputBuf, outputSize),
+			numBlocks,
+			blockCtr);
+	assert(writtenSize == outputSize);
+	assert(memcmp(outputPrefix, expected, outputPrefixSize) == 0);
+	assert(memcmp(outputBuf, expected + outputPrefixSize, outputSize) == 0);
+
+	// Decrypt in place, like the UART does.
+	uint8_t* inPlace = outputBuf;
+	memcpy(inPlace, expected, numBlocks * AES_BLOCK_SIZE);
+	writtenSize = engine.ctr(
+			cs_data_t(nonce, sizeof(nonce)),
+			cs_data_t(),
+			cs_data_t(inPlace, numBlocks * AES_BLOCK_SIZE),
+			cs_data_t(outputPrefix, outputPrefixSize),
+			cs_data_t(inPlace, numBlocks * AES_BLOCK_SIZE - outputPrefixSize),
+			numBlocks,
+			blockCtr);
+	assert(writtenSize == numBlocks * AES_BLOCK_SIZE - outputPrefixSize);
+	assert(memcmp(outputPrefix, data, outputPrefixSize) == 0);
+	uint16_t payloadSize = totalSize - outputPrefixSize;
+	assert(memcmp(inPlace, data + outputPrefixSize, payloadSize) == 0);
+}
+
+int main() {
+	cout << "Test AesEngine implementation" << endl;
+
+	testVectors();
+
+	cout << "Test CTR against block by block reference." << endl;
+	const uint16_t inputPrefixSizes[] = {0, 1, 3, 16, 17};
+	const uint16_t inputSizes[] = {1, 4, 15, 16, 33, 64, 65, 128, 200};
+	for (auto inputPrefixSize : inputPrefixSizes) {
+		for (auto inputSize : inputSizes) {
+			for (uint16_t outputPrefixSize = 0; outputPrefixSize < 20 && outputPrefixSize <= inputPrefixSize + inputSize; outputPrefixSize += 3) {
+				for (uint8_t alignmentOffset = 0; alignmentOffset < 4; ++alignmentOffset) {
+					testCtr(inputPrefixSize, inputSize, outputPrefixSize, alignmentOffset);
+				}
+			}
+		}
+	}
+
+	cout << "AesEngine SUCCESS" << endl;
+	return 0;
+}
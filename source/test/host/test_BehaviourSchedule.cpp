@@ -0,0 +1,335 @@
+#include <behaviour/cs_BehaviourSchedule.h>
+#include <time/cs_DayOfWeek.h>
+#include <util/cs_Math.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+const uint32_t secondsPerDay = 24 * 60 * 60;
+
+struct test_behaviour_t {
+	uint32_t from;
+	uint32_t until;
+	uint8_t activeDays;
+	uint8_t value;
+	uint8_t type;
+	// Whether the presence condition is met, only used for switch behaviours.
+	bool presenceValid;
+};
+
+/**
+ * Reference copy of the original Behaviour::isValid(Time).
+ */
+bool referenceIsValid(const test_behaviour_t& b, uint32_t posixTime) {
+	bool isValidIntervalOverlapsMidnight = (b.from >= b.until);
+
+	DayOfWeek today = DayOfWeek(1 << ((posixTime / secondsPerDay + 4) % 7));
+	DayOfWeek yesterday = today - 1;
+	uint32_t now = CsMath::mod(static_cast<int32_t>(posixTime), secondsPerDay);
+
+	if (isValidIntervalOverlapsMidnight) {
+		if (now < b.until) {
+			return b.activeDays & static_cast<uint8_t>(yesterday);
+		}
+		if (b.from <= now) {
+			return b.activeDays & static_cast<uint8_t>(today);
+		}
+		return false;
+	}
+	else {
+		if (b.activeDays & static_cast<uint8_t>(today)) {
+			return b.from <= now && now < b.until;
+		}
+		else {
+			return false;
+		}
+	}
+}
+
+/**
+ * Reference copy of the original FromUntilIntervalIsMoreRelevantOrEqual().
+ */
+bool referenceMoreRelevantOrEqual(
+		int32_t lhsFrom, int32_t lhsUntil,
+		int32_t rhsFrom, int32_t rhsUntil,
+		int32_t currentTimeOfDay) {
+	uint32_t lhsFromNormalized = CsMath::mod(lhsFrom - currentTimeOfDay, secondsPerDay);
+	uint32_t rhsFromNormalized = CsMath::mod(rhsFrom - currentTimeOfDay, secondsPerDay);
+	uint32_t lhsUntilNormalized = CsMath::mod(lhsUntil - currentTimeOfDay, secondsPerDay);
+	uint32_t rhsUntilNormalized = CsMath::mod(rhsUntil - currentTimeOfDay, secondsPerDay);
+
+	if (lhsFromNormalized > rhsFromNormalized) {
+		return true;
+	}
+	if (rhsFromNormalized == lhsFromNormalized && lhsUntilNormalized <= rhsUntilNormalized) {
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Reference copy of the original resolver of BehaviourHandler::computeIntendedState().
+ */
+uint8_t referenceSwitchState(const test_behaviour_t* behaviours, int count, uint32_t posixTime) {
+	int32_t nowTimeOfDay = posixTime % secondsPerDay;
+	const test_behaviour_t* best = nullptr;
+	for (int i = 0; i < count; ++i) {
+		const test_behaviour_t* candidate = &behaviours[i];
+		if (candidate->type == 1 || !referenceIsValid(*candidate, posixTime) || !candidate->presenceValid) {
+			candidate = nullptr;
+		}
+		if (best == nullptr) {
+			best = candidate;
+			continue;
+		}
+		if (candidate == nullptr) {
+			continue;
+		}
+		if (best->from == candidate->from && best->until == candidate->until) {
+			if (candidate->value < best->value) {
+				best = candidate;
+			}
+		}
+		else if (referenceMoreRelevantOrEqual(candidate->from, candidate->until, best->from, best->until, nowTimeOfDay)) {
+			best = candidate;
+		}
+	}
+	return best ? best->value : 0;
+}
+
+/**
+ * Reference copy of the original resolver of TwilightHandler::computeIntendedState().
+ */
+uint8_t referenceTwilightState(const test_behaviour_t* behaviours, int count, uint32_t posixTime) {
+	uint32_t nowTimeOfDay = posixTime % secondsPerDay;
+	uint32_t winningFrom = 0;
+	uint32_t winningUntil = 0;
+	uint8_t winningValue = 0xFF;
+	for (int i = 0; i < count; ++i) {
+		const test_behaviour_t& b = behaviours[i];
+		if (b.type != 1 || !referenceIsValid(b, posixTime)) {
+			continue;
+		}
+		bool overwrite = (winningValue == 0xFF) || referenceMoreRelevantOrEqual(b.from, b.until, winningFrom, winningUntil, nowTimeOfDay);
+		if (overwrite) {
+			if (b.from == winningFrom && b.until == winningUntil) {
+				winningValue = CsMath::min(b.value, winningValue);
+			}
+			else {
+				winningValue = b.value;
+			}
+			winningFrom = b.from;
+			winningUntil = b.until;
+		}
+	}
+	return winningValue == 0xFF ? 100 : winningValue;
+}
+
+/**
+ * Same resolving as BehaviourHandler::computeIntendedState(), using the schedule.
+ */
+uint8_t scheduleSwitchState(BehaviourSchedule& schedule, const test_behaviour_t* behaviours, uint32_t posixTime) {
+	schedule.update(posixTime);
+	const BehaviourSchedule::entry_t* bestEntry = nullptr;
+	uint8_t bestValue = 0;
+	for (uint8_t i = 0; i < schedule.getValidCount(); ++i) {
+		const BehaviourSchedule::entry_t& entry = schedule.getValid(i);
+		const test_behaviour_t& b = behaviours[entry.index];
+		if (entry.type == 1 || !b.presenceValid) {
+			continue;
+		}
+		if (bestEntry == nullptr) {
+			bestEntry = &entry;
+			bestValue = b.value;
+			continue;
+		}
+		if (BehaviourSchedule::intervalIsEqual(*bestEntry, entry) && b.value < bestValue) {
+			bestEntry = &entry;
+			bestValue = b.value;
+		}
+	}
+	return bestValue;
+}
+
+/**
+ * Same resolving as TwilightHandler::computeIntendedState(), using the schedule.
+ */
+uint8_t scheduleTwilightState(BehaviourSchedule& schedule, const test_behaviour_t* behaviours, uint32_t posixTime) {
+	schedule.update(posixTime);
+	const BehaviourSchedule::entry_t* winningEntry = nullptr;
+	uint8_t winningValue = 0xFF;
+	for (uint8_t i = 0; i < schedule.getValidCount(); ++i) {
+		const BehaviourSchedule::entry_t& entry = schedule.getValid(i);
+		if (entry.type != 1) {
+			continue;
+		}
+		uint8_t value = behaviours[entry.index].value;
+		if (winningEntry == nullptr) {
+			winningEntry = &entry;
+			winningValue = value;
+			continue;
+		}
+		if (!BehaviourSchedule::intervalIsEqual(*winningEntry, entry)) {
+			break;
+		}
+		winningValue = CsMath::min(value, winningValue);
+	}
+	return winningEntry == nullptr ? 100 : winningValue;
+}
+
+/**
+ * Random time of day, biased towards a few values, so that boundaries coincide often.
+ */
+uint32_t randomTimeOfDay() {
+	switch (rand() % 4) {
+		case 0: return (rand() % 4) * 6 * 60 * 60;
+		case 1: return (rand() % 24) * 60 * 60 + (rand() % 2) * 30 * 60;
+		default: return rand() % secondsPerDay;
+	}
+}
+
+void randomBehaviours(test_behaviour_t* behaviours, int count) {
+	for (int i = 0; i < count; ++i) {
+		test_behaviour_t& b = behaviours[i];
+		b.from = randomTimeOfDay();
+		b.until = (rand() % 8 == 0) ? b.from : randomTimeOfDay();
+		b.activeDays = (rand() % 4 == 0) ? 0x7F : (rand() & 0x7F);
+		b.value = (rand() % 3 == 0) ? 100 : rand() % 101;
+		b.type = rand() % 3;
+		b.presenceValid = (rand() % 4 != 0);
+	}
+}
+
+void compile(BehaviourSchedule& schedule, const test_behaviour_t* behaviours, int count) {
+	schedule.clear();
+	for (int i = 0; i < count; ++i) {
+		assert(schedule.add(i, behaviours[i].type, behaviours[i].activeDays, behaviours[i].from, behaviours[i].until));
+	}
+}
+
+void check(BehaviourSchedule& schedule, const test_behaviour_t* behaviours, int count, uint32_t posixTime) {
+	assert(scheduleSwitchState(schedule, behaviours, posixTime) == referenceSwitchState(behaviours, count, posixTime));
+	assert(scheduleTwilightState(schedule, behaviours, posixTime) == referenceTwilightState(behaviours, count, posixTime));
+
+	// Every valid entry should be valid, every other entry invalid.
+	int validCount = 0;
+	for (int i = 0; i < count; ++i) {
+		bool valid = referenceIsValid(behaviours[i], posixTime);
+		assert(BehaviourSchedule::isValid(behaviours[i].from, behaviours[i].until, behaviours[i].activeDays, posixTime) == valid);
+		validCount += valid;
+	}
+	assert(schedule.getValidCount() == validCount);
+}
+
+/**
+ * Simulate a week with the given step size, with occasional time jumps.
+ */
+void simulateWeek(BehaviourSchedule& schedule, test_behaviour_t* behaviours, int count, uint32_t startTime, uint32_t maxStep) {
+	uint32_t posixTime = startTime;
+	uint32_t endTime = startTime + 7 * secondsPerDay;
+	bool sameSegment = false;
+	while (posixTime < endTime) {
+		uint32_t generation = schedule.getGeneration();
+		uint32_t nextBoundary = schedule.getNextBoundary();
+		check(schedule, behaviours, count, posixTime);
+		if (sameSegment && posixTime < nextBoundary) {
+			// Still in the same segment: the valid set should not have been recomputed.
+			assert(schedule.getGeneration() == generation);
+		}
+		sameSegment = true;
+
+		switch (rand() % 200) {
+			case 0:
+				// Jump back in time.
+				posixTime -= rand() % secondsPerDay;
+				sameSegment = false;
+				break;
+			case 1:
+				// Jump forward in time.
+				posixTime += rand() % (2 * secondsPerDay);
+				break;
+			case 2:
+				// Behaviour changed.
+				randomBehaviours(behaviours + rand() % count, 1);
+				compile(schedule, behaviours, count);
+				sameSegment = false;
+				break;
+			default:
+				posixTime += 1 + rand() % maxStep;
+		}
+	}
+}
+
+void testSegments() {
+	cout << "Test that the valid set is only recomputed at boundaries." << endl;
+	BehaviourSchedule schedule;
+	schedule.add(0, 0, 0x7F, 8 * 60 * 60, 18 * 60 * 60);
+	schedule.add(1, 0, 0x7F, 22 * 60 * 60, 7 * 60 * 60);
+
+	// Thursday 1 jan 1970, 09:00.
+	uint32_t posixTime = 9 * 60 * 60;
+	schedule.update(posixTime);
+	uint32_t generation = schedule.getGeneration();
+	assert(schedule.getValidCount() == 1);
+	assert(schedule.getValid(0).index == 0);
+	assert(schedule.getNextBoundary() == 18 * 60 * 60);
+
+	for (; posixTime < 18 * 60 * 60; posixTime += 60) {
+		schedule.update(posixTime);
+	}
+	assert(schedule.getGeneration() == generation);
+
+	// The second of a boundary is a segment on its own.
+	schedule.update(18 * 60 * 60);
+	assert(schedule.getGeneration() == generation + 1);
+	assert(schedule.getValidCount() == 0);
+	assert(schedule.getNextBoundary() == 18 * 60 * 60 + 1);
+
+	schedule.update(18 * 60 * 60 + 1);
+	assert(schedule.getNextBoundary() == 22 * 60 * 60);
+
+	schedule.update(23 * 60 * 60);
+	assert(schedule.getValidCount() == 1);
+	assert(schedule.getValid(0).index == 1);
+	// Midnight is a boundary as well.
+	assert(schedule.getNextBoundary() == secondsPerDay);
+
+	cout << "Test that the most relevant entry comes first." << endl;
+	schedule.clear();
+	schedule.add(0, 0, 0x7F, 0, 0);
+	schedule.add(1, 0, 0x7F, 8 * 60 * 60, 18 * 60 * 60);
+	schedule.add(2, 0, 0x7F, 8 * 60 * 60, 12 * 60 * 60);
+	schedule.add(3, 0, 0x7F, 10 * 60 * 60, 20 * 60 * 60);
+	schedule.update(11 * 60 * 60);
+	assert(schedule.getValidCount() == 4);
+	assert(schedule.getValid(0).index == 3);
+	assert(schedule.getValid(1).index == 2);
+	assert(schedule.getValid(2).index == 1);
+	assert(schedule.getValid(3).index == 0);
+}
+
+int main() {
+	cout << "Test BehaviourSchedule implementation" << endl;
+
+	testSegments();
+
+	cout << "Test against the original resolver with random behaviours." << endl;
+	srand(42);
+	const uint32_t maxSteps[] = {1, 60, 600, 3600};
+	BehaviourSchedule schedule;
+	test_behaviour_t behaviours[BehaviourSchedule::MaxEntries];
+	for (int run = 0; run < 400; ++run) {
+		int count = (run % 10 == 0) ? BehaviourSchedule::MaxEntries : 1 + rand() % 12;
+		randomBehaviours(behaviours, count);
+		compile(schedule, behaviours, count);
+		// Start somewhere in 2026.
+		uint32_t startTime = 1767225600 + rand() % (365 * secondsPerDay);
+		simulateWeek(schedule, behaviours, count, startTime, maxSteps[run % 4]);
+	}
+
+	cout << "BehaviourSchedule SUCCESS" << endl;
+	return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * Tests the hash index with linear probing and backward shift deletion, against a plain array of keys.
+ */
+
+#include <util/cs_HashIndex.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+const uint32_t NO_KEY = 0xFFFFFFFF;
+
+/**
+ * Array of keys with a hash index, kept in sync the way TrackedDevices does.
+ */
+template <uint8_t Capacity>
+struct indexed_keys_t {
+	uint32_t keys[Capacity];
+	HashIndex<Capacity> index;
+
+	indexed_keys_t() {
+		for (auto& key : keys) {
+			key = NO_KEY;
+		}
+	}
+
+	uint8_t find(uint32_t key) {
+		return index.find(key, [&](uint8_t i) { return keys[i] == key; });
+	}
+
+	/**
+	 * Add a key at the first free array index.
+	 */
+	uint8_t add(uint32_t key) {
+		for (uint8_t i = 0; i < Capacity; ++i) {
+			if (keys[i] == NO_KEY) {
+				keys[i] = key;
+				index.insert(key, i);
+				return i;
+			}
+		}
+		return HashIndex<Capacity>::INDEX_NOT_FOUND;
+	}
+
+	bool remove(uint32_t key) {
+		uint8_t i = find(key);
+		if (i == HashIndex<Capacity>::INDEX_NOT_FOUND) {
+			return false;
+		}
+		assert(index.remove(key, i, [&](uint8_t j) { return keys[j]; }));
+		keys[i] = NO_KEY;
+		return true;
+	}
+
+	/**
+	 * Check that every key in the array is found at its index.
+	 */
+	void check() {
+		for (uint8_t i = 0; i < Capacity; ++i) {
+			if (keys[i] != NO_KEY) {
+				assert(find(keys[i]) == i);
+			}
+		}
+	}
+};
+
+/**
+ * Find keys with the given home slot.
+ */
+template <uint8_t Capacity>
+vector<uint32_t> keysWithHomeSlot(uint16_t homeSlot, size_t count) {
+	vector<uint32_t> keys;
+	for (uint32_t key = 1; keys.size() < count; ++key) {
+		if (HashIndex<Capacity>::getHomeSlot(key) == homeSlot) {
+			keys.push_back(key);
+		}
+	}
+	return keys;
+}
+
+void testInsertFind() {
+	indexed_keys_t<10> keys;
+	assert(keys.find(123) == HashIndex<10>::INDEX_NOT_FOUND);
+	assert(keys.add(123) == 0);
+	assert(keys.add(456) == 1);
+	assert(keys.find(123) == 0);
+	assert(keys.find(456) == 1);
+	assert(keys.find(789) == HashIndex<10>::INDEX_NOT_FOUND);
+	assert(!keys.remove(789));
+	assert(keys.remove(123));
+	assert(keys.find(123) == HashIndex<10>::INDEX_NOT_FOUND);
+	assert(keys.find(456) == 1);
+
+	// Replace: the item moved in the array.
+	keys.keys[5] = 456;
+	keys.keys[1] = NO_KEY;
+	assert(keys.index.replace(456, 1, 5));
+	assert(keys.find(456) == 5);
+	assert(!keys.index.replace(456, 1, 6));
+
+	keys.index.clear();
+	assert(keys.find(456) == HashIndex<10>::INDEX_NOT_FOUND);
+	cout << "insert find: ok" << endl;
+}
+
+void testWraparound() {
+	const uint8_t capacity = 8;
+	typedef HashIndex<capacity> index_t;
+	const uint16_t lastSlot = index_t::TABLE_SIZE - 1;
+
+	// A cluster that starts at the last slot and wraps around to slot 0 and 1, plus a key with home slot 0.
+	vector<uint32_t> lastSlotKeys = keysWithHomeSlot<capacity>(lastSlot, 3);
+	uint32_t firstSlotKey = keysWithHomeSlot<capacity>(0, 1)[0];
+
+	// Remove each of the cluster keys in turn, the others should still be found.
+	for (size_t removed = 0; removed < lastSlotKeys.size(); ++removed) {
+		indexed_keys_t<capacity> keys;
+		for (auto key : lastSlotKeys) {
+			keys.add(key);
+		}
+		keys.add(firstSlotKey);
+		keys.check();
+
+		assert(keys.remove(lastSlotKeys[removed]));
+		keys.check();
+		assert(keys.find(lastSlotKeys[removed]) == index_t::INDEX_NOT_FOUND);
+
+		// The key with home slot 0 is behind the wrapped cluster.
+		assert(keys.remove(firstSlotKey));
+		keys.check();
+		assert(keys.add(firstSlotKey) != index_t::INDEX_NOT_FOUND);
+		keys.check();
+	}
+
+	// Removing the key at home slot 0 should not move the wrapped keys in front of their home slot.
+	indexed_keys_t<capacity> keys;
+	keys.add(firstSlotKey);
+	for (auto key : lastSlotKeys) {
+		keys.add(key);
+	}
+	keys.check();
+	assert(keys.remove(firstSlotKey));
+	keys.check();
+	cout << "wraparound: ok" << endl;
+}
+
+/**
+ * Fill the index to capacity, with keys that all have the same home slot, and empty it again.
+ */
+template <uint8_t Capacity>
+void testFull() {
+	typedef HashIndex<Capacity> index_t;
+	vector<uint32_t> collidingKeys = keysWithHomeSlot<Capacity>(index_t::TABLE_SIZE - 2, Capacity);
+	indexed_keys_t<Capacity> keys;
+	for (auto key : collidingKeys) {
+		assert(keys.add(key) != index_t::INDEX_NOT_FOUND);
+	}
+	keys.check();
+	assert(keys.add(NO_KEY - 1) == index_t::INDEX_NOT_FOUND);
+	assert(keys.find(NO_KEY - 1) == index_t::INDEX_NOT_FOUND);
+
+	// Remove in a different order than added.
+	for (size_t i = 0; i < collidingKeys.size(); i += 2) {
+		assert(keys.remove(collidingKeys[i]));
+		keys.check();
+	}
+	for (size_t i = 1; i < collidingKeys.size(); i += 2) {
+		assert(keys.remove(collidingKeys[i]));
+		keys.check();
+	}
+	for (auto key : collidingKeys) {
+		assert(keys.find(key) == index_t::INDEX_NOT_FOUND);
+	}
+	cout << "full, capacity " << (int)Capacity << ": ok" << endl;
+}
+
+/**
+ * Random adds and removes, with keys from a small range so that there are many collisions.
+ */
+template <uint8_t Capacity>
+void testRandom(uint32_t keyRange) {
+	indexed_keys_t<Capacity> keys;
+	vector<uint32_t> added;
+	for (int i = 0; i < 100000; ++i) {
+		uint32_t key = rand() % keyRange;
+		bool present = false;
+		for (auto k : added) {
+			present |= (k == key);
+		}
+		if (present) {
+			assert(keys.remove(key));
+			for (auto it = added.begin(); it != added.end(); ++it) {
+				if (*it == key) {
+					added.erase(it);
+					break;
+				}
+			}
+		}
+		else if (added.size() < Capacity) {
+			assert(keys.find(key) == HashIndex<Capacity>::INDEX_NOT_FOUND);
+			assert(keys.add(key) != HashIndex<Capacity>::INDEX_NOT_FOUND);
+			added.push_back(key);
+		}
+		keys.check();
+	}
+	cout << "random, capacity " << (int)Capacity << ": ok" << endl;
+}
+
+int main() {
+	srand(1);
+	testInsertFind();
+	testWraparound();
+	testFull<1>();
+	testFull<5>();
+	testFull<64>();
+	testFull<100>();
+	testRandom<3>(10);
+	testRandom<20>(50);
+	testRandom<100>(300);
+	cout << "HashIndex SUCCESS" << endl;
+	return 0;
+}
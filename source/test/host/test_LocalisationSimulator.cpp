@@ -0,0 +1,594 @@
+/**
+ * Simulates the nearest crownstone election on a grid of virtual crownstones.
+ *
+ * Each virtual crownstone has its own asset records and NearestCrownstoneElection, like the NearestCrownstoneTracker
+ * on a real crownstone. Asset advertisements are generated with a path loss model, or replayed from a trace file.
+ * Reports are sent over a simulated mesh, with random latency and loss.
+ *
+ * Reports:
+ * - The latency from the moment an asset got a new nearest crownstone, until all crownstones agree on it.
+ * - The number of mesh messages and UART updates sent.
+ * - The CPU time spent per advertisement.
+ * Each configuration is run with several random seeds, with the same assets and RSSI noise per seed, and the
+ * differences are reported per seed. With hysteresis and suppression, fewer messages should be sent than with the
+ * defaults, while the crownstones should not agree on the true nearest crownstone for clearly less of the time.
+ *
+ * Usage: test_LocalisationSimulator [trace file]
+ * Each line of the trace file is: <time ms> <asset index> <stone index> <rssi> <channel>
+ * With a trace, the nearest crownstone is the one with the highest average RSSI over the last seconds.
+ */
+
+#include <cfg/cs_Config.h>
+#include <localisation/cs_NearestCrownstoneElection.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+constexpr uint32_t GRID_SIZE              = 4;
+constexpr double GRID_SPACING_METERS      = 5.0;
+constexpr uint32_t STATIONARY_ASSET_COUNT = 6;
+constexpr uint32_t MOVING_ASSET_COUNT     = 6;
+constexpr double ASSET_SPEED_METERS_PER_S = 1.0;
+constexpr uint32_t ADVERTISEMENT_INTERVAL_MS = 200;
+constexpr uint32_t SIMULATION_DURATION_MS = 10 * 60 * 1000;
+constexpr uint32_t STEP_MS                = 10;
+
+constexpr double RSSI_AT_ONE_METER        = -59.0;
+constexpr double PATH_LOSS_EXPONENT       = 2.5;
+constexpr double RSSI_NOISE_STDDEV        = 4.0;
+constexpr int RSSI_RECEIVE_THRESHOLD      = -92;
+
+/**
+ * Each configuration is simulated with this many random seeds, so that a comparison doesn't depend on one seed.
+ */
+constexpr uint32_t SEED_COUNT             = 8;
+
+constexpr uint32_t MESH_MIN_LATENCY_MS    = 20;
+constexpr uint32_t MESH_MAX_LATENCY_MS    = 150;
+constexpr double MESH_LOSS_PROBABILITY    = 0.05;
+
+/**
+ * Time constant of the RSSI average that determines the nearest crownstone in a replayed trace.
+ */
+constexpr double TRACE_AVERAGE_TIME_MS    = 5000.0;
+
+struct advertisement_t {
+	uint32_t timeMs;
+	uint32_t assetIndex;
+	uint32_t stoneIndex;
+	int8_t rssi;
+	uint8_t channel;
+};
+
+struct mesh_message_t {
+	uint32_t deliveryTimeMs;
+	uint32_t senderIndex;
+	uint32_t receiverIndex;
+	uint32_t assetIndex;
+	compressed_rssi_data_t rssi;
+};
+
+struct virtual_stone_t {
+	stone_id_t id;
+	double x;
+	double y;
+	NearestCrownstoneElection election;
+	map<uint32_t, asset_record_t> records;
+};
+
+struct virtual_asset_t {
+	double x;
+	double y;
+	double targetX;
+	double targetY;
+	bool moving;
+	uint32_t nextAdvertisementMs;
+};
+
+/**
+ * Tracks how long it takes until all crownstones agree on the true nearest crownstone of an asset.
+ */
+struct decision_tracker_t {
+	stone_id_t trueNearest = 0;
+	uint32_t changeTimeMs  = 0;
+	bool decided           = false;
+};
+
+struct simulation_result_t {
+	uint32_t advertisements     = 0;
+	uint32_t meshMessagesSent   = 0;
+	uint32_t meshMessagesLost   = 0;
+	uint32_t uartUpdates        = 0;
+	uint32_t broadcastsAvoided  = 0;
+	uint32_t uartUpdatesAvoided = 0;
+	vector<uint32_t> decisionLatenciesMs;
+	uint32_t undecidedChanges   = 0;
+	uint64_t correctSamples     = 0;
+	uint64_t totalSamples       = 0;
+	double cpuNanosecondsPerAdvertisement = 0;
+	bool allAssetsHaveWinner    = true;
+};
+
+class Simulation {
+public:
+	Simulation(const nearest_crownstone_election_config_t& config, const vector<advertisement_t>* trace, uint32_t seed)
+			: _trace(trace), _random(seed), _meshRandom(seed) {
+		for (uint32_t row = 0; row < GRID_SIZE; ++row) {
+			for (uint32_t column = 0; column < GRID_SIZE; ++column) {
+				virtual_stone_t stone;
+				stone.id = static_cast<stone_id_t>(_stones.size() + 1);
+				stone.x  = column * GRID_SPACING_METERS;
+				stone.y  = row * GRID_SPACING_METERS;
+				stone.election.init(stone.id, config);
+				_stones.push_back(stone);
+			}
+		}
+
+		uint32_t assetCount = STATIONARY_ASSET_COUNT + MOVING_ASSET_COUNT;
+		if (_trace != nullptr) {
+			assetCount = 0;
+			for (auto& advertisement : *_trace) {
+				assert(advertisement.stoneIndex < _stones.size());
+				assetCount = max(assetCount, advertisement.assetIndex + 1);
+			}
+		}
+		for (uint32_t i = 0; i < assetCount; ++i) {
+			virtual_asset_t asset;
+			asset.x = randomPosition();
+			asset.y = randomPosition();
+			asset.targetX = randomPosition();
+			asset.targetY = randomPosition();
+			asset.moving  = (i >= STATIONARY_ASSET_COUNT);
+			asset.nextAdvertisementMs = uniform_int_distribution<uint32_t>(0, ADVERTISEMENT_INTERVAL_MS)(_random);
+			_assets.push_back(asset);
+		}
+		_decisions.resize(assetCount);
+		_averageRssi.assign(assetCount, vector<double>(_stones.size(), -128.0));
+	}
+
+	simulation_result_t run() {
+		uint32_t endTimeMs = SIMULATION_DURATION_MS;
+		if (_trace != nullptr && !_trace->empty()) {
+			endTimeMs = _trace->back().timeMs + 1000;
+		}
+		size_t traceIndex = 0;
+
+		for (_timeMs = 0; _timeMs < endTimeMs; _timeMs += STEP_MS) {
+			if (_trace != nullptr) {
+				while (traceIndex < _trace->size() && (*_trace)[traceIndex].timeMs < _timeMs + STEP_MS) {
+					handleAdvertisement((*_trace)[traceIndex]);
+					traceIndex++;
+				}
+			}
+			else {
+				moveAssets();
+				generateAdvertisements();
+			}
+			deliverMeshMessages();
+			if (_timeMs % TICK_INTERVAL_MS == 0) {
+				tick();
+				checkDecisions();
+			}
+		}
+
+		_result.cpuNanosecondsPerAdvertisement =
+				_result.advertisements ? static_cast<double>(_cpuTime.count()) / _result.advertisements : 0;
+		for (auto& stone : _stones) {
+			auto& stats = stone.election.getStats();
+			_result.broadcastsAvoided += stats.broadcastsAvoided;
+			_result.uartUpdatesAvoided += stats.uartUpdatesAvoided;
+		}
+		for (auto& decision : _decisions) {
+			if (decision.trueNearest != 0 && !decision.decided) {
+				_result.undecidedChanges++;
+			}
+		}
+		for (uint32_t assetIndex = 0; assetIndex < _assets.size(); ++assetIndex) {
+			for (auto& stone : _stones) {
+				auto iter = stone.records.find(assetIndex);
+				if (iter != stone.records.end() && iter->second.nearestStoneId == 0) {
+					_result.allAssetsHaveWinner = false;
+				}
+			}
+		}
+		return _result;
+	}
+
+private:
+	const vector<advertisement_t>* _trace;
+	mt19937 _random;
+	//! Separate from the assets and RSSI noise, so that those are the same for each configuration.
+	mt19937 _meshRandom;
+	vector<virtual_stone_t> _stones;
+	vector<virtual_asset_t> _assets;
+	vector<decision_tracker_t> _decisions;
+	vector<vector<double>> _averageRssi;
+	vector<mesh_message_t> _meshQueue;
+	uint32_t _timeMs = 0;
+	chrono::nanoseconds _cpuTime {0};
+	simulation_result_t _result;
+
+	double randomPosition() {
+		return uniform_real_distribution<double>(-2.0, (GRID_SIZE - 1) * GRID_SPACING_METERS + 2.0)(_random);
+	}
+
+	double distance(const virtual_asset_t& asset, const virtual_stone_t& stone) {
+		// Crownstones are mounted about a meter above the assets.
+		double dx = asset.x - stone.x;
+		double dy = asset.y - stone.y;
+		return sqrt(dx * dx + dy * dy + 1.0);
+	}
+
+	double expectedRssi(const virtual_asset_t& asset, const virtual_stone_t& stone) {
+		return RSSI_AT_ONE_METER - 10.0 * PATH_LOSS_EXPONENT * log10(distance(asset, stone));
+	}
+
+	void moveAssets() {
+		double step = ASSET_SPEED_METERS_PER_S * STEP_MS / 1000.0;
+		for (auto& asset : _assets) {
+			if (!asset.moving) {
+				continue;
+			}
+			double dx = asset.targetX - asset.x;
+			double dy = asset.targetY - asset.y;
+			double remaining = sqrt(dx * dx + dy * dy);
+			if (remaining <= step) {
+				asset.x = asset.targetX;
+				asset.y = asset.targetY;
+				asset.targetX = randomPosition();
+				asset.targetY = randomPosition();
+				continue;
+			}
+			asset.x += dx / remaining * step;
+			asset.y += dy / remaining * step;
+		}
+	}
+
+	void generateAdvertisements() {
+		normal_distribution<double> noise(0.0, RSSI_NOISE_STDDEV);
+		for (uint32_t assetIndex = 0; assetIndex < _assets.size(); ++assetIndex) {
+			auto& asset = _assets[assetIndex];
+			if (asset.nextAdvertisementMs >= _timeMs + STEP_MS) {
+				continue;
+			}
+			asset.nextAdvertisementMs += ADVERTISEMENT_INTERVAL_MS;
+			uint8_t channel = 37 + (asset.nextAdvertisementMs / ADVERTISEMENT_INTERVAL_MS) % 3;
+			for (uint32_t stoneIndex = 0; stoneIndex < _stones.size(); ++stoneIndex) {
+				double rssi = round(expectedRssi(asset, _stones[stoneIndex]) + noise(_random));
+				if (rssi < RSSI_RECEIVE_THRESHOLD) {
+					continue;
+				}
+				handleAdvertisement({_timeMs, assetIndex, stoneIndex, static_cast<int8_t>(min(rssi, -1.0)), channel});
+			}
+		}
+	}
+
+	/**
+	 * Same as what AssetStore and NearestCrownstoneTracker do for an advertisement.
+	 */
+	void handleAdvertisement(const advertisement_t& advertisement) {
+		auto& stone = _stones[advertisement.stoneIndex];
+		_result.advertisements++;
+
+		auto startTime = chrono::steady_clock::now();
+		auto& record   = getOrCreateRecord(stone, advertisement.assetIndex);
+		record.addRssi(advertisement.rssi, advertisement.channel);
+		stone.election.onAdvertisement(record, record.myRssi);
+		_cpuTime += chrono::steady_clock::now() - startTime;
+
+		if (_trace != nullptr) {
+			double& average = _averageRssi[advertisement.assetIndex][advertisement.stoneIndex];
+			double weight   = min(1.0, ADVERTISEMENT_INTERVAL_MS / TRACE_AVERAGE_TIME_MS);
+			average += (advertisement.rssi - average) * weight;
+		}
+	}
+
+	asset_record_t& getOrCreateRecord(virtual_stone_t& stone, uint32_t assetIndex) {
+		auto iter = stone.records.find(assetIndex);
+		if (iter != stone.records.end()) {
+			return iter->second;
+		}
+		asset_record_t& record = stone.records[assetIndex];
+		record.empty();
+		record.assetId = {{
+				static_cast<uint8_t>(assetIndex), static_cast<uint8_t>(assetIndex >> 8), static_cast<uint8_t>(assetIndex >> 16)}};
+		return record;
+	}
+
+	void tick() {
+		for (uint32_t stoneIndex = 0; stoneIndex < _stones.size(); ++stoneIndex) {
+			auto& stone = _stones[stoneIndex];
+			for (auto& entry : stone.records) {
+				uint8_t reports = stone.election.tick(entry.second);
+				if (reports & NearestCrownstoneElection::PENDING_BROADCAST) {
+					broadcast(stoneIndex, entry.first, entry.second.nearestRssi);
+				}
+				if (reports & NearestCrownstoneElection::PENDING_UART_UPDATE) {
+					_result.uartUpdates++;
+				}
+			}
+		}
+	}
+
+	/**
+	 * A broadcast is a single mesh message, that arrives at each other crownstone with its own latency.
+	 */
+	void broadcast(uint32_t senderIndex, uint32_t assetIndex, compressed_rssi_data_t rssi) {
+		_result.meshMessagesSent++;
+		uniform_int_distribution<uint32_t> latency(MESH_MIN_LATENCY_MS, MESH_MAX_LATENCY_MS);
+		bernoulli_distribution lost(MESH_LOSS_PROBABILITY);
+		for (uint32_t receiverIndex = 0; receiverIndex < _stones.size(); ++receiverIndex) {
+			if (receiverIndex == senderIndex) {
+				continue;
+			}
+			if (lost(_meshRandom)) {
+				_result.meshMessagesLost++;
+				continue;
+			}
+			_meshQueue.push_back({_timeMs + latency(_meshRandom), senderIndex, receiverIndex, assetIndex, rssi});
+		}
+	}
+
+	/**
+	 * Same as what NearestCrownstoneTracker does for a received report.
+	 * Reports about assets without a record are ignored, like the asset store does.
+	 */
+	void deliverMeshMessages() {
+		auto firstLater = stable_partition(_meshQueue.begin(), _meshQueue.end(), [&](const mesh_message_t& message) {
+			return message.deliveryTimeMs < _timeMs + STEP_MS;
+		});
+		for (auto iter = _meshQueue.begin(); iter != firstLater; ++iter) {
+			auto& receiver = _stones[iter->receiverIndex];
+			auto record    = receiver.records.find(iter->assetIndex);
+			if (record == receiver.records.end()) {
+				continue;
+			}
+			receiver.election.onReport(record->second, iter->rssi, _stones[iter->senderIndex].id);
+		}
+		_meshQueue.erase(_meshQueue.begin(), firstLater);
+	}
+
+	stone_id_t getTrueNearest(uint32_t assetIndex) {
+		uint32_t bestIndex = 0;
+		double bestRssi    = -1000.0;
+		for (uint32_t stoneIndex = 0; stoneIndex < _stones.size(); ++stoneIndex) {
+			double rssi = (_trace != nullptr) ? _averageRssi[assetIndex][stoneIndex]
+											  : expectedRssi(_assets[assetIndex], _stones[stoneIndex]);
+			if (rssi > bestRssi) {
+				bestRssi  = rssi;
+				bestIndex = stoneIndex;
+			}
+		}
+		return _stones[bestIndex].id;
+	}
+
+	/**
+	 * Whether all crownstones that know the asset agree on the given nearest crownstone.
+	 */
+	bool isAgreed(uint32_t assetIndex, stone_id_t nearest) {
+		bool known = false;
+		for (auto& stone : _stones) {
+			auto iter = stone.records.find(assetIndex);
+			if (iter == stone.records.end()) {
+				continue;
+			}
+			known = true;
+			if (iter->second.nearestStoneId != nearest) {
+				return false;
+			}
+		}
+		return known;
+	}
+
+	void checkDecisions() {
+		for (uint32_t assetIndex = 0; assetIndex < _assets.size(); ++assetIndex) {
+			auto& decision     = _decisions[assetIndex];
+			stone_id_t nearest = getTrueNearest(assetIndex);
+			if (nearest != decision.trueNearest) {
+				if (decision.trueNearest != 0 && !decision.decided) {
+					_result.undecidedChanges++;
+				}
+				decision.trueNearest  = nearest;
+				decision.changeTimeMs = _timeMs;
+				decision.decided      = false;
+			}
+			bool agreed = isAgreed(assetIndex, nearest);
+			if (agreed && !decision.decided) {
+				decision.decided = true;
+				_result.decisionLatenciesMs.push_back(_timeMs - decision.changeTimeMs);
+			}
+			_result.totalSamples++;
+			if (agreed) {
+				_result.correctSamples++;
+			}
+		}
+	}
+};
+
+/**
+ * Run the simulation with each seed.
+ */
+vector<simulation_result_t> simulate(const nearest_crownstone_election_config_t& config, const vector<advertisement_t>* trace) {
+	vector<simulation_result_t> results;
+	for (uint32_t seed = 1; seed <= SEED_COUNT; ++seed) {
+		results.push_back(Simulation(config, trace, seed).run());
+	}
+	return results;
+}
+
+/**
+ * Add up the results of all seeds.
+ */
+simulation_result_t addUp(const vector<simulation_result_t>& results) {
+	simulation_result_t total;
+	for (auto& result : results) {
+		total.advertisements     += result.advertisements;
+		total.meshMessagesSent   += result.meshMessagesSent;
+		total.meshMessagesLost   += result.meshMessagesLost;
+		total.uartUpdates        += result.uartUpdates;
+		total.broadcastsAvoided  += result.broadcastsAvoided;
+		total.uartUpdatesAvoided += result.uartUpdatesAvoided;
+		total.decisionLatenciesMs.insert(
+				total.decisionLatenciesMs.end(), result.decisionLatenciesMs.begin(), result.decisionLatenciesMs.end());
+		total.undecidedChanges   += result.undecidedChanges;
+		total.correctSamples     += result.correctSamples;
+		total.totalSamples       += result.totalSamples;
+		total.cpuNanosecondsPerAdvertisement += result.cpuNanosecondsPerAdvertisement / results.size();
+		total.allAssetsHaveWinner &= result.allAssetsHaveWinner;
+	}
+	return total;
+}
+
+double correctFraction(const simulation_result_t& result) {
+	return static_cast<double>(result.correctSamples) / max<uint64_t>(result.totalSamples, 1);
+}
+
+bool readTrace(const char* fileName, vector<advertisement_t>& trace) {
+	ifstream file(fileName);
+	if (!file) {
+		return false;
+	}
+	uint32_t timeMs, assetIndex, stoneIndex;
+	int rssi, channel;
+	while (file >> timeMs >> assetIndex >> stoneIndex >> rssi >> channel) {
+		trace.push_back({timeMs, assetIndex, stoneIndex, static_cast<int8_t>(rssi), static_cast<uint8_t>(channel)});
+	}
+	stable_sort(trace.begin(), trace.end(), [](const advertisement_t& lhs, const advertisement_t& rhs) {
+		return lhs.timeMs < rhs.timeMs;
+	});
+	return true;
+}
+
+uint32_t percentile(vector<uint32_t> values, uint32_t percent) {
+	if (values.empty()) {
+		return 0;
+	}
+	sort(values.begin(), values.end());
+	return values[(values.size() - 1) * percent / 100];
+}
+
+/**
+ * Mean, standard deviation, min and max of values that differ per seed.
+ */
+struct spread_t {
+	double mean   = 0;
+	double stddev = 0;
+	double min    = 0;
+	double max    = 0;
+};
+
+spread_t getSpread(const vector<double>& values) {
+	spread_t spread;
+	if (values.empty()) {
+		return spread;
+	}
+	spread.min = *min_element(values.begin(), values.end());
+	spread.max = *max_element(values.begin(), values.end());
+	for (auto value : values) {
+		spread.mean += value / values.size();
+	}
+	for (auto value : values) {
+		spread.stddev += (value - spread.mean) * (value - spread.mean);
+	}
+	if (values.size() > 1) {
+		spread.stddev = sqrt(spread.stddev / (values.size() - 1));
+	}
+	return spread;
+}
+
+void printSpread(const char* name, const spread_t& spread) {
+	cout << "  " << name << "mean " << spread.mean << ", stddev " << spread.stddev
+		 << ", min " << spread.min << ", max " << spread.max << endl;
+}
+
+/**
+ * Compare two configurations per seed, as each seed simulates the same assets and noise for both.
+ *
+ * @return The differences in the percentage of the time that the crownstones agreed on the true nearest crownstone.
+ */
+spread_t printPerSeed(const vector<simulation_result_t>& baseline, const vector<simulation_result_t>& results) {
+	vector<double> correctDiffs;
+	vector<double> latencyDiffs;
+	cout << "Per seed (defaults -> hysteresis and suppression):" << endl;
+	for (size_t i = 0; i < results.size(); ++i) {
+		double baselineCorrect = 100.0 * correctFraction(baseline[i]);
+		double correct = 100.0 * correctFraction(results[i]);
+		uint32_t baselineLatency = percentile(baseline[i].decisionLatenciesMs, 50);
+		uint32_t latency = percentile(results[i].decisionLatenciesMs, 50);
+		correctDiffs.push_back(correct - baselineCorrect);
+		latencyDiffs.push_back(static_cast<double>(latency) - baselineLatency);
+		cout << "  seed " << i + 1 << ": correct " << baselineCorrect << "% -> " << correct << "%"
+			 << ", median latency " << baselineLatency << " -> " << latency << " ms" << endl;
+	}
+	spread_t correctSpread = getSpread(correctDiffs);
+	printSpread("correct difference %:         ", correctSpread);
+	printSpread("median latency difference ms: ", getSpread(latencyDiffs));
+	return correctSpread;
+}
+
+void printResult(const char* name, const simulation_result_t& result) {
+	cout << name << ":" << endl;
+	cout << "  advertisements:        " << result.advertisements << endl;
+	cout << "  mesh messages:         " << result.meshMessagesSent << " (avoided " << result.broadcastsAvoided
+		 << ", lost deliveries " << result.meshMessagesLost << ")" << endl;
+	cout << "  uart updates:          " << result.uartUpdates << " (avoided " << result.uartUpdatesAvoided << ")" << endl;
+	cout << "  decision latency ms:   median " << percentile(result.decisionLatenciesMs, 50) << ", p90 "
+		 << percentile(result.decisionLatenciesMs, 90) << ", max " << percentile(result.decisionLatenciesMs, 100)
+		 << " (" << result.decisionLatenciesMs.size() << " decided, " << result.undecidedChanges << " undecided)" << endl;
+	cout << "  correct of the time:   " << 100.0 * correctFraction(result) << "%" << endl;
+	cout << "  cpu per advertisement: " << result.cpuNanosecondsPerAdvertisement << " ns" << endl;
+}
+
+int main(int argc, char** argv) {
+	vector<advertisement_t> trace;
+	const vector<advertisement_t>* tracePtr = nullptr;
+	if (argc > 1) {
+		if (!readTrace(argv[1], trace)) {
+			cout << "Could not read trace " << argv[1] << endl;
+			return 1;
+		}
+		cout << "Replaying " << trace.size() << " advertisements from " << argv[1] << endl;
+		tracePtr = &trace;
+	}
+
+	// The defaults have no hysteresis and suppression: every change is reported right away.
+	nearest_crownstone_election_config_t defaultConfig;
+
+	// A candidate for the defaults, once it's clearly as correct.
+	nearest_crownstone_election_config_t candidateConfig;
+	candidateConfig.rssiHysteresisHalved   = 1;
+	candidateConfig.reportSuppressionTicks = 3;
+
+	vector<simulation_result_t> baselinePerSeed = simulate(defaultConfig, tracePtr);
+	simulation_result_t baseline = addUp(baselinePerSeed);
+	printResult("Defaults", baseline);
+	vector<simulation_result_t> resultPerSeed = simulate(candidateConfig, tracePtr);
+	simulation_result_t result = addUp(resultPerSeed);
+	printResult("Hysteresis and suppression", result);
+	spread_t correctDiff = printPerSeed(baselinePerSeed, resultPerSeed);
+
+	assert(baseline.allAssetsHaveWinner);
+	assert(result.allAssetsHaveWinner);
+	assert(result.meshMessagesSent < baseline.meshMessagesSent);
+	assert(result.uartUpdates < baseline.uartUpdates);
+	// Fewer messages should not come at the cost of agreeing on the wrong crownstone, beyond the spread of the seeds.
+	assert(correctDiff.mean + 2 * correctDiff.stddev / sqrt(SEED_COUNT) >= 0);
+	if (tracePtr == nullptr) {
+		assert(!baseline.decisionLatenciesMs.empty());
+		assert(percentile(baseline.decisionLatenciesMs, 50) < 10000);
+		assert(!result.decisionLatenciesMs.empty());
+		assert(percentile(result.decisionLatenciesMs, 50) < 10000);
+	}
+
+	cout << "LocalisationSimulator SUCCESS" << endl;
+	return 0;
+}
@@ -0,0 +1,277 @@
+/**
+ * Runs two example microapps on the host, and checks what they did.
+ */
+
+#include "microapp/cs_MicroappHostRunner.h"
+#include "microapp/cs_MicroappHostSdk.h"
+
+#include <microapp/cs_MicroappCommandRing.h>
+#include <protocol/cs_ErrorCodes.h>
+
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+
+const uint8_t TEMPERATURE_SENSOR_ADDRESS = 0x48;
+const uint8_t TEMPERATURE_THRESHOLD = 25;
+
+/**
+ * Example microapp: switches on when it's warm, and advertises a counter.
+ */
+namespace example {
+
+uint8_t counter = 0;
+uint32_t completionsSuccess = 0;
+uint32_t completionsFailed = 0;
+
+void setup() {
+	microappLog("setup");
+	microappPinMode(CS_MICROAPP_COMMAND_PIN_LED1, CS_MICROAPP_COMMAND_PIN_WRITE);
+	twi_cmd_t init = {};
+	init.cmd = CS_MICROAPP_COMMAND_TWI;
+	init.opcode = CS_MICROAPP_COMMAND_TWI_INIT;
+	microappSendCommand((uint8_t*)&init, sizeof(init));
+}
+
+void loop() {
+	counter++;
+
+	uint8_t temperature = 0;
+	microappTwiRead(TEMPERATURE_SENSOR_ADDRESS, &temperature, 1);
+	microappDigitalWrite(
+			CS_MICROAPP_COMMAND_PIN_SWITCH,
+			temperature >= TEMPERATURE_THRESHOLD ? CS_MICROAPP_COMMAND_VALUE_ON : CS_MICROAPP_COMMAND_VALUE_OFF);
+
+	// Queue the rest, these are handled when the loop returns or yields.
+	pin_cmd_t led = {};
+	led.cmd = CS_MICROAPP_COMMAND_PIN;
+	led.pin = CS_MICROAPP_COMMAND_PIN_LED1;
+	led.opcode1 = CS_MICROAPP_COMMAND_PIN_ACTION;
+	led.opcode2 = CS_MICROAPP_COMMAND_PIN_WRITE;
+	led.value = counter % 2;
+	assert(microappQueueCommand((uint8_t*)&led, sizeof(led)));
+
+	uint8_t serviceData[] = {CS_MICROAPP_COMMAND_SERVICE_DATA, 0, 0, 0x12, 0x34, counter, temperature};
+	assert(microappQueueCommand(serviceData, sizeof(serviceData)));
+
+	uint8_t log[] = {CS_MICROAPP_COMMAND_LOG, CS_MICROAPP_COMMAND_LOG_STR, CS_MICROAPP_COMMAND_LOG_NEWLINE, 'l', 'o', 'o', 'p'};
+	assert(microappQueueCommand(log, sizeof(log)));
+
+	microapp_ring_completion_t completion;
+	while (microappGetCompletion(completion)) {
+		if (completion.result == ERR_SUCCESS) {
+			completionsSuccess++;
+		}
+		else {
+			completionsFailed++;
+		}
+	}
+
+	if (counter % 4 == 0) {
+		microappDelay(2 * MICROAPP_HOST_LOOP_INTERVAL_MS);
+		microappLog("resumed");
+	}
+}
+
+void main() {
+	assert(microappRegister(&setup, &loop));
+}
+
+}  // namespace example
+
+/**
+ * Second microapp: blinks a LED, only via the command ring.
+ */
+namespace blinker {
+
+uint32_t loops = 0;
+uint32_t completionsSuccess = 0;
+uint32_t completionsFailed = 0;
+
+void setup() {
+	uint8_t log[] = {CS_MICROAPP_COMMAND_LOG, CS_MICROAPP_COMMAND_LOG_STR, CS_MICROAPP_COMMAND_LOG_NEWLINE, 'b', 'l', 'i', 'n', 'k', 'e', 'r'};
+	assert(microappQueueCommand(log, sizeof(log)));
+}
+
+void loop() {
+	loops++;
+
+	// The completions of the previous loop, of this microapp only.
+	microapp_ring_completion_t completion;
+	while (microappGetCompletion(completion)) {
+		if (completion.result == ERR_SUCCESS && completion.cmd != CS_MICROAPP_COMMAND_SERVICE_DATA) {
+			completionsSuccess++;
+		}
+		else {
+			completionsFailed++;
+		}
+	}
+
+	pin_cmd_t led = {};
+	led.cmd = CS_MICROAPP_COMMAND_PIN;
+	led.pin = CS_MICROAPP_COMMAND_PIN_LED2;
+	led.opcode1 = CS_MICROAPP_COMMAND_PIN_ACTION;
+	led.opcode2 = CS_MICROAPP_COMMAND_PIN_WRITE;
+	led.value = loops % 2;
+	assert(microappQueueCommand((uint8_t*)&led, sizeof(led)));
+
+	uint8_t log[] = {CS_MICROAPP_COMMAND_LOG, CS_MICROAPP_COMMAND_LOG_STR, CS_MICROAPP_COMMAND_LOG_NEWLINE, 'b', 'l', 'i', 'n', 'k'};
+	assert(microappQueueCommand(log, sizeof(log)));
+}
+
+void main() {
+	assert(microappRegister(&setup, &loop));
+}
+
+}  // namespace blinker
+
+uint32_t countLogLines(const MicroappHostBackend& backend, const string& line) {
+	uint32_t count = 0;
+	for (auto& logLine : backend.logLines) {
+		if (logLine == line) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * The command ring handling that the firmware and the runner share.
+ */
+void testCommandRing() {
+	microapp_command_ring_t ring = {};
+	uint32_t handled = 0;
+	auto handleCommand = [&](uint8_t* payload, uint16_t length) {
+		handled++;
+		return payload[0] == CS_MICROAPP_COMMAND_LOG ? ERR_SUCCESS : ERR_UNKNOWN_OP_CODE;
+	};
+	uint8_t handledCount = 0;
+
+	// A command for each result.
+	ring.commands[0] = {1, {CS_MICROAPP_COMMAND_LOG}};
+	ring.commands[1] = {1, {CS_MICROAPP_COMMAND_PIN}};
+	ring.commands[2] = {0, {}};
+	ring.commands[3] = {MAX_PAYLOAD + 1, {CS_MICROAPP_COMMAND_LOG}};
+	ring.commands[4] = {3, {CS_MICROAPP_COMMAND_DELAY}};
+	ring.commandHead = 5;
+	assert(handleMicroappCommandRing(ring, handleCommand, handledCount) == ERR_SUCCESS);
+	assert(handledCount == 5);
+	assert(handled == 2);
+	assert(ring.commandTail == 5 && ring.completionHead == 5);
+	assert(ring.completions[0].id == 0 && ring.completions[0].result == ERR_SUCCESS);
+	assert(ring.completions[1].cmd == CS_MICROAPP_COMMAND_PIN && ring.completions[1].result == ERR_UNKNOWN_OP_CODE);
+	assert(ring.completions[2].result == ERR_NO_PAYLOAD);
+	assert(ring.completions[3].result == ERR_TOO_LARGE);
+	assert(ring.completions[4].id == 4 && ring.completions[4].result == ERR_NOT_IN_RING);
+
+	// Stops when the completion ring is full, and wraps around.
+	ring.completionTail = 2;
+	for (uint8_t i = 0; i < MICROAPP_COMMAND_RING_SIZE; ++i) {
+		ring.commands[(5 + i) % MICROAPP_COMMAND_RING_SIZE] = {1, {CS_MICROAPP_COMMAND_LOG}};
+	}
+	ring.commandHead = 5 + MICROAPP_COMMAND_RING_SIZE;
+	assert(handleMicroappCommandRing(ring, handleCommand, handledCount) == ERR_SUCCESS);
+	assert(handledCount == 5);
+	assert(ring.commandTail == 10 && ring.completionHead == 10);
+	ring.completionTail = 10;
+	assert(handleMicroappCommandRing(ring, handleCommand, handledCount) == ERR_SUCCESS);
+	assert(handledCount == 3);
+	assert(ring.commandTail == ring.commandHead);
+	assert(ring.completions[12 % MICROAPP_COMMAND_RING_SIZE].id == 12);
+
+	// A head that is too far ahead of the tail: the commands are dropped, without handling them.
+	handled = 0;
+	ring.commandHead = ring.commandTail + MICROAPP_COMMAND_RING_SIZE + 1;
+	assert(handleMicroappCommandRing(ring, handleCommand, handledCount) == ERR_WRONG_STATE);
+	assert(handledCount == 0);
+	assert(handled == 0);
+	assert(ring.commandTail == ring.commandHead);
+	assert(ring.completionHead == 13);
+
+	// A head behind the tail.
+	ring.commandHead = ring.commandTail - 1;
+	assert(handleMicroappCommandRing(ring, handleCommand, handledCount) == ERR_WRONG_STATE);
+	assert(handled == 0);
+	assert(ring.commandTail == ring.commandHead);
+	cout << "command ring: ok" << endl;
+}
+
+int main() {
+	testCommandRing();
+
+	MicroappHostRunner runner;
+	MicroappHostBackend& backend = runner.getBackend();
+	backend.twiReadData[TEMPERATURE_SENSOR_ADDRESS] = {20};
+
+	assert(runner.boot(&example::main));
+
+	// Fill the command ring before setup.
+	uint8_t queued = 0;
+	uint8_t log[] = {CS_MICROAPP_COMMAND_LOG, CS_MICROAPP_COMMAND_LOG_STR, CS_MICROAPP_COMMAND_LOG_NEWLINE, 'p', 'r', 'e'};
+	while (microappQueueCommand(log, sizeof(log))) {
+		queued++;
+	}
+	assert(queued == MICROAPP_COMMAND_RING_SIZE);
+	uint8_t delay[] = {CS_MICROAPP_COMMAND_DELAY, 0, 0};
+	assert(!microappQueueCommand(delay, sizeof(delay)));
+
+	assert(runner.boot(&blinker::main));
+	assert(runner.getAppCount() == 2);
+	assert(!runner.boot(&blinker::main));
+	const microapp_host_app_t& exampleApp = runner.getApp(0);
+	const microapp_host_app_t& blinkerApp = runner.getApp(1);
+	assert(&exampleApp.commandRing != &blinkerApp.commandRing);
+
+	// Every 4 loops, the microapp delays 2 intervals and then resumes in the next call: 7 intervals per 4 loops.
+	runner.run(21);
+	cout << "loops=" << (int)example::counter << " loop calls=" << exampleApp.loopStats.count
+			<< " yields=" << exampleApp.yields << endl;
+	assert(example::counter == 12);
+	assert(exampleApp.loopStats.count == 15);
+	assert(exampleApp.yields == 3);
+	assert(exampleApp.setupStats.count == 1);
+	assert(countLogLines(backend, "setup") == 1);
+	assert(countLogLines(backend, "pre") == MICROAPP_COMMAND_RING_SIZE);
+	assert(countLogLines(backend, "loop") == 12);
+	assert(countLogLines(backend, "resumed") == 3);
+	assert(exampleApp.ringCommands == MICROAPP_COMMAND_RING_SIZE + 3 * 12);
+	assert(backend.twiInitialized);
+	assert(backend.pinMode[CS_MICROAPP_COMMAND_PIN_LED1] == CS_MICROAPP_COMMAND_PIN_WRITE);
+	assert(backend.pinValue[CS_MICROAPP_COMMAND_PIN_LED1] == 0);
+	assert(backend.serviceDataUpdates == 12);
+	assert((backend.serviceData == vector<uint8_t>{12, 20}));
+	assert(!backend.switchOn);
+	assert(backend.switchChanges == 0);
+
+	// The blinker doesn't delay, and its commands don't end up in the ring of the example.
+	assert(blinkerApp.setupStats.count == 1);
+	assert(blinker::loops == 21);
+	assert(blinkerApp.loopStats.count == 21);
+	assert(blinkerApp.yields == 0);
+	assert(blinkerApp.ringCommands == 1 + 2 * 21);
+	assert(countLogLines(backend, "blinker") == 1);
+	assert(countLogLines(backend, "blink") == 21);
+	assert(backend.pinValue[CS_MICROAPP_COMMAND_PIN_LED2] == 1);
+
+	// It gets warm.
+	backend.twiReadData[TEMPERATURE_SENSOR_ADDRESS] = {30};
+	runner.run(7);
+	assert(example::counter == 16);
+	assert(exampleApp.setupStats.count == 1);
+	assert(backend.switchOn);
+	assert(backend.switchChanges == 1);
+	assert((backend.serviceData == vector<uint8_t>{16, 30}));
+
+	// The completions of all but the last loop have been read by the microapp.
+	uint32_t completions = example::completionsSuccess + example::completionsFailed;
+	assert(example::completionsFailed == 0);
+	assert(completions == MICROAPP_COMMAND_RING_SIZE + 3 * 15);
+	assert(blinker::completionsFailed == 0);
+	assert(blinker::completionsSuccess == 1 + 2 * 27);
+
+	runner.printReport(cout);
+
+	cout << "MicroappHostRunner SUCCESS" << endl;
+	return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * Tests the scan forwarder of microapps: the checks of the buffer in the RAM of the microapp, the subscriptions,
+ * the matching of scanned devices, and the ring buffer the devices are forwarded to.
+ */
+
+#include <microapp/cs_MicroappScanForwarder.h>
+#include <protocol/cs_ErrorCodes.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+const uint8_t AD_TYPE_SERVICE_DATA = 0x16;
+const uint8_t AD_TYPE_MANUFACTURER_DATA = 0xFF;
+
+/**
+ * Fake RAM of a microapp, with room for a scan buffer of 8 devices.
+ */
+const size_t RAM_SIZE = offsetof(microapp_scan_buffer_t, devices) + 8 * sizeof(microapp_scanned_device_t);
+alignas(microapp_scan_buffer_t) uint8_t ram[RAM_SIZE + 64];
+
+uintptr_t ramStart() {
+	return reinterpret_cast<uintptr_t>(ram);
+}
+
+microapp_scan_buffer_t* initBuffer(uintptr_t offset, uint8_t size) {
+	microapp_scan_buffer_t* buffer = reinterpret_cast<microapp_scan_buffer_t*>(ramStart() + offset);
+	buffer->head = 0;
+	buffer->tail = 0;
+	buffer->size = size;
+	buffer->dropped = 0;
+	return buffer;
+}
+
+scan_subscription_cmd_t subscription(uint8_t id, uint8_t inputType, int8_t rssiThreshold = -100) {
+	scan_subscription_cmd_t cmd = {};
+	cmd.id = id;
+	cmd.inputType = inputType;
+	cmd.rssiThreshold = rssiThreshold;
+	return cmd;
+}
+
+void setValue(scan_subscription_cmd_t& cmd, const uint8_t* value, const uint8_t* valueMask, uint8_t valueLength) {
+	cmd.valueLength = valueLength;
+	memcpy(cmd.value, value, valueLength);
+	memcpy(cmd.valueMask, valueMask, valueLength);
+}
+
+/**
+ * A scanned device with a flags field, and a service data field.
+ */
+struct test_device_t {
+	uint8_t data[10] = {0x02, 0x01, 0x06, 0x06, AD_TYPE_SERVICE_DATA, 0xC0, 0xFE, 0x11, 0x22, 0x33};
+	scanned_device_t device = {};
+
+	test_device_t(uint8_t lastMacByte, int8_t rssi) {
+		device.rssi = rssi;
+		uint8_t address[6] = {0x01, 0x02, 0x03, 0x04, 0x05, lastMacByte};
+		memcpy(device.address, address, sizeof(address));
+		device.channel = 37;
+		device.dataSize = sizeof(data);
+		device.data = data;
+	}
+};
+
+void testSetBuffer() {
+	MicroappScanForwarder forwarder;
+	assert(forwarder.setBuffer(0, ramStart(), RAM_SIZE) == ERR_SUCCESS);
+
+	initBuffer(0, 8);
+	assert(forwarder.setBuffer(ramStart() + 1, ramStart(), RAM_SIZE) == ERR_WRONG_PARAMETER);
+
+	// The header should be inside the RAM.
+	assert(forwarder.setBuffer(ramStart() - 8, ramStart(), RAM_SIZE) == ERR_WRONG_PARAMETER);
+	assert(forwarder.setBuffer(ramStart() + RAM_SIZE, ramStart(), RAM_SIZE) == ERR_WRONG_PARAMETER);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), 4) == ERR_WRONG_PARAMETER);
+
+	// The size should be a power of 2.
+	initBuffer(0, 0);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_WRONG_PARAMETER);
+	initBuffer(0, 6);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_WRONG_PARAMETER);
+
+	// All devices should be inside the RAM.
+	initBuffer(0, 16);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_BUFFER_TOO_SMALL);
+	initBuffer(2, 8);
+	assert(forwarder.setBuffer(ramStart() + 2, ramStart(), RAM_SIZE) == ERR_BUFFER_TOO_SMALL);
+
+	microapp_scan_buffer_t* buffer = initBuffer(0, 8);
+	buffer->head = 5;
+	buffer->tail = 3;
+	buffer->dropped = 7;
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_SUCCESS);
+	assert(buffer->head == buffer->tail);
+	assert(buffer->dropped == 0);
+	cout << "set buffer: ok" << endl;
+}
+
+void testSubscribe() {
+	MicroappScanForwarder forwarder;
+	scan_subscription_cmd_t cmd = subscription(1, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS);
+	cmd.valueLength = MICROAPP_SCAN_VALUE_SIZE + 1;
+	assert(forwarder.subscribe(cmd) == ERR_WRONG_PARAMETER);
+	cmd.valueLength = MICROAPP_SCAN_VALUE_SIZE;
+	assert(forwarder.subscribe(cmd) == ERR_SUCCESS);
+
+	assert(forwarder.subscribe(subscription(2, 3)) == ERR_WRONG_PARAMETER);
+
+	// Subscribing with the same ID replaces the subscription, and doesn't take another slot.
+	for (uint8_t i = 0; i < 3; ++i) {
+		assert(forwarder.subscribe(subscription(1, CS_MICROAPP_COMMAND_SCAN_INPUT_AD_DATA_TYPE)) == ERR_SUCCESS);
+	}
+	for (uint8_t id = 2; id <= MICROAPP_MAX_SCAN_SUBSCRIPTIONS; ++id) {
+		assert(forwarder.subscribe(subscription(id, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_SUCCESS);
+	}
+	uint8_t newId = MICROAPP_MAX_SCAN_SUBSCRIPTIONS + 1;
+	assert(forwarder.subscribe(subscription(newId, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_NO_SPACE);
+
+	assert(forwarder.unsubscribe(newId) == ERR_NOT_FOUND);
+	assert(forwarder.unsubscribe(2) == ERR_SUCCESS);
+	assert(forwarder.unsubscribe(2) == ERR_NOT_FOUND);
+	assert(forwarder.subscribe(subscription(newId, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_SUCCESS);
+	cout << "subscribe: ok" << endl;
+}
+
+/**
+ * Subscribe with a single subscription, and check which devices are forwarded.
+ */
+void checkMatch(const scan_subscription_cmd_t& cmd, test_device_t& matching, test_device_t& notMatching) {
+	MicroappScanForwarder forwarder;
+	microapp_scan_buffer_t* buffer = initBuffer(0, 8);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_SUCCESS);
+	assert(forwarder.subscribe(cmd) == ERR_SUCCESS);
+
+	forwarder.onScannedDevice(notMatching.device);
+	assert(buffer->head == 0);
+	forwarder.onScannedDevice(matching.device);
+	assert(buffer->head == 1);
+	assert(buffer->devices[0].id == cmd.id);
+	assert(buffer->devices[0].rssi == matching.device.rssi);
+	assert(buffer->devices[0].channel == matching.device.channel);
+	assert(memcmp(buffer->devices[0].address, matching.device.address, sizeof(matching.device.address)) == 0);
+	assert(buffer->devices[0].dataSize == matching.device.dataSize);
+	assert(memcmp(buffer->devices[0].data, matching.data, matching.device.dataSize) == 0);
+}
+
+void testMatch() {
+	test_device_t device(0xAA, -60);
+	test_device_t otherMac(0xBB, -60);
+	test_device_t weak(0xAA, -90);
+	uint8_t allBits[MICROAPP_SCAN_VALUE_SIZE];
+	memset(allBits, 0xFF, sizeof(allBits));
+
+	// Every device, above the RSSI threshold.
+	scan_subscription_cmd_t cmd = subscription(3, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS, -80);
+	checkMatch(cmd, device, weak);
+
+	// By MAC address, only the masked bits should be compared.
+	uint8_t mac[6] = {0x01, 0x02, 0x03, 0x04, 0x05, 0xA0};
+	uint8_t macMask[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0};
+	setValue(cmd, mac, macMask, sizeof(mac));
+	checkMatch(cmd, device, otherMac);
+
+	// By AD type: the service data UUID.
+	cmd = subscription(4, CS_MICROAPP_COMMAND_SCAN_INPUT_AD_DATA_TYPE);
+	cmd.adDataType = AD_TYPE_SERVICE_DATA;
+	uint8_t uuid[2] = {0xC0, 0xFE};
+	setValue(cmd, uuid, allBits, sizeof(uuid));
+	test_device_t otherUuid(0xAA, -60);
+	otherUuid.data[6] = 0xFF;
+	checkMatch(cmd, device, otherUuid);
+
+	// A device without the AD type doesn't match, even with an empty value.
+	cmd = subscription(5, CS_MICROAPP_COMMAND_SCAN_INPUT_AD_DATA_TYPE);
+	cmd.adDataType = AD_TYPE_SERVICE_DATA;
+	test_device_t noServiceData(0xAA, -60);
+	noServiceData.data[4] = AD_TYPE_MANUFACTURER_DATA;
+	checkMatch(cmd, device, noServiceData);
+
+	// The value can't be longer than the AD data.
+	uint8_t longValue[6] = {0xC0, 0xFE, 0x11, 0x22, 0x33, 0x00};
+	setValue(cmd, longValue, allBits, sizeof(longValue));
+	MicroappScanForwarder forwarder;
+	microapp_scan_buffer_t* buffer = initBuffer(0, 8);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_SUCCESS);
+	assert(forwarder.subscribe(cmd) == ERR_SUCCESS);
+	forwarder.onScannedDevice(device.device);
+	assert(buffer->head == 0);
+
+	// By masked AD type: byte 0 and 4 of the service data.
+	cmd = subscription(6, CS_MICROAPP_COMMAND_SCAN_INPUT_MASKED_AD_DATA_TYPE);
+	cmd.adDataType = AD_TYPE_SERVICE_DATA;
+	cmd.adDataMask = 0x11;
+	uint8_t masked[2] = {0xC0, 0x33};
+	setValue(cmd, masked, allBits, sizeof(masked));
+	test_device_t otherMasked(0xAA, -60);
+	otherMasked.data[9] = 0x34;
+	checkMatch(cmd, device, otherMasked);
+	cout << "match: ok" << endl;
+}
+
+void testForward() {
+	MicroappScanForwarder forwarder;
+	test_device_t device(0xAA, -60);
+
+	// Without buffer, or without subscription, nothing happens.
+	assert(forwarder.subscribe(subscription(1, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_SUCCESS);
+	forwarder.onScannedDevice(device.device);
+	assert(forwarder.unsubscribe(1) == ERR_SUCCESS);
+	microapp_scan_buffer_t* buffer = initBuffer(0, 4);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_SUCCESS);
+	forwarder.onScannedDevice(device.device);
+	assert(buffer->head == 0);
+
+	// The first matching subscription is used.
+	assert(forwarder.subscribe(subscription(7, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS, -50)) == ERR_SUCCESS);
+	assert(forwarder.subscribe(subscription(8, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_SUCCESS);
+	assert(forwarder.subscribe(subscription(9, CS_MICROAPP_COMMAND_SCAN_INPUT_MAC_ADDRESS)) == ERR_SUCCESS);
+
+	// Read the devices in different batch sizes, so that the head and tail wrap around the buffer and the counter.
+	uint8_t tail = 0;
+	uint16_t dropped = 0;
+	for (int loop = 0; loop < 600; ++loop) {
+		int scanned = loop % 7;
+		for (int i = 0; i < scanned; ++i) {
+			device.data[9] = tail + i;
+			forwarder.onScannedDevice(device.device);
+		}
+		uint8_t available = buffer->head - tail;
+		assert(available == (scanned < 4 ? scanned : 4));
+		dropped += scanned - available;
+		assert(buffer->dropped == dropped);
+		for (; tail != buffer->head; ++tail) {
+			microapp_scanned_device_t& forwarded = buffer->devices[tail % 4];
+			assert(forwarded.id == 8);
+			assert(forwarded.data[9] == tail);
+		}
+		buffer->tail = tail;
+	}
+
+	// The microapp can't make bluenet write outside the buffer by changing the size afterwards.
+	buffer->size = 128;
+	for (int i = 0; i < 10; ++i) {
+		forwarder.onScannedDevice(device.device);
+	}
+	assert((uint8_t)(buffer->head - buffer->tail) == 4);
+
+	// Advertisements longer than the forwarded data are cut off.
+	uint8_t longData[40] = {};
+	device.device.data = longData;
+	device.device.dataSize = sizeof(longData);
+	buffer = initBuffer(0, 4);
+	assert(forwarder.setBuffer(ramStart(), ramStart(), RAM_SIZE) == ERR_SUCCESS);
+	forwarder.onScannedDevice(device.device);
+	assert(buffer->head == 1);
+	assert(buffer->devices[0].dataSize == MICROAPP_SCAN_DATA_SIZE);
+	cout << "forward: ok" << endl;
+}
+
+int main() {
+	testSetBuffer();
+	testSubscribe();
+	testMatch();
+	testForward();
+	cout << "MicroappScanForwarder SUCCESS" << endl;
+	return 0;
+}
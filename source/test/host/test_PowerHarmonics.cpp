@@ -0,0 +1,245 @@
+/**
+ * Compares the fixed point harmonics analysis with a floating point DFT reference, and measures how long an analysis takes.
+ */
+
+#include <processing/cs_PowerHarmonics.h>
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+const double PI = 3.14159265358979323846;
+
+const uint8_t CHANNEL_COUNT = 2;
+const uint8_t VOLTAGE_CHANNEL = 0;
+const uint8_t CURRENT_CHANNEL = 1;
+
+// Zeros, times 1024, like PowerSampling keeps them up.
+const int32_t VOLTAGE_ZERO = 37 * 1024 + 300;
+const int32_t CURRENT_ZERO = -21 * 1024 - 700;
+const float CURRENT_MULTIPLIER = 0.0045f;
+
+/**
+ * A waveform as function of the phase of the fundamental, in ADC units.
+ */
+typedef function<double(double)> waveform_t;
+
+/**
+ * Sample a period of voltage and current, with 12 bit quantization and some noise.
+ */
+vector<adc_sample_value_t> sample(uint16_t numSamples, waveform_t voltage, waveform_t current, int noise) {
+	vector<adc_sample_value_t> samples(numSamples * CHANNEL_COUNT);
+	for (uint16_t i = 0; i < numSamples; ++i) {
+		double phase = 2 * PI * i / numSamples;
+		double v = voltage(phase) + VOLTAGE_ZERO / 1024.0 + (noise ? rand() % (2 * noise + 1) - noise : 0);
+		double c = current(phase) + CURRENT_ZERO / 1024.0 + (noise ? rand() % (2 * noise + 1) - noise : 0);
+		samples[i * CHANNEL_COUNT + VOLTAGE_CHANNEL] = max(-2048.0, min(2047.0, round(v)));
+		samples[i * CHANNEL_COUNT + CURRENT_CHANNEL] = max(-2048.0, min(2047.0, round(c)));
+	}
+	return samples;
+}
+
+/**
+ * Reference: DFT in double precision, of the same samples.
+ */
+cs_power_harmonics_t reference(const vector<adc_sample_value_t>& samples, uint16_t numSamples) {
+	vector<double> voltage(numSamples);
+	vector<double> current(numSamples);
+	double pSum = 0, vSquareSum = 0, cSquareSum = 0;
+	for (uint16_t i = 0; i < numSamples; ++i) {
+		voltage[i] = samples[i * CHANNEL_COUNT + VOLTAGE_CHANNEL] - VOLTAGE_ZERO / 1024.0;
+		current[i] = samples[i * CHANNEL_COUNT + CURRENT_CHANNEL] - CURRENT_ZERO / 1024.0;
+		pSum += voltage[i] * current[i];
+		vSquareSum += voltage[i] * voltage[i];
+		cSquareSum += current[i] * current[i];
+	}
+	auto dft = [&](const vector<double>& x, int harmonic, double& real, double& imag) {
+		real = 0;
+		imag = 0;
+		for (uint16_t i = 0; i < numSamples; ++i) {
+			real += x[i] * cos(2 * PI * harmonic * i / numSamples);
+			imag -= x[i] * sin(2 * PI * harmonic * i / numSamples);
+		}
+	};
+
+	cs_power_harmonics_t result;
+	result.powerFactor = lround(pSum / sqrt(vSquareSum * cSquareSum) * 1000);
+	double vReal, vImag, cReal, cImag;
+	dft(voltage, 1, vReal, vImag);
+	double fundamental = 0;
+	double harmonicsSquareSum = 0;
+	for (int h = 0; h < POWER_HARMONICS_COUNT; ++h) {
+		int harmonic = 2 * h + 1;
+		if (2 * harmonic >= numSamples) {
+			result.currentHarmonicsMilliAmp[h] = 0;
+			continue;
+		}
+		dft(current, harmonic, cReal, cImag);
+		double magnitude = hypot(cReal, cImag);
+		result.currentHarmonicsMilliAmp[h] = lround(magnitude * sqrt(2.0) / numSamples * CURRENT_MULTIPLIER * 1000);
+		if (h == 0) {
+			fundamental = magnitude;
+			result.displacementPowerFactor = lround((vReal * cReal + vImag * cImag) / (hypot(vReal, vImag) * magnitude) * 1000);
+		}
+		else {
+			harmonicsSquareSum += magnitude * magnitude;
+		}
+	}
+	result.currentThd = lround(sqrt(harmonicsSquareSum) / fundamental * 1000);
+	return result;
+}
+
+/**
+ * Analyse a waveform, and check the result against the reference.
+ *
+ * @return The result.
+ */
+cs_power_harmonics_t check(const char* name, uint16_t numSamples, waveform_t voltage, waveform_t current, int noise = 0) {
+	PowerHarmonics harmonics;
+	assert(harmonics.init(numSamples) == ERR_SUCCESS);
+	vector<adc_sample_value_t> samples = sample(numSamples, voltage, current, noise);
+
+	cs_power_harmonics_t result;
+	harmonics.analyse(samples.data(), CHANNEL_COUNT, VOLTAGE_CHANNEL, CURRENT_CHANNEL, VOLTAGE_ZERO, CURRENT_ZERO, CURRENT_MULTIPLIER, result);
+	cs_power_harmonics_t expected = reference(samples, numSamples);
+
+	cout << name << " N=" << numSamples << ": PF=" << result.powerFactor << " (" << expected.powerFactor << ")"
+		 << " DPF=" << result.displacementPowerFactor << " (" << expected.displacementPowerFactor << ")"
+		 << " THD=" << result.currentThd << " (" << expected.currentThd << ")" << " mA:";
+	int maxError = 0;
+	for (int h = 0; h < POWER_HARMONICS_COUNT; ++h) {
+		cout << " " << result.currentHarmonicsMilliAmp[h];
+		maxError = max(maxError, abs(result.currentHarmonicsMilliAmp[h] - expected.currentHarmonicsMilliAmp[h]));
+	}
+	cout << " (max error " << maxError << " mA)" << endl;
+
+	// Rounding of the zero to whole sample values only affects the power factor by a permille or so.
+	assert(abs(result.powerFactor - expected.powerFactor) <= 2);
+	assert(abs(result.displacementPowerFactor - expected.displacementPowerFactor) <= 1);
+	assert(abs(result.currentThd - expected.currentThd) <= 1);
+	for (int h = 0; h < POWER_HARMONICS_COUNT; ++h) {
+		assert(abs(result.currentHarmonicsMilliAmp[h] - expected.currentHarmonicsMilliAmp[h]) <= 1);
+	}
+	return result;
+}
+
+waveform_t sine(double amplitude, double phaseShift = 0) {
+	return [=](double phase) { return amplitude * sin(phase - phaseShift); };
+}
+
+/**
+ * Sine with odd harmonics, relative to the fundamental amplitude.
+ */
+waveform_t distortedSine(double amplitude, double third, double fifth) {
+	return [=](double phase) { return amplitude * (sin(phase) + third * sin(3 * phase) + fifth * sin(5 * phase)); };
+}
+
+/**
+ * Current of a switched mode power supply: pulses when the voltage is near its peak.
+ */
+waveform_t pulses(double amplitude, double width) {
+	return [=](double phase) {
+		double s = sin(phase);
+		if (fabs(s) < cos(width / 2)) {
+			return 0.0;
+		}
+		return (s > 0 ? 1 : -1) * amplitude * (fabs(s) - cos(width / 2)) / (1 - cos(width / 2));
+	};
+}
+
+void testWaveforms(uint16_t numSamples) {
+	waveform_t voltage = sine(1500);
+	cs_power_harmonics_t result;
+
+	result = check("sine", numSamples, voltage, sine(1000));
+	assert(result.powerFactor >= 998);
+	assert(result.displacementPowerFactor >= 999);
+	assert(result.currentThd <= 2);
+	// 1000 / sqrt(2) * 4.5 mA
+	assert(abs(result.currentHarmonicsMilliAmp[0] - 3182) <= 3);
+
+	result = check("shifted", numSamples, voltage, sine(1000, acos(0.8)));
+	assert(abs(result.powerFactor - 800) <= 3);
+	assert(abs(result.displacementPowerFactor - 800) <= 2);
+
+	result = check("small load", numSamples, voltage, sine(20), 1);
+
+	result = check("distorted", numSamples, voltage, distortedSine(1000, 0.3, 0.15));
+	// sqrt(0.3^2 + 0.15^2)
+	assert(abs(result.currentThd - 335) <= 2);
+	assert(abs(result.currentHarmonicsMilliAmp[1] - 955) <= 3);
+	assert(abs(result.currentHarmonicsMilliAmp[2] - 477) <= 3);
+	assert(result.displacementPowerFactor >= 999);
+	// The harmonics don't carry power: PF = DPF / sqrt(1 + THD^2)
+	assert(abs(result.powerFactor - 948) <= 3);
+
+	result = check("pulses", numSamples, voltage, pulses(2000, PI / 3), 2);
+	assert(result.currentThd > 500);
+	assert(result.powerFactor < 800);
+	assert(result.displacementPowerFactor >= 995);
+}
+
+void testInit() {
+	PowerHarmonics harmonics;
+	assert(!harmonics.isInitialized());
+	assert(harmonics.init(2) == ERR_WRONG_PARAMETER);
+	assert(harmonics.init(CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL + 1) == ERR_WRONG_PARAMETER);
+	assert(!harmonics.isInitialized());
+	assert(harmonics.init(CS_ADC_NUM_SAMPLES_PER_CHANNEL) == ERR_SUCCESS);
+	assert(harmonics.isInitialized());
+
+	// Only the harmonics below the Nyquist frequency are analysed: 1, 3, 5 for 12 samples.
+	cs_power_harmonics_t result = check("few samples", 12, sine(1500), distortedSine(1000, 0.3, 0.15));
+	assert(result.currentHarmonicsMilliAmp[3] == 0);
+
+	// No load.
+	assert(harmonics.init(CS_ADC_NUM_SAMPLES_PER_CHANNEL) == ERR_SUCCESS);
+	vector<adc_sample_value_t> samples = sample(CS_ADC_NUM_SAMPLES_PER_CHANNEL, sine(1500), sine(0), 0);
+	harmonics.analyse(samples.data(), CHANNEL_COUNT, VOLTAGE_CHANNEL, CURRENT_CHANNEL, VOLTAGE_ZERO, CURRENT_ZERO, CURRENT_MULTIPLIER, result);
+	assert(result.currentHarmonicsMilliAmp[0] <= 3);
+}
+
+void testFullScale() {
+	// The fixed point state should not overflow with a full scale signal at the max number of samples.
+	uint16_t numSamples = CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL;
+	check("full scale", numSamples, sine(2047), sine(2047));
+	check("full scale pulses", numSamples, sine(2047), pulses(2047, PI / 4));
+}
+
+void benchmark(uint16_t numSamples) {
+	PowerHarmonics harmonics;
+	harmonics.init(numSamples);
+	vector<adc_sample_value_t> samples = sample(numSamples, sine(1500), pulses(2000, PI / 3), 2);
+	cs_power_harmonics_t result;
+	const int iterations = 20000;
+	int32_t checksum = 0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		harmonics.analyse(samples.data(), CHANNEL_COUNT, VOLTAGE_CHANNEL, CURRENT_CHANNEL, VOLTAGE_ZERO, CURRENT_ZERO, CURRENT_MULTIPLIER, result);
+		checksum += result.currentThd;
+	}
+	auto end = chrono::steady_clock::now();
+	double ns = chrono::duration<double, nano>(end - start).count() / iterations;
+	cout << "N=" << numSamples << ": " << ns << " ns per analysis (checksum " << checksum << ")" << endl;
+}
+
+int main() {
+	srand(1);
+	testInit();
+	testWaveforms(CS_ADC_NUM_SAMPLES_PER_CHANNEL);
+	testWaveforms(CS_ADC_BUFFER_DURATION_US / CS_ADC_SAMPLE_INTERVAL_LOW_POWER_US);
+	testWaveforms(CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL);
+	testFullScale();
+
+	benchmark(CS_ADC_NUM_SAMPLES_PER_CHANNEL);
+	benchmark(CS_ADC_MAX_NUM_SAMPLES_PER_CHANNEL);
+
+	cout << "PowerHarmonics SUCCESS" << endl;
+	return 0;
+}
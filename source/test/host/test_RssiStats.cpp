@@ -0,0 +1,182 @@
+/**
+ * Compares the fixed point RSSI statistics with a floating point reference.
+ */
+
+#include <util/cs_RssiStats.h>
+#include <util/cs_Variance.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Floating point reference of the same algorithm: Welford, with the weight capped at 1/windowSize.
+ */
+struct reference_stats_t {
+	uint32_t windowSize;
+	uint32_t count = 0;
+	double mean = 0;
+	double variance = 0;
+
+	void addValue(double value) {
+		if (count < windowSize) {
+			count++;
+		}
+		double diffWithOldMean = value - mean;
+		mean += diffWithOldMean / count;
+		double diffWithNewMean = value - mean;
+		variance += (diffWithOldMean * diffWithNewMean - variance) / count;
+	}
+};
+
+template <uint16_t WindowSize>
+double getMean(const RssiStats<WindowSize>& stats) {
+	return static_cast<double>(stats.getMeanFixedPoint()) / RssiStats<WindowSize>::ONE;
+}
+
+template <uint16_t WindowSize>
+double getVariance(const RssiStats<WindowSize>& stats) {
+	return static_cast<double>(stats.getVarianceFixedPoint()) / RssiStats<WindowSize>::ONE;
+}
+
+/**
+ * Random RSSI around a mean, with a roughly normal distribution.
+ */
+int8_t randomRssi(int mean, int spread) {
+	int sum = 0;
+	for (int i = 0; i < 4; ++i) {
+		sum += rand() % (2 * spread + 1) - spread;
+	}
+	int rssi = mean + sum / 2;
+	if (rssi < -128) {
+		rssi = -128;
+	}
+	if (rssi > 0) {
+		rssi = 0;
+	}
+	return static_cast<int8_t>(rssi);
+}
+
+void checkClose(double value, double expected, double tolerance, const char* name) {
+	if (fabs(value - expected) > tolerance) {
+		cout << name << " " << value << " differs from " << expected << " by more than " << tolerance << endl;
+		assert(false);
+	}
+}
+
+/**
+ * While the count is below the window size, the statistics should match plain Welford.
+ */
+void testWelford() {
+	cout << "Test against VarianceAggregator." << endl;
+	for (int run = 0; run < 100; ++run) {
+		RssiStats<1000> stats;
+		VarianceAggregator aggregator;
+		int mean = -40 - rand() % 60;
+		int spread = 1 + rand() % 12;
+		int count = 2 + rand() % 900;
+		for (int i = 0; i < count; ++i) {
+			int8_t rssi = randomRssi(mean, spread);
+			stats.addValue(rssi);
+			aggregator.addValue(rssi);
+		}
+		assert(stats.getCount() == aggregator.getCount());
+		double populationVariance = aggregator.getVariance() * (count - 1) / count;
+		checkClose(getMean(stats), aggregator.getMean(), 0.05, "mean");
+		checkClose(getVariance(stats), populationVariance, 0.02 * populationVariance + 0.1, "variance");
+		assert(abs(stats.getMean() - aggregator.getMean()) <= 0.55);
+	}
+}
+
+/**
+ * After the window size, the statistics should follow the exponentially weighted reference.
+ */
+template <uint16_t WindowSize>
+void testExponential() {
+	cout << "Test exponential weighting with window size " << WindowSize << "." << endl;
+	for (int run = 0; run < 50; ++run) {
+		RssiStats<WindowSize> stats;
+		reference_stats_t reference = {.windowSize = WindowSize};
+		int mean = -40 - rand() % 60;
+		int spread = 1 + rand() % 12;
+		for (int i = 0; i < 20 * WindowSize; ++i) {
+			// Let the mean move, so old values have to be forgotten.
+			if (i % (4 * WindowSize) == 0) {
+				mean = -40 - rand() % 60;
+			}
+			int8_t rssi = randomRssi(mean, spread);
+			stats.addValue(rssi);
+			reference.addValue(rssi);
+		}
+		assert(stats.getCount() == WindowSize);
+		checkClose(getMean(stats), reference.mean, 0.1, "mean");
+		checkClose(getVariance(stats), reference.variance, 0.03 * reference.variance + 0.2, "variance");
+	}
+}
+
+void testExtremes() {
+	cout << "Test extreme values." << endl;
+	RssiStats<16> stats;
+	reference_stats_t reference = {.windowSize = 16};
+	for (int i = 0; i < 1000; ++i) {
+		int8_t rssi = (i % 2) ? 0 : -128;
+		stats.addValue(rssi);
+		reference.addValue(rssi);
+	}
+	checkClose(getMean(stats), reference.mean, 0.01, "mean");
+	checkClose(getVariance(stats), reference.variance, 0.01 * reference.variance, "variance");
+
+	stats.reset();
+	for (int i = 0; i < 100; ++i) {
+		stats.addValue(-128);
+	}
+	assert(stats.getMean() == -128);
+	assert(stats.getVarianceFixedPoint() == 0);
+
+	stats.reset();
+	assert(stats.getCount() == 0);
+	stats.addValue(-61);
+	assert(stats.getMean() == -61);
+	stats.addValue(-62);
+	// -61.5 rounds away from zero.
+	assert(stats.getMean() == -62);
+	assert(stats.getVarianceFixedPoint() == RssiStats<16>::ONE / 4);
+}
+
+void testChannels() {
+	cout << "Test channel stats." << endl;
+	RssiChannelStats<32> stats;
+	assert(stats.addValue(-50, 36) == false);
+	assert(stats.addValue(-50, 40) == false);
+	assert(stats.getMinCount() == 0);
+	for (int i = 0; i < 10; ++i) {
+		assert(stats.addValue(-50, 37));
+		assert(stats.addValue(-60, 38));
+	}
+	assert(stats.getMinCount() == 0);
+	assert(stats.addValue(-70, 39));
+	assert(stats.getMinCount() == 1);
+	assert(stats.getChannel(0).getMean() == -50);
+	assert(stats.getChannel(1).getMean() == -60);
+	assert(stats.getChannel(2).getMean() == -70);
+	assert(stats.getChannel(0).getCount() == 10);
+	stats.reset();
+	assert(stats.getChannel(0).getCount() == 0);
+	assert(sizeof(stats) == 3 * 10);
+}
+
+int main() {
+	srand(1);
+	testWelford();
+	testExponential<4>();
+	testExponential<32>();
+	testExponential<256>();
+	testExtremes();
+	testChannels();
+
+	cout << "RssiStats SUCCESS" << endl;
+	return 0;
+}
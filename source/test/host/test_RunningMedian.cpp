@@ -0,0 +1,231 @@
+/**
+ * Replays current RMS traces of overload scenarios through the running median, and through the copy and opt_med()
+ * that PowerSampling used before, and checks that the soft fuse triggers at the same period.
+ */
+
+#include <cfg/cs_Config.h>
+#include <third/optmed.h>
+#include <util/cs_RunningMedian.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+const int32_t THRESHOLD_MA = CURRENT_USAGE_THRESHOLD;
+const int32_t THRESHOLD_DIMMER_MA = CURRENT_USAGE_THRESHOLD_DIMMER;
+const int NOT_TRIGGERED = -1;
+
+/**
+ * The filtering as PowerSampling did before: a circular buffer, copied and partially sorted by opt_med().
+ */
+struct reference_filter_t {
+	int32_t hist[POWER_SAMPLING_RMS_WINDOW_SIZE];
+	int32_t histCopy[POWER_SAMPLING_RMS_WINDOW_SIZE];
+	uint16_t count = 0;
+	uint16_t next = 0;
+
+	int32_t push(int32_t value) {
+		hist[next] = value;
+		next = (next + 1) % POWER_SAMPLING_RMS_WINDOW_SIZE;
+		if (count < POWER_SAMPLING_RMS_WINDOW_SIZE) {
+			count++;
+		}
+		if (count == POWER_SAMPLING_RMS_WINDOW_SIZE) {
+			memcpy(histCopy, hist, sizeof(hist));
+			return opt_med9(histCopy);
+		}
+		int64_t sum = 0;
+		for (uint16_t i = 0; i < count; ++i) {
+			sum += hist[i];
+		}
+		return sum / count;
+	}
+};
+
+int32_t filter(RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE>& hist, int32_t value) {
+	hist.push(value);
+	return hist.full() ? hist.getMedian() : hist.getMean();
+}
+
+/**
+ * The consecutive overcurrent counting of PowerSampling::checkSoftfuse().
+ */
+struct soft_fuse_t {
+	uint32_t consecutiveOvercurrent = 0;
+	uint32_t consecutiveDimmerOvercurrent = 0;
+	int triggeredPeriod = NOT_TRIGGERED;
+	int triggeredDimmerPeriod = NOT_TRIGGERED;
+
+	void check(int32_t filteredCurrentRmsMilliAmp, int period) {
+		consecutiveOvercurrent = filteredCurrentRmsMilliAmp > THRESHOLD_MA ? consecutiveOvercurrent + 1 : 0;
+		if (consecutiveOvercurrent > CURRENT_THRESHOLD_CONSECUTIVE && triggeredPeriod == NOT_TRIGGERED) {
+			triggeredPeriod = period;
+			return;
+		}
+		consecutiveDimmerOvercurrent = filteredCurrentRmsMilliAmp > THRESHOLD_DIMMER_MA ? consecutiveDimmerOvercurrent + 1 : 0;
+		if (consecutiveDimmerOvercurrent > CURRENT_THRESHOLD_DIMMER_CONSECUTIVE && triggeredDimmerPeriod == NOT_TRIGGERED) {
+			triggeredDimmerPeriod = period;
+		}
+	}
+};
+
+/**
+ * A current RMS trace, as function of the period.
+ */
+typedef function<int32_t(int)> trace_t;
+
+int32_t noise(int32_t amplitude) {
+	return rand() % (2 * amplitude + 1) - amplitude;
+}
+
+/**
+ * Replay a trace through both filters, and check that the filtered values and the trigger periods are the same.
+ *
+ * @return The soft fuse result.
+ */
+soft_fuse_t replay(const char* name, int periods, trace_t trace) {
+	reference_filter_t reference;
+	RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE> hist;
+	soft_fuse_t expected;
+	soft_fuse_t result;
+	for (int period = 0; period < periods; ++period) {
+		int32_t currentRmsMilliAmp = trace(period);
+		int32_t expectedFiltered = reference.push(currentRmsMilliAmp);
+		int32_t filtered = filter(hist, currentRmsMilliAmp);
+		assert(filtered == expectedFiltered);
+		expected.check(expectedFiltered, period);
+		result.check(filtered, period);
+	}
+	cout << name << ": triggered at " << result.triggeredPeriod << " (" << expected.triggeredPeriod << ")"
+		 << " dimmer at " << result.triggeredDimmerPeriod << " (" << expected.triggeredDimmerPeriod << ")" << endl;
+	assert(result.triggeredPeriod == expected.triggeredPeriod);
+	assert(result.triggeredDimmerPeriod == expected.triggeredDimmerPeriod);
+	return result;
+}
+
+void testScenarios() {
+	const int periods = 1000;
+	const int start = 200;
+	// Number of values above the threshold before the median is.
+	const int medianDelay = POWER_SAMPLING_RMS_WINDOW_SIZE / 2;
+	soft_fuse_t result;
+
+	result = replay("no load", periods, [](int) { return 20 + noise(20); });
+	assert(result.triggeredPeriod == NOT_TRIGGERED);
+	assert(result.triggeredDimmerPeriod == NOT_TRIGGERED);
+
+	result = replay("normal load", periods, [](int) { return 8000 + noise(500); });
+	assert(result.triggeredPeriod == NOT_TRIGGERED);
+
+	result = replay("step overload", periods, [&](int period) { return period < start ? 8000 : 20000; });
+	assert(result.triggeredPeriod == start + medianDelay + CURRENT_THRESHOLD_CONSECUTIVE);
+	assert(result.triggeredDimmerPeriod == NOT_TRIGGERED || result.triggeredDimmerPeriod < result.triggeredPeriod);
+
+	result = replay("noisy overload", periods, [&](int period) { return (period < start ? 8000 : 17000) + noise(1500); });
+	assert(result.triggeredPeriod != NOT_TRIGGERED);
+
+	// Short peaks are filtered out by the median.
+	result = replay("inrush", periods, [&](int period) { return (period >= start && period < start + medianDelay) ? 60000 : 8000; });
+	assert(result.triggeredPeriod == NOT_TRIGGERED);
+
+	// Overload every other period: more than half of the window is never above the threshold.
+	result = replay("intermittent", periods, [&](int period) { return (period >= start && period % 2) ? 30000 : 2000; });
+	assert(result.triggeredPeriod == NOT_TRIGGERED);
+
+	// Overload 3 out of 4 periods: the median stays above the threshold.
+	result = replay("mostly overload", periods, [&](int period) { return (period >= start && period % 4) ? 30000 : 2000; });
+	assert(result.triggeredPeriod != NOT_TRIGGERED);
+
+	result = replay("slow ramp", periods, [](int period) { return period * 25 + noise(300); });
+	assert(result.triggeredPeriod != NOT_TRIGGERED);
+
+	result = replay("dimmer overload", periods, [&](int period) { return (period < start ? 300 : 1500) + noise(100); });
+	assert(result.triggeredPeriod == NOT_TRIGGERED);
+	assert(result.triggeredDimmerPeriod == start + medianDelay + CURRENT_THRESHOLD_DIMMER_CONSECUTIVE);
+
+	// Dropping below the threshold for a few periods resets the count, but only when the median drops too.
+	result = replay("overload with dips", periods, [&](int period) { return (period >= start && period % 50 < 46) ? 20000 : 8000; });
+	assert(result.triggeredPeriod != NOT_TRIGGERED);
+
+	result = replay("random", periods * 10, [](int) { return rand() % 40000; });
+}
+
+/**
+ * Check median, max, and mean against a sorted copy of the window, for several window sizes.
+ */
+template <uint16_t WindowSize>
+void testWindow(int32_t range) {
+	RunningMedian<WindowSize> hist;
+	vector<int32_t> values;
+	assert(hist.empty());
+	for (int i = 0; i < 2000; ++i) {
+		int32_t value = rand() % (2 * range + 1) - range;
+		hist.push(value);
+		values.push_back(value);
+		vector<int32_t> window(values.end() - min<size_t>(values.size(), WindowSize), values.end());
+		assert(hist.size() == window.size());
+		assert(hist.full() == (window.size() == WindowSize));
+		int64_t sum = 0;
+		for (auto v : window) {
+			sum += v;
+		}
+		assert(hist.getMean() == sum / (int64_t)window.size());
+		sort(window.begin(), window.end());
+		assert(hist.getMedian() == window[window.size() / 2]);
+		assert(hist.getMax() == window.back());
+	}
+	hist.clear();
+	assert(hist.empty());
+	hist.push(-5);
+	assert(hist.getMedian() == -5 && hist.getMax() == -5 && hist.getMean() == -5);
+}
+
+void testWindows() {
+	testWindow<2>(1000);
+	testWindow<3>(1000);
+	testWindow<7>(3);
+	testWindow<9>(1000000);
+	testWindow<10>(10);
+	testWindow<25>(100000);
+}
+
+void benchmark() {
+	const int iterations = 1000000;
+	vector<int32_t> trace(iterations);
+	for (auto& value : trace) {
+		value = 8000 + noise(500);
+	}
+	reference_filter_t reference;
+	RunningMedian<POWER_SAMPLING_RMS_WINDOW_SIZE> hist;
+	int64_t checksum = 0;
+
+	auto start = chrono::steady_clock::now();
+	for (auto value : trace) {
+		checksum += reference.push(value);
+	}
+	auto middle = chrono::steady_clock::now();
+	for (auto value : trace) {
+		checksum -= filter(hist, value);
+	}
+	auto end = chrono::steady_clock::now();
+	assert(checksum == 0);
+	cout << "copy and opt_med: " << chrono::duration<double, nano>(middle - start).count() / iterations << " ns per period" << endl;
+	cout << "running median: " << chrono::duration<double, nano>(end - middle).count() / iterations << " ns per period" << endl;
+}
+
+int main() {
+	static_assert(POWER_SAMPLING_RMS_WINDOW_SIZE == 9, "The reference uses opt_med9()");
+	srand(1);
+	testWindows();
+	testScenarios();
+	benchmark();
+	cout << "RunningMedian SUCCESS" << endl;
+	return 0;
+}
@@ -0,0 +1,242 @@
+/**
+ * Tests the timer wheel at the cascade boundaries of each level, with callbacks that cancel and schedule entries,
+ * and with a seconds counter that wraps around.
+ */
+
+#include <time/cs_TimerWheel.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+const uint32_t NOT_EXPIRED = 0xFFFFFFFF;
+
+/**
+ * A timer that remembers at which second of the wheel it expired.
+ */
+struct test_timer_t {
+	timer_wheel_entry_t entry;
+	TimerWheel* wheel = nullptr;
+	uint32_t expiredAt = NOT_EXPIRED;
+	uint32_t expiredCount = 0;
+
+	//! When set, this entry is cancelled by the callback.
+	test_timer_t* cancelOther = nullptr;
+	//! When not 0, the callback schedules this timer again with this delay.
+	uint32_t rescheduleDelay = 0;
+	//! Number of times the callback schedules this timer again.
+	uint32_t rescheduleCount = 0;
+
+	test_timer_t(TimerWheel& timerWheel) : wheel(&timerWheel) {
+		entry.callback = onExpired;
+		entry.context = this;
+	}
+
+	static void onExpired(void* context) {
+		test_timer_t* timer = static_cast<test_timer_t*>(context);
+		assert(!TimerWheel::isScheduled(timer->entry));
+		timer->expiredAt = timer->wheel->getSeconds();
+		timer->expiredCount++;
+		if (timer->cancelOther != nullptr) {
+			timer->wheel->cancel(timer->cancelOther->entry);
+		}
+		if (timer->rescheduleCount != 0) {
+			timer->rescheduleCount--;
+			timer->wheel->schedule(timer->entry, timer->rescheduleDelay);
+		}
+	}
+};
+
+/**
+ * Schedule a timer, and check that it expires exactly after the delay.
+ */
+void checkDelay(uint32_t startSeconds, uint32_t delay) {
+	TimerWheel wheel(startSeconds);
+	test_timer_t timer(wheel);
+	wheel.schedule(timer.entry, delay);
+	for (uint32_t i = 1; i < delay; ++i) {
+		wheel.tickSecond();
+		if (timer.expiredCount != 0) {
+			cout << "start=" << startSeconds << " delay=" << delay << " expired after " << i << " seconds" << endl;
+			assert(false);
+		}
+		assert(wheel.getSecondsLeft(timer.entry) == delay - i);
+	}
+	wheel.tickSecond();
+	if (timer.expiredCount != 1) {
+		cout << "start=" << startSeconds << " delay=" << delay << " did not expire" << endl;
+		assert(false);
+	}
+	assert(timer.expiredAt == startSeconds + delay);
+	assert(!TimerWheel::isScheduled(timer.entry));
+	assert(wheel.getSecondsLeft(timer.entry) == 0);
+}
+
+/**
+ * Delays around the size of each level, from start times around the wrap of each level.
+ */
+void testBoundaries() {
+	const uint32_t level1 = 1 << TIMER_WHEEL_SLOT_BITS;
+	const uint32_t level2 = 1 << (2 * TIMER_WHEEL_SLOT_BITS);
+	const uint32_t wheelSize = 1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS);
+	vector<uint32_t> delays = {
+			1, 2,
+			level1 - 1, level1, level1 + 1,
+			level2 - 1, level2, level2 + 1,
+			wheelSize - 1, wheelSize, wheelSize + 1,
+			2 * wheelSize + level2 + 3
+	};
+	vector<uint32_t> starts = {
+			0, 1,
+			level1 - 1, level1,
+			level2 - 1, level2,
+			wheelSize - 1, wheelSize - level1 + 5
+	};
+	for (auto start : starts) {
+		for (auto delay : delays) {
+			checkDelay(start, delay);
+		}
+	}
+}
+
+/**
+ * The seconds counter wraps around at every level at the same time.
+ */
+void testWraparound() {
+	for (uint32_t before : {1u, 2u, 63u, 64u, 4095u, 4096u, 4097u}) {
+		for (uint32_t delay : {1u, 63u, 64u, 65u, 4095u, 4096u, 4097u, 10000u}) {
+			checkDelay(0 - before, delay);
+		}
+	}
+}
+
+/**
+ * A delay of 0 expires at the next tick, like a delay of 1.
+ */
+void testZeroDelay() {
+	TimerWheel wheel(100);
+	test_timer_t timer(wheel);
+	wheel.schedule(timer.entry, 0);
+	assert(wheel.getSecondsLeft(timer.entry) == 1);
+	wheel.tickSecond();
+	assert(timer.expiredAt == 101);
+}
+
+/**
+ * Scheduling again moves the entry, cancelling removes it.
+ */
+void testRescheduleAndCancel() {
+	TimerWheel wheel(0);
+	test_timer_t a(wheel);
+	test_timer_t b(wheel);
+	wheel.schedule(a.entry, 4096);
+	wheel.schedule(b.entry, 10);
+	wheel.schedule(a.entry, 5);
+	wheel.cancel(b.entry);
+	assert(!TimerWheel::isScheduled(b.entry));
+	// Cancelling again does nothing.
+	wheel.cancel(b.entry);
+	for (int i = 0; i < 5000; ++i) {
+		wheel.tickSecond();
+	}
+	assert(a.expiredCount == 1 && a.expiredAt == 5);
+	assert(b.expiredCount == 0);
+}
+
+/**
+ * Callbacks that cancel an entry of the same slot, or schedule their own entry again.
+ */
+void testCallbacks() {
+	for (uint32_t delay : {1u, 64u, 4096u}) {
+		TimerWheel wheel(7);
+		test_timer_t first(wheel);
+		test_timer_t second(wheel);
+		test_timer_t rearmed(wheel);
+		wheel.schedule(first.entry, delay);
+		wheel.schedule(second.entry, delay);
+		wheel.schedule(rearmed.entry, delay);
+
+		// The order within a slot is not defined: whichever expires first cancels the other.
+		first.cancelOther = &second;
+		second.cancelOther = &first;
+		rearmed.rescheduleDelay = 0;
+		rearmed.rescheduleCount = 1;
+		for (uint32_t i = 0; i < delay; ++i) {
+			wheel.tickSecond();
+		}
+		assert(first.expiredCount + second.expiredCount == 1);
+		assert(!TimerWheel::isScheduled(first.entry) && !TimerWheel::isScheduled(second.entry));
+		assert(rearmed.expiredCount == 1 && TimerWheel::isScheduled(rearmed.entry));
+		wheel.tickSecond();
+		assert(rearmed.expiredCount == 2 && rearmed.expiredAt == 7 + delay + 1);
+		assert(first.expiredCount + second.expiredCount == 1);
+
+		// An entry that schedules itself every 64 seconds, across all levels.
+		test_timer_t periodic(wheel);
+		periodic.rescheduleDelay = 64;
+		periodic.rescheduleCount = 100;
+		uint32_t start = wheel.getSeconds();
+		wheel.schedule(periodic.entry, 64);
+		for (uint32_t i = 0; i < 101 * 64 + 10; ++i) {
+			wheel.tickSecond();
+		}
+		assert(periodic.expiredCount == 101);
+		assert(periodic.expiredAt == start + 101 * 64);
+		assert(!TimerWheel::isScheduled(periodic.entry));
+	}
+}
+
+/**
+ * Many entries with random delays, checked against the expiry time of each entry.
+ */
+void testRandom(uint32_t startSeconds, uint16_t count, uint32_t maxDelay, uint32_t seconds) {
+	TimerWheel wheel(startSeconds);
+	vector<test_timer_t> timers(count, test_timer_t(wheel));
+	vector<bool> pending(count, false);
+	vector<uint32_t> expected(count, 0);
+	for (uint32_t s = 0; s < seconds; ++s) {
+		uint16_t i = rand() % count;
+		if (rand() % 4 == 0) {
+			wheel.cancel(timers[i].entry);
+			pending[i] = false;
+		}
+		else {
+			// Set the pointers, as the vector copied the entries.
+			timers[i].entry.context = &timers[i];
+			uint32_t delay = 1 + rand() % maxDelay;
+			wheel.schedule(timers[i].entry, delay);
+			pending[i] = true;
+			expected[i] = wheel.getSeconds() + delay;
+		}
+		wheel.tickSecond();
+		for (uint16_t j = 0; j < count; ++j) {
+			if (pending[j] && expected[j] == wheel.getSeconds()) {
+				assert(timers[j].expiredAt == expected[j]);
+				pending[j] = false;
+			}
+			else if (pending[j]) {
+				assert(TimerWheel::isScheduled(timers[j].entry));
+				assert(wheel.getSecondsLeft(timers[j].entry) == expected[j] - wheel.getSeconds());
+			}
+			else {
+				assert(!TimerWheel::isScheduled(timers[j].entry));
+			}
+		}
+	}
+}
+
+int main() {
+	srand(1);
+	testBoundaries();
+	testWraparound();
+	testZeroDelay();
+	testRescheduleAndCancel();
+	testCallbacks();
+	testRandom(0, 20, 100, 10000);
+	testRandom(0 - 5000, 50, 5000, 20000);
+	cout << "TimerWheel SUCCESS" << endl;
+	return 0;
+}